@@ -21,6 +21,7 @@
 
 #include <neogfx/neogfx.hpp>
 #include <map>
+#include <unordered_map>
 #include <boost/optional.hpp>
 #include <boost/pool/pool_alloc.hpp>
 #include <neolib/async_thread.hpp>
@@ -78,7 +79,15 @@ namespace neogfx
 	private:
 		typedef std::map<std::string, style> style_list;
 		typedef std::multimap<std::string, action, std::less<std::string>, boost::fast_pool_allocator<std::pair<const std::string, action>>> action_list;
-		typedef std::vector<i_mnemonic*> mnemonic_list;
+		typedef std::unordered_map<const i_action*, sink> action_sinks;
+		typedef std::unordered_map<i_mnemonic*, char32_t> mnemonic_list;
+		typedef std::unordered_map<char32_t, std::vector<i_mnemonic*>> mnemonic_map;
+		typedef std::unordered_map<i_surface*, mnemonic_map> mnemonic_index;
+		struct shortcut_node
+		{
+			std::vector<i_action*> actions;
+			std::unordered_map<key_sequence::combo_key, std::unique_ptr<shortcut_node>> children;
+		};
 	public:
 		struct no_instance : std::logic_error { no_instance() : std::logic_error("neogfx::app::no_instance") {} };
 		struct no_basic_services : std::logic_error { no_basic_services() : std::logic_error("neogfx::app::no_basic_services") {} };
@@ -144,6 +153,7 @@ namespace neogfx
 		void remove_action(i_action& aAction) override;
 		void add_mnemonic(i_mnemonic& aMnemonic) override;
 		void remove_mnemonic(i_mnemonic& aMnemonic) override;
+		void invalidate_mnemonics() override;
 	public:
 		i_menu& add_standard_menu(i_menu& aParentMenu, standard_menu aStandardMenu) override;
 	public:
@@ -152,7 +162,13 @@ namespace neogfx
 		bool process_events() override;
 		bool process_events(i_event_processing_context& aContext) override;
 	private:
+		void wake_owner_thread() override;
 		bool do_process_events();
+		i_action& register_action(i_action& aAction);
+		void unregister_action(i_action& aAction);
+		void rebuild_shortcuts();
+		void update_standard_actions();
+		void rebuild_mnemonic_index();
 	private:
 		bool key_pressed(scan_code_e aScanCode, key_code_e aKeyCode, key_modifiers_e aKeyModifiers) override;
 		bool key_released(scan_code_e aScanCode, key_code_e aKeyCode, key_modifiers_e aKeyModifiers) override;
@@ -175,6 +191,10 @@ namespace neogfx
 		texture iDefaultWindowIcon;
 		style_list iStyles;
 		style_list::iterator iCurrentStyle;
+		shortcut_node iShortcuts;
+		bool iShortcutsInvalid;
+		const shortcut_node* iShortcutState;
+		action_sinks iActionSinks;
 		action_list iActions;
 		i_action& iActionFileNew;
 		i_action& iActionFileOpen;
@@ -190,11 +210,13 @@ namespace neogfx
 		i_action& iActionPaste;
 		i_action& iActionDelete;
 		i_action& iActionSelectAll;
-		neolib::callback_timer iStandardActionManager;
+		sink iClipboardSink;
+		sink iActiveClipboardSinkSink;
 		mnemonic_list iMnemonics;
+		mnemonic_index iMnemonicIndex;
+		bool iMnemonicIndexInvalid;
 		event_processing_context iAppContext;
 		event_processing_context iAppMessageQueueContext;
-		std::vector<std::pair<key_code_e, key_modifiers_e>> iKeySequence;
 		mutable std::unique_ptr<i_help> iHelp;
 	};
 }
\ No newline at end of file
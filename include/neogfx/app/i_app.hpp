@@ -115,6 +115,7 @@ namespace neogfx
 		virtual void remove_action(i_action& aAction) = 0;
 		virtual void add_mnemonic(i_mnemonic& aMnemonic) = 0;
 		virtual void remove_mnemonic(i_mnemonic& aMnemonic) = 0;
+		virtual void invalidate_mnemonics() = 0;
 	public:
 		virtual i_menu& add_standard_menu(i_menu& aParentMenu, standard_menu aStandardMenu) = 0;
 	public:
@@ -28,6 +28,8 @@ namespace neogfx
 
 	class i_clipboard_sink
 	{
+	public:
+		event<> sink_state_changed; // result of one or more can_xxx() may have changed
 	public:
 		virtual bool can_undo() const = 0;
 		virtual bool can_redo() const = 0;
@@ -53,6 +55,7 @@ namespace neogfx
 	public:
 		event<> sink_activated;
 		event<> sink_deactivated;
+		event<> updated;
 	public:
 		virtual bool sink_active() const = 0;
 		virtual i_clipboard_sink& active_sink() = 0;
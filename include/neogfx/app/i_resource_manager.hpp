@@ -24,12 +24,18 @@
 
 namespace neogfx
 {
+	class mapped_zip_archive;
+	class mapped_resource_archive;
+
 	class i_resource_manager
 	{
 	public:
 		virtual void add_resource(const std::string& aUri, const void* aResourceData, std::size_t aResourceSize) = 0;
 		virtual void add_module_resource(const std::string& aUri, const void* aResourceData, std::size_t aResourceSize) = 0;
+		virtual void add_module_archive(const void* aArchiveData, std::size_t aArchiveSize) = 0;
+		virtual void add_archive(const std::string& aArchivePath) = 0;
 		virtual i_resource::pointer load_resource(const std::string& aUri) = 0;
+		virtual std::shared_ptr<const mapped_zip_archive> load_archive(const std::string& aArchiveUri) = 0;
 	public:
 		virtual void cleanup() = 0;
 		virtual void clean() = 0;
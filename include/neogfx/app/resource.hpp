@@ -32,6 +32,7 @@ namespace neogfx
 		resource() = delete;
 		resource(i_resource_manager& aManager, const std::string& aUri);
 		resource(i_resource_manager& aManager, const std::string& aUri, const void* aData, std::size_t aSize);
+		resource(i_resource_manager& aManager, const std::string& aUri, std::vector<uint8_t>&& aData);
 		~resource();
 	public:
 		virtual bool available() const;
@@ -50,6 +51,10 @@ namespace neogfx
 		std::string iUri;
 		boost::optional<std::string> iError;
 		std::size_t iSize;
+		std::shared_ptr<const mapped_zip_archive> iArchive;
+		boost::optional<std::size_t> iArchiveEntry;
+		const void* iView;
+		mutable std::shared_ptr<const std::vector<uint8_t>> iInflated;
 		std::vector<uint8_t> iData;
 	};
 }
\ No newline at end of file
@@ -33,12 +33,16 @@ namespace neogfx
 	public:
 		virtual void add_resource(const std::string& aUri, const void* aResourceData, std::size_t aResourceSize);
 		virtual void add_module_resource(const std::string& aUri, const void* aResourceData, std::size_t aResourceSize);
+		virtual void add_module_archive(const void* aArchiveData, std::size_t aArchiveSize);
+		virtual void add_archive(const std::string& aArchivePath);
 		virtual i_resource::pointer load_resource(const std::string& aUri);
+		virtual std::shared_ptr<const mapped_zip_archive> load_archive(const std::string& aArchiveUri);
 	public:
 		virtual void cleanup();
 		virtual void clean();
 	private:
 		std::map<std::string, neolib::variant<i_resource::pointer, i_resource::weak_pointer>> iResources;
-		std::map<std::string, neolib::variant<i_resource::pointer, i_resource::weak_pointer>> iResourceArchives;
+		std::map<std::string, std::shared_ptr<const mapped_zip_archive>> iResourceArchives;
+		std::vector<std::shared_ptr<const mapped_resource_archive>> iIndexedArchives;
 	};
 }
\ No newline at end of file
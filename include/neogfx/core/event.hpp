@@ -22,11 +22,18 @@
 #include <neogfx/neogfx.hpp>
 #include <list>
 #include <deque>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <tuple>
+#include <type_traits>
 #include <boost/optional.hpp>
 #include <boost/pool/pool_alloc.hpp>
+#include <neolib/vecarray.hpp>
 #include <neolib/lifetime.hpp>
 #include <neolib/async_task.hpp>
-#include <neolib/timer.hpp>
 
 namespace neogfx
 {
@@ -45,11 +52,27 @@ namespace neogfx
 		typedef const void* unique_id_type;
 		typedef std::function<void(Arguments...)> handler_callback;
 		typedef uint32_t sink_reference_count;
-		struct handler_list_item { boost::optional<std::thread::id> iThreadId; unique_id_type iUniqueId; handler_callback iHandlerCallback; sink_reference_count iSinkReferenceCount; };
-		typedef std::list<handler_list_item, boost::fast_pool_allocator<handler_list_item>> handler_list;
+		struct handler_list_item 
+		{ 
+			handler_list_item(const boost::optional<std::thread::id>& aThreadId, unique_id_type aUniqueId, const handler_callback& aHandlerCallback) :
+				iThreadId{ aThreadId }, iUniqueId{ aUniqueId }, iHandlerCallback{ aHandlerCallback }, iSinkReferenceCount{ std::make_shared<std::atomic<sink_reference_count>>(0u) }, iSubscribed{ true }
+			{
+			}
+			// a resubscription with the same unique id; sinks of either item keep the subscription alive
+			handler_list_item(const handler_list_item& aReplaced, const handler_callback& aHandlerCallback) :
+				iThreadId{ aReplaced.iThreadId }, iUniqueId{ aReplaced.iUniqueId }, iHandlerCallback{ aHandlerCallback }, iSinkReferenceCount{ aReplaced.iSinkReferenceCount }, iSubscribed{ true }
+			{
+			}
+			boost::optional<std::thread::id> iThreadId; 
+			unique_id_type iUniqueId; 
+			handler_callback iHandlerCallback; 
+			std::shared_ptr<std::atomic<sink_reference_count>> iSinkReferenceCount;
+			std::atomic<bool> iSubscribed;
+		};
+		typedef std::shared_ptr<handler_list_item> handler_pointer;
 	public:
 		event_instance_weak_ptr iEvent;
-		typename handler_list::iterator iHandler;
+		handler_pointer iHandler;
 	public:
 		event_handle& operator~()
 		{
@@ -62,48 +85,77 @@ namespace neogfx
 	{
 	public:
 		typedef std::function<void()> callback;
+		struct statistics
+		{
+			uint64_t posted;
+			uint64_t coalesced;
+			uint64_t dispatched;
+			uint64_t discarded;
+			uint64_t wakeups;
+			std::chrono::nanoseconds totalLatency;
+			std::chrono::nanoseconds maxLatency;
+		};
 	public:
 		struct no_instance : std::logic_error { no_instance() : std::logic_error("neogfx::async_event_queue::no_instance") {} };
 		struct instance_exists : std::logic_error { instance_exists() : std::logic_error("neogfx::async_event_queue::instance_exists") {} };
-		struct event_not_found : std::logic_error { event_not_found() : std::logic_error("neogfx::async_event_queue::event_not_found") {} };
 	private:
-		typedef std::multimap<const void*, std::pair<callback, neolib::lifetime::destroyed_flag>> event_list;
-		typedef std::vector<callback> callback_list;
-		typedef std::map<std::thread::id, callback_list, std::less<std::thread::id>, boost::fast_pool_allocator<std::pair<const std::thread::id, callback_list>>> threaded_callbacks;
+		struct entry
+		{
+			std::atomic<entry*> next;
+			boost::optional<std::weak_ptr<void>> event;
+			callback function;
+			std::chrono::steady_clock::time_point posted;
+		};
+		// Intrusive multiple producer, single consumer queue (D. Vyukov); producers never block.
+		class entry_queue
+		{
+		public:
+			entry_queue();
+		public:
+			void push(entry* aEntry);
+			entry* pop();
+		private:
+			entry iStub;
+			std::atomic<entry*> iHead;
+			entry* iTail;
+		};
+		struct thread_queue
+		{
+			thread_queue(std::thread::id aThread) : thread{ aThread }, size{ 0u }, wakePending{ false }, next{ nullptr } {}
+			const std::thread::id thread;
+			entry_queue entries;
+			std::atomic<std::size_t> size;
+			std::atomic<bool> wakePending;
+			thread_queue* next;
+		};
 	public:
-		async_event_queue(neolib::async_task& aIoTask);
-		~async_event_queue();
+		async_event_queue();
+		virtual ~async_event_queue();
 		static async_event_queue& instance();
 	public:
-		template<typename... Arguments>
-		void add(const event<Arguments...>& aEvent, callback aCallback)
-		{
-			add(static_cast<const void*>(&aEvent), aCallback, neolib::lifetime::destroyed_flag(aEvent));
-		}
-		template<typename... Arguments>
-		void remove(const event<Arguments...>& aEvent)
-		{
-			remove(static_cast<const void*>(&aEvent));
-		}
-		template<typename... Arguments>
-		bool has(const event<Arguments...>& aEvent) const
-		{
-			return has(static_cast<const void*>(&aEvent));
-		}
 		bool exec();
+		void post(std::weak_ptr<void> aEvent, callback aCallback);
 		void enqueue_to_thread(std::thread::id aThreadId, callback aCallback);
+		void count_coalesced();
+		statistics stats() const;
+		void reset_stats();
+	protected:
+		virtual void wake_owner_thread();
 	private:
-		void add(const void* aEvent, callback aCallback, neolib::lifetime::destroyed_flag aDestroyedFlag);
-		void remove(const void* aEvent);
-		bool has(const void* aEvent) const;
-		void publish_events();
+		void push(std::thread::id aThreadId, std::unique_ptr<entry> aEntry);
+		thread_queue* find_queue(std::thread::id aThreadId) const;
+		thread_queue& queue(std::thread::id aThreadId);
 	private:
 		static async_event_queue* sInstance;
-		neolib::callback_timer iTimer;
-		event_list iEvents;
-		std::recursive_mutex iThreadedCallbacksMutex;
-		std::atomic<bool> iHaveThreadedCallbacks;
-		threaded_callbacks iThreadedCallbacks;
+		const std::thread::id iOwnerThread;
+		std::atomic<thread_queue*> iQueues;
+		std::atomic<uint64_t> iPosted;
+		std::atomic<uint64_t> iCoalesced;
+		std::atomic<uint64_t> iDispatched;
+		std::atomic<uint64_t> iDiscarded;
+		std::atomic<uint64_t> iWakeups;
+		std::atomic<int64_t> iTotalLatency;
+		std::atomic<int64_t> iMaxLatency;
 	};
 
 	enum class event_trigger_type
@@ -113,11 +165,26 @@ namespace neogfx
 		Asynchronous
 	};
 
+	enum class event_coalescing
+	{
+		All,
+		LatestWins,
+		Accumulate
+	};
+
+	// Asynchronous triggers store their arguments by value: copied, or moved in when the type is move-only
+	// (trigger with an rvalue). Only arguments that can be neither copied nor moved (e.g. abstract
+	// interfaces) are held by reference and must outlive delivery.
+	template <typename T>
+	using async_argument_t = typename std::conditional<
+		std::is_copy_constructible<typename std::decay<T>::type>::value || std::is_move_constructible<typename std::decay<T>::type>::value,
+		typename std::decay<T>::type,
+		std::reference_wrapper<typename std::remove_reference<T>::type>>::type;
+
 	template <typename... Arguments>
 	class event : protected neolib::lifetime
 	{
 		friend class sink;
-		friend class async_event_queue;
 	private:
 		typedef event_handle<Arguments...> handle;
 		typedef typename handle::event_ptr ptr;
@@ -127,24 +194,90 @@ namespace neogfx
 		typedef typename handle::handler_callback handler_callback;
 		typedef typename handle::sink_reference_count sink_reference_count;
 		typedef typename handle::handler_list_item handler_list_item;
-		typedef typename handle::handler_list handler_list;
-		typedef std::map<unique_id_type, typename handler_list::iterator> unique_id_map;
-		typedef std::deque<typename handler_list::const_iterator> notification_list;
+		typedef typename handle::handler_pointer handler_pointer;
+		typedef neolib::vecarray<handler_pointer, 4, -1> handler_list;
+	public:
+		typedef std::tuple<async_argument_t<Arguments>...> argument_pack;
+		typedef std::function<void(argument_pack& aPending, argument_pack&& aNext)> argument_accumulator;
+	public:
+		struct no_accumulator : std::logic_error { no_accumulator() : std::logic_error("neogfx::event::no_accumulator") {} };
+		struct argument_not_copyable : std::logic_error { argument_not_copyable() : std::logic_error("neogfx::event::argument_not_copyable") {} };
+	private:
+		// Triggers read an immutable handler snapshot published by subscribe/unsubscribe with a compare
+		// and swap; a replaced snapshot is retired until no trigger (or writer) can still be reading it.
+		// The trigger count shares a word with the destroyed bit so that exactly one of the event's
+		// destructor and the last trigger frees the instance data. Entering a trigger and publishing are
+		// both sequentially consistent: a reader increments the count before loading the snapshot and
+		// reclamation swaps the snapshot before checking the count, so one of them sees the other.
+		struct handler_snapshot
+		{
+			handler_snapshot() : nextRetired{ nullptr } {}
+			handler_snapshot(const handler_snapshot& aOther) : handlers{ aOther.handlers }, nextRetired{ nullptr } {}
+			handler_list handlers;
+			handler_snapshot* nextRetired;
+		};
 		struct instance_data
 		{
+			static const uint32_t Destroyed = 0x80000000u;
+			static const uint32_t TriggerCountMask = ~Destroyed;
+			instance_data(ptr aEvent) :
+				instancePtr{ std::make_shared<ptr>(aEvent) }, handlers{ nullptr }, state{ 0u }, retired{ nullptr }, triggerType{ event_trigger_type::Default }, accepted{ false },
+				coalescing{ event_coalescing::All }, pending{ nullptr }, scheduled{ false }
+			{
+			}
+			~instance_data()
+			{
+				delete pending.load();
+				delete handlers.load();
+				for (auto r = retired.load(); r != nullptr;)
+				{
+					auto next = r->nextRetired;
+					delete r;
+					r = next;
+				}
+			}
 			instance_ptr instancePtr;
-			handler_list handlers;
-			unique_id_map uniqueIdMap;
-			event_trigger_type triggerType;
-			bool accepted;
-			notification_list notifications;
+			std::atomic<handler_snapshot*> handlers;
+			std::atomic<uint32_t> state;
+			std::atomic<handler_snapshot*> retired;
+			std::atomic<event_trigger_type> triggerType;
+			std::atomic<bool> accepted;
+			std::atomic<event_coalescing> coalescing;
+			argument_accumulator accumulator;
+			std::atomic<argument_pack*> pending;
+			std::atomic<bool> scheduled;
+		};
+		class trigger_scope
+		{
+		public:
+			trigger_scope(instance_data& aInstance) :
+				iInstance{ aInstance }
+			{
+				iInstance.state.fetch_add(1u);
+			}
+			~trigger_scope()
+			{
+				auto const previous = iInstance.state.fetch_sub(1u);
+				if (previous == (instance_data::Destroyed | 1u))
+					delete &iInstance;
+				else if ((previous & instance_data::TriggerCountMask) == 1u && iInstance.retired.load() != nullptr)
+					event::reclaim(iInstance);
+			}
+		public:
+			bool destroyed() const
+			{
+				return (iInstance.state.load(std::memory_order_acquire) & instance_data::Destroyed) != 0u;
+			}
+		private:
+			instance_data& iInstance;
 		};
-		typedef std::list<instance_data, boost::fast_pool_allocator<instance_data>> instance_data_list;
 	public:
-		event()
+		event() :
+			iInstanceData{ nullptr }
 		{
 		}
-		event(const event&)
+		event(const event&) :
+			iInstanceData{ nullptr }
 		{
 			// do nothing.
 		}
@@ -167,12 +300,25 @@ namespace neogfx
 		{
 			instance().triggerType = aTriggerType;
 		}
+		event_coalescing coalescing() const
+		{
+			return instance().coalescing;
+		}
+		// Set before asynchronous triggers start; an accumulator may be called from any posting thread.
+		void set_coalescing(event_coalescing aCoalescing, const argument_accumulator& aAccumulator = argument_accumulator{})
+		{
+			if (aCoalescing == event_coalescing::Accumulate && !aAccumulator)
+				throw no_accumulator();
+			auto& data = instance();
+			data.accumulator = aAccumulator;
+			data.coalescing = aCoalescing;
+		}
 		template<class... Ts>
 		bool trigger(Ts&&... aArguments) const
 		{
 			if (!has_instance()) // no instance means no subscribers so no point triggering.
 				return true;
-			switch (instance().triggerType)
+			switch (instance().triggerType.load())
 			{
 			case event_trigger_type::Default:
 			case event_trigger_type::Synchronous:
@@ -186,27 +332,27 @@ namespace neogfx
 		template<class... Ts>
 		bool sync_trigger(Ts&&... aArguments) const
 		{
-			if (!has_instance()) // no instance means no subscribers so no point triggering.
+			auto instance = iInstanceData.load(std::memory_order_acquire);
+			if (instance == nullptr) // no instance means no subscribers so no point triggering.
 				return true;
-			destroyed_flag destroyed{ *this };
-			for (auto i = instance().handlers.begin(); i != instance().handlers.end(); ++i)
-				instance().notifications.push_back(i);
-			while (!instance().notifications.empty())
+			trigger_scope scope{ *instance };
+			auto snapshot = instance->handlers.load();
+			if (snapshot == nullptr)
+				return true;
+			auto const thisThread = std::this_thread::get_id();
+			// handlers subscribed during this trigger are not called; handlers unsubscribed during it are skipped
+			for (auto const& handler : snapshot->handlers)
 			{
-				auto i = instance().notifications.front();
-				instance().notifications.pop_front();
-				if (i->iThreadId == boost::none || *i->iThreadId == std::this_thread::get_id())
-					i->iHandlerCallback(std::forward<Ts>(aArguments)...);
+				if (!handler->iSubscribed.load(std::memory_order_acquire))
+					continue;
+				if (handler->iThreadId == boost::none || *handler->iThreadId == thisThread)
+					handler->iHandlerCallback(std::forward<Ts>(aArguments)...);
 				else
-					enqueue_to_thread(*i, std::forward<Ts>(aArguments)...);
-				if (destroyed)
+					enqueue_to_thread(*handler, std::forward<Ts>(aArguments)...);
+				if (scope.destroyed())
 					return false;
-				if (instance().accepted)
-				{
-					instance().notifications.clear();
-					instance().accepted = false;
+				if (instance->accepted.load(std::memory_order_relaxed) && instance->accepted.exchange(false))
 					return false;
-				}
 			}
 			return true;
 		}
@@ -215,7 +361,40 @@ namespace neogfx
 		{
 			if (!has_instance()) // no instance means no subscribers so no point triggering.
 				return;
-			async_event_queue::instance().add(*this, [this, &aArguments...]() { sync_trigger(std::forward<Ts>(aArguments)...); });
+			auto& data = instance();
+			auto& queue = async_event_queue::instance();
+			if (data.coalescing == event_coalescing::All)
+			{
+				queue.post(data.instancePtr, [this, arguments = queue_arguments(std::forward<Ts>(aArguments)...)]() mutable
+				{
+					sync_trigger_with(queued(arguments), std::index_sequence_for<Arguments...>{});
+				});
+				return;
+			}
+			// Coalesce into the event's single pending argument pack; at most one queue entry is outstanding per event.
+			std::unique_ptr<argument_pack> next{ new argument_pack{ std::forward<Ts>(aArguments)... } };
+			while (next != nullptr)
+			{
+				if (data.coalescing == event_coalescing::Accumulate)
+				{
+					std::unique_ptr<argument_pack> current{ data.pending.exchange(nullptr) };
+					if (current != nullptr)
+					{
+						data.accumulator(*current, std::move(*next));
+						next = std::move(current);
+						queue.count_coalesced();
+					}
+				}
+				std::unique_ptr<argument_pack> previous{ data.pending.exchange(next.release()) };
+				if (previous != nullptr && data.coalescing == event_coalescing::LatestWins)
+				{
+					previous.reset();
+					queue.count_coalesced();
+				}
+				next = std::move(previous); // another producer raced us when accumulating; fold its pack in too
+			}
+			if (!data.scheduled.exchange(true))
+				queue.post(data.instancePtr, [this]() { trigger_pending(); });
 		}
 		void accept() const
 		{
@@ -228,14 +407,36 @@ namespace neogfx
 	public:
 		handle subscribe(const handler_callback& aHandlerCallback, const void* aUniqueId = 0) const
 		{
-			if (aUniqueId == 0)
-				return handle{ instance().instancePtr, instance().handlers.insert(instance().handlers.end(), handler_list_item{ std::this_thread::get_id(), aUniqueId, aHandlerCallback, 0 }) };
-			auto existing = instance().uniqueIdMap.find(aUniqueId);
-			if (existing == instance().uniqueIdMap.end())
-				existing = instance().uniqueIdMap.insert(std::make_pair(aUniqueId, instance().handlers.insert(instance().handlers.end(), handler_list_item{ std::this_thread::get_id(), aUniqueId, aHandlerCallback, 0 }))).first;
-			else
-				existing->second->iHandlerCallback = aHandlerCallback;
-			return handle{ instance().instancePtr, existing->second };
+			auto& data = instance();
+			trigger_scope scope{ data };
+			handler_pointer newHandler;
+			for (;;)
+			{
+				auto current = data.handlers.load();
+				if (aUniqueId != 0)
+				{
+					auto existing = find(current, aUniqueId);
+					if (existing != nullptr)
+					{
+						// a trigger may be calling the existing handler so publish a replacement rather than assign to it
+						auto replacement = std::make_shared<handler_list_item>(*existing, aHandlerCallback);
+						std::unique_ptr<handler_snapshot> updated{ new handler_snapshot{ *current } };
+						std::replace(updated->handlers.begin(), updated->handlers.end(), existing, replacement);
+						if (publish(data, current, updated))
+						{
+							existing->iSubscribed = false;
+							return handle{ data.instancePtr, replacement };
+						}
+						continue;
+					}
+				}
+				if (newHandler == nullptr)
+					newHandler = std::make_shared<handler_list_item>(std::this_thread::get_id(), aUniqueId, aHandlerCallback);
+				std::unique_ptr<handler_snapshot> updated{ current != nullptr ? new handler_snapshot{ *current } : new handler_snapshot{} };
+				updated->handlers.push_back(newHandler);
+				if (publish(data, current, updated))
+					return handle{ data.instancePtr, newHandler };
+			}
 		}
 		handle operator()(const handler_callback& aHandlerCallback, const void* aUniqueId = 0) const
 		{
@@ -263,9 +464,13 @@ namespace neogfx
 		}
 		void unsubscribe(const void* aUniqueId) const
 		{
-			auto existing = instance().uniqueIdMap.find(aUniqueId);
-			if (existing != instance().uniqueIdMap.end())
-				unsubscribe(handle{ instance().instancePtr, existing->second });
+			if (!has_instance())
+				return;
+			auto& data = instance();
+			trigger_scope scope{ data };
+			auto existing = find(data.handlers.load(), aUniqueId);
+			if (existing != nullptr)
+				unsubscribe(handle{ data.instancePtr, existing });
 		}
 		template <typename T>
 		void unsubscribe(const T* aUniqueIdObject) const
@@ -280,48 +485,176 @@ namespace neogfx
 	private:
 		template<class... Ts>
 		void enqueue_to_thread(const handler_list_item& aItem, Ts&&... aArguments) const
+		{
+			enqueue_to_thread(std::is_copy_constructible<argument_pack>{}, aItem, std::forward<Ts>(aArguments)...);
+		}
+		// The arguments are copied, not forwarded, as the trigger still has to pass them to later handlers.
+		template<class... Ts>
+		void enqueue_to_thread(std::true_type, const handler_list_item& aItem, Ts&&... aArguments) const
 		{
 			auto& callback = aItem.iHandlerCallback;
-			async_event_queue::instance().enqueue_to_thread(*aItem.iThreadId, [callback, &aArguments...](){ callback(std::forward<Ts>(aArguments)...); });
+			async_event_queue::instance().enqueue_to_thread(*aItem.iThreadId, [callback, arguments = argument_pack{ aArguments... }]() mutable
+			{
+				call_with(callback, arguments, std::index_sequence_for<Arguments...>{});
+			});
+		}
+		// A synchronous trigger has no copy of a move-only argument to give to a handler on another thread.
+		template<class... Ts>
+		void enqueue_to_thread(std::false_type, const handler_list_item&, Ts&&...) const
+		{
+			throw argument_not_copyable();
+		}
+		// Queued callbacks are std::function objects which must be copyable so a pack holding a move-only
+		// argument is moved into shared storage rather than captured directly.
+		template<class... Ts>
+		static auto queue_arguments(Ts&&... aArguments)
+		{
+			return make_argument_pack(std::is_copy_constructible<argument_pack>{}, std::forward<Ts>(aArguments)...);
+		}
+		template<class... Ts>
+		static argument_pack make_argument_pack(std::true_type, Ts&&... aArguments)
+		{
+			return argument_pack{ std::forward<Ts>(aArguments)... };
+		}
+		template<class... Ts>
+		static std::shared_ptr<argument_pack> make_argument_pack(std::false_type, Ts&&... aArguments)
+		{
+			return std::make_shared<argument_pack>(std::forward<Ts>(aArguments)...);
+		}
+		static argument_pack& queued(argument_pack& aArguments)
+		{
+			return aArguments;
+		}
+		static argument_pack& queued(std::shared_ptr<argument_pack>& aArguments)
+		{
+			return *aArguments;
+		}
+		template <typename T>
+		static T& unpack(T& aArgument)
+		{
+			return aArgument;
+		}
+		template <typename T>
+		static T& unpack(std::reference_wrapper<T> aArgument)
+		{
+			return aArgument.get();
+		}
+		template <std::size_t... Indices>
+		bool sync_trigger_with(argument_pack& aArguments, std::index_sequence<Indices...>) const
+		{
+			return sync_trigger(unpack(std::get<Indices>(aArguments))...);
+		}
+		template <std::size_t... Indices>
+		static void call_with(const handler_callback& aCallback, argument_pack& aArguments, std::index_sequence<Indices...>)
+		{
+			aCallback(unpack(std::get<Indices>(aArguments))...);
+		}
+		void trigger_pending() const
+		{
+			auto& data = instance();
+			data.scheduled = false;
+			std::unique_ptr<argument_pack> pending{ data.pending.exchange(nullptr) };
+			if (pending != nullptr)
+				sync_trigger_with(*pending, std::index_sequence_for<Arguments...>{});
 		}
 		void clear()
 		{
-			if (async_event_queue::instance().has(*this))
-				async_event_queue::instance().remove(*this);
-			if (iInstanceData != boost::none)
+			auto data = iInstanceData.exchange(nullptr);
+			if (data != nullptr)
 			{
-				instance_list().erase(*iInstanceData);
-				iInstanceData = boost::none;
+				data->instancePtr.reset();
+				if ((data->state.fetch_or(instance_data::Destroyed) & instance_data::TriggerCountMask) == 0u)
+					delete data;
 			}
 		}
 		void unsubscribe(handle aHandle) const
 		{
-			instance().notifications.erase(std::remove(instance().notifications.begin(), instance().notifications.end(), aHandle.iHandler), instance().notifications.end());
-			if (aHandle.iHandler->iUniqueId != 0)
+			auto& data = instance();
+			trigger_scope scope{ data };
+			handler_pointer target;
+			for (;;)
 			{
-				auto existing = instance().uniqueIdMap.find(aHandle.iHandler->iUniqueId);
-				if (existing != instance().uniqueIdMap.end())
-					instance().uniqueIdMap.erase(existing);
+				auto current = data.handlers.load();
+				// a handler replaced by a resubscription with the same unique id is unsubscribed through its replacement
+				auto const found = aHandle.iHandler->iUniqueId != 0 ? find(current, aHandle.iHandler->iUniqueId) : aHandle.iHandler;
+				if (found != target)
+				{
+					if (found == nullptr || !found->iSubscribed.exchange(false))
+						return;
+					target = found;
+				}
+				std::unique_ptr<handler_snapshot> updated{ new handler_snapshot{} };
+				if (current != nullptr)
+					for (auto const& h : current->handlers)
+						if (h != target)
+							updated->handlers.push_back(h);
+				if (publish(data, current, updated))
+					return;
 			}
-			instance().handlers.erase(aHandle.iHandler);
 		}
-		bool has_instance() const
+		// Called inside a trigger_scope so that aCurrent cannot be reclaimed while it is being copied.
+		static handler_pointer find(const handler_snapshot* aCurrent, unique_id_type aUniqueId)
 		{
-			return iInstanceData != boost::none;
+			if (aCurrent != nullptr)
+				for (auto const& h : aCurrent->handlers)
+					if (h->iUniqueId == aUniqueId)
+						return h;
+			return nullptr;
 		}
-		instance_data& instance() const
+		// Called inside a trigger_scope; the scope reclaims the replaced snapshot once no trigger is left.
+		static bool publish(instance_data& aData, handler_snapshot* aCurrent, std::unique_ptr<handler_snapshot>& aUpdated)
 		{
-			if (iInstanceData == boost::none)
-				iInstanceData = instance_list().insert(instance_list().end(), instance_data{ instance_ptr{ new ptr{ this } } });
-			return **iInstanceData;
+			if (!aData.handlers.compare_exchange_strong(aCurrent, aUpdated.get()))
+				return false;
+			aUpdated.release();
+			if (aCurrent != nullptr)
+				retire(aData, aCurrent, aCurrent);
+			return true;
+		}
+		static void retire(instance_data& aData, handler_snapshot* aFirst, handler_snapshot* aLast)
+		{
+			aLast->nextRetired = aData.retired.load();
+			while (!aData.retired.compare_exchange_weak(aLast->nextRetired, aFirst));
 		}
-		static instance_data_list& instance_list()
+		static void reclaim(instance_data& aData)
+		{
+			auto retired = aData.retired.exchange(nullptr);
+			if (retired == nullptr)
+				return;
+			// every snapshot taken was unpublished before the exchange so only triggers that are still
+			// running can be reading one; if any are, hand the snapshots back for a later scope to free
+			if ((aData.state.load() & instance_data::TriggerCountMask) != 0u)
+			{
+				auto last = retired;
+				while (last->nextRetired != nullptr)
+					last = last->nextRetired;
+				retire(aData, retired, last);
+				return;
+			}
+			while (retired != nullptr)
+			{
+				auto next = retired->nextRetired;
+				delete retired;
+				retired = next;
+			}
+		}
+		bool has_instance() const
+		{
+			return iInstanceData.load(std::memory_order_acquire) != nullptr;
+		}
+		instance_data& instance() const
 		{
-			static instance_data_list sInstanceDataList;
-			return sInstanceDataList;
+			auto existing = iInstanceData.load(std::memory_order_acquire);
+			if (existing != nullptr)
+				return *existing;
+			auto newInstance = new instance_data{ this };
+			if (iInstanceData.compare_exchange_strong(existing, newInstance))
+				return *newInstance;
+			delete newInstance;
+			return *existing;
 		}
 	private:
-		mutable boost::optional<typename instance_data_list::iterator> iInstanceData;
+		mutable std::atomic<instance_data*> iInstanceData;
 	};
 
 	class sink
@@ -345,11 +678,15 @@ namespace neogfx
 						switch (aOperation)
 						{
 						case AddRef:
-							++aHandle.iHandler->iSinkReferenceCount;
+							++*aHandle.iHandler->iSinkReferenceCount;
 							break;
 						case Release:
-							if (--aHandle.iHandler->iSinkReferenceCount == 0 && !aHandle.iEvent.expired())
-								(**aHandle.iEvent.lock()).unsubscribe(aHandle);
+							if (--*aHandle.iHandler->iSinkReferenceCount == 0)
+							{
+								auto e = aHandle.iEvent.lock();
+								if (e != nullptr)
+									(**e).unsubscribe(aHandle);
+							}
 							break;
 						}
 					}
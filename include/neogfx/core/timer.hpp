@@ -0,0 +1,89 @@
+// timer.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <map>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <boost/optional.hpp>
+#include <neolib/lifetime.hpp>
+
+namespace neogfx
+{
+	class callback_timer;
+
+	// Timers run by the app's event loop on the GUI thread. Unlike neolib timers, which are polled, their
+	// deadlines are known to the loop so it can sleep until the next one is due. The service is not
+	// thread safe: timers must be started, cancelled and destroyed on the thread that first used it,
+	// which fires them; other threads should post to that thread's event queue instead.
+	class timer_service
+	{
+		friend class callback_timer;
+	public:
+		struct wrong_thread : std::logic_error { wrong_thread() : std::logic_error("neogfx::timer_service::wrong_thread") {} };
+	public:
+		typedef std::chrono::steady_clock clock;
+	private:
+		typedef std::pair<clock::time_point, uint64_t> schedule_key;
+		typedef std::map<schedule_key, callback_timer*> schedule;
+	public:
+		timer_service();
+		static timer_service& instance();
+	public:
+		boost::optional<clock::time_point> next_deadline() const;
+		bool fire_due_timers();
+	private:
+		schedule::iterator add(callback_timer& aTimer, clock::time_point aDeadline);
+		void remove(schedule::iterator aEntry);
+		void check_thread() const;
+	private:
+		std::thread::id iThread;
+		schedule iSchedule;
+		uint64_t iNextSequence;
+	};
+
+	class callback_timer : public neolib::lifetime
+	{
+		friend class timer_service;
+	public:
+		typedef timer_service::clock clock;
+		typedef std::function<void(callback_timer&)> callback;
+	public:
+		callback_timer(callback aCallback, uint32_t aDuration_ms, bool aInitialWait = true);
+		callback_timer(const callback_timer&) = delete;
+		virtual ~callback_timer();
+	public:
+		uint32_t duration() const;
+		void set_duration(uint32_t aDuration_ms, bool aEffectiveImmediately = false);
+		bool waiting() const;
+		void again();
+		void again_if();
+		void cancel();
+	private:
+		void schedule(clock::time_point aStarted);
+		void fire();
+	private:
+		callback iCallback;
+		uint32_t iDuration;
+		clock::time_point iStarted;
+		boost::optional<timer_service::schedule::iterator> iScheduled;
+	};
+}
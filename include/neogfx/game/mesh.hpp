@@ -43,6 +43,7 @@ namespace neogfx
 		void set_vertices(vertex_list_pointer aVertices) override;
 		void set_textures(texture_list_pointer aTextures) override;
 		void set_faces(face_list aFaces) override;
+		void set_transformation_matrix(const mat44& aTransformationMatrix);
 	private:
 		vertex_list_pointer iVertices;
 		texture_list_pointer iTextures;
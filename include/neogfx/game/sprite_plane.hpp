@@ -23,7 +23,7 @@
 #include <mutex>
 #include <boost/pool/pool_alloc.hpp>
 #include <boost/functional/hash.hpp>
-#include <neolib/timer.hpp>
+#include <neogfx/core/timer.hpp>
 #include <neogfx/gui/widget/widget.hpp>
 #include <neogfx/game/chrono.hpp>
 #include <neogfx/game/sprite.hpp>
@@ -121,7 +121,7 @@ namespace neogfx
 		void update_objects();
 		bool snapshot();
 	private:
-		neolib::callback_timer iUpdater;
+		callback_timer iUpdater;
 		bool iEnableDynamicUpdate;
 		bool iEnableZSorting;
 		bool iNeedsSorting;
@@ -346,6 +346,7 @@ namespace neogfx
 		void set_origin(const point& aOrigin) const;
 		point origin() const;
 		void flush() const;
+		uint64_t operation_count() const;
 		void scissor_on(const rect& aRect) const;
 		void scissor_off() const;
 		void clip_to(const rect& aRect) const;
@@ -448,6 +449,7 @@ namespace neogfx
 		static i_native_font_face& to_native_font_face(const font& aFont);
 		// own
 	private:
+		path& to_device_path(const path& aPath) const;
 		glyph_text::container to_glyph_text_impl(string::const_iterator aTextBegin, string::const_iterator aTextEnd, std::function<font(std::string::size_type)> aFontSelector) const;
 		glyph_text::container to_glyph_text_impl(std::u32string::const_iterator aTextBegin, std::u32string::const_iterator aTextEnd, std::function<font(std::u32string::size_type)> aFontSelector) const;
 		// attributes
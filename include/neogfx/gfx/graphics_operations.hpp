@@ -34,6 +34,9 @@ namespace neogfx
 {
 	namespace graphics_operation
 	{
+		// path and mesh payloads are owned by the enqueuing context's arena and are valid until it is flushed
+		class arena;
+
 		struct set_logical_coordinate_system
 		{
 			logical_coordinate_system system;
@@ -60,7 +63,7 @@ namespace neogfx
 
 		struct clip_to_path
 		{
-			path path;
+			const neogfx::path* path;
 			dimension pathOutline;
 		};
 
@@ -165,13 +168,13 @@ namespace neogfx
 
 		struct draw_path
 		{
-			path path;
+			const neogfx::path* path;
 			pen pen;
 		};
 
 		struct draw_shape
 		{
-			neogfx::mesh mesh;
+			const neogfx::mesh* mesh;
 			pen pen;
 		};
 
@@ -206,13 +209,13 @@ namespace neogfx
 
 		struct fill_path
 		{
-			path path;
+			const neogfx::path* path;
 			brush fill;
 		};
 
 		struct fill_shape
 		{
-			neogfx::mesh mesh;
+			const neogfx::mesh* mesh;
 			brush fill;
 		};
 
@@ -225,7 +228,7 @@ namespace neogfx
 
 		struct draw_textures
 		{
-			neogfx::mesh mesh;
+			const neogfx::mesh* mesh;
 			optional_colour colour;
 			shader_effect shaderEffect;
 		};
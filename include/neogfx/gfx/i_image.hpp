@@ -32,6 +32,13 @@ namespace neogfx
 		RGBA8
 	};
 
+	enum class resampling_filter
+	{
+		Box,
+		Bilinear,
+		Lanczos3
+	};
+
 	class i_image : public i_resource
 	{
 	public:
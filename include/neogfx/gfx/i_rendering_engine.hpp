@@ -20,6 +20,7 @@
 #pragma once
 
 #include <neogfx/neogfx.hpp>
+#include <chrono>
 #include <neogfx/core/numerical.hpp>
 #include <neogfx/core/geometry.hpp>
 #include <neogfx/gui/window/window.hpp>
@@ -44,6 +45,51 @@ namespace neogfx
 		Software
 	};
 
+	struct frame_statistics
+	{
+		uint64_t frames;
+		uint64_t missedDeadlines;
+		std::chrono::microseconds lastFrameTime;
+		std::chrono::microseconds worstFrameTime;
+		std::chrono::microseconds totalFrameTime;
+	};
+
+	struct render_call_counters
+	{
+		uint64_t calls;
+		uint64_t errorChecks;
+		uint64_t uniformUploads;
+		uint64_t redundantUniformUploads;
+		uint64_t stateChanges;
+		uint64_t redundantStateChanges;
+	};
+
+	struct shader_program_cache_statistics
+	{
+		uint64_t hits;
+		uint64_t misses;
+		uint64_t rejected;
+		std::chrono::microseconds compileTime;
+		std::chrono::microseconds loadTime;
+	};
+
+	// growths counts arenas created, slots added and recycled slots whose storage (path points or
+	// transformed mesh vertices) had to be enlarged; zero growths in a frame means no arena heap allocation
+	struct operation_arena_counters
+	{
+		uint64_t payloads;
+		uint64_t growths;
+	};
+
+	struct render_layer_statistics
+	{
+		uint64_t hits;
+		uint64_t rerenders;
+		uint64_t evictions;
+		uint64_t layers;
+		uint64_t bytes;
+	};
+
 	class i_rendering_engine
 	{
 	public:
@@ -59,6 +105,7 @@ namespace neogfx
 			virtual bool has_projection_matrix() const = 0;
 			virtual void set_projection_matrix(const i_native_graphics_context& aGraphicsContext) = 0;
 			virtual void* variable(const std::string& aVariableName) const = 0;
+			virtual int32_t attribute_location(const std::string& aVariableName) const = 0;
 			virtual void set_uniform_variable(const std::string& aName, float aValue) = 0;
 			virtual void set_uniform_variable(const std::string& aName, double aValue) = 0;
 			virtual void set_uniform_variable(const std::string& aName, int aValue) = 0;
@@ -125,11 +172,24 @@ namespace neogfx
 		virtual void subpixel_rendering_off() = 0;
 	public:
 		virtual void render_now() = 0;
+		virtual bool render_frame() = 0;
+		virtual void wait_for_frame() = 0;
+		virtual const boost::optional<std::chrono::milliseconds>& maximum_idle_wait() const = 0;
+		virtual void set_maximum_idle_wait(const boost::optional<std::chrono::milliseconds>& aWait) = 0;
 	public:
 		virtual bool process_events() = 0;
+		virtual void wake() = 0;
 	public:
 		virtual void register_frame_counter(i_widget& aWidget, uint32_t aDuration) = 0;
 		virtual void unregister_frame_counter(i_widget& aWidget, uint32_t aDuration) = 0;
 		virtual uint32_t frame_counter(uint32_t aDuration) const = 0;
+		virtual const frame_statistics& frame_stats() const = 0;
+		virtual const frame_statistics& frame_stats(uint32_t aDuration) const = 0;
+		virtual const render_call_counters& frame_call_counters() const = 0;
+		virtual const operation_arena_counters& frame_arena_counters() const = 0;
+		virtual const shader_program_cache_statistics& shader_program_cache_stats() const = 0;
+		virtual const render_layer_statistics& render_layer_stats() const = 0;
+		virtual uint64_t render_layer_budget() const = 0;
+		virtual void set_render_layer_budget(uint64_t aBytes) = 0;
 	};
 }
\ No newline at end of file
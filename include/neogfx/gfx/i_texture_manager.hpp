@@ -28,6 +28,23 @@ namespace neogfx
 {
 	class i_native_texture;
 
+	struct texture_page_usage
+	{
+		const void* id;
+		std::string uri;
+		size storageExtents;
+		texture_sampling sampling;
+		std::size_t bytes;
+		long references;
+	};
+
+	struct texture_memory_usage
+	{
+		std::size_t textureCount;
+		std::size_t bytes;
+		std::vector<texture_page_usage> pages;
+	};
+
 	class i_texture_manager
 	{
 	public:
@@ -39,5 +56,6 @@ namespace neogfx
 		virtual std::unique_ptr<i_native_texture> join_texture(const i_texture& aTexture) = 0;
 		virtual void clear_textures() = 0;
 		virtual std::unique_ptr<i_texture_atlas> create_texture_atlas(const size& aSize = size{ 1024.0, 1024.0 }) = 0;
+		virtual texture_memory_usage memory_usage() const = 0;
 	};
 }
\ No newline at end of file
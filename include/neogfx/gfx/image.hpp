@@ -42,6 +42,8 @@ namespace neogfx
 		image(dimension aDpiScaleFactor = 1.0, texture_sampling aSampling = texture_sampling::NormalMipmap);
 		image(const neogfx::size& aSize, const colour& aColour = colour::Black, dimension aDpiScaleFactor = 1.0, texture_sampling aSampling = texture_sampling::NormalMipmap);
 		image(const std::string& aUri, dimension aDpiScaleFactor = 1.0, texture_sampling aSampling = texture_sampling::NormalMipmap);
+		image(const std::string& aUri, const void* aEncodedData, std::size_t aEncodedSize, dimension aDpiScaleFactor = 1.0, texture_sampling aSampling = texture_sampling::NormalMipmap);
+		image(i_resource::pointer aResource, dimension aDpiScaleFactor = 1.0, texture_sampling aSampling = texture_sampling::NormalMipmap);
 		image(const std::string& aImagePattern, const std::unordered_map<std::string, colour>& aColourMap, dimension aDpiScaleFactor = 1.0, texture_sampling aSampling = texture_sampling::NormalMipmap);
 		image(const std::string& aUri, const std::string& aImagePattern, const std::unordered_map<std::string, colour>& aColourMap, dimension aDpiScaleFactor = 1.0, texture_sampling aSampling = texture_sampling::NormalMipmap);
 		~image();
@@ -65,12 +67,17 @@ namespace neogfx
 		void resize(const neogfx::size& aNewSize) override;
 		colour get_pixel(const point& aPoint) const override;
 		void set_pixel(const point& aPoint, const colour& aColour) override;
+	public:
+		void resample(const neogfx::size& aNewSize, resampling_filter aFilter = resampling_filter::Lanczos3);
+		void premultiply();
+		void unpremultiply();
 	private:
 		bool has_resource() const;
 		const i_resource& resource() const;
-		image_type_e recognize() const;
+		image_type_e recognize(const void* aData, std::size_t aSize) const;
 		bool load();
-		bool load_png();
+		bool load(const void* aData, std::size_t aSize);
+		bool load_png(const void* aData, std::size_t aSize);
 	private:
 		i_resource::pointer iResource;
 		std::string iUri;
@@ -0,0 +1,103 @@
+// image_loader.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <map>
+#include <deque>
+#include <algorithm>
+#include <vector>
+#include <tuple>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <neogfx/gfx/image.hpp>
+#include <neogfx/gfx/texture.hpp>
+
+namespace neogfx
+{
+	// Decodes images on a pool of worker threads. Decoded images are cached by URI and target size so
+	// duplicate requests share one decode; textures for completed requests are created in one batch on
+	// the rendering thread (see upload_textures). Resources are loaded, and the cache trimmed, only on
+	// the calling (GUI) thread; workers see nothing but copies of the encoded bytes.
+	class image_loader
+	{
+	public:
+		typedef std::shared_ptr<const image> image_pointer;
+		typedef std::shared_future<image_pointer> image_future;
+		typedef std::function<void(const texture&)> texture_ready_callback;
+	public:
+		static const std::size_t DefaultCacheCapacity = 64u * 1024u * 1024u;
+	private:
+		typedef std::tuple<std::string, dimension, texture_sampling, size> key_type;
+		struct cache_entry
+		{
+			image_future future;
+			bool decoded;
+			std::size_t bytes;
+			uint64_t lastUse;
+		};
+		typedef std::map<key_type, cache_entry> cache;
+		struct job
+		{
+			key_type key;
+			std::vector<uint8_t> data;
+			std::shared_ptr<std::promise<image_pointer>> result;
+		};
+		typedef std::deque<job> job_queue;
+		typedef std::vector<std::pair<image_future, texture_ready_callback>> texture_request_list;
+	public:
+		image_loader();
+		~image_loader();
+		static image_loader& instance();
+	public:
+		image_future load(const std::string& aUri, dimension aDpiScaleFactor = 1.0, texture_sampling aSampling = texture_sampling::NormalMipmap, const optional_size& aTargetSize = optional_size{});
+		void load_texture(const std::string& aUri, texture_ready_callback aTextureReady, dimension aDpiScaleFactor = 1.0, texture_sampling aSampling = texture_sampling::NormalMipmap, const optional_size& aTargetSize = optional_size{});
+		void prefetch(const std::string& aUri, dimension aDpiScaleFactor = 1.0, texture_sampling aSampling = texture_sampling::NormalMipmap, const optional_size& aTargetSize = optional_size{});
+		bool textures_ready() const;
+		std::size_t upload_textures();
+	public:
+		std::size_t cache_capacity() const;
+		void set_cache_capacity(std::size_t aCapacity);
+		std::size_t cache_size() const;
+		void clear_cache();
+	private:
+		image_future request(const std::string& aUri, dimension aDpiScaleFactor, texture_sampling aSampling, const optional_size& aTargetSize, bool aPrefetch);
+		void start_workers();
+		void worker();
+		static image_pointer decode(const job& aJob);
+		static void wake_owner_thread();
+		void trim_cache();
+	private:
+		mutable std::mutex iMutex;
+		std::condition_variable iWork;
+		std::vector<std::thread> iWorkers;
+		bool iStopping;
+		job_queue iJobs;
+		job_queue iPrefetchJobs;
+		cache iCache;
+		std::size_t iCacheCapacity;
+		std::size_t iCacheSize;
+		uint64_t iUseCounter;
+		texture_request_list iTextureRequests;
+	};
+}
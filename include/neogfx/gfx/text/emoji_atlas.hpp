@@ -21,29 +21,57 @@
 
 #include <neogfx/neogfx.hpp>
 #include <unordered_map>
+#include <array>
 #include <neogfx/gfx/i_texture_manager.hpp>
 #include <neogfx/gfx/i_texture_atlas.hpp>
 #include "i_emoji_atlas.hpp"
 
 namespace neogfx
 {
+	class mapped_zip_archive;
+	namespace emoji_index { struct contents; }
+
 	class emoji_atlas : public i_emoji_atlas
 	{
 	private:
-		typedef std::map<dimension, std::string> sets;
+		struct emoji_file
+		{
+			uint32_t entry;
+			boost::optional<emoji_id> id;
+		};
+		typedef std::map<dimension, emoji_file> sets;
 		typedef std::map<std::u32string, sets> emojis;
+		struct sequence_node
+		{
+			bool terminal;
+			std::vector<std::pair<char32_t, uint32_t>> children;
+		};
+		typedef std::vector<sequence_node> sequence_trie;
+		typedef std::array<uint64_t, 4> code_point_block;
 	public:
 		emoji_atlas(i_texture_manager& aTextureManager);
+		~emoji_atlas();
 	public:
 		virtual bool is_emoji(char32_t aCodePoint) const;
 		virtual bool is_emoji(const std::u32string& aCodePoints) const;
+		virtual std::size_t match_emoji_sequence(const char32_t* aCodePoints, const char32_t* aCodePointsEnd) const;
 		virtual emoji_id emoji(char32_t aCodePoint, dimension aDesiredSize) const;
 		virtual emoji_id emoji(const std::u32string& aCodePoints, dimension aDesiredSize = 64) const;
 		virtual const i_texture& emoji_texture(emoji_id aId) const;
+	private:
+		void load() const;
+		void index_emojis() const;
+		uint32_t find_child(uint32_t aNode, char32_t aCodePoint) const;
 	private:
 		const std::string kFilePath;
-		std::unique_ptr<i_texture_atlas> iTextureAtlas;
-		emojis iEmojis;
-		mutable std::unordered_map<std::u32string, boost::optional<emoji_id>> iEmojiMap;
+		i_texture_manager& iTextureManager;
+		mutable std::unique_ptr<i_texture_atlas> iTextureAtlas;
+		mutable bool iLoaded;
+		mutable std::unique_ptr<mapped_zip_archive> iArchive;
+		mutable std::unique_ptr<emoji_index::contents> iIndex;
+		mutable emojis iEmojis;
+		mutable std::vector<uint16_t> iSingleEmojiPages;
+		mutable std::vector<code_point_block> iSingleEmojiBlocks;
+		mutable sequence_trie iSequences;
 	};
 }
\ No newline at end of file
@@ -25,6 +25,46 @@
 
 namespace neogfx
 {
+	enum class text_script : uint8_t
+	{
+		Unknown,
+		Common,
+		Inherited,
+		Latin,
+		Greek,
+		Cyrillic,
+		Armenian,
+		Hebrew,
+		Arabic,
+		Syriac,
+		Thaana,
+		Devanagari,
+		Bengali,
+		Gurmukhi,
+		Gujarati,
+		Oriya,
+		Tamil,
+		Telugu,
+		Kannada,
+		Malayalam,
+		Sinhala,
+		Thai,
+		Lao,
+		Tibetan,
+		Myanmar,
+		Georgian,
+		Hangul,
+		Ethiopic,
+		Cherokee,
+		Khmer,
+		Mongolian,
+		Hiragana,
+		Katakana,
+		Bopomofo,
+		Han,
+		Yi
+	};
+
 	namespace detail
 	{
 		typedef std::pair<uint32_t, text_category> TEXT_CATEGORY_MAP_VALUE_TYPE;
@@ -1971,12 +2011,147 @@ namespace neogfx
 			{ 0x100001, text_category::Unknown },
 			{ 0x10FFFD, text_category::LTR }
 		};
+
+		// Script ranges at (roughly) Unicode block granularity; good enough for run itemization.
+		typedef std::pair<uint32_t, text_script> TEXT_SCRIPT_MAP_VALUE_TYPE;
+		const TEXT_SCRIPT_MAP_VALUE_TYPE TEXT_SCRIPT_MAP[] =
+		{
+			{ 0x00000, text_script::Common },
+			{ 0x00041, text_script::Latin },
+			{ 0x0005B, text_script::Common },
+			{ 0x00061, text_script::Latin },
+			{ 0x0007B, text_script::Common },
+			{ 0x000AA, text_script::Latin },
+			{ 0x000AB, text_script::Common },
+			{ 0x000BA, text_script::Latin },
+			{ 0x000BB, text_script::Common },
+			{ 0x000C0, text_script::Latin },
+			{ 0x000D7, text_script::Common },
+			{ 0x000D8, text_script::Latin },
+			{ 0x000F7, text_script::Common },
+			{ 0x000F8, text_script::Latin },
+			{ 0x002B9, text_script::Common },
+			{ 0x002E0, text_script::Latin },
+			{ 0x002E5, text_script::Common },
+			{ 0x00300, text_script::Inherited },
+			{ 0x00370, text_script::Greek },
+			{ 0x00400, text_script::Cyrillic },
+			{ 0x00530, text_script::Armenian },
+			{ 0x00590, text_script::Hebrew },
+			{ 0x00600, text_script::Arabic },
+			{ 0x00700, text_script::Syriac },
+			{ 0x00750, text_script::Arabic },
+			{ 0x00780, text_script::Thaana },
+			{ 0x007C0, text_script::Common },
+			{ 0x008A0, text_script::Arabic },
+			{ 0x00900, text_script::Devanagari },
+			{ 0x00980, text_script::Bengali },
+			{ 0x00A00, text_script::Gurmukhi },
+			{ 0x00A80, text_script::Gujarati },
+			{ 0x00B00, text_script::Oriya },
+			{ 0x00B80, text_script::Tamil },
+			{ 0x00C00, text_script::Telugu },
+			{ 0x00C80, text_script::Kannada },
+			{ 0x00D00, text_script::Malayalam },
+			{ 0x00D80, text_script::Sinhala },
+			{ 0x00E00, text_script::Thai },
+			{ 0x00E80, text_script::Lao },
+			{ 0x00F00, text_script::Tibetan },
+			{ 0x01000, text_script::Myanmar },
+			{ 0x010A0, text_script::Georgian },
+			{ 0x01100, text_script::Hangul },
+			{ 0x01200, text_script::Ethiopic },
+			{ 0x013A0, text_script::Cherokee },
+			{ 0x01400, text_script::Common },
+			{ 0x01780, text_script::Khmer },
+			{ 0x01800, text_script::Mongolian },
+			{ 0x018B0, text_script::Common },
+			{ 0x01AB0, text_script::Inherited },
+			{ 0x01B00, text_script::Common },
+			{ 0x01C80, text_script::Cyrillic },
+			{ 0x01C90, text_script::Georgian },
+			{ 0x01CC0, text_script::Common },
+			{ 0x01D00, text_script::Latin },
+			{ 0x01DC0, text_script::Inherited },
+			{ 0x01E00, text_script::Latin },
+			{ 0x01F00, text_script::Greek },
+			{ 0x02000, text_script::Common },
+			{ 0x020D0, text_script::Inherited },
+			{ 0x02100, text_script::Common },
+			{ 0x02C60, text_script::Latin },
+			{ 0x02C80, text_script::Common },
+			{ 0x02D00, text_script::Georgian },
+			{ 0x02D30, text_script::Common },
+			{ 0x02DE0, text_script::Cyrillic },
+			{ 0x02E00, text_script::Common },
+			{ 0x02E80, text_script::Han },
+			{ 0x02FE0, text_script::Common },
+			{ 0x03040, text_script::Hiragana },
+			{ 0x030A0, text_script::Katakana },
+			{ 0x03100, text_script::Bopomofo },
+			{ 0x03130, text_script::Hangul },
+			{ 0x03190, text_script::Common },
+			{ 0x031A0, text_script::Bopomofo },
+			{ 0x031C0, text_script::Common },
+			{ 0x031F0, text_script::Katakana },
+			{ 0x03200, text_script::Common },
+			{ 0x03400, text_script::Han },
+			{ 0x04DC0, text_script::Common },
+			{ 0x04E00, text_script::Han },
+			{ 0x0A000, text_script::Yi },
+			{ 0x0A4D0, text_script::Common },
+			{ 0x0A640, text_script::Cyrillic },
+			{ 0x0A6A0, text_script::Common },
+			{ 0x0A720, text_script::Latin },
+			{ 0x0A800, text_script::Common },
+			{ 0x0A960, text_script::Hangul },
+			{ 0x0A980, text_script::Common },
+			{ 0x0AB30, text_script::Latin },
+			{ 0x0AB70, text_script::Cherokee },
+			{ 0x0ABC0, text_script::Common },
+			{ 0x0AC00, text_script::Hangul },
+			{ 0x0D800, text_script::Common },
+			{ 0x0F900, text_script::Han },
+			{ 0x0FB00, text_script::Latin },
+			{ 0x0FB07, text_script::Common },
+			{ 0x0FB1D, text_script::Hebrew },
+			{ 0x0FB50, text_script::Arabic },
+			{ 0x0FE00, text_script::Inherited },
+			{ 0x0FE10, text_script::Common },
+			{ 0x0FE20, text_script::Inherited },
+			{ 0x0FE30, text_script::Common },
+			{ 0x0FE70, text_script::Arabic },
+			{ 0x0FF00, text_script::Common },
+			{ 0x0FF21, text_script::Latin },
+			{ 0x0FF3B, text_script::Common },
+			{ 0x0FF41, text_script::Latin },
+			{ 0x0FF5B, text_script::Common },
+			{ 0x0FF66, text_script::Katakana },
+			{ 0x0FF9E, text_script::Common },
+			{ 0x0FFA0, text_script::Hangul },
+			{ 0x0FFE0, text_script::Common },
+			{ 0x1B000, text_script::Hiragana },
+			{ 0x1B100, text_script::Common },
+			{ 0x20000, text_script::Han },
+			{ 0x2FA20, text_script::Common },
+			{ 0xE0100, text_script::Inherited },
+			{ 0xE01F0, text_script::Common }
+		};
+
+		// Two-stage (block index + shared block) lookup table giving the category and script of a code
+		// point in constant time; the tables are generated from the maps above at build time (textcat2hpp).
+		class text_category_table
+		{
+		public:
+			static text_category category(char32_t aCodePoint);
+			static text_script script(char32_t aCodePoint);
+		};
 	}
 
 	inline text_category get_text_category(const i_emoji_atlas& aEmojiAtlas, const char32_t* aCodePoint, const char32_t* aCodePointEnd)
 	{
 		char32_t ch = aCodePoint[0];
-		if (aEmojiAtlas.is_emoji(ch))
+		if (ch >= 0x80 && aEmojiAtlas.is_emoji(ch))
 		{
 			if (aCodePoint + 1 == aCodePointEnd || aCodePoint[1] != 0xEF0E)
 				return text_category::Emoji;
@@ -1984,17 +2159,7 @@ namespace neogfx
 		}
 		else if (ch == 0xFE0F || ch == 0xFE0E)
 			return text_category::Control;
-		const detail::TEXT_CATEGORY_MAP_VALUE_TYPE* rangeStart = std::lower_bound(
-			&detail::TEXT_CATEGORY_MAP[0], 
-			&detail::TEXT_CATEGORY_MAP[0] + sizeof(detail::TEXT_CATEGORY_MAP) / sizeof(detail::TEXT_CATEGORY_MAP[0]),
-			detail::TEXT_CATEGORY_MAP_VALUE_TYPE(ch, text_category::Unknown),
-			[](const detail::TEXT_CATEGORY_MAP_VALUE_TYPE& lhs, const detail::TEXT_CATEGORY_MAP_VALUE_TYPE& rhs) -> bool
-		{
-			return lhs.first < rhs.first;
-		});
-		if (rangeStart != &detail::TEXT_CATEGORY_MAP[0] && ch < rangeStart->first)
-			--rangeStart;
-		return rangeStart->second;
+		return detail::text_category_table::category(ch);
 	}
 
 	inline text_category get_text_category(const i_emoji_atlas& aEmojiAtlas, char32_t aCodePoint)
@@ -2036,4 +2201,9 @@ namespace neogfx
 	{
 		return get_text_direction(aEmojiAtlas, &aCodePoint, &aCodePoint + 1, aExistingDirection);
 	}
+
+	inline text_script get_text_script(char32_t aCodePoint)
+	{
+		return detail::text_category_table::script(aCodePoint);
+	}
 }
\ No newline at end of file
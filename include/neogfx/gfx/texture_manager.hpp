@@ -20,6 +20,7 @@
 #pragma once
 
 #include <neogfx/neogfx.hpp>
+#include <unordered_map>
 #include <neogfx/gfx/i_image.hpp>
 #include "i_texture_manager.hpp"
 
@@ -29,20 +30,35 @@ namespace neogfx
 	{
 		friend class texture_wrapper;
 	protected:
-		typedef std::list<std::weak_ptr<i_native_texture>> texture_list;
+		struct texture_record
+		{
+			std::weak_ptr<i_native_texture> texture;
+			std::string key;
+			std::size_t bytes;
+		};
+		// keyed by native handle (texture id)
+		typedef std::unordered_map<const void*, texture_record> texture_list;
+		// image key (URI plus format) to native handle
+		typedef std::unordered_map<std::string, const void*> texture_index;
 	public:
 		virtual std::unique_ptr<i_native_texture> join_texture(const i_native_texture& aTexture);
 		virtual std::unique_ptr<i_native_texture> join_texture(const i_texture& aTexture);
 		virtual void clear_textures();
 		virtual std::unique_ptr<i_texture_atlas> create_texture_atlas(const size& aSize = size{ 1024.0, 1024.0 });
+		virtual texture_memory_usage memory_usage() const;
 	protected:
 		const texture_list& textures() const;
 		texture_list& textures();
-		texture_list::const_iterator find_texture(const i_image& aImage) const;
-		texture_list::iterator find_texture(const i_image& aImage);
+		std::shared_ptr<i_native_texture> find_texture(const i_image& aImage) const;
 		std::unique_ptr<i_native_texture> add_texture(std::shared_ptr<i_native_texture> aTexture);
+		std::unique_ptr<i_native_texture> add_texture(std::shared_ptr<i_native_texture> aTexture, const i_image& aImage);
+	private:
+		static std::string image_key(const i_image& aImage);
+		static std::size_t texture_bytes(const i_native_texture& aTexture);
+		void release_texture(const void* aHandle);
 	private:
 		texture_list iTextures;
+		texture_index iIndex;
 		std::vector<std::unique_ptr<i_texture_atlas>> iTextureAtlases;
 	};
 }
\ No newline at end of file
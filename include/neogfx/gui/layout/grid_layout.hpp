@@ -38,10 +38,24 @@ namespace neogfx
 		typedef basic_point<cell_coordinate> cell_coordinates;
 		typedef basic_size<cell_coordinate> cell_dimensions;
 	private:
-		struct row_major;
-		struct column_major;
 		typedef std::map<cell_coordinates, item_list::iterator, std::less<cell_coordinates>, boost::pool_allocator<std::pair<cell_coordinates, item_list::iterator>>> cell_list;
 		typedef std::vector<std::pair<cell_coordinates, cell_coordinates>> span_list;
+		static constexpr uint32_t NoSpan = static_cast<uint32_t>(-1);
+		struct cell
+		{
+			item* occupant;
+			uint32_t span;
+		};
+		typedef std::vector<cell> occupancy_map;
+		struct track
+		{
+			size::dimension_type minimum;
+			size::dimension_type maximum;
+			size::dimension_type weight;
+			size::dimension_type extent;
+			size::dimension_type position;
+		};
+		typedef std::vector<track> track_list;
 	public:
 		grid_layout(neogfx::alignment aAlignment = neogfx::alignment::Centre | neogfx::alignment::VCentre);
 		grid_layout(cell_coordinate aRows, cell_coordinate aColumns, neogfx::alignment aAlignment = neogfx::alignment::Centre | neogfx::alignment::VCentre);
@@ -84,17 +98,13 @@ namespace neogfx
 	public:
 		void layout_items(const point& aPosition, const size& aSize) override;
 	private:
-		uint32_t visible_rows() const;
-		bool is_row_visible(uint32_t aRow) const;
-		uint32_t visible_columns() const;
-		bool is_column_visible(uint32_t aColumn) const;
-		size::dimension_type row_minimum_size(cell_coordinate aRow, const optional_size& aAvailableSpace = optional_size()) const;
-		size::dimension_type column_minimum_size(cell_coordinate aColumn, const optional_size& aAvailableSpace = optional_size()) const;
-		size::dimension_type row_maximum_size(cell_coordinate aRow, const optional_size& aAvailableSpace = optional_size()) const;
-		size::dimension_type column_maximum_size(cell_coordinate aColumn, const optional_size& aAvailableSpace = optional_size()) const;
+		const occupancy_map& occupancy() const;
+		template <typename AxisPolicy>
+		void size_tracks(track_list& aTracks, const optional_size& aAvailableSpace) const;
+		template <typename AxisPolicy>
+		void distribute_tracks(track_list& aTracks, size::dimension_type aAvailableExtent) const;
 		void increment_cursor();
 		horizontal_layout& row_layout(cell_coordinate aRow);
-		span_list::const_iterator find_span(const cell_coordinates& aCell) const;
 		void init();
 		// helpers
 	public:
@@ -110,5 +120,9 @@ namespace neogfx
 		cell_dimensions iDimensions;
 		cell_coordinates iCursor;
 		span_list iSpans;
+		mutable occupancy_map iOccupancy;
+		mutable bool iOccupancyValid;
+		mutable track_list iColumnTracks;
+		mutable track_list iRowTracks;
 	};
 }
\ No newline at end of file
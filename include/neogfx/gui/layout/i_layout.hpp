@@ -82,7 +82,12 @@ namespace neogfx
 		virtual bool enabled() const = 0;
 		virtual void layout_items(const point& aPosition, const size& aSize) = 0;
 		virtual bool invalidated() const = 0;
-		virtual void invalidate() = 0;
+		virtual void invalidate() = 0; // measurement and arrangement
+		virtual void invalidate_arrangement() = 0;
+		virtual bool item_arrangement_invalidated() const = 0;
+		virtual void invalidate_item_arrangement() = 0; // an item below us needs arranging but our own arrangement is unchanged
+		virtual void invalidate_measurements() = 0; // discard the cached measurements of everything below us
+		virtual bool item_measurement_changed(const i_layout_item& aItem) const = 0;
 		virtual void validate() = 0;
 		// helpers
 	public:
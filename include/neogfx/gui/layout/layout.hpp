@@ -113,6 +113,11 @@ namespace neogfx
 		bool enabled() const override;
 		bool invalidated() const override;
 		void invalidate() override;
+		void invalidate_arrangement() override;
+		bool item_arrangement_invalidated() const override;
+		void invalidate_item_arrangement() override;
+		void invalidate_measurements() override;
+		bool item_measurement_changed(const i_layout_item& aItem) const override;
 		void validate() override;
 	public:
 		point position() const override;
@@ -156,6 +161,9 @@ namespace neogfx
 		size do_maximum_size(const optional_size& aAvailableSpace) const;
 		template <typename AxisPolicy>
 		void do_layout_items(const point& aPosition, const size& aSize);
+	private:
+		void propagate_arrangement_invalidation();
+		void arrange_invalidated_items();
 	private:
 		i_layout* iParent;
 		mutable i_widget* iOwner;
@@ -174,6 +182,8 @@ namespace neogfx
 		item_list iItems;
 		bool iLayoutStarted;
 		uint32_t iLayoutId;
+		uint32_t iArrangedGeneration;
 		bool iInvalidated;
+		bool iItemArrangementInvalidated;
 	};
 }
@@ -86,12 +86,27 @@ namespace neogfx
 		void layout_as(const point& aPosition, const size& aSize) override;
 		uint32_t layout_id() const override;
 		void next_layout_id() override;
+	public:
+		bool measurement_changed() const;
+		void invalidate_measurement();
 	public:
 		bool operator==(const layout_item& aOther) const;
+	public:
+		static uint32_t generation();
+		static void next_generation();
+	private:
+		size measure_minimum_size(const optional_size& aAvailableSpace) const;
+	private:
+		struct cached_size
+		{
+			uint32_t layoutId;
+			uint32_t generation;
+			optional_size availableSpace;
+			size value;
+		};
 	private:
 		std::shared_ptr<i_layout_item> iSubject;
-		mutable std::pair<uint32_t, uint32_t> iLayoutId;
-		mutable size iMinimumSize;
-		mutable size iMaximumSize;
+		mutable cached_size iMinimumSize;
+		mutable cached_size iMaximumSize;
 	};
 }
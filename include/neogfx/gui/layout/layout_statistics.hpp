@@ -0,0 +1,58 @@
+// layout_statistics.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+
+namespace neogfx
+{
+	// Counts the work done by layout passes so that regressions in incremental layout are visible.
+	// A pass starts when the outermost widget starts laying out its items and ends when it completes; 
+	// measurements made while invalidating ahead of a pass are counted against that pass.
+	class layout_statistics
+	{
+	public:
+		struct pass
+		{
+			uint32_t itemsMeasured;
+			uint32_t itemsArranged;
+		};
+	public:
+		layout_statistics();
+	public:
+		static layout_statistics& instance();
+	public:
+		uint32_t passes() const;
+		const pass& current_pass() const;
+		const pass& last_pass() const;
+		bool pass_in_progress() const;
+		void reset();
+	public:
+		void pass_started();
+		void pass_completed();
+		void item_measured();
+		void item_arranged();
+	private:
+		uint32_t iPasses;
+		uint32_t iPassDepth;
+		pass iCurrentPass;
+		pass iLastPass;
+	};
+}
@@ -89,6 +89,8 @@ namespace neogfx
 		void next_layout_id() override;
 	public:
 		bool visible() const override;
+	private:
+		void update_layout();
 	private:
 		i_layout* iParentLayout;
 		uint32_t iLayoutId;
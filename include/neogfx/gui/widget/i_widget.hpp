@@ -25,14 +25,13 @@
 #include <neogfx/hid/mouse.hpp>
 #include <neogfx/hid/i_keyboard.hpp>
 #include <neogfx/gui/window/window_events.hpp>
-#include <neogfx/gui/layout/i_layout_item.hpp>
+#include <neogfx/gui/layout/i_layout.hpp>
 #include <neogfx/gui/widget/widget_bits.hpp>
 
 namespace neogfx
 {
 	class i_surface;
 	class i_window;
-	class i_layout;
 
 	class i_widget : public i_layout_item, public i_keyboard_handler
 	{
@@ -135,6 +134,7 @@ namespace neogfx
 		virtual point origin() const = 0;
 		virtual void move(const point& aPosition) = 0;
 		virtual void moved() = 0;
+		virtual point child_offset(const i_widget& aChild) const = 0;
 		virtual size extents() const = 0;
 		virtual void resize(const size& aSize) = 0;
 		virtual void resized() = 0;
@@ -143,6 +143,7 @@ namespace neogfx
 		virtual const i_widget& widget_at(const point& aPosition) const = 0;
 		virtual i_widget& widget_at(const point& aPosition) = 0;
 		virtual widget_part hit_test(const point& aPosition) const = 0;
+		virtual void invalidate_hit_test_index() = 0;
 	public:
 		virtual void update(bool aIncludeNonClient = false) = 0;
 		virtual void update(const rect& aUpdateRect) = 0;
@@ -155,6 +156,9 @@ namespace neogfx
 		virtual void paint_non_client(graphics_context& aGraphicsContext) const = 0;
 		virtual void paint_non_client_after(graphics_context& aGraphicsContext) const = 0;
 		virtual void paint(graphics_context& aGraphicsContext) const = 0;
+		virtual neogfx::render_layer_policy render_layer_policy() const = 0;
+		virtual void set_render_layer_policy(neogfx::render_layer_policy aPolicy) = 0;
+		virtual void invalidate_render_layer() = 0;
 	public:
 		virtual double opacity() const = 0;
 		virtual void set_opacity(double aOpacity) = 0;
@@ -234,6 +238,17 @@ namespace neogfx
 			add(newWidget);
 			return *newWidget;
 		}
+	public:
+		void update_layout(bool aDeferLayout = true)
+		{
+			next_layout_id();
+			if (has_parent_layout())
+				parent_layout().invalidate_arrangement();
+			if (has_layout())
+				layout().invalidate_arrangement();
+			if (has_managing_layout())
+				managing_layout().layout_items(aDeferLayout);
+		}
 	public:
 		bool same_surface(const i_widget& aWidget) const
 		{
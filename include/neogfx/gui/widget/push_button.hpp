@@ -20,7 +20,7 @@
 #pragma once
 
 #include <neogfx/neogfx.hpp>
-#include <neolib/timer.hpp>
+#include <neogfx/core/timer.hpp>
 #include "button.hpp"
 
 namespace neogfx
@@ -79,7 +79,7 @@ namespace neogfx
 	private:
 		void init();
 	private:
-		neolib::callback_timer iAnimator;
+		callback_timer iAnimator;
 		uint32_t iAnimationFrame;
 		push_button_style iStyle;
 		optional_colour iHoverColour;
@@ -69,6 +69,7 @@ namespace neogfx
 		void resized() override;
 		rect client_rect(bool aIncludeMargins = true) const override;
 		widget_part hit_test(const point& aPosition) const override;
+		point child_offset(const i_widget& aChild) const override;
 	public:
 		void paint_non_client_after(graphics_context& aGraphicsContext) const override;
 	public:
@@ -98,10 +99,12 @@ namespace neogfx
 		virtual void update_scrollbar_visibility(usv_stage_e aStage);
 	protected:
 		void init_scrollbars();
+	private:
+		bool can_scroll_surface(const i_scrollbar& aScrollbar, rect& aArea) const;
 	private:
 		scrollbar iVerticalScrollbar;
 		scrollbar iHorizontalScrollbar;
-		point iOldScrollPosition;
+		point iScrollPosition;
 		uint32_t iIgnoreScrollbarUpdates;
 	};
 }
\ No newline at end of file
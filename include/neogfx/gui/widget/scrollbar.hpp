@@ -21,7 +21,7 @@
 
 #include <neogfx/neogfx.hpp>
 #include <neolib/optional.hpp>
-#include <neolib/timer.hpp>
+#include <neogfx/core/timer.hpp>
 #include "i_scrollbar.hpp"
 #include <neogfx/gfx/graphics_context.hpp>
 
@@ -79,7 +79,7 @@ namespace neogfx
 		value_type iPage;
 		element_e iClickedElement;
 		element_e iHoverElement;
-		boost::optional<std::shared_ptr<neolib::callback_timer>> iTimer;
+		boost::optional<std::shared_ptr<callback_timer>> iTimer;
 		bool iPaused;
 		point iThumbClickedPosition;
 		value_type iThumbClickedValue;
@@ -549,8 +549,8 @@ namespace neogfx
 		optional_dimension iTabStops;
 		std::string iTabStopHint;
 		mutable boost::optional<std::pair<neogfx::font, dimension>> iCalculatedTabStops;
-		neolib::callback_timer iAnimator;
-		boost::optional<neolib::callback_timer> iDragger;
+		callback_timer iAnimator;
+		boost::optional<callback_timer> iDragger;
 		std::unique_ptr<context_menu> iMenu;
 		uint32_t iSuppressTextChangedNotification;
 		uint32_t iWantedToNotfiyTextChanged;
@@ -22,7 +22,7 @@
 #include <neogfx/neogfx.hpp>
 #include <unordered_set>
 #include <neolib/lifetime.hpp>
-#include <neolib/timer.hpp>
+#include <neogfx/core/timer.hpp>
 #include "i_widget.hpp"
 
 namespace neogfx
@@ -107,6 +107,7 @@ namespace neogfx
 		point origin() const override;
 		void move(const point& aPosition) override;
 		void moved() override;
+		point child_offset(const i_widget& aChild) const override;
 		size extents() const override;
 		void set_extents(const size& aSize) override;
 		void resize(const size& aSize) override;
@@ -116,6 +117,7 @@ namespace neogfx
 		const i_widget& widget_at(const point& aPosition) const override;
 		i_widget& widget_at(const point& aPosition) override;
 		widget_part hit_test(const point& aPosition) const override;
+		void invalidate_hit_test_index() override;
 	public:
 		bool has_size_policy() const override;
 		neogfx::size_policy size_policy() const override;
@@ -166,6 +168,9 @@ namespace neogfx
 		void paint_non_client(graphics_context& aGraphicsContext) const override;
 		void paint(graphics_context& aGraphicsContext) const override;
 		void paint_non_client_after(graphics_context& aGraphicsContext) const override;
+		neogfx::render_layer_policy render_layer_policy() const override;
+		void set_render_layer_policy(neogfx::render_layer_policy aPolicy) override;
+		void invalidate_render_layer() override;
 	public:
 		double opacity() const override;
 		void set_opacity(double aOpacity) override;
@@ -241,6 +246,7 @@ namespace neogfx
 		i_surface* find_surface() override;
 		const i_window* find_root() const override;
 		i_window* find_root() override;
+		void render_subtree(graphics_context& aGraphicsContext) const;
 		// helpers
 	public:
 		using i_widget::set_size_policy;
@@ -259,6 +265,8 @@ namespace neogfx
 		std::shared_ptr<i_layout> iLayout;
 		class layout_timer;
 		std::unique_ptr<layout_timer> iLayoutTimer;
+		class hit_test_index;
+		mutable std::unique_ptr<hit_test_index> iHitTestIndex;
 		units_context iUnitsContext;
 		optional_logical_coordinate_system iLogicalCoordinateSystem;
 		point iPosition;
@@ -278,5 +286,10 @@ namespace neogfx
 		bool iIgnoreMouseEvents;
 		bool iIgnoreNonClientMouseEvents;
 		mutable std::pair<optional_rect, optional_rect> iDefaultClipRect;
+		neogfx::render_layer_policy iRenderLayerPolicy;
+		mutable bool iRenderLayerDirty;
+		mutable bool iRenderLayerAcquired;
+		mutable uint32_t iRenderLayerStableRenders;
+		mutable uint64_t iRenderLayerOperations;
 	};
 }
\ No newline at end of file
@@ -83,6 +83,14 @@ namespace neogfx
 		IgnoreNonClient		= 0x40000000
 	};
 
+	// layers of widgets without an opaque background are composited with blending
+	enum class render_layer_policy
+	{
+		Never,
+		Automatic,
+		Always
+	};
+
 	enum class focus_event
 	{
 		FocusGained,
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <neogfx/neogfx.hpp>
+#include <chrono>
 #include <neolib/variant.hpp>
 #include <neogfx/core/geometry.hpp>
 #include <neogfx/hid/mouse.hpp>
@@ -27,6 +28,9 @@
 
 namespace neogfx
 {
+	// monotonic, high resolution time at which an event was received from the windowing system
+	typedef std::chrono::steady_clock::time_point event_timestamp;
+
 	enum class window_event_type
 	{
 		Paint,
@@ -54,7 +58,7 @@ namespace neogfx
 		typedef neolib::variant<neogfx::size, neogfx::point> parameter_type;
 	public:
 		window_event(window_event_type aType, const parameter_type& aParameter = parameter_type()) :
-			iType(aType), iParameter(aParameter)
+			iType(aType), iParameter(aParameter), iTimestamp(std::chrono::steady_clock::now())
 		{
 		}
 	public:
@@ -62,6 +66,10 @@ namespace neogfx
 		{
 			return iType;
 		}
+		event_timestamp timestamp() const
+		{
+			return iTimestamp;
+		}
 		neogfx::size extents() const
 		{
 			return static_variant_cast<neogfx::size>(iParameter);
@@ -81,6 +89,7 @@ namespace neogfx
 	private:
 		window_event_type iType;
 		parameter_type iParameter;
+		event_timestamp iTimestamp;
 	};
 
 	enum class mouse_event_location
@@ -105,7 +114,7 @@ namespace neogfx
 		typedef neolib::variant<neogfx::mouse_wheel, neogfx::delta, neogfx::mouse_button, neogfx::point, neogfx::key_modifiers_e> parameter_type;
 	public:
 		basic_mouse_event(mouse_event_type aType, const parameter_type& aParameter1 = parameter_type(), const parameter_type& aParameter2 = parameter_type(), const parameter_type& aParameter3 = parameter_type()) :
-			iType(aType), iParameter1(aParameter1), iParameter2(aParameter2), iParameter3(aParameter3)
+			iType(aType), iParameter1(aParameter1), iParameter2(aParameter2), iParameter3(aParameter3), iTimestamp(std::chrono::steady_clock::now())
 		{
 		}
 	public:
@@ -113,6 +122,10 @@ namespace neogfx
 		{
 			return iType;
 		}
+		event_timestamp timestamp() const
+		{
+			return iTimestamp;
+		}
 		neogfx::mouse_wheel mouse_wheel() const
 		{
 			return static_variant_cast<neogfx::mouse_wheel>(iParameter1);
@@ -133,11 +146,30 @@ namespace neogfx
 		{
 			return static_variant_cast<neogfx::key_modifiers_e>(iParameter3);
 		}
+	public:
+		// merge a later event of the same type into this one (see native_window event coalescing)
+		void coalesce(const basic_mouse_event& aLater)
+		{
+			switch (iType)
+			{
+			case mouse_event_type::Moved:
+				iParameter2 = aLater.iParameter2;
+				break;
+			case mouse_event_type::WheelScrolled:
+				iParameter1 = mouse_wheel() | aLater.mouse_wheel();
+				iParameter2 = neogfx::delta{ delta().dx + aLater.delta().dx, delta().dy + aLater.delta().dy };
+				break;
+			default:
+				break;
+			}
+			iTimestamp = aLater.iTimestamp;
+		}
 	private:
 		mouse_event_type iType;
 		parameter_type iParameter1;
 		parameter_type iParameter2;
 		parameter_type iParameter3;
+		event_timestamp iTimestamp;
 	};
 
 	typedef basic_mouse_event<mouse_event_location::Client> mouse_event;
@@ -157,7 +189,7 @@ namespace neogfx
 		typedef neolib::variant<neogfx::scan_code_e, neogfx::key_code_e, neogfx::key_modifiers_e, std::string> parameter_type;
 	public:
 		keyboard_event(keyboard_event_type aType, const parameter_type& aParameter1 = parameter_type(), const parameter_type& aParameter2 = parameter_type(), const parameter_type& aParameter3 = parameter_type()) :
-			iType(aType), iParameter1(aParameter1), iParameter2(aParameter2), iParameter3(aParameter3)
+			iType(aType), iParameter1(aParameter1), iParameter2(aParameter2), iParameter3(aParameter3), iTimestamp(std::chrono::steady_clock::now())
 		{
 		}
 	public:
@@ -165,6 +197,10 @@ namespace neogfx
 		{
 			return iType;
 		}
+		event_timestamp timestamp() const
+		{
+			return iTimestamp;
+		}
 		neogfx::scan_code_e scan_code() const
 		{
 			return static_variant_cast<neogfx::scan_code_e>(iParameter1);
@@ -186,5 +222,6 @@ namespace neogfx
 		parameter_type iParameter1;
 		parameter_type iParameter2;
 		parameter_type iParameter3;
+		event_timestamp iTimestamp;
 	};
 }
\ No newline at end of file
@@ -638,6 +638,8 @@ namespace neogfx
 	private:
 		typedef std::pair<key_code_e, std::set<key_modifiers_e>> combo_type;
 		typedef std::vector<combo_type> sequence_type;
+	public:
+		typedef uint64_t combo_key; // key code and normalized modifiers; suitable for hashing
 	public:
 		key_sequence(const std::string& aSequence) : iText{ aSequence }
 		{
@@ -756,6 +758,29 @@ namespace neogfx
 		{
 			return iText;
 		}
+	public:
+		std::size_t length() const
+		{
+			return iSequence.size();
+		}
+		combo_key combo_key_at(std::size_t aIndex) const
+		{
+			uint32_t modifiers = KeyModifier_NONE;
+			for (auto m : iSequence[aIndex].second)
+				modifiers |= m;
+			return (static_cast<combo_key>(static_cast<uint32_t>(iSequence[aIndex].first)) << 32) | modifiers;
+		}
+		static combo_key to_combo_key(key_code_e aKeyCode, key_modifiers_e aKeyModifiers)
+		{
+			uint32_t modifiers = aKeyModifiers & (KeyModifier_CTRL | KeyModifier_ALT | KeyModifier_SHIFT);
+			for (auto m : { KeyModifier_CTRL, KeyModifier_ALT, KeyModifier_SHIFT })
+				if ((modifiers & m) != 0)
+					modifiers |= m;
+			// any other non-lock modifier (e.g. GUI) prevents a match just as it does in matches()
+			if ((aKeyModifiers & ~(KeyModifier_CTRL | KeyModifier_ALT | KeyModifier_SHIFT | KeyModifier_LOCKS)) != 0)
+				modifiers |= KeyModifier_RESERVED;
+			return (static_cast<combo_key>(static_cast<uint32_t>(aKeyCode)) << 32) | modifiers;
+		}
 	private:
 		match matches(std::size_t aIndex, key_code_e aKeyCode, key_modifiers_e aKeyModifiers) const
 		{
@@ -87,6 +87,10 @@ namespace neogfx
 		virtual bool has_invalidated_area() const = 0;
 		virtual const rect& invalidated_area() const = 0;
 		virtual rect validate() = 0;
+		virtual void scroll_surface(const rect& aArea, const point& aDelta) = 0;
+		virtual bool render_layer(const i_widget& aOwner, const rect& aLayerRect, const rect& aVisibleRect, bool aOpaque, bool aContentsChanged, const std::function<void()>& aPainter) const = 0;
+		virtual void release_render_layer(const i_widget& aOwner) const = 0;
+		virtual void invalidate_render_layers() = 0;
 		virtual bool has_rendering_priority() const = 0;
 		virtual void render_surface() = 0;
 		virtual void pause_rendering() = 0;
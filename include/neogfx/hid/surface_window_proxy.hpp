@@ -65,6 +65,10 @@ namespace neogfx
 		bool has_invalidated_area() const override;
 		const rect& invalidated_area() const override;
 		rect validate() override;
+		void scroll_surface(const rect& aArea, const point& aDelta) override;
+		bool render_layer(const i_widget& aOwner, const rect& aLayerRect, const rect& aVisibleRect, bool aOpaque, bool aContentsChanged, const std::function<void()>& aPainter) const override;
+		void release_render_layer(const i_widget& aOwner) const override;
+		void invalidate_render_layers() override;
 		bool has_rendering_priority() const override;
 		void render_surface() override;
 		void pause_rendering() override;
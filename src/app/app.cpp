@@ -20,12 +20,15 @@
 #include <neogfx/neogfx.hpp>
 #include <string>
 #include <atomic>
+#include <cctype>
 #include <boost/locale.hpp> 
+#include <neogfx/core/timer.hpp>
 #include <neogfx/gfx/image.hpp>
 #include <neogfx/app/app.hpp>
 #include <neogfx/hid/surface_manager.hpp>
 #include <neogfx/app/resource_manager.hpp>
 #include <neogfx/gui/window/window.hpp>
+#include <neogfx/gui/layout/layout_item.hpp>
 #include <neogfx/gui/widget/i_menu.hpp>
 #include "../gui/window/native/i_native_window.hpp"
 
@@ -138,7 +141,7 @@ namespace neogfx
 	app::app(int argc, char* argv[], const std::string& aName, i_service_factory& aServiceFactory)
 		try :
 		neolib::async_thread{ "neogfx::app", true },
-		async_event_queue{ static_cast<neolib::async_task&>(*this) },
+		async_event_queue{},
 		iProgramOptions{ argc, argv },
 		iLoader{ iProgramOptions, *this },
 		iName{ aName },
@@ -153,6 +156,8 @@ namespace neogfx
 		iAudio{ aServiceFactory.create_audio() },
 		iDefaultWindowIcon{ image{ ":/neogfx/resources/icons/neoGFX.png" } },
 		iCurrentStyle{ iStyles.begin() },
+		iShortcutsInvalid{ true },
+		iShortcutState{ &iShortcuts },
 		iActionFileNew{ add_action("&New..."_t, ":/neogfx/resources/icons.naa#new.png").set_shortcut("Ctrl+Shift+N") },
 		iActionFileOpen{ add_action("&Open..."_t, ":/neogfx/resources/icons.naa#open.png").set_shortcut("Ctrl+Shift+O") },
 		iActionFileClose{ add_action("&Close"_t).set_shortcut("Ctrl+F4") },
@@ -167,52 +172,7 @@ namespace neogfx
 		iActionPaste{ add_action("Paste"_t, ":/neogfx/resources/icons.naa#paste.png").set_shortcut("Ctrl+V") },
 		iActionDelete{ add_action("Delete"_t).set_shortcut("Del") },
 		iActionSelectAll{ add_action("Select All"_t).set_shortcut("Ctrl+A") },
-		iStandardActionManager{ *this, [this](neolib::callback_timer& aTimer)
-		{
-			aTimer.again();
-			if (clipboard().sink_active())
-			{
-				auto& sink = clipboard().active_sink();
-				if (sink.can_undo())
-					iActionUndo.enable();
-				else
-					iActionUndo.disable();
-				if (sink.can_redo())
-					iActionRedo.enable();
-				else
-					iActionRedo.disable();
-				if (sink.can_cut())
-					iActionCut.enable();
-				else
-					iActionCut.disable();
-				if (sink.can_copy())
-					iActionCopy.enable();
-				else
-					iActionCopy.disable();
-				if (sink.can_paste())
-					iActionPaste.enable();
-				else
-					iActionPaste.disable();
-				if (sink.can_delete_selected())
-					iActionDelete.enable();
-				else
-					iActionDelete.disable();
-				if (sink.can_select_all())
-					iActionSelectAll.enable();
-				else
-					iActionSelectAll.disable();
-			}
-			else
-			{
-				iActionUndo.disable();
-				iActionRedo.disable();
-				iActionCut.disable();
-				iActionCopy.disable();
-				iActionPaste.disable();
-				iActionDelete.disable();
-				iActionSelectAll.disable();
-			}
-		}, 100 },
+		iMnemonicIndexInvalid{ true },
 		iAppContext{ *this, "neogfx::app::iAppContext" },
 		iAppMessageQueueContext{ *this, "neogfx::app::iAppMessageQueueContext" }
 	{
@@ -232,6 +192,19 @@ namespace neogfx
 		iActionPaste.triggered([this]() { clipboard().paste(); });
 		iActionDelete.triggered([this]() { clipboard().delete_selected(); });
 		iActionSelectAll.triggered([this]() { clipboard().select_all(); });
+
+		iClipboardSink += clipboard().sink_activated([this]()
+		{
+			iActiveClipboardSinkSink = clipboard().active_sink().sink_state_changed([this]() { update_standard_actions(); });
+			update_standard_actions();
+		});
+		iClipboardSink += clipboard().sink_deactivated([this]()
+		{
+			iActiveClipboardSinkSink = sink{};
+			update_standard_actions();
+		});
+		iClipboardSink += clipboard().updated([this]() { update_standard_actions(); });
+		update_standard_actions();
 	}
 	catch (std::exception& e)
 	{
@@ -406,6 +379,7 @@ namespace neogfx
 		if (iCurrentStyle != existingStyle)
 		{
 			iCurrentStyle = existingStyle;
+			layout_item::next_generation();
 			current_style_changed.trigger(style_aspect::Style);
 			surface_manager().layout_surfaces();
 			surface_manager().invalidate_surfaces();
@@ -513,25 +487,25 @@ namespace neogfx
 	i_action& app::add_action(const std::string& aText)
 	{
 		auto a = iActions.emplace(aText, action{ aText });
-		return a->second;
+		return register_action(a->second);
 	}
 
 	i_action& app::add_action(const std::string& aText, const std::string& aImageUri, dimension aDpiScaleFactor, texture_sampling aSampling)
 	{
 		auto a = iActions.emplace(aText, action{ aText, aImageUri, aDpiScaleFactor, aSampling });
-		return a->second;
+		return register_action(a->second);
 	}
 
 	i_action& app::add_action(const std::string& aText, const i_texture& aImage)
 	{
 		auto a = iActions.emplace(aText, action{ aText, aImage });
-		return a->second;
+		return register_action(a->second);
 	}
 
 	i_action& app::add_action(const std::string& aText, const i_image& aImage)
 	{
 		auto a = iActions.emplace(aText, action{ aText, aImage });
-		return a->second;
+		return register_action(a->second);
 	}
 
 	void app::remove_action(i_action& aAction)
@@ -539,21 +513,164 @@ namespace neogfx
 		for (auto i = iActions.begin(); i != iActions.end(); ++i)
 			if (&i->second == &aAction)
 			{
+				unregister_action(aAction);
 				iActions.erase(i);
 				break;
 			}
 	}
 
+	i_action& app::register_action(i_action& aAction)
+	{
+		iActionSinks[&aAction] += aAction.changed([this]() { iShortcutsInvalid = true; });
+		iShortcutsInvalid = true;
+		return aAction;
+	}
+
+	void app::unregister_action(i_action& aAction)
+	{
+		iActionSinks.erase(&aAction);
+		iShortcutsInvalid = true;
+	}
+
+	void app::rebuild_shortcuts()
+	{
+		iShortcuts.actions.clear();
+		iShortcuts.children.clear();
+		iShortcutState = &iShortcuts;
+		for (auto& a : iActions)
+		{
+			if (a.second.shortcut() == boost::none || a.second.shortcut()->length() == 0)
+				continue;
+			auto& shortcut = *a.second.shortcut();
+			shortcut_node* node = &iShortcuts;
+			for (std::size_t i = 0; i < shortcut.length(); ++i)
+			{
+				auto& child = node->children[shortcut.combo_key_at(i)];
+				if (child == nullptr)
+					child = std::make_unique<shortcut_node>();
+				node = child.get();
+			}
+			node->actions.push_back(&a.second);
+		}
+		iShortcutsInvalid = false;
+	}
+
+	void app::update_standard_actions()
+	{
+		if (clipboard().sink_active())
+		{
+			auto& sink = clipboard().active_sink();
+			if (sink.can_undo())
+				iActionUndo.enable();
+			else
+				iActionUndo.disable();
+			if (sink.can_redo())
+				iActionRedo.enable();
+			else
+				iActionRedo.disable();
+			if (sink.can_cut())
+				iActionCut.enable();
+			else
+				iActionCut.disable();
+			if (sink.can_copy())
+				iActionCopy.enable();
+			else
+				iActionCopy.disable();
+			if (sink.can_paste())
+				iActionPaste.enable();
+			else
+				iActionPaste.disable();
+			if (sink.can_delete_selected())
+				iActionDelete.enable();
+			else
+				iActionDelete.disable();
+			if (sink.can_select_all())
+				iActionSelectAll.enable();
+			else
+				iActionSelectAll.disable();
+		}
+		else
+		{
+			iActionUndo.disable();
+			iActionRedo.disable();
+			iActionCut.disable();
+			iActionCopy.disable();
+			iActionPaste.disable();
+			iActionDelete.disable();
+			iActionSelectAll.disable();
+		}
+	}
+
+	namespace
+	{
+		char32_t fold_mnemonic(const std::string& aMnemonic)
+		{
+			auto text = neolib::utf8_to_utf32(aMnemonic);
+			if (text.empty())
+				return U'\0';
+			if (text[0] < 0x80)
+				return static_cast<char32_t>(std::tolower(static_cast<int>(text[0])));
+			static boost::locale::generator gen;
+			static std::locale loc = gen("en_US.UTF-8");
+			auto folded = neolib::utf8_to_utf32(boost::locale::to_lower(neolib::utf32_to_utf8(text.substr(0, 1)), loc));
+			return !folded.empty() ? folded[0] : text[0];
+		}
+	}
+
 	void app::add_mnemonic(i_mnemonic& aMnemonic)
 	{
-		iMnemonics.push_back(&aMnemonic);
+		// mnemonics re-register when their text changes so drop any existing index entry first
+		remove_mnemonic(aMnemonic);
+		iMnemonics.emplace(&aMnemonic, fold_mnemonic(aMnemonic.mnemonic()));
+		iMnemonicIndexInvalid = true;
 	}
 
 	void app::remove_mnemonic(i_mnemonic& aMnemonic)
 	{
-		auto n = std::find(iMnemonics.begin(), iMnemonics.end(), &aMnemonic);
-		if (n != iMnemonics.end())
-			iMnemonics.erase(n);
+		if (iMnemonics.erase(&aMnemonic) != 0)
+			iMnemonicIndexInvalid = true;
+	}
+
+	void app::invalidate_mnemonics()
+	{
+		iMnemonicIndexInvalid = true;
+	}
+
+	void app::rebuild_mnemonic_index()
+	{
+		// Mnemonics usually register before their widget is attached to a window so the index is
+		// built lazily, on the first keystroke after a change, rather than on registration.
+		iMnemonicIndex.clear();
+		std::unordered_map<const i_widget*, std::size_t> focusOrder;
+		for (const auto& m : iMnemonics)
+			if (m.second != U'\0' && m.first->mnemonic_widget().has_surface() && m.first->mnemonic_widget().surface().surface_type() == surface_type::Window)
+			{
+				auto& surfaceIndex = iMnemonicIndex[&m.first->mnemonic_widget().surface()];
+				if (surfaceIndex.empty())
+				{
+					// number the window's widgets in focus (tab) order so clashing mnemonics resolve the same way every time
+					const i_widget& root = m.first->mnemonic_widget().root().as_widget();
+					const i_widget* w = &root;
+					do
+					{
+						if (!focusOrder.emplace(w, focusOrder.size()).second)
+							break;
+						w = &w->after();
+					} while (w != &root);
+				}
+				surfaceIndex[m.second].push_back(m.first);
+			}
+		for (auto& surfaceIndex : iMnemonicIndex)
+			for (auto& candidates : surfaceIndex.second)
+				std::sort(candidates.second.begin(), candidates.second.end(), [&focusOrder](i_mnemonic* aLeft, i_mnemonic* aRight)
+				{
+					auto left = focusOrder.find(&aLeft->mnemonic_widget());
+					auto right = focusOrder.find(&aRight->mnemonic_widget());
+					auto const leftOrder = left != focusOrder.end() ? left->second : focusOrder.size();
+					auto const rightOrder = right != focusOrder.end() ? right->second : focusOrder.size();
+					return leftOrder < rightOrder;
+				});
+		iMnemonicIndexInvalid = false;
 	}
 
 	i_menu& app::add_standard_menu(i_menu& aParentMenu, standard_menu aStandardMenu)
@@ -649,12 +766,15 @@ namespace neogfx
 				return didSome;
 
 			bool hadStrongSurfaces = surface_manager().any_strong_surfaces();
-			didSome = pump_messages();
+			didSome = (pump_messages() || didSome);
 			didSome = (do_io(neolib::yield_type::NoYield) || didSome);
+			didSome = (timer_service::instance().fire_due_timers() || didSome);
 			didSome = (do_process_events() || didSome);
 			if (!in_exec() && hadStrongSurfaces && !surface_manager().any_strong_surfaces())
 				throw main_window_closed_prematurely();
-			rendering_engine().render_now();
+			didSome = (rendering_engine().render_frame() || didSome);
+			if (!didSome)
+				rendering_engine().wait_for_frame();
 		}
 		catch (std::exception& e)
 		{
@@ -679,6 +799,12 @@ namespace neogfx
 		return didSome;
 	}
 
+	void app::wake_owner_thread()
+	{
+		if (iRenderingEngine)
+			iRenderingEngine->wake();
+	}
+
 	bool app::do_process_events()
 	{
 		bool lastWindowClosed = false;
@@ -695,34 +821,58 @@ namespace neogfx
 	{
 		if (aScanCode == ScanCode_LALT || aScanCode == ScanCode_RALT)
 			for (auto& m : iMnemonics)
-				m->mnemonic_widget().update();
-		bool partialMatches = false;
-		iKeySequence.push_back(std::make_pair(aKeyCode, aKeyModifiers));
-		for (auto& a : iActions)
-			if (a.second.is_enabled() && a.second.shortcut() != boost::none)
+				m.first->mnemonic_widget().update();
+		switch (aKeyCode)
+		{
+		case KeyCode_LCTRL:
+		case KeyCode_RCTRL:
+		case KeyCode_LSHIFT:
+		case KeyCode_RSHIFT:
+		case KeyCode_LALT:
+		case KeyCode_RALT:
+		case KeyCode_LGUI:
+		case KeyCode_RGUI:
+			return false; // modifier keys on their own neither match nor break a key sequence
+		default:
+			break;
+		}
+		if (iShortcutsInvalid)
+			rebuild_shortcuts();
+		auto const key = key_sequence::to_combo_key(aKeyCode, aKeyModifiers);
+		const shortcut_node* next = nullptr;
+		for (;;)
+		{
+			auto child = iShortcutState->children.find(key);
+			if (child != iShortcutState->children.end())
+			{
+				next = child->second.get();
+				break;
+			}
+			if (iShortcutState == &iShortcuts)
+				break;
+			// key sequence broken; the key may start a new one
+			iShortcutState = &iShortcuts;
+		}
+		if (next == nullptr)
+			return false;
+		for (auto a : next->actions)
+			if (a->is_enabled())
 			{
-				auto matchResult = a.second.shortcut()->matches(iKeySequence.begin(), iKeySequence.end());
-				if (matchResult == key_sequence::match::Full)
+				iShortcutState = &iShortcuts;
+				if (keyboard().is_front_grabber(*this))
 				{
-					iKeySequence.clear();
-					if (keyboard().is_front_grabber(*this))
-					{
-						a.second.triggered.trigger();
-						if (a.second.is_checkable())
-							a.second.toggle();
-						return true;
-					}
-					else
-					{
-						basic_services().system_beep();
-						return false;
-					}
+					a->triggered.trigger();
+					if (a->is_checkable())
+						a->toggle();
+					return true;
+				}
+				else
+				{
+					basic_services().system_beep();
+					return false;
 				}
-				else if (matchResult == key_sequence::match::Partial)
-					partialMatches = true;
 			}
-		if (!partialMatches)
-			iKeySequence.clear();
+		iShortcutState = (!next->children.empty() ? next : &iShortcuts);
 		return false;
 	}
 
@@ -730,34 +880,26 @@ namespace neogfx
 	{
 		if (aScanCode == ScanCode_LALT || aScanCode == ScanCode_RALT)
 			for (auto& m : iMnemonics)
-				m->mnemonic_widget().update();
+				m.first->mnemonic_widget().update();
 		return false;
 	}
 
 	namespace
 	{
-		struct mnemonic_sorter
+		struct mnemonic_surface_sorter
 		{
-			bool operator()(i_mnemonic* lhs, i_mnemonic* rhs) const
+			bool operator()(const i_surface* lhs, const i_surface* rhs) const
 			{
-				if (!lhs->mnemonic_widget().has_surface() && !rhs->mnemonic_widget().has_surface())
-					return lhs < rhs;
-				else if (lhs->mnemonic_widget().has_surface() && !rhs->mnemonic_widget().has_surface())
-					return true;
-				else if (!lhs->mnemonic_widget().has_surface() && rhs->mnemonic_widget().has_surface())
-					return false;
-				else if (lhs->mnemonic_widget().same_surface(rhs->mnemonic_widget()))
-					return lhs < rhs;
-				else if (lhs->mnemonic_widget().surface().is_owner_of(rhs->mnemonic_widget().surface()))
+				if (lhs->is_owner_of(*rhs))
 					return false;
-				else if (rhs->mnemonic_widget().surface().is_owner_of(lhs->mnemonic_widget().surface()))
+				else if (rhs->is_owner_of(*lhs))
 					return true;
-				else if (lhs->mnemonic_widget().has_surface() && lhs->mnemonic_widget().surface().surface_type() == surface_type::Window && static_cast<i_native_window&>(lhs->mnemonic_widget().surface().native_surface()).is_active())
+				else if (static_cast<const i_native_window&>(lhs->native_surface()).is_active())
 					return true;
-				else if (rhs->mnemonic_widget().has_surface() && rhs->mnemonic_widget().surface().surface_type() == surface_type::Window && static_cast<i_native_window&>(rhs->mnemonic_widget().surface().native_surface()).is_active())
+				else if (static_cast<const i_native_window&>(rhs->native_surface()).is_active())
 					return false;
 				else
-					return &lhs->mnemonic_widget().surface() < &rhs->mnemonic_widget().surface();
+					return lhs < rhs;
 			}
 		};
 	}
@@ -769,26 +911,31 @@ namespace neogfx
 
 	bool app::sys_text_input(const std::string& aInput)
 	{
-		static boost::locale::generator gen;
-		static std::locale loc = gen("en_US.UTF-8");
-		std::sort(iMnemonics.begin(), iMnemonics.end(), mnemonic_sorter());
-		i_surface* lastWindowSurface = nullptr;
-		for (auto& m : iMnemonics)
+		auto key = fold_mnemonic(aInput);
+		if (key == U'\0')
+			return false;
+		if (iMnemonicIndexInvalid)
+			rebuild_mnemonic_index();
+		if (iMnemonicIndex.empty())
+			return false;
+		// mnemonics are only active in the foremost window that has any (e.g. an open popup menu rather than its owner)
+		auto target = std::min_element(iMnemonicIndex.begin(), iMnemonicIndex.end(), 
+			[](const mnemonic_index::value_type& aLeft, const mnemonic_index::value_type& aRight) { return mnemonic_surface_sorter{}(aLeft.first, aRight.first); });
+		auto candidates = target->second.find(key);
+		if (candidates == target->second.end())
+			return false;
+		for (auto m : candidates->second)
 		{
-			if (lastWindowSurface == nullptr)
-			{
-				if (m->mnemonic_widget().has_surface() && m->mnemonic_widget().surface().surface_type() == surface_type::Window)
-					lastWindowSurface = &m->mnemonic_widget().surface();
-			}
-			else if (m->mnemonic_widget().has_surface() && m->mnemonic_widget().surface().surface_type() == surface_type::Window && lastWindowSurface != &m->mnemonic_widget().surface())
+			if (!m->mnemonic_widget().has_surface() || &m->mnemonic_widget().surface() != target->first)
 			{
+				// widget has moved to another window since the index was built
+				iMnemonicIndexInvalid = true;
 				continue;
 			}
-			if (boost::locale::to_lower(m->mnemonic(), loc) == boost::locale::to_lower(aInput, loc))
-			{
-				m->mnemonic_execute();
-				return true;
-			}
+			if (!m->mnemonic_widget().effectively_visible())
+				continue;
+			m->mnemonic_execute();
+			return true;
 		}
 		return false;
 	}
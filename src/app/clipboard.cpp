@@ -68,6 +68,7 @@ namespace neogfx
 	void clipboard::set_text(const std::string& aText)
 	{
 		iSystemClipboard.set_text(aText);
+		updated.trigger();
 	}
 
 	void clipboard::cut()
@@ -0,0 +1,90 @@
+// mapped_resource_archive.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include "mapped_resource_archive.hpp"
+
+namespace neogfx
+{
+	mapped_resource_archive::mapped_resource_archive(const std::string& aPath) :
+		iData{ nullptr }, iSize{ 0u }
+	{
+		try
+		{
+			iFile.open(aPath);
+		}
+		catch (...)
+		{
+			throw failed_to_open_archive();
+		}
+		iData = reinterpret_cast<const uint8_t*>(iFile.data());
+		iSize = iFile.size();
+		iHeader = resource_archive::read_header(iData, iSize);
+	}
+
+	mapped_resource_archive::mapped_resource_archive(const void* aData, std::size_t aSize) :
+		iData{ static_cast<const uint8_t*>(aData) }, iSize{ aSize }, iHeader(resource_archive::read_header(iData, iSize))
+	{
+	}
+
+	const uint8_t* mapped_resource_archive::data() const
+	{
+		return iData;
+	}
+
+	std::size_t mapped_resource_archive::size() const
+	{
+		return iSize;
+	}
+
+	std::size_t mapped_resource_archive::entry_count() const
+	{
+		return iHeader.entryCount;
+	}
+
+	boost::optional<std::size_t> mapped_resource_archive::index_of(const std::string& aName) const
+	{
+		auto const index = resource_archive::find(iData, iSize, iHeader, aName);
+		if (index == iHeader.entryCount)
+			return boost::none;
+		return index;
+	}
+
+	resource_archive::entry mapped_resource_archive::entry(std::size_t aIndex) const
+	{
+		return resource_archive::read_entry(iData, iSize, iHeader, static_cast<uint32_t>(aIndex));
+	}
+
+	bool mapped_resource_archive::stored(const resource_archive::entry& aEntry) const
+	{
+		return aEntry.codec == resource_archive::codec::Store;
+	}
+
+	std::pair<const void*, std::size_t> mapped_resource_archive::stored_data(const resource_archive::entry& aEntry) const
+	{
+		if (!stored(aEntry))
+			throw resource_archive::unknown_codec();
+		return std::make_pair(static_cast<const void*>(iData + aEntry.offset), static_cast<std::size_t>(aEntry.size));
+	}
+
+	void mapped_resource_archive::extract(const resource_archive::entry& aEntry, buffer_type& aBuffer) const
+	{
+		resource_archive::inflate(iData, aEntry, aBuffer);
+	}
+}
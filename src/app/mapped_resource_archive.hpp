@@ -0,0 +1,56 @@
+// mapped_resource_archive.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <boost/optional.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include "resource_archive.hpp"
+
+namespace neogfx
+{
+	// An indexed resource archive (.na) that is memory-mapped or, when embedded in a module, used in
+	// place; lookups probe the archive's own hash table so opening an archive costs nothing.
+	class mapped_resource_archive
+	{
+	public:
+		typedef std::vector<uint8_t> buffer_type;
+	public:
+		struct failed_to_open_archive : std::runtime_error { failed_to_open_archive() : std::runtime_error("neogfx::mapped_resource_archive::failed_to_open_archive") {} };
+	public:
+		mapped_resource_archive(const std::string& aPath);
+		mapped_resource_archive(const void* aData, std::size_t aSize);
+	public:
+		const uint8_t* data() const;
+		std::size_t size() const;
+		std::size_t entry_count() const;
+		boost::optional<std::size_t> index_of(const std::string& aName) const;
+		resource_archive::entry entry(std::size_t aIndex) const;
+	public:
+		bool stored(const resource_archive::entry& aEntry) const;
+		std::pair<const void*, std::size_t> stored_data(const resource_archive::entry& aEntry) const;
+		void extract(const resource_archive::entry& aEntry, buffer_type& aBuffer) const;
+	private:
+		boost::iostreams::mapped_file_source iFile;
+		const uint8_t* iData;
+		std::size_t iSize;
+		resource_archive::header iHeader;
+	};
+}
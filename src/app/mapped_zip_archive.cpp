@@ -0,0 +1,183 @@
+// mapped_zip_archive.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <zlib.h>
+#include "mapped_zip_archive.hpp"
+
+namespace neogfx
+{
+	mapped_zip_archive::mapped_zip_archive(const std::string& aPath) :
+		iData{ nullptr }, iSize{ 0u }, iCacheCapacity{ DefaultCacheCapacity }, iCacheSize{ 0u }
+	{
+		try
+		{
+			iFile.open(aPath);
+		}
+		catch (...)
+		{
+			throw failed_to_open_archive();
+		}
+		iData = reinterpret_cast<const uint8_t*>(iFile.data());
+		iSize = iFile.size();
+		iEndRecord = zip_directory::end_record(iData, iSize);
+	}
+
+	mapped_zip_archive::mapped_zip_archive(const void* aData, std::size_t aSize) :
+		iData{ static_cast<const uint8_t*>(aData) }, iSize{ aSize }, iEndRecord(zip_directory::end_record(iData, iSize)), iCacheCapacity{ DefaultCacheCapacity }, iCacheSize{ 0u }
+	{
+	}
+
+	const uint8_t* mapped_zip_archive::data() const
+	{
+		return iData;
+	}
+
+	std::size_t mapped_zip_archive::size() const
+	{
+		return iSize;
+	}
+
+	const zip_end_record& mapped_zip_archive::end_record() const
+	{
+		return iEndRecord;
+	}
+
+	const zip_entry_list& mapped_zip_archive::entries() const
+	{
+		std::lock_guard<std::recursive_mutex> lock{ iMutex };
+		if (iEntries == boost::none)
+		{
+			iEntries = zip_directory::entries(iData, iSize);
+			for (std::size_t i = 0; i < iEntries->size(); ++i)
+				iIndex.emplace((*iEntries)[i].path, i);
+		}
+		return *iEntries;
+	}
+
+	boost::optional<std::size_t> mapped_zip_archive::index_of(const std::string& aPath) const
+	{
+		std::lock_guard<std::recursive_mutex> lock{ iMutex };
+		entries();
+		auto existing = iIndex.find(aPath);
+		if (existing == iIndex.end())
+			return boost::none;
+		return existing->second;
+	}
+
+	bool mapped_zip_archive::stored(const zip_entry& aEntry) const
+	{
+		return aEntry.method == zip_directory::Stored;
+	}
+
+	std::pair<const void*, std::size_t> mapped_zip_archive::stored_data(const zip_entry& aEntry) const
+	{
+		if (!stored(aEntry))
+			throw unsupported_compression_method();
+		return std::make_pair(zip_directory::entry_data(iData, iSize, aEntry), static_cast<std::size_t>(aEntry.uncompressedSize));
+	}
+
+	void mapped_zip_archive::extract(const zip_entry& aEntry, buffer_type& aBuffer) const
+	{
+		auto const source = zip_directory::entry_data(iData, iSize, aEntry);
+		if (stored(aEntry))
+		{
+			aBuffer.assign(source, source + aEntry.uncompressedSize);
+			return;
+		}
+		if (aEntry.method != zip_directory::Deflated)
+			throw unsupported_compression_method();
+		aBuffer.resize(aEntry.uncompressedSize);
+		if (aEntry.uncompressedSize == 0u)
+			return;
+		z_stream stream = {};
+		stream.next_in = const_cast<Bytef*>(source);
+		stream.avail_in = aEntry.compressedSize;
+		stream.next_out = &aBuffer[0];
+		stream.avail_out = static_cast<uInt>(aBuffer.size());
+		if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+			throw failed_to_inflate();
+		int const result = inflate(&stream, Z_FINISH);
+		inflateEnd(&stream);
+		if (result != Z_STREAM_END || stream.total_out != aEntry.uncompressedSize)
+			throw failed_to_inflate();
+	}
+
+	std::string mapped_zip_archive::extract_to_string(const zip_entry& aEntry) const
+	{
+		buffer_type buffer;
+		extract(aEntry, buffer);
+		return std::string(buffer.begin(), buffer.end());
+	}
+
+	mapped_zip_archive::cached_buffer mapped_zip_archive::inflate(std::size_t aIndex) const
+	{
+		std::unique_lock<std::recursive_mutex> lock{ iMutex };
+		auto cached = iCacheIndex.find(aIndex);
+		if (cached != iCacheIndex.end())
+		{
+			iCache.splice(iCache.begin(), iCache, cached->second);
+			return cached->second->second;
+		}
+		zip_entry const entry = entries().at(aIndex);
+		lock.unlock();
+		auto buffer = std::make_shared<buffer_type>();
+		extract(entry, *buffer);
+		lock.lock();
+		cached = iCacheIndex.find(aIndex);
+		if (cached != iCacheIndex.end())
+			return cached->second->second;
+		if (buffer->size() <= iCacheCapacity)
+		{
+			iCache.emplace_front(aIndex, buffer);
+			iCacheIndex[aIndex] = iCache.begin();
+			iCacheSize += buffer->size();
+			trim_cache();
+		}
+		return buffer;
+	}
+
+	std::size_t mapped_zip_archive::cache_capacity() const
+	{
+		return iCacheCapacity;
+	}
+
+	void mapped_zip_archive::set_cache_capacity(std::size_t aCapacity)
+	{
+		std::lock_guard<std::recursive_mutex> lock{ iMutex };
+		iCacheCapacity = aCapacity;
+		trim_cache();
+	}
+
+	std::size_t mapped_zip_archive::cache_size() const
+	{
+		std::lock_guard<std::recursive_mutex> lock{ iMutex };
+		return iCacheSize;
+	}
+
+	void mapped_zip_archive::trim_cache() const
+	{
+		while (iCacheSize > iCacheCapacity && !iCache.empty())
+		{
+			iCacheSize -= iCache.back().second->size();
+			iCacheIndex.erase(iCache.back().first);
+			iCache.pop_back();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+// mapped_zip_archive.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <memory>
+#include <unordered_map>
+#include <list>
+#include <mutex>
+#include <boost/optional.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include "zip_directory.hpp"
+
+namespace neogfx
+{
+	// A zip archive that is memory-mapped (or borrowed from memory) rather than read; the central
+	// directory is only parsed if entries are looked up by path and entries are inflated on demand.
+	// Inflated entries are kept in a bounded (least recently used) cache.
+	class mapped_zip_archive
+	{
+	public:
+		typedef std::vector<uint8_t> buffer_type;
+		typedef std::shared_ptr<const buffer_type> cached_buffer;
+	private:
+		typedef std::unordered_map<std::string, std::size_t> entry_index;
+		typedef std::list<std::pair<std::size_t, cached_buffer>> cache_list;
+		typedef std::unordered_map<std::size_t, cache_list::iterator> cache_index;
+	public:
+		static const std::size_t DefaultCacheCapacity = 16u * 1024u * 1024u;
+	public:
+		struct failed_to_open_archive : std::runtime_error { failed_to_open_archive() : std::runtime_error("neogfx::mapped_zip_archive::failed_to_open_archive") {} };
+		struct unsupported_compression_method : std::runtime_error { unsupported_compression_method() : std::runtime_error("neogfx::mapped_zip_archive::unsupported_compression_method") {} };
+		struct failed_to_inflate : std::runtime_error { failed_to_inflate() : std::runtime_error("neogfx::mapped_zip_archive::failed_to_inflate") {} };
+	public:
+		mapped_zip_archive(const std::string& aPath);
+		mapped_zip_archive(const void* aData, std::size_t aSize);
+	public:
+		const uint8_t* data() const;
+		std::size_t size() const;
+		const zip_end_record& end_record() const;
+		const zip_entry_list& entries() const;
+		boost::optional<std::size_t> index_of(const std::string& aPath) const;
+	public:
+		bool stored(const zip_entry& aEntry) const;
+		std::pair<const void*, std::size_t> stored_data(const zip_entry& aEntry) const;
+		void extract(const zip_entry& aEntry, buffer_type& aBuffer) const;
+		std::string extract_to_string(const zip_entry& aEntry) const;
+		cached_buffer inflate(std::size_t aIndex) const;
+		std::size_t cache_capacity() const;
+		void set_cache_capacity(std::size_t aCapacity);
+		std::size_t cache_size() const;
+	private:
+		void trim_cache() const;
+	private:
+		boost::iostreams::mapped_file_source iFile;
+		const uint8_t* iData;
+		std::size_t iSize;
+		zip_end_record iEndRecord;
+		mutable boost::optional<zip_entry_list> iEntries;
+		mutable entry_index iIndex;
+		mutable std::recursive_mutex iMutex;
+		std::size_t iCacheCapacity;
+		mutable cache_list iCache;
+		mutable cache_index iCacheIndex;
+		mutable std::size_t iCacheSize;
+	};
+}
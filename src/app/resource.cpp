@@ -22,67 +22,50 @@
 #include <boost/filesystem.hpp>
 #include <openssl/sha.h>
 #include <neolib/uri.hpp>
-#include <neolib/zip.hpp>
 #include <neogfx/app/resource.hpp>
+#include "mapped_zip_archive.hpp"
 
 namespace neogfx
 {
 	resource::resource(i_resource_manager& aManager, const std::string& aUri) : 
-		iManager{aManager}, iUri{aUri}, iSize{0}
+		iManager{aManager}, iUri{aUri}, iSize{0}, iView{nullptr}
 	{
 		neolib::uri uri{aUri};
-		if (uri.scheme() == "file")
+		if (!uri.fragment().empty()) // asset archive
 		{
-			if (uri.fragment().empty()) // individual asset file
-			{ 
-				iData.resize(static_cast<std::size_t>(boost::filesystem::file_size(uri.path())));
-				std::ifstream input(uri.path(), std::ios::binary | std::ios::in);
-				input.read(reinterpret_cast<char*>(data()), iData.size());
-				iSize = iData.size();
+			iArchive = aManager.load_archive(aUri.substr(0, aUri.find('#')));
+			if (iArchive == nullptr)
+			{
+				iError = "Unsupported archive URI scheme";
+				return;
 			}
-			else // asset archive
+			iArchiveEntry = iArchive->index_of(uri.fragment());
+			if (iArchiveEntry == boost::none)
 			{
-				neolib::zip archive{uri.path()};
-				for (std::size_t i = 0; i < archive.file_count(); ++i)
-				{
-					if (archive.file_path(i) == uri.fragment())
-					{
-						archive.extract_to(i, iData);
-						iSize = iData.size();
-					}
-				}
+				iError = "Resource not found in archive";
+				return;
 			}
+			auto const& entry = iArchive->entries()[*iArchiveEntry];
+			iSize = entry.uncompressedSize;
+			if (iArchive->stored(entry))
+				iView = iArchive->stored_data(entry).first;
 		}
-		else if (uri.scheme().empty())
+		else if (uri.scheme() == "file") // individual asset file
 		{
-			if (!uri.fragment().empty()) // asset archive
-			{
-				auto assetArchive = aManager.load_resource(":/" + uri.path());
-				neolib::zip archive{assetArchive->cdata(), assetArchive->size()};
-				for (std::size_t i = 0; i < archive.file_count(); ++i)
-				{
-					if (archive.file_path(i) == uri.fragment())
-					{
-						archive.extract_to(i, iData);
-						iSize = iData.size();
-					}
-					else
-					{
-						neolib::uri otherResource(uri);
-						otherResource.set_fragment(archive.file_path(i));
-						std::ostringstream oss;
-						oss << otherResource;
-						neolib::zip::buffer_type buffer;
-						archive.extract_to(i, buffer);
-						aManager.add_resource(oss.str(), &buffer[0], buffer.size());
-					}
-				}
-			}
+			iData.resize(static_cast<std::size_t>(boost::filesystem::file_size(uri.path())));
+			std::ifstream input(uri.path(), std::ios::binary | std::ios::in);
+			input.read(reinterpret_cast<char*>(&iData[0]), iData.size());
+			iSize = iData.size();
 		}
 	}
 
 	resource::resource(i_resource_manager& aManager, const std::string& aUri, const void* aData, std::size_t aSize) : 
-		iManager{aManager}, iUri{aUri}, iSize{aSize}, iData{reinterpret_cast<const uint8_t*>(aData), reinterpret_cast<const uint8_t*>(aData) + aSize}
+		iManager{aManager}, iUri{aUri}, iSize{aSize}, iView{nullptr}, iData{reinterpret_cast<const uint8_t*>(aData), reinterpret_cast<const uint8_t*>(aData) + aSize}
+	{
+	}
+
+	resource::resource(i_resource_manager& aManager, const std::string& aUri, std::vector<uint8_t>&& aData) : 
+		iManager{aManager}, iUri{aUri}, iSize{aData.size()}, iView{nullptr}, iData{std::move(aData)}
 	{
 	}
 
@@ -93,13 +76,15 @@ namespace neogfx
 
 	bool resource::available() const
 	{
-		return iSize != 0 && iData.size() == iSize;
+		return iSize != 0 && (iArchiveEntry != boost::none || iData.size() == iSize);
 	}
 
 	std::pair<bool, double> resource::downloading() const
 	{
 		if (iSize == 0)
 			return std::make_pair(false, 0.0);
+		else if (iArchiveEntry != boost::none)
+			return std::make_pair(false, 100.0);
 		else if (iData.size() != iSize)
 			return std::make_pair(true, 100.0 * iData.size() / iSize);
 		else
@@ -126,9 +111,17 @@ namespace neogfx
 	
 	const void* resource::cdata() const
 	{
-		if (iData.empty())
-			throw no_data();
-		return &iData[0];
+		if (!iData.empty())
+			return &iData[0];
+		if (iView != nullptr)
+			return iView;
+		if (iArchiveEntry != boost::none && iSize != 0)
+		{
+			if (iInflated == nullptr)
+				iInflated = iArchive->inflate(*iArchiveEntry);
+			return &(*iInflated)[0];
+		}
+		throw no_data();
 	}
 
 	const void* resource::data() const
@@ -138,12 +131,20 @@ namespace neogfx
 	
 	void* resource::data()
 	{
+		if (iData.empty() && iArchiveEntry != boost::none && iSize != 0)
+		{
+			// archive contents are shared so take a private copy before allowing writes
+			auto const source = static_cast<const uint8_t*>(cdata());
+			iData.assign(source, source + iSize);
+			iView = nullptr;
+			iInflated.reset();
+		}
 		return const_cast<void*>(const_cast<const resource*>(this)->data());
 	}
 
 	std::size_t resource::size() const
 	{
-		return iData.size();
+		return iArchiveEntry != boost::none ? iSize : iData.size();
 	}
 
 	resource::hash_digest_type resource::hash() const
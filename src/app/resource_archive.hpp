@@ -0,0 +1,271 @@
+// resource_archive.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace neogfx
+{
+	// Indexed resource archive (.na) as written by the resource compiler (nrc -archive/-incbin). The
+	// header is followed by an open addressing hash table of entry indices, fixed size entry records,
+	// a name table and 16-byte aligned entry data so that an archive held in memory can be searched
+	// in constant time and stored entries used in place.
+	namespace resource_archive
+	{
+		struct bad_archive : std::runtime_error { bad_archive() : std::runtime_error("neogfx::resource_archive::bad_archive") {} };
+		struct unknown_codec : std::runtime_error { unknown_codec() : std::runtime_error("neogfx::resource_archive::unknown_codec") {} };
+		struct failed_to_deflate : std::runtime_error { failed_to_deflate() : std::runtime_error("neogfx::resource_archive::failed_to_deflate") {} };
+		struct failed_to_inflate : std::runtime_error { failed_to_inflate() : std::runtime_error("neogfx::resource_archive::failed_to_inflate") {} };
+
+		const uint32_t Magic = 0x41524E47u; // "NGRA"
+		const uint32_t Version = 1u;
+		const std::size_t HeaderSize = 32u;
+		const std::size_t RecordSize = 32u;
+		const std::size_t DataAlignment = 16u;
+
+		enum class codec : uint8_t
+		{
+			Store	= 0,
+			Deflate	= 1,
+			Auto	= 0xFF // compressor only: deflate unless that does not pay
+		};
+
+		struct header
+		{
+			uint32_t entryCount;
+			uint32_t slotCount;
+			uint32_t recordsOffset;
+			uint32_t namesOffset;
+		};
+
+		struct entry
+		{
+			uint64_t hash;
+			uint64_t offset;
+			uint32_t storedSize;
+			uint32_t size;
+			uint32_t nameOffset;
+			uint16_t nameLength;
+			resource_archive::codec codec;
+		};
+
+		struct source
+		{
+			std::string name;
+			resource_archive::codec codec;
+			std::vector<uint8_t> data;
+		};
+
+		inline uint64_t hash(const char* aName, std::size_t aLength)
+		{
+			uint64_t result = 0xCBF29CE484222325ull;
+			for (std::size_t i = 0; i < aLength; ++i)
+			{
+				result ^= static_cast<uint8_t>(aName[i]);
+				result *= 0x100000001B3ull;
+			}
+			return result;
+		}
+
+		template <typename T>
+		inline T read_value(const uint8_t* aData)
+		{
+			T result;
+			std::memcpy(&result, aData, sizeof(T));
+			return result;
+		}
+
+		template <typename T>
+		inline void write_value(std::ostream& aStream, T aValue)
+		{
+			aStream.write(reinterpret_cast<const char*>(&aValue), sizeof(T));
+		}
+
+		inline header read_header(const uint8_t* aData, std::size_t aSize)
+		{
+			if (aSize < HeaderSize || read_value<uint32_t>(aData) != Magic || read_value<uint32_t>(aData + 4u) != Version)
+				throw bad_archive();
+			header result{ read_value<uint32_t>(aData + 8u), read_value<uint32_t>(aData + 12u), read_value<uint32_t>(aData + 16u), read_value<uint32_t>(aData + 20u) };
+			if (result.slotCount == 0u || (result.slotCount & (result.slotCount - 1u)) != 0u || result.slotCount <= result.entryCount ||
+				result.recordsOffset != HeaderSize + result.slotCount * 4u ||
+				result.namesOffset != result.recordsOffset + result.entryCount * RecordSize || result.namesOffset > aSize)
+				throw bad_archive();
+			return result;
+		}
+
+		inline entry read_entry(const uint8_t* aData, std::size_t aSize, const header& aHeader, uint32_t aIndex)
+		{
+			auto const record = aData + aHeader.recordsOffset + aIndex * RecordSize;
+			entry result{ read_value<uint64_t>(record), read_value<uint64_t>(record + 8u), read_value<uint32_t>(record + 16u), read_value<uint32_t>(record + 20u),
+				read_value<uint32_t>(record + 24u), read_value<uint16_t>(record + 28u), static_cast<codec>(record[30u]) };
+			if (result.offset + result.storedSize > aSize || aHeader.namesOffset + static_cast<std::size_t>(result.nameOffset) + result.nameLength > aSize)
+				throw bad_archive();
+			return result;
+		}
+
+		inline const char* entry_name(const uint8_t* aData, const header& aHeader, const entry& aEntry)
+		{
+			return reinterpret_cast<const char*>(aData + aHeader.namesOffset + aEntry.nameOffset);
+		}
+
+		// Returns the index of the named entry or aHeader.entryCount if there is no such entry.
+		inline uint32_t find(const uint8_t* aData, std::size_t aSize, const header& aHeader, const std::string& aName)
+		{
+			auto const nameHash = hash(aName.data(), aName.size());
+			auto const mask = aHeader.slotCount - 1u;
+			auto const slots = aData + HeaderSize;
+			for (uint32_t slot = static_cast<uint32_t>(nameHash) & mask;; slot = (slot + 1u) & mask)
+			{
+				auto const index = read_value<uint32_t>(slots + slot * 4u);
+				if (index == 0u || index > aHeader.entryCount)
+					return aHeader.entryCount;
+				auto const e = read_entry(aData, aSize, aHeader, index - 1u);
+				if (e.hash == nameHash && e.nameLength == aName.size() && std::memcmp(entry_name(aData, aHeader, e), aName.data(), aName.size()) == 0)
+					return index - 1u;
+			}
+		}
+
+		inline void inflate(const uint8_t* aData, const entry& aEntry, std::vector<uint8_t>& aBuffer)
+		{
+			auto const source = aData + aEntry.offset;
+			if (aEntry.codec == codec::Store)
+			{
+				aBuffer.assign(source, source + aEntry.size);
+				return;
+			}
+			if (aEntry.codec != codec::Deflate)
+				throw unknown_codec();
+			aBuffer.resize(aEntry.size);
+			if (aEntry.size == 0u)
+				return;
+			z_stream stream = {};
+			stream.next_in = const_cast<Bytef*>(source);
+			stream.avail_in = aEntry.storedSize;
+			stream.next_out = &aBuffer[0];
+			stream.avail_out = static_cast<uInt>(aBuffer.size());
+			if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+				throw failed_to_inflate();
+			int const result = ::inflate(&stream, Z_FINISH);
+			inflateEnd(&stream);
+			if (result != Z_STREAM_END || stream.total_out != aEntry.size)
+				throw failed_to_inflate();
+		}
+
+		inline std::vector<uint8_t> deflate(const std::vector<uint8_t>& aData)
+		{
+			std::vector<uint8_t> result;
+			z_stream stream = {};
+			if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 9, Z_DEFAULT_STRATEGY) != Z_OK)
+				throw failed_to_deflate();
+			result.resize(deflateBound(&stream, static_cast<uLong>(aData.size())));
+			stream.next_in = const_cast<Bytef*>(aData.empty() ? nullptr : &aData[0]);
+			stream.avail_in = static_cast<uInt>(aData.size());
+			stream.next_out = &result[0];
+			stream.avail_out = static_cast<uInt>(result.size());
+			int const status = ::deflate(&stream, Z_FINISH);
+			deflateEnd(&stream);
+			if (status != Z_STREAM_END)
+				throw failed_to_deflate();
+			result.resize(stream.total_out);
+			return result;
+		}
+
+		inline void write(std::ostream& aStream, const std::vector<source>& aSources)
+		{
+			auto const entryCount = static_cast<uint32_t>(aSources.size());
+			uint32_t slotCount = 1u;
+			while (slotCount < entryCount * 2u + 1u)
+				slotCount *= 2u;
+			std::vector<entry> entries;
+			std::vector<std::vector<uint8_t>> payloads;
+			std::string names;
+			for (auto const& s : aSources)
+			{
+				entry e{ hash(s.name.data(), s.name.size()), 0u, 0u, static_cast<uint32_t>(s.data.size()), static_cast<uint32_t>(names.size()), static_cast<uint16_t>(s.name.size()), codec::Store };
+				names += s.name;
+				payloads.push_back(s.data);
+				if (s.codec != codec::Store)
+				{
+					auto compressed = deflate(s.data);
+					if (s.codec == codec::Deflate || compressed.size() < s.data.size() - s.data.size() / 8u)
+					{
+						e.codec = codec::Deflate;
+						payloads.back() = std::move(compressed);
+					}
+				}
+				e.storedSize = static_cast<uint32_t>(payloads.back().size());
+				entries.push_back(e);
+			}
+			std::vector<uint32_t> slots(slotCount);
+			for (uint32_t i = 0; i < entryCount; ++i)
+			{
+				uint32_t slot = static_cast<uint32_t>(entries[i].hash) & (slotCount - 1u);
+				while (slots[slot] != 0u)
+					slot = (slot + 1u) & (slotCount - 1u);
+				slots[slot] = i + 1u;
+			}
+			auto const recordsOffset = static_cast<uint32_t>(HeaderSize + slotCount * 4u);
+			auto const namesOffset = static_cast<uint32_t>(recordsOffset + entryCount * RecordSize);
+			uint64_t offset = namesOffset + names.size();
+			for (uint32_t i = 0; i < entryCount; ++i)
+			{
+				offset = (offset + DataAlignment - 1u) / DataAlignment * DataAlignment;
+				entries[i].offset = offset;
+				offset += entries[i].storedSize;
+			}
+			write_value(aStream, Magic);
+			write_value(aStream, Version);
+			write_value(aStream, entryCount);
+			write_value(aStream, slotCount);
+			write_value(aStream, recordsOffset);
+			write_value(aStream, namesOffset);
+			write_value(aStream, uint64_t{});
+			for (auto slot : slots)
+				write_value(aStream, slot);
+			for (auto const& e : entries)
+			{
+				write_value(aStream, e.hash);
+				write_value(aStream, e.offset);
+				write_value(aStream, e.storedSize);
+				write_value(aStream, e.size);
+				write_value(aStream, e.nameOffset);
+				write_value(aStream, e.nameLength);
+				write_value(aStream, static_cast<uint8_t>(e.codec));
+				write_value(aStream, uint8_t{});
+			}
+			aStream.write(names.data(), names.size());
+			offset = namesOffset + names.size();
+			for (uint32_t i = 0; i < entryCount; ++i)
+			{
+				for (; offset < entries[i].offset; ++offset)
+					aStream.put('\0');
+				if (!payloads[i].empty())
+					aStream.write(reinterpret_cast<const char*>(&payloads[i][0]), payloads[i].size());
+				offset += payloads[i].size();
+			}
+		}
+	}
+}
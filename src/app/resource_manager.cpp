@@ -21,6 +21,9 @@
 #include <neogfx/app/resource_manager.hpp>
 #include <neogfx/app/module_resource.hpp>
 #include <neogfx/app/resource.hpp>
+#include <neolib/uri.hpp>
+#include "mapped_zip_archive.hpp"
+#include "mapped_resource_archive.hpp"
 
 namespace neogfx
 {	
@@ -44,6 +47,16 @@ namespace neogfx
 		iResources[aUri] = i_resource::pointer(std::make_shared<module_resource>(aUri, aResourceData, aResourceSize));
 	}
 
+	void resource_manager::add_module_archive(const void* aArchiveData, std::size_t aArchiveSize)
+	{
+		iIndexedArchives.push_back(std::make_shared<mapped_resource_archive>(aArchiveData, aArchiveSize));
+	}
+
+	void resource_manager::add_archive(const std::string& aArchivePath)
+	{
+		iIndexedArchives.push_back(std::make_shared<mapped_resource_archive>(aArchivePath));
+	}
+
 	i_resource::pointer resource_manager::load_resource(const std::string& aUri)
 	{
 		auto existing = iResources.find(aUri);
@@ -55,11 +68,55 @@ namespace neogfx
 			if (!ptr.expired())
 				return ptr.lock();
 		}
+		if (aUri.compare(0, 2, ":/") == 0)
+		{
+			// indexed archives: stored entries are used in place, others are inflated on each load
+			for (auto const& archive : iIndexedArchives)
+			{
+				auto index = archive->index_of(aUri.substr(2));
+				if (index == boost::none)
+					continue;
+				auto const entry = archive->entry(*index);
+				if (archive->stored(entry))
+				{
+					auto const storedData = archive->stored_data(entry);
+					i_resource::pointer newResource = std::make_shared<module_resource>(aUri, storedData.first, storedData.second);
+					iResources[aUri] = newResource;
+					return newResource;
+				}
+				mapped_resource_archive::buffer_type buffer;
+				archive->extract(entry, buffer);
+				i_resource::pointer newResource = std::make_shared<resource>(*this, aUri, std::move(buffer));
+				iResources[aUri] = i_resource::weak_pointer(newResource);
+				return newResource;
+			}
+		}
 		i_resource::pointer newResource = std::make_shared<resource>(*this, aUri);
 		iResources[aUri] = i_resource::weak_pointer(newResource);
 		return newResource;
 	}
 
+	std::shared_ptr<const mapped_zip_archive> resource_manager::load_archive(const std::string& aArchiveUri)
+	{
+		auto existing = iResourceArchives.find(aArchiveUri);
+		if (existing != iResourceArchives.end())
+			return existing->second;
+		std::shared_ptr<const mapped_zip_archive> newArchive;
+		neolib::uri uri{aArchiveUri};
+		if (uri.scheme() == "file")
+			newArchive = std::make_shared<mapped_zip_archive>(uri.path());
+		else if (uri.scheme().empty())
+		{
+			// embedded archive: index the module's bytes in place, keeping them alive with the archive
+			auto backing = load_resource(":/" + uri.path());
+			newArchive.reset(new mapped_zip_archive{ backing->cdata(), backing->size() }, [backing](const mapped_zip_archive* aArchive) { delete aArchive; });
+		}
+		else
+			return newArchive;
+		iResourceArchives[aArchiveUri] = newArchive;
+		return newArchive;
+	}
+
 	void resource_manager::cleanup()
 	{
 		for (auto i = iResources.begin(); i != iResources.end();)
@@ -77,5 +134,7 @@ namespace neogfx
 		resources.swap(iResources);
 		decltype(iResourceArchives) resourceArchives;
 		resourceArchives.swap(iResourceArchives);
+		decltype(iIndexedArchives) indexedArchives;
+		indexedArchives.swap(iIndexedArchives);
 	}
 }
\ No newline at end of file
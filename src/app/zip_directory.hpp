@@ -0,0 +1,125 @@
+// zip_directory.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+namespace neogfx
+{
+	// Minimal, header-only reader for the central directory of a zip archive held in memory; shared
+	// with the resource compiler.
+	struct zip_entry
+	{
+		std::string path;
+		uint16_t method;
+		uint32_t crc;
+		uint32_t compressedSize;
+		uint32_t uncompressedSize;
+		uint32_t localHeaderOffset;
+	};
+	typedef std::vector<zip_entry> zip_entry_list;
+
+	struct zip_end_record
+	{
+		uint32_t directoryOffset;
+		uint32_t directorySize;
+		uint16_t entryCount;
+	};
+
+	namespace zip_directory
+	{
+		struct bad_archive : std::runtime_error { bad_archive() : std::runtime_error("neogfx::zip_directory::bad_archive") {} };
+
+		const uint16_t Stored = 0u;
+		const uint16_t Deflated = 8u;
+
+		inline uint16_t read16(const uint8_t* aData)
+		{
+			return static_cast<uint16_t>(aData[0] | (aData[1] << 8u));
+		}
+
+		inline uint32_t read32(const uint8_t* aData)
+		{
+			return static_cast<uint32_t>(aData[0]) | (static_cast<uint32_t>(aData[1]) << 8u) | (static_cast<uint32_t>(aData[2]) << 16u) | (static_cast<uint32_t>(aData[3]) << 24u);
+		}
+
+		inline zip_end_record end_record(const uint8_t* aData, std::size_t aSize)
+		{
+			const std::size_t RecordSize = 22u;
+			if (aSize < RecordSize)
+				throw bad_archive();
+			std::size_t const searchLimit = aSize > RecordSize + 0xFFFFu ? aSize - RecordSize - 0xFFFFu : 0u;
+			for (std::size_t pos = aSize - RecordSize + 1u; pos-- > searchLimit;)
+			{
+				if (read32(aData + pos) == 0x06054B50u)
+				{
+					zip_end_record result{ read32(aData + pos + 16u), read32(aData + pos + 12u), read16(aData + pos + 10u) };
+					if (static_cast<std::size_t>(result.directoryOffset) + result.directorySize > aSize)
+						throw bad_archive();
+					return result;
+				}
+			}
+			throw bad_archive();
+		}
+
+		inline zip_entry_list entries(const uint8_t* aData, std::size_t aSize)
+		{
+			auto const endRecord = end_record(aData, aSize);
+			zip_entry_list result;
+			result.reserve(endRecord.entryCount);
+			const uint8_t* next = aData + endRecord.directoryOffset;
+			const uint8_t* const end = next + endRecord.directorySize;
+			for (uint16_t i = 0; i < endRecord.entryCount; ++i)
+			{
+				if (end - next < 46 || read32(next) != 0x02014B50u)
+					throw bad_archive();
+				uint16_t const nameLength = read16(next + 28u);
+				uint16_t const extraLength = read16(next + 30u);
+				uint16_t const commentLength = read16(next + 32u);
+				if (end - next < 46 + nameLength + extraLength + commentLength)
+					throw bad_archive();
+				result.push_back(zip_entry{
+					std::string(reinterpret_cast<const char*>(next + 46u), nameLength),
+					read16(next + 10u),
+					read32(next + 16u),
+					read32(next + 20u),
+					read32(next + 24u),
+					read32(next + 42u) });
+				next += 46u + nameLength + extraLength + commentLength;
+			}
+			return result;
+		}
+
+		// Returns the (possibly compressed) data of an entry by following its local header.
+		inline const uint8_t* entry_data(const uint8_t* aData, std::size_t aSize, const zip_entry& aEntry)
+		{
+			std::size_t const header = aEntry.localHeaderOffset;
+			if (header + 30u > aSize || read32(aData + header) != 0x04034B50u)
+				throw bad_archive();
+			std::size_t const data = header + 30u + read16(aData + header + 26u) + read16(aData + header + 28u);
+			if (data + aEntry.compressedSize > aSize)
+				throw bad_archive();
+			return aData + data;
+		}
+	}
+}
@@ -18,29 +18,74 @@
 */
 
 #include <neogfx/neogfx.hpp>
-#include <neolib/timer.hpp>
 #include <neogfx/core/event.hpp>
 #include <neogfx/app/app.hpp>
 
 namespace neogfx
 { 
-	async_event_queue::async_event_queue(neolib::async_task& aIoTask) : iTimer{ aIoTask,
-		[this](neolib::callback_timer& aTimer)
+	async_event_queue::entry_queue::entry_queue() :
+		iHead{ &iStub }, iTail{ &iStub }
+	{
+		iStub.next = nullptr;
+	}
+
+	void async_event_queue::entry_queue::push(entry* aEntry)
+	{
+		aEntry->next.store(nullptr, std::memory_order_relaxed);
+		auto previous = iHead.exchange(aEntry, std::memory_order_acq_rel);
+		previous->next.store(aEntry, std::memory_order_release);
+	}
+
+	async_event_queue::entry* async_event_queue::entry_queue::pop()
+	{
+		auto tail = iTail;
+		auto next = tail->next.load(std::memory_order_acquire);
+		if (tail == &iStub)
+		{
+			if (next == nullptr)
+				return nullptr;
+			iTail = next;
+			tail = next;
+			next = next->next.load(std::memory_order_acquire);
+		}
+		if (next != nullptr)
+		{
+			iTail = next;
+			return tail;
+		}
+		if (tail != iHead.load(std::memory_order_acquire))
+			return nullptr; // a producer is mid-push; the entry will be visible on the next pop
+		push(&iStub);
+		next = tail->next.load(std::memory_order_acquire);
+		if (next != nullptr)
 		{
-			publish_events();
-			if (!iEvents.empty() && !aTimer.waiting())
-				aTimer.again();
-		}, 10, false },
-		iHaveThreadedCallbacks{ false }
+			iTail = next;
+			return tail;
+		}
+		return nullptr;
+	}
+
+	async_event_queue::async_event_queue() :
+		iOwnerThread{ std::this_thread::get_id() },
+		iQueues{ nullptr }
 	{
 		if (sInstance != nullptr)
 			throw instance_exists();
+		reset_stats();
 		sInstance = this;
 	}
 
 	async_event_queue::~async_event_queue()
 	{
 		sInstance = nullptr;
+		for (auto q = iQueues.load(); q != nullptr;)
+		{
+			while (auto e = q->entries.pop())
+				delete e;
+			auto next = q->next;
+			delete q;
+			q = next;
+		}
 	}
 
 	async_event_queue* async_event_queue::sInstance;
@@ -54,62 +99,115 @@ namespace neogfx
 
 	bool async_event_queue::exec()
 	{
+		auto q = find_queue(std::this_thread::get_id());
+		if (q == nullptr || q->size == 0u)
+			return false;
+		q->wakePending = false;
 		bool didSome = false;
-		if (iHaveThreadedCallbacks)
+		// Only entries present on entry are processed so that handlers which post again cannot starve the caller.
+		for (auto count = q->size.load(); count > 0u; --count)
 		{
-			callback_list work;
+			std::unique_ptr<entry> e{ q->entries.pop() };
+			if (e == nullptr)
+				break;
+			--q->size;
+			auto const latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - e->posted).count();
+			iTotalLatency += latency;
+			auto maxLatency = iMaxLatency.load();
+			while (latency > maxLatency && !iMaxLatency.compare_exchange_weak(maxLatency, latency));
+			if (e->event != boost::none && e->event->expired())
 			{
-				std::lock_guard<std::recursive_mutex> guard{ iThreadedCallbacksMutex };
-				work = std::move(iThreadedCallbacks[std::this_thread::get_id()]);
-				iThreadedCallbacks.erase(iThreadedCallbacks.find(std::this_thread::get_id()));
-				iHaveThreadedCallbacks = !iThreadedCallbacks.empty();
-			}
-			for (auto& cb : work)
-			{
-				cb();
-				didSome = true;
+				++iDiscarded;
+				continue;
 			}
+			e->function();
+			++iDispatched;
+			didSome = true;
 		}
 		return didSome;
 	}
 
+	void async_event_queue::post(std::weak_ptr<void> aEvent, callback aCallback)
+	{
+		std::unique_ptr<entry> e{ new entry{} };
+		e->event = std::move(aEvent);
+		e->function = std::move(aCallback);
+		push(iOwnerThread, std::move(e));
+	}
+
 	void async_event_queue::enqueue_to_thread(std::thread::id aThreadId, callback aCallback)
 	{
-		std::lock_guard<std::recursive_mutex> guard{ iThreadedCallbacksMutex };
-		iThreadedCallbacks[aThreadId].push_back(aCallback);
-		iHaveThreadedCallbacks = true;
+		std::unique_ptr<entry> e{ new entry{} };
+		e->function = std::move(aCallback);
+		push(aThreadId, std::move(e));
+	}
+
+	void async_event_queue::count_coalesced()
+	{
+		++iCoalesced;
 	}
 
-	void async_event_queue::add(const void* aEvent, callback aCallback, neolib::lifetime::destroyed_flag aDestroyedFlag)
+	async_event_queue::statistics async_event_queue::stats() const
 	{
-		iEvents.emplace(aEvent, std::make_pair(aCallback, aDestroyedFlag));
-		if (!iTimer.waiting())
-			iTimer.again();
+		return statistics{ 
+			iPosted, 
+			iCoalesced, 
+			iDispatched, 
+			iDiscarded, 
+			iWakeups, 
+			std::chrono::nanoseconds{ iTotalLatency.load() }, 
+			std::chrono::nanoseconds{ iMaxLatency.load() } };
 	}
 
-	void async_event_queue::remove(const void* aEvent)
+	void async_event_queue::reset_stats()
 	{
-		auto events = iEvents.equal_range(aEvent);
-		if (events.first == events.second)
-			throw event_not_found();
-		event_list toPublish{ events.first, events.second };
-		iEvents.erase(events.first, events.second);
-		for (auto& e : toPublish)
-			if (!e.second.second)
-				e.second.first();
+		iPosted = 0u;
+		iCoalesced = 0u;
+		iDispatched = 0u;
+		iDiscarded = 0u;
+		iWakeups = 0u;
+		iTotalLatency = 0;
+		iMaxLatency = 0;
+	}
+
+	void async_event_queue::wake_owner_thread()
+	{
+	}
+
+	void async_event_queue::push(std::thread::id aThreadId, std::unique_ptr<entry> aEntry)
+	{
+		auto& q = queue(aThreadId);
+		aEntry->posted = std::chrono::steady_clock::now();
+		q.entries.push(aEntry.release());
+		++q.size;
+		++iPosted;
+		if (aThreadId == iOwnerThread && std::this_thread::get_id() != iOwnerThread && !q.wakePending.exchange(true))
+		{
+			++iWakeups;
+			wake_owner_thread();
+		}
 	}
 
-	bool async_event_queue::has(const void* aEvent) const
+	async_event_queue::thread_queue* async_event_queue::find_queue(std::thread::id aThreadId) const
 	{
-		return iEvents.find(aEvent) != iEvents.end();
+		for (auto q = iQueues.load(std::memory_order_acquire); q != nullptr; q = q->next)
+			if (q->thread == aThreadId)
+				return q;
+		return nullptr;
 	}
 
-	void async_event_queue::publish_events()
+	async_event_queue::thread_queue& async_event_queue::queue(std::thread::id aThreadId)
 	{
-		event_list toPublish;
-		toPublish.swap(iEvents);
-		for (auto& e : toPublish)
-			if (!e.second.second)
-				e.second.first();
+		auto existing = find_queue(aThreadId);
+		if (existing != nullptr)
+			return *existing;
+		// Queues are only ever prepended and live as long as the event queue so lookups need no lock.
+		std::unique_ptr<thread_queue> newQueue{ new thread_queue{ aThreadId } };
+		newQueue->next = iQueues.load(std::memory_order_acquire);
+		while (!iQueues.compare_exchange_weak(newQueue->next, newQueue.get(), std::memory_order_acq_rel))
+			for (auto q = newQueue->next; q != nullptr; q = q->next)
+				if (q->thread == aThreadId)
+					return *q;
+		return *newQueue.release();
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,145 @@
+// timer.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <neogfx/neogfx.hpp>
+#include <neogfx/core/timer.hpp>
+
+namespace neogfx
+{
+	timer_service::timer_service() :
+		iThread{ std::this_thread::get_id() }, iNextSequence{ 0u }
+	{
+	}
+
+	timer_service& timer_service::instance()
+	{
+		static timer_service sInstance;
+		return sInstance;
+	}
+
+	boost::optional<timer_service::clock::time_point> timer_service::next_deadline() const
+	{
+		if (iSchedule.empty())
+			return boost::none;
+		return iSchedule.begin()->first.first;
+	}
+
+	bool timer_service::fire_due_timers()
+	{
+		check_thread();
+		auto const now = clock::now();
+		auto const passStart = iNextSequence;
+		bool didSome = false;
+		for (;;)
+		{
+			// a timer (re)started by a callback in this pass waits for the next one even if already due
+			auto next = iSchedule.begin();
+			while (next != iSchedule.end() && next->first.first <= now && next->first.second >= passStart)
+				++next;
+			if (next == iSchedule.end() || next->first.first > now)
+				break;
+			auto& timer = *next->second;
+			remove(next);
+			timer.iScheduled = boost::none;
+			timer.fire(); // may destroy the timer
+			didSome = true;
+		}
+		return didSome;
+	}
+
+	timer_service::schedule::iterator timer_service::add(callback_timer& aTimer, clock::time_point aDeadline)
+	{
+		check_thread();
+		return iSchedule.emplace(schedule_key{ aDeadline, iNextSequence++ }, &aTimer).first;
+	}
+
+	void timer_service::remove(schedule::iterator aEntry)
+	{
+		check_thread();
+		iSchedule.erase(aEntry);
+	}
+
+	void timer_service::check_thread() const
+	{
+		if (std::this_thread::get_id() != iThread)
+			throw wrong_thread();
+	}
+
+	callback_timer::callback_timer(callback aCallback, uint32_t aDuration_ms, bool aInitialWait) :
+		iCallback{ aCallback }, iDuration{ aDuration_ms }
+	{
+		if (aInitialWait)
+			again();
+	}
+
+	callback_timer::~callback_timer()
+	{
+		cancel();
+	}
+
+	uint32_t callback_timer::duration() const
+	{
+		return iDuration;
+	}
+
+	void callback_timer::set_duration(uint32_t aDuration_ms, bool aEffectiveImmediately)
+	{
+		iDuration = aDuration_ms;
+		if (aEffectiveImmediately && waiting())
+			schedule(iStarted);
+	}
+
+	bool callback_timer::waiting() const
+	{
+		return iScheduled != boost::none;
+	}
+
+	void callback_timer::again()
+	{
+		schedule(clock::now());
+	}
+
+	void callback_timer::again_if()
+	{
+		if (!waiting())
+			again();
+	}
+
+	void callback_timer::cancel()
+	{
+		if (waiting())
+		{
+			timer_service::instance().remove(*iScheduled);
+			iScheduled = boost::none;
+		}
+	}
+
+	void callback_timer::schedule(clock::time_point aStarted)
+	{
+		cancel();
+		iStarted = aStarted;
+		iScheduled = timer_service::instance().add(*this, iStarted + std::chrono::milliseconds{ iDuration });
+	}
+
+	void callback_timer::fire()
+	{
+		// the callback may destroy this timer so it is called through a copy
+		auto callback = iCallback;
+		callback(*this);
+	}
+}
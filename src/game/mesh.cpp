@@ -100,4 +100,9 @@ namespace neogfx
 	{
 		iFaces = aFaces;
 	}
+
+	void mesh::set_transformation_matrix(const mat44& aTransformationMatrix)
+	{
+		iTransformationMatrix = aTransformationMatrix;
+	}
 }
\ No newline at end of file
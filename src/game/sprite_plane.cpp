@@ -48,7 +48,7 @@ namespace neogfx
 	};
 
 	sprite_plane::sprite_plane() : 
-		iUpdater{ app::instance(), [this](neolib::callback_timer& aTimer)
+		iUpdater{ [this](callback_timer& aTimer)
 		{
 			aTimer.again();
 			if (snapshot())
@@ -68,7 +68,7 @@ namespace neogfx
 
 	sprite_plane::sprite_plane(i_widget& aParent) :
 		widget{ aParent }, 
-		iUpdater{ app::instance(), [this](neolib::callback_timer& aTimer)
+		iUpdater{ [this](callback_timer& aTimer)
 		{
 			aTimer.again();
 			if (snapshot())
@@ -87,7 +87,7 @@ namespace neogfx
 
 	sprite_plane::sprite_plane(i_layout& aLayout) :
 		widget{ aLayout }, 
-		iUpdater{ app::instance(), [this](neolib::callback_timer& aTimer)
+		iUpdater{ [this](callback_timer& aTimer)
 		{
 			aTimer.again();
 			if (snapshot())
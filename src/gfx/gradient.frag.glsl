@@ -2,6 +2,7 @@
 
 precision mediump float;
 uniform float posViewportTop;
+uniform vec2 posTargetOrigin;
 uniform vec2 posTopLeft;
 uniform vec2 posBottomRight;
 uniform int nGradientDirection;
@@ -182,7 +183,7 @@ int to_1d(int x, int y, int width)
 
 void main()
 {
-	vec2 viewPos = gl_FragCoord.xy;
+	vec2 viewPos = gl_FragCoord.xy + posTargetOrigin;
 	viewPos.y = posViewportTop - viewPos.y;
 	int d = nFilterSize / 2;
 	if (texelFetch(texFilter, ivec2(d, d)).r == 1.0)
@@ -44,6 +44,7 @@
 #include <neogfx/game/mesh.hpp>
 #include <neogfx/game/rectangle.hpp>
 #include "native/i_native_graphics_context.hpp"
+#include "native/graphics_operation_arena.hpp"
 #include "text/native/native_font_face.hpp"
 #include "../hid/native/i_native_surface.hpp"
 
@@ -60,7 +61,7 @@ namespace neogfx
 		mutable cluster_map_t iClusterMap;
 		mutable std::vector<character_type> iTextDirections;
 		mutable std::u32string iCodePointsBuffer;
-		typedef std::tuple<const char32_t*, const char32_t*, text_direction, bool, hb_script_t> glyph_run;
+		typedef std::tuple<const char32_t*, const char32_t*, text_direction, bool, hb_script_t, uint32_t> glyph_run; // last element is the fallback font level of the run
 		typedef std::vector<glyph_run> run_list;
 		mutable run_list iRuns;
 		mutable glyph_text::container iGlyphTextResult;
@@ -175,6 +176,16 @@ namespace neogfx
 		return result;
 	}
 
+	path& graphics_context::to_device_path(const path& aPath) const
+	{
+		auto& result = native_context().operation_arena().allocate(aPath);
+		for (std::size_t i = 0; i < result.paths().size(); ++i)
+			for (std::size_t j = 0; j < result.paths()[i].size(); ++j)
+				result.paths()[i][j] = to_device_units(result.paths()[i][j]);
+		result.set_position(to_device_units(aPath.position()) + iOrigin);
+		return result;
+	}
+
 	delta graphics_context::from_device_units(const delta& aValue) const
 	{
 		return units_converter(*this).from_device_units(aValue);
@@ -300,9 +311,7 @@ namespace neogfx
 	{
 		if (!aFill.empty())
 			fill_path(aPath, aFill);
-		path path = to_device_units(aPath);
-		path.set_position(path.position() + iOrigin);
-		native_context().enqueue(graphics_operation::draw_path{ path, aPen });
+		native_context().enqueue(graphics_operation::draw_path{ &to_device_path(aPath), aPen });
 	}
 
 	void graphics_context::draw_shape(const i_shape& aShape, const pen& aPen, const brush& aFill) const
@@ -312,13 +321,13 @@ namespace neogfx
 		vec2 toDeviceUnits = to_device_units(vec2{ 1.0, 1.0 });
 		native_context().enqueue(
 			graphics_operation::draw_shape{
-				mesh{ 
+				&native_context().operation_arena().allocate(
 					aShape, 
 					mat44{ 
 						{ toDeviceUnits.x, 0.0, 0.0, 0.0 },
 						{ 0.0, toDeviceUnits.y, 0.0, 0.0 },
 						{ 0.0, 0.0, 1.0, 0.0 }, 
-						{ iOrigin.x, iOrigin.y, 0.0, 1.0 } } },
+						{ iOrigin.x, iOrigin.y, 0.0, 1.0 } }),
 				aPen });
 	}
 
@@ -353,9 +362,7 @@ namespace neogfx
 
 	void graphics_context::fill_path(const path& aPath, const brush& aFill) const
 	{
-		path path = to_device_units(aPath);
-		path.set_position(path.position() + iOrigin);
-		native_context().enqueue(graphics_operation::fill_path{ path, aFill });
+		native_context().enqueue(graphics_operation::fill_path{ &to_device_path(aPath), aFill });
 	}
 
 	void graphics_context::fill_shape(const i_shape& aShape, const brush& aFill) const
@@ -363,13 +370,13 @@ namespace neogfx
 		vec2 toDeviceUnits = to_device_units(vec2{ 1.0, 1.0 });
 		native_context().enqueue(
 			graphics_operation::fill_shape{
-				mesh{ 
+				&native_context().operation_arena().allocate(
 					aShape, 
 					mat44{ 
 						{ toDeviceUnits.x, 0.0, 0.0, 0.0 },
 						{ 0.0, toDeviceUnits.y, 0.0, 0.0 },
 						{ 0.0, 0.0, 1.0, 0.0 }, 
-						{ iOrigin.x, iOrigin.y, 0.0, 1.0 } } },
+						{ iOrigin.x, iOrigin.y, 0.0, 1.0 } }),
 				aFill });
 	}
 
@@ -687,6 +694,11 @@ namespace neogfx
 		native_context().flush();
 	}
 
+	uint64_t graphics_context::operation_count() const
+	{
+		return native_context().operation_count();
+	}
+
 	void graphics_context::scissor_on(const rect& aRect) const
 	{
 		native_context().enqueue(graphics_operation::scissor_on{ to_device_units(aRect) + iOrigin });
@@ -704,10 +716,9 @@ namespace neogfx
 
 	void graphics_context::clip_to(const path& aPath, dimension aPathOutline) const
 	{
-		path path = to_device_units(aPath);
+		auto& path = to_device_path(aPath);
 		path.set_shape(path::ConvexPolygon);
-		path.set_position(path.position() + iOrigin);
-		native_context().enqueue(graphics_operation::clip_to_path{ path, aPathOutline });
+		native_context().enqueue(graphics_operation::clip_to_path{ &path, aPathOutline });
 	}
 
 	void graphics_context::reset_clip() const
@@ -960,15 +971,15 @@ namespace neogfx
 	void graphics_context::draw_textures(const i_shape& aShape, texture_list_pointer aTextures, const optional_colour& aColour, shader_effect aShaderEffect) const
 	{
 		vec2 toDeviceUnits = to_device_units(vec2{ 1.0, 1.0 });
-		neogfx::mesh mesh{
+		auto& mesh = native_context().operation_arena().allocate(
 			aShape,
 			mat44{
 				{ toDeviceUnits.x, 0.0, 0.0, 0.0 },
 				{ 0.0, toDeviceUnits.y, 0.0, 0.0 },
 				{ 0.0, 0.0, 1.0, 0.0 },
-				{ iOrigin.x, iOrigin.y, 0.0, 1.0 } } };
+				{ iOrigin.x, iOrigin.y, 0.0, 1.0 } });
 		mesh.set_textures(aTextures);
-		native_context().enqueue(graphics_operation::draw_textures{mesh,	aColour, aShaderEffect});	
+		native_context().enqueue(graphics_operation::draw_textures{ &mesh, aColour, aShaderEffect });
 	}
 
 	class graphics_context::glyph_shapes
@@ -1055,7 +1066,7 @@ namespace neogfx
 			{
 				for (uint32_t i = 0; i < glyph_count(); ++i)
 				{
-					auto tc = get_text_category(iParent.surface().rendering_engine().font_manager().emoji_atlas(), std::get<0>(iGlyphRun), std::get<1>(iGlyphRun));
+					auto tc = get_text_category(iParent.surface().rendering_engine().font_manager().emoji_atlas(), std::get<0>(iGlyphRun) + glyph_info(i).cluster, std::get<1>(iGlyphRun));
 					if (glyph_info(i).codepoint == 0 && tc != text_category::Whitespace && tc != text_category::Emoji)
 						return true;
 				}
@@ -1090,7 +1101,7 @@ namespace neogfx
 					for (uint32_t i = 0; i < iGlyphsList.back().glyph_count(); ++i)
 						if (iGlyphsList.back().glyph_info(i).codepoint == 0)
 							lastResort[iGlyphsList.back().glyph_info(i).cluster] = neolib::INVALID_CHAR32; // replacement character
-					iGlyphsList.emplace_back(glyphs{ aParent, aFont, glyph_text_data::glyph_run{&lastResort[0], &lastResort[0] + lastResort.size(), std::get<2>(aGlyphRun), std::get<3>(aGlyphRun), std::get<4>(aGlyphRun) } });
+					iGlyphsList.emplace_back(glyphs{ aParent, aFont, glyph_text_data::glyph_run{&lastResort[0], &lastResort[0] + lastResort.size(), std::get<2>(aGlyphRun), std::get<3>(aGlyphRun), std::get<4>(aGlyphRun), std::get<5>(aGlyphRun) } });
 					break;
 				}
 			}
@@ -1219,6 +1230,7 @@ namespace neogfx
 		std::u32string::size_type lastCodePointIndex = codePointCount - 1;
 		font previousFont = aFontSelector(0);
 		hb_script_t previousScript = hb_unicode_script(static_cast<native_font_face::hb_handle*>(previousFont.native_font_face().aux_handle())->unicodeFuncs, codePoints[0]);
+		uint32_t previousFallbackLevel = 0u;
 
 		std::deque<std::pair<text_direction, bool>> directionStack;
 		const char32_t LRE = U'\u202A';
@@ -1335,13 +1347,18 @@ namespace neogfx
 			hb_script_t currentScript = hb_unicode_script(unicodeFuncs, codePoints[codePointIndex]);
 			if (currentScript == HB_SCRIPT_COMMON || currentScript == HB_SCRIPT_INHERITED)
 				currentScript = previousScript;
+			uint32_t currentFallbackLevel = previousFallbackLevel;
+			if (previousFont != currentFont || (currentCategory != text_category::Whitespace && currentCategory != text_category::Mark &&
+				currentCategory != text_category::Control && currentCategory != text_category::Emoji && currentCategory != text_category::Mnemonic))
+				currentFallbackLevel = currentFont.native_font_face().fallback_level(codePoints[codePointIndex]);
 			bool newRun =
 				previousFont != currentFont ||
 				(newLine && (previousDirection == text_direction::RTL || previousDirection == text_direction::None_RTL || previousDirection == text_direction::Digit_RTL || previousDirection == text_direction::Emoji_RTL)) ||
 				currentCategory == text_category::Mnemonic ||
 				previousCategory == text_category::Mnemonic ||
 				previousDirection != currentDirection ||
-				previousScript != currentScript;
+				previousScript != currentScript ||
+				previousFallbackLevel != currentFallbackLevel;
 			if (!newRun)
 			{
 				if ((currentCategory == text_category::Whitespace || currentCategory == text_category::None || currentCategory == text_category::Mnemonic) &&
@@ -1366,14 +1383,15 @@ namespace neogfx
 				hasEmojis = true;
 			if (newRun && codePointIndex > 0)
 			{
-				runs.push_back(std::make_tuple(runStart, &codePoints[codePointIndex], previousDirection, previousCategory == text_category::Mnemonic, previousScript));
+				runs.push_back(std::make_tuple(runStart, &codePoints[codePointIndex], previousDirection, previousCategory == text_category::Mnemonic, previousScript, previousFallbackLevel));
 				runStart = &codePoints[codePointIndex];
 			}
 			previousDirection = currentDirection;
 			previousCategory = currentCategory;
 			previousScript = currentScript;
+			previousFallbackLevel = currentFallbackLevel;
 			if (codePointIndex == lastCodePointIndex)
-				runs.push_back(std::make_tuple(runStart, &codePoints[codePointIndex + 1], previousDirection, previousCategory == text_category::Mnemonic, previousScript));
+				runs.push_back(std::make_tuple(runStart, &codePoints[codePointIndex + 1], previousDirection, previousCategory == text_category::Mnemonic, previousScript, previousFallbackLevel));
 			if (newLine && (newRun || codePointIndex == lastCodePointIndex))
 			{
 				for (auto i = runs.rbegin(); i != runs.rend(); ++i)
@@ -1428,7 +1446,10 @@ namespace neogfx
 				continue;
 			bool drawMnemonic = (i > 0 && std::get<3>(runs[i - 1]));
 			std::string::size_type sourceClusterRunStart = std::get<0>(runs[i]) - &codePoints[0];
-			glyph_shapes shapes{ *this, aFontSelector(sourceClusterRunStart), runs[i] };
+			neogfx::font runFont = aFontSelector(sourceClusterRunStart);
+			for (auto level = std::get<5>(runs[i]); level > 0 && runFont.has_fallback(); --level)
+				runFont = runFont.fallback();
+			glyph_shapes shapes{ *this, runFont, runs[i] };
 			for (uint32_t j = 0; j < shapes.glyph_count(); ++j)
 			{
 				std::u32string::size_type startCluster = shapes.glyph_info(j).cluster;
@@ -1449,13 +1470,12 @@ namespace neogfx
 				}
 				startCluster += (std::get<0>(runs[i]) - &codePoints[0]);
 				endCluster += (std::get<0>(runs[i]) - &codePoints[0]);
-				neogfx::font selectedFont = aFontSelector(startCluster);
-				neogfx::font font = selectedFont;
+				neogfx::font font = runFont;
 				if (shapes.using_fallback(j))
 				{
-					font = font.has_fallback() ? font.fallback() : selectedFont;
-					for (auto fi = shapes.fallback_index(j); font != selectedFont && fi > 0; --fi)
-						font = font.has_fallback() ? font.fallback() : selectedFont;
+					font = font.has_fallback() ? font.fallback() : runFont;
+					for (auto fi = shapes.fallback_index(j); font != runFont && fi > 0; --fi)
+						font = font.has_fallback() ? font.fallback() : runFont;
 				}
 				if (j > 0 && !result.empty())
 					result.back().kerning_adjust(static_cast<float>(font.kerning(shapes.glyph_info(j - 1).codepoint, shapes.glyph_info(j).codepoint)));
@@ -1482,7 +1502,7 @@ namespace neogfx
 					auto& glyph = result.back();
 					if (glyph.advance() != advance.ceil())
 					{
-						const i_glyph_texture& glyphTexture = aFontSelector(startCluster).native_font_face().glyph_texture(glyph);
+						const i_glyph_texture& glyphTexture = font.native_font_face().glyph_texture(glyph);
 						auto visibleAdvance = std::ceil(glyph.offset().cx + glyphTexture.placement().x + glyphTexture.texture().extents().cx);
 						if (visibleAdvance > advance.cx)
 						{
@@ -1500,14 +1520,13 @@ namespace neogfx
 			for (auto i = result.begin(); i != result.end(); ++i)
 			{
 				auto cluster = i->source().first;
-				auto chStart = aTextBegin[cluster];
 				if (i->category() == text_category::Emoji)
 				{
 					if (!emojiResult.empty() && emojiResult.back().is_emoji() && emojiResult.back().source() == i->source())
 					{
 						// probable variant selector fubar'd by harfbuzz
 						auto s = emojiResult.back().source();
-						if (s.second < codePointCount && get_text_category(surface().rendering_engine().font_manager().emoji_atlas(), aTextBegin[s.second]) == text_category::Control)
+						if (s.second < codePointCount && get_text_category(emojiAtlas, aTextBegin[s.second]) == text_category::Control)
 						{
 							++s.first;
 							++s.second;
@@ -1516,38 +1535,22 @@ namespace neogfx
 							i->set_advance(size{});
 						}
 					}
-					std::u32string sequence;
-					sequence += chStart;
-					auto j = i + 1;
-					bool absorbNext = false;
-					for (; j != result.end(); ++j)
-					{
-						auto ch = aTextBegin[cluster + (j - i)];
-						if (ch == 0x200D)
-							continue;
-						else if (ch == 0xFE0F)
-						{
-							absorbNext = true;
-							break;
-						}
-						else if (surface().rendering_engine().font_manager().emoji_atlas().is_emoji(sequence + ch))
-							sequence += ch;
-						else
-							break;
-					}
-					if (sequence.size() > 1 && surface().rendering_engine().font_manager().emoji_atlas().is_emoji(sequence))
+					auto const sequenceLength = emojiAtlas.match_emoji_sequence(&*aTextBegin + cluster, &*aTextBegin + codePointCount);
+					if (sequenceLength > 1)
 					{
 						auto g = *i;
-						g.set_value(surface().rendering_engine().font_manager().emoji_atlas().emoji(sequence, aFontSelector(cluster).height()));
-						g.set_source(glyph::source_type{ g.source().first, g.source().first + sequence.size() });
+						g.set_value(emojiAtlas.emoji(std::u32string(aTextBegin + cluster, aTextBegin + cluster + sequenceLength), aFontSelector(cluster).height()));
+						g.set_source(glyph::source_type{ g.source().first, g.source().first + sequenceLength });
 						emojiResult.push_back(g);
-						i = j - 1;
+						while (i + 1 != result.end() && (i + 1)->source().first < cluster + sequenceLength)
+							++i;
 					}
 					else
 						emojiResult.push_back(*i);
-					if (absorbNext)
+					auto const next = emojiResult.back().source().second;
+					if (next < codePointCount && aTextBegin[next] == 0xFE0F && i + 1 != result.end() && (i + 1)->source().first == next)
 					{
-						emojiResult.back().set_source(glyph::source_type{ emojiResult.back().source().first, emojiResult.back().source().first + sequence.size() + 1 });
+						emojiResult.back().set_source(glyph::source_type{ emojiResult.back().source().first, next + 1 });
 						++i;
 					}
 				}
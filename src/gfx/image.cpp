@@ -24,6 +24,7 @@
 #include <neolib/string_utils.hpp>
 #include <neogfx/gfx/image.hpp>
 #include <neogfx/app/resource_manager.hpp>
+#include "image_kernels.hpp"
 
 namespace neogfx
 {
@@ -56,6 +57,26 @@ namespace neogfx
 			load();
 	}
 
+	image::image(const std::string& aUri, const void* aEncodedData, std::size_t aEncodedSize, dimension aDpiScaleFactor, texture_sampling aSampling) :
+		iUri{ aUri },
+		iDpiScaleFactor{ aDpiScaleFactor },
+		iColourFormat{ neogfx::colour_format::RGBA8 },
+		iSampling{ aSampling }
+	{
+		load(aEncodedData, aEncodedSize);
+	}
+
+	image::image(i_resource::pointer aResource, dimension aDpiScaleFactor, texture_sampling aSampling) :
+		iResource{ aResource },
+		iUri{ aResource->uri() },
+		iDpiScaleFactor{ aDpiScaleFactor },
+		iColourFormat{ neogfx::colour_format::RGBA8 },
+		iSampling{ aSampling }
+	{
+		if (available())
+			load();
+	}
+
 	image::image(const std::string& aImagePattern, const std::unordered_map<std::string, colour>& aColourMap, dimension aDpiScaleFactor, texture_sampling aSampling) :
 		image{ std::string{}, aImagePattern, aColourMap, aDpiScaleFactor, aSampling }
 	{
@@ -242,6 +263,38 @@ namespace neogfx
 		}
 	}
 
+	void image::resample(const neogfx::size& aNewSize, resampling_filter aFilter)
+	{
+		if (aNewSize == iSize || iData.empty())
+		{
+			resize(aNewSize);
+			return;
+		}
+		// filter in premultiplied space so transparent pixels don't bleed their colour
+		data_type source;
+		source.swap(iData);
+		auto const sourceSize = iSize;
+		image_kernels::premultiply(&source[0], source.size() / 4u);
+		resize(aNewSize);
+		if (iData.empty())
+			return;
+		image_kernels::resample(&source[0], static_cast<uint32_t>(sourceSize.cx), static_cast<uint32_t>(sourceSize.cy), static_cast<std::size_t>(sourceSize.cx) * 4u,
+			&iData[0], static_cast<uint32_t>(iSize.cx), static_cast<uint32_t>(iSize.cy), static_cast<std::size_t>(iSize.cx) * 4u, aFilter);
+		image_kernels::unpremultiply(&iData[0], iData.size() / 4u);
+	}
+
+	void image::premultiply()
+	{
+		if (!iData.empty())
+			image_kernels::premultiply(&iData[0], iData.size() / 4u);
+	}
+
+	void image::unpremultiply()
+	{
+		if (!iData.empty())
+			image_kernels::unpremultiply(&iData[0], iData.size() / 4u);
+	}
+
 	bool image::has_resource() const
 	{
 		return iResource != nullptr;
@@ -254,19 +307,13 @@ namespace neogfx
 		return *iResource;
 	}
 
-	image::image_type_e image::recognize() const
+	image::image_type_e image::recognize(const void* aData, std::size_t aSize) const
 	{
-		if (has_resource())
+		if (aSize >= 4)
 		{
-			if (resource().size() > 0)
-			{
-				if (resource().size() >= 4)
-				{
-					const uint8_t* magic = static_cast<const uint8_t*>(resource().data());
-					if (magic[0] == 0x89 && magic[1] == 'P' && magic[2] == 'N' && magic[3] == 'G')
-						return PngImage;
-				}
-			}
+			const uint8_t* magic = static_cast<const uint8_t*>(aData);
+			if (magic[0] == 0x89 && magic[1] == 'P' && magic[2] == 'N' && magic[3] == 'G')
+				return PngImage;
 		}
 		return UnknownImage;
 	}
@@ -275,21 +322,28 @@ namespace neogfx
 	{
 		if (!available())
 			throw not_available();
-		switch (recognize())
+		if (!has_resource())
+			throw unknown_image_format();
+		return load(resource().data(), resource().size());
+	}
+
+	bool image::load(const void* aData, std::size_t aSize)
+	{
+		switch (recognize(aData, aSize))
 		{
 		case PngImage:
-			return load_png();
+			return load_png(aData, aSize);
 		default:
 			throw unknown_image_format();
 		}
 	}
 
-	bool image::load_png()
+	bool image::load_png(const void* aData, std::size_t aSize)
 	{
 		png_image image;
 		std::memset(&image, 0, (sizeof image));
 		image.version = PNG_IMAGE_VERSION;
-		if (png_image_begin_read_from_memory(&image, resource().data(), resource().size()) != 0)
+		if (png_image_begin_read_from_memory(&image, aData, aSize) != 0)
 		{
 			image.format = PNG_FORMAT_RGBA;
 			iData.resize(PNG_IMAGE_SIZE(image));
@@ -0,0 +1,385 @@
+// image_kernels.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <cmath>
+#include <cstring>
+#include <array>
+#include <thread>
+#include <algorithm>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NEOGFX_IMAGE_KERNELS_AVX2
+#define NEOGFX_IMAGE_KERNELS_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NEOGFX_IMAGE_KERNELS_SSE2
+#endif
+#include "image_kernels.hpp"
+
+namespace neogfx
+{
+	namespace image_kernels
+	{
+		namespace
+		{
+			const int32_t WeightBits = 14;
+			const int32_t WeightOne = 1 << WeightBits;
+			const std::size_t ParallelThreshold = 1u << 20u; // multiply-adds
+
+			inline uint8_t div255(uint32_t aValue)
+			{
+				aValue += 128u;
+				return static_cast<uint8_t>((aValue + (aValue >> 8u)) >> 8u);
+			}
+
+			inline uint32_t load32(const uint8_t* aData)
+			{
+				uint32_t result;
+				std::memcpy(&result, aData, sizeof(result));
+				return result;
+			}
+
+			// 16.16 reciprocals of alpha scaled by 255
+			struct unpremultiply_table
+			{
+				std::array<uint32_t, 256> reciprocal;
+				unpremultiply_table()
+				{
+					reciprocal[0] = 0u;
+					for (uint32_t a = 1u; a < 256u; ++a)
+						reciprocal[a] = (255u * 65536u + a / 2u) / a;
+				}
+			};
+
+			template <typename Function>
+			void parallel_rows(std::size_t aRows, std::size_t aCost, Function aFunction)
+			{
+				std::size_t threads = std::min<std::size_t>(std::thread::hardware_concurrency(), aRows);
+				if (aCost < ParallelThreshold || threads < 2u)
+				{
+					aFunction(std::size_t{ 0u }, aRows);
+					return;
+				}
+				std::size_t const rowsPerThread = (aRows + threads - 1u) / threads;
+				std::vector<std::thread> workers;
+				for (std::size_t begin = rowsPerThread; begin < aRows; begin += rowsPerThread)
+					workers.emplace_back(aFunction, begin, std::min(begin + rowsPerThread, aRows));
+				aFunction(std::size_t{ 0u }, rowsPerThread);
+				for (auto& worker : workers)
+					worker.join();
+			}
+
+			double filter_support(resampling_filter aFilter)
+			{
+				switch (aFilter)
+				{
+				case resampling_filter::Box:
+					return 0.5;
+				case resampling_filter::Bilinear:
+					return 1.0;
+				case resampling_filter::Lanczos3:
+				default:
+					return 3.0;
+				}
+			}
+
+			double filter_weight(resampling_filter aFilter, double aX)
+			{
+				switch (aFilter)
+				{
+				case resampling_filter::Box:
+					return aX >= -0.5 && aX < 0.5 ? 1.0 : 0.0;
+				case resampling_filter::Bilinear:
+					aX = std::abs(aX);
+					return aX < 1.0 ? 1.0 - aX : 0.0;
+				case resampling_filter::Lanczos3:
+				default:
+					{
+						if (aX == 0.0)
+							return 1.0;
+						if (aX <= -3.0 || aX >= 3.0)
+							return 0.0;
+						double const pi = 3.14159265358979323846;
+						double const x = pi * aX;
+						return 3.0 * std::sin(x) * std::sin(x / 3.0) / (x * x);
+					}
+				}
+			}
+
+			// Source span and fixed point weights (summing to WeightOne) for each destination pixel.
+			struct contributions
+			{
+				std::size_t stride;
+				std::vector<uint32_t> start;
+				std::vector<uint32_t> count;
+				std::vector<int16_t> weights;
+			};
+
+			contributions compute_contributions(uint32_t aSourceSize, uint32_t aDestinationSize, resampling_filter aFilter)
+			{
+				double const scale = static_cast<double>(aSourceSize) / aDestinationSize;
+				double const filterScale = std::max(1.0, scale);
+				double const support = filter_support(aFilter) * filterScale;
+				contributions result;
+				result.stride = static_cast<std::size_t>(std::ceil(support) * 2.0) + 2u;
+				result.start.resize(aDestinationSize);
+				result.count.resize(aDestinationSize);
+				result.weights.resize(result.stride * aDestinationSize);
+				std::vector<double> weights(result.stride);
+				for (uint32_t i = 0; i < aDestinationSize; ++i)
+				{
+					double const centre = (i + 0.5) * scale;
+					auto const first = static_cast<uint32_t>(std::max(0.0, std::floor(centre - support)));
+					auto const last = static_cast<uint32_t>(std::min<double>(aSourceSize, std::ceil(centre + support)));
+					uint32_t count = std::min<uint32_t>(last - first, static_cast<uint32_t>(result.stride));
+					double total = 0.0;
+					for (uint32_t j = 0; j < count; ++j)
+						total += (weights[j] = filter_weight(aFilter, (first + j + 0.5 - centre) / filterScale));
+					auto fixed = &result.weights[i * result.stride];
+					int32_t fixedTotal = 0;
+					uint32_t largest = 0u;
+					for (uint32_t j = 0; j < count; ++j)
+					{
+						fixed[j] = static_cast<int16_t>(std::lround(total != 0.0 ? weights[j] / total * WeightOne : (j == 0u ? WeightOne : 0)));
+						fixedTotal += fixed[j];
+						if (fixed[j] > fixed[largest])
+							largest = j;
+					}
+					fixed[largest] = static_cast<int16_t>(fixed[largest] + WeightOne - fixedTotal);
+					// drop taps that contribute nothing (box filter edges)
+					uint32_t skip = 0u;
+					while (skip + 1u < count && fixed[skip] == 0)
+						++skip;
+					while (count > skip + 1u && fixed[count - 1u] == 0)
+						--count;
+					std::copy(fixed + skip, fixed + count, fixed);
+					result.start[i] = first + skip;
+					result.count[i] = count - skip;
+				}
+				return result;
+			}
+
+			inline uint8_t clamp_weighted(int32_t aSum)
+			{
+				return static_cast<uint8_t>(std::max(0, std::min(255, aSum >> WeightBits)));
+			}
+
+			void horizontal_pass(const uint8_t* aSource, uint8_t* aDestination, uint32_t aWidth, const contributions& aContributions)
+			{
+				for (uint32_t x = 0; x < aWidth; ++x)
+				{
+					auto const weights = &aContributions.weights[x * aContributions.stride];
+					auto const pixels = aSource + aContributions.start[x] * 4u;
+					uint32_t const count = aContributions.count[x];
+#ifdef NEOGFX_IMAGE_KERNELS_SSE2
+					const __m128i zero = _mm_setzero_si128();
+					__m128i sum = _mm_set1_epi32(WeightOne / 2);
+					uint32_t j = 0u;
+					for (; j + 2u <= count; j += 2u)
+					{
+						__m128i a = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(load32(pixels + j * 4u))), zero);
+						__m128i b = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(load32(pixels + j * 4u + 4u))), zero);
+						__m128i w = _mm_set1_epi32(static_cast<int>(static_cast<uint16_t>(weights[j]) | (static_cast<uint32_t>(static_cast<uint16_t>(weights[j + 1u])) << 16u)));
+						sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+					}
+					if (j < count)
+					{
+						__m128i a = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(load32(pixels + j * 4u))), zero);
+						__m128i w = _mm_set1_epi32(static_cast<int>(static_cast<uint16_t>(weights[j])));
+						sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi16(a, zero), w));
+					}
+					sum = _mm_srai_epi32(sum, WeightBits);
+					sum = _mm_packs_epi32(sum, sum);
+					auto const packed = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(sum, sum)));
+					std::memcpy(aDestination + x * 4u, &packed, sizeof(packed));
+#else
+					int32_t sum[4] = { WeightOne / 2, WeightOne / 2, WeightOne / 2, WeightOne / 2 };
+					for (uint32_t j = 0u; j < count; ++j)
+						for (uint32_t c = 0u; c < 4u; ++c)
+							sum[c] += pixels[j * 4u + c] * weights[j];
+					for (uint32_t c = 0u; c < 4u; ++c)
+						aDestination[x * 4u + c] = clamp_weighted(sum[c]);
+#endif
+				}
+			}
+
+			void vertical_pass(const uint8_t* aSource, std::size_t aSourceStride, uint8_t* aDestination, std::size_t aBytes, const contributions& aContributions, uint32_t aRow)
+			{
+				auto const weights = &aContributions.weights[aRow * aContributions.stride];
+				auto const rows = aSource + aContributions.start[aRow] * aSourceStride;
+				uint32_t const count = aContributions.count[aRow];
+				std::size_t x = 0u;
+#ifdef NEOGFX_IMAGE_KERNELS_AVX2
+				for (; x + 16u <= aBytes; x += 16u)
+				{
+					__m256i sum0 = _mm256_set1_epi32(WeightOne / 2);
+					__m256i sum1 = sum0;
+					for (uint32_t j = 0u; j < count; j += 2u)
+					{
+						__m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rows + j * aSourceStride + x)));
+						__m256i b = j + 1u < count ? _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rows + (j + 1u) * aSourceStride + x))) : _mm256_setzero_si256();
+						__m256i w = _mm256_set1_epi32(static_cast<int>(static_cast<uint16_t>(weights[j]) | (j + 1u < count ? static_cast<uint32_t>(static_cast<uint16_t>(weights[j + 1u])) << 16u : 0u)));
+						sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), w));
+						sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), w));
+					}
+					__m256i packed = _mm256_packs_epi32(_mm256_srai_epi32(sum0, WeightBits), _mm256_srai_epi32(sum1, WeightBits));
+					packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(packed, packed), 0xD8);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(aDestination + x), _mm256_castsi256_si128(packed));
+				}
+#endif
+#ifdef NEOGFX_IMAGE_KERNELS_SSE2
+				const __m128i zero = _mm_setzero_si128();
+				for (; x + 8u <= aBytes; x += 8u)
+				{
+					__m128i sum0 = _mm_set1_epi32(WeightOne / 2);
+					__m128i sum1 = sum0;
+					for (uint32_t j = 0u; j < count; j += 2u)
+					{
+						__m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(rows + j * aSourceStride + x)), zero);
+						__m128i b = j + 1u < count ? _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(rows + (j + 1u) * aSourceStride + x)), zero) : zero;
+						__m128i w = _mm_set1_epi32(static_cast<int>(static_cast<uint16_t>(weights[j]) | (j + 1u < count ? static_cast<uint32_t>(static_cast<uint16_t>(weights[j + 1u])) << 16u : 0u)));
+						sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+						sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+					}
+					__m128i packed = _mm_packs_epi32(_mm_srai_epi32(sum0, WeightBits), _mm_srai_epi32(sum1, WeightBits));
+					_mm_storel_epi64(reinterpret_cast<__m128i*>(aDestination + x), _mm_packus_epi16(packed, zero));
+				}
+#endif
+				for (; x < aBytes; ++x)
+				{
+					int32_t sum = WeightOne / 2;
+					for (uint32_t j = 0u; j < count; ++j)
+						sum += rows[j * aSourceStride + x] * weights[j];
+					aDestination[x] = clamp_weighted(sum);
+				}
+			}
+		}
+
+		void premultiply(uint8_t* aPixels, std::size_t aCount)
+		{
+			std::size_t i = 0u;
+#ifdef NEOGFX_IMAGE_KERNELS_AVX2
+			{
+				const __m256i zero = _mm256_setzero_si256();
+				const __m256i colourMask = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1);
+				const __m256i alphaOne = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+				const __m256i half = _mm256_set1_epi16(128);
+				for (; i + 8u <= aCount; i += 8u)
+				{
+					__m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aPixels + i * 4u));
+					__m256i halves[2] = { _mm256_unpacklo_epi8(pixels, zero), _mm256_unpackhi_epi8(pixels, zero) };
+					for (auto& h : halves)
+					{
+						__m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(h, 0xFF), 0xFF);
+						__m256i x = _mm256_add_epi16(_mm256_mullo_epi16(h, _mm256_or_si256(_mm256_and_si256(alpha, colourMask), alphaOne)), half);
+						h = _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+					}
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(aPixels + i * 4u), _mm256_packus_epi16(halves[0], halves[1]));
+				}
+			}
+#endif
+#ifdef NEOGFX_IMAGE_KERNELS_SSE2
+			{
+				const __m128i zero = _mm_setzero_si128();
+				const __m128i colourMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+				const __m128i alphaOne = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+				const __m128i half = _mm_set1_epi16(128);
+				for (; i + 4u <= aCount; i += 4u)
+				{
+					__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aPixels + i * 4u));
+					__m128i halves[2] = { _mm_unpacklo_epi8(pixels, zero), _mm_unpackhi_epi8(pixels, zero) };
+					for (auto& h : halves)
+					{
+						__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(h, 0xFF), 0xFF);
+						__m128i x = _mm_add_epi16(_mm_mullo_epi16(h, _mm_or_si128(_mm_and_si128(alpha, colourMask), alphaOne)), half);
+						h = _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+					}
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(aPixels + i * 4u), _mm_packus_epi16(halves[0], halves[1]));
+				}
+			}
+#endif
+			for (; i < aCount; ++i)
+			{
+				uint8_t* pixel = aPixels + i * 4u;
+				pixel[0] = div255(pixel[0] * pixel[3]);
+				pixel[1] = div255(pixel[1] * pixel[3]);
+				pixel[2] = div255(pixel[2] * pixel[3]);
+			}
+		}
+
+		void unpremultiply(uint8_t* aPixels, std::size_t aCount)
+		{
+			// no vector divide or gather in SSE2/AVX2 worth having here; the reciprocal table keeps this cheap
+			static const unpremultiply_table sTable;
+			for (std::size_t i = 0u; i < aCount; ++i)
+			{
+				uint8_t* pixel = aPixels + i * 4u;
+				uint32_t const reciprocal = sTable.reciprocal[pixel[3]];
+				if (pixel[3] == 255u)
+					continue;
+				for (uint32_t c = 0u; c < 3u; ++c)
+					pixel[c] = static_cast<uint8_t>(std::min<uint32_t>(255u, (pixel[c] * reciprocal + 0x8000u) >> 16u));
+			}
+		}
+
+		void resample(const uint8_t* aSource, uint32_t aSourceWidth, uint32_t aSourceHeight, std::size_t aSourceStride,
+			uint8_t* aDestination, uint32_t aDestinationWidth, uint32_t aDestinationHeight, std::size_t aDestinationStride, resampling_filter aFilter)
+		{
+			if (aSourceWidth == 0u || aSourceHeight == 0u || aDestinationWidth == 0u || aDestinationHeight == 0u)
+				return;
+			auto const horizontal = compute_contributions(aSourceWidth, aDestinationWidth, aFilter);
+			auto const vertical = compute_contributions(aSourceHeight, aDestinationHeight, aFilter);
+			std::size_t const intermediateStride = aDestinationWidth * 4u;
+			std::vector<uint8_t> intermediate(intermediateStride * aSourceHeight);
+			parallel_rows(aSourceHeight, aSourceHeight * aDestinationWidth * horizontal.stride, [&](std::size_t aBegin, std::size_t aEnd)
+			{
+				for (std::size_t y = aBegin; y < aEnd; ++y)
+					horizontal_pass(aSource + y * aSourceStride, &intermediate[y * intermediateStride], aDestinationWidth, horizontal);
+			});
+			parallel_rows(aDestinationHeight, aDestinationHeight * aDestinationWidth * vertical.stride, [&](std::size_t aBegin, std::size_t aEnd)
+			{
+				for (std::size_t y = aBegin; y < aEnd; ++y)
+					vertical_pass(&intermediate[0], intermediateStride, aDestination + y * aDestinationStride, intermediateStride, vertical, static_cast<uint32_t>(y));
+			});
+		}
+
+		std::vector<std::vector<uint8_t>> mipmap_chain(const uint8_t* aPixels, uint32_t aWidth, uint32_t aHeight)
+		{
+			std::vector<std::vector<uint8_t>> levels;
+			if (aWidth == 0u || aHeight == 0u)
+				return levels;
+			std::vector<uint8_t> previous(aPixels, aPixels + aWidth * aHeight * 4u);
+			premultiply(&previous[0], aWidth * aHeight);
+			while (aWidth > 1u || aHeight > 1u)
+			{
+				uint32_t const width = std::max(1u, aWidth / 2u);
+				uint32_t const height = std::max(1u, aHeight / 2u);
+				std::vector<uint8_t> level(width * height * 4u);
+				resample(&previous[0], aWidth, aHeight, aWidth * 4u, &level[0], width, height, width * 4u, resampling_filter::Box);
+				previous = level;
+				unpremultiply(&level[0], width * height);
+				levels.push_back(std::move(level));
+				aWidth = width;
+				aHeight = height;
+			}
+			return levels;
+		}
+	}
+}
@@ -0,0 +1,43 @@
+// image_kernels.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <vector>
+#include <neogfx/gfx/i_image.hpp>
+
+namespace neogfx
+{
+	// Resampling, mipmap generation and alpha premultiplication of RGBA8 pixel data. Inner loops use
+	// SSE2/AVX2 where the compiler targets them (integer arithmetic, so every path gives the same
+	// result) and large images are split by rows across threads.
+	namespace image_kernels
+	{
+		void premultiply(uint8_t* aPixels, std::size_t aCount);
+		void unpremultiply(uint8_t* aPixels, std::size_t aCount);
+		// Separable resampling; when minifying the filter is widened to cover the source footprint.
+		// Resample premultiplied data to avoid dark fringes at transparent edges.
+		void resample(const uint8_t* aSource, uint32_t aSourceWidth, uint32_t aSourceHeight, std::size_t aSourceStride,
+			uint8_t* aDestination, uint32_t aDestinationWidth, uint32_t aDestinationHeight, std::size_t aDestinationStride, resampling_filter aFilter);
+		// Successive half-size box filtered levels (premultiplied internally) down to 1x1; level 0 is
+		// not included.
+		std::vector<std::vector<uint8_t>> mipmap_chain(const uint8_t* aPixels, uint32_t aWidth, uint32_t aHeight);
+	}
+}
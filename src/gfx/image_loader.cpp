@@ -0,0 +1,277 @@
+// image_loader.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <neogfx/gfx/image_loader.hpp>
+#include <neogfx/app/resource_manager.hpp>
+#include <neogfx/app/app.hpp>
+
+namespace neogfx
+{
+	image_loader::image_loader() :
+		iStopping{ false }, iCacheCapacity{ DefaultCacheCapacity }, iCacheSize{ 0u }, iUseCounter{ 0u }
+	{
+	}
+
+	image_loader::~image_loader()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ iMutex };
+			iStopping = true;
+		}
+		iWork.notify_all();
+		for (auto& worker : iWorkers)
+			worker.join();
+	}
+
+	image_loader& image_loader::instance()
+	{
+		static image_loader sInstance;
+		return sInstance;
+	}
+
+	image_loader::image_future image_loader::load(const std::string& aUri, dimension aDpiScaleFactor, texture_sampling aSampling, const optional_size& aTargetSize)
+	{
+		return request(aUri, aDpiScaleFactor, aSampling, aTargetSize, false);
+	}
+
+	void image_loader::load_texture(const std::string& aUri, texture_ready_callback aTextureReady, dimension aDpiScaleFactor, texture_sampling aSampling, const optional_size& aTargetSize)
+	{
+		auto future = request(aUri, aDpiScaleFactor, aSampling, aTargetSize, false);
+		std::lock_guard<std::mutex> lock{ iMutex };
+		iTextureRequests.emplace_back(future, aTextureReady);
+	}
+
+	void image_loader::prefetch(const std::string& aUri, dimension aDpiScaleFactor, texture_sampling aSampling, const optional_size& aTargetSize)
+	{
+		request(aUri, aDpiScaleFactor, aSampling, aTargetSize, true);
+	}
+
+	bool image_loader::textures_ready() const
+	{
+		std::lock_guard<std::mutex> lock{ iMutex };
+		return std::any_of(iTextureRequests.begin(), iTextureRequests.end(),
+			[](const texture_request_list::value_type& aRequest) { return aRequest.first.wait_for(std::chrono::seconds{ 0 }) == std::future_status::ready; });
+	}
+
+	std::size_t image_loader::upload_textures()
+	{
+		texture_request_list ready;
+		{
+			std::lock_guard<std::mutex> lock{ iMutex };
+			trim_cache();
+			for (auto i = iTextureRequests.begin(); i != iTextureRequests.end();)
+			{
+				if (i->first.wait_for(std::chrono::seconds{ 0 }) == std::future_status::ready)
+				{
+					ready.push_back(std::move(*i));
+					i = iTextureRequests.erase(i);
+				}
+				else
+					++i;
+			}
+		}
+		std::size_t uploaded = 0u;
+		for (auto& r : ready)
+		{
+			image_pointer decoded;
+			try
+			{
+				decoded = r.first.get();
+			}
+			catch (...)
+			{
+				continue;
+			}
+			if (decoded->error() || decoded->extents().cx == 0.0 || decoded->extents().cy == 0.0)
+				continue;
+			r.second(texture{ *decoded });
+			++uploaded;
+		}
+		return uploaded;
+	}
+
+	std::size_t image_loader::cache_capacity() const
+	{
+		return iCacheCapacity;
+	}
+
+	void image_loader::set_cache_capacity(std::size_t aCapacity)
+	{
+		std::lock_guard<std::mutex> lock{ iMutex };
+		iCacheCapacity = aCapacity;
+		trim_cache();
+	}
+
+	std::size_t image_loader::cache_size() const
+	{
+		std::lock_guard<std::mutex> lock{ iMutex };
+		return iCacheSize;
+	}
+
+	void image_loader::clear_cache()
+	{
+		std::lock_guard<std::mutex> lock{ iMutex };
+		for (auto i = iCache.begin(); i != iCache.end();)
+		{
+			if (i->second.decoded)
+			{
+				iCacheSize -= i->second.bytes;
+				i = iCache.erase(i);
+			}
+			else
+				++i;
+		}
+	}
+
+	image_loader::image_future image_loader::request(const std::string& aUri, dimension aDpiScaleFactor, texture_sampling aSampling, const optional_size& aTargetSize, bool aPrefetch)
+	{
+		key_type key{ aUri, aDpiScaleFactor, aSampling, aTargetSize != boost::none ? *aTargetSize : size{} };
+		{
+			std::lock_guard<std::mutex> lock{ iMutex };
+			auto existing = iCache.find(key);
+			if (existing != iCache.end())
+			{
+				existing->second.lastUse = ++iUseCounter;
+				if (!aPrefetch && !existing->second.decoded)
+				{
+					// promote an outstanding prefetch
+					auto queued = std::find_if(iPrefetchJobs.begin(), iPrefetchJobs.end(), [&key](const job& aJob) { return aJob.key == key; });
+					if (queued != iPrefetchJobs.end())
+					{
+						iJobs.push_back(std::move(*queued));
+						iPrefetchJobs.erase(queued);
+					}
+				}
+				return existing->second.future;
+			}
+		}
+		// resources are loaded (and any compressed resource inflated) here, on the calling thread, as the
+		// resource manager is not thread-safe; workers are handed a copy of the encoded bytes and the
+		// resource is released before we return
+		job newJob{ key, {}, std::make_shared<std::promise<image_pointer>>() };
+		{
+			auto resource = resource_manager::instance().load_resource(aUri);
+			if (resource->available() && resource->size() != 0u)
+			{
+				auto const bytes = static_cast<const uint8_t*>(resource->cdata());
+				newJob.data.assign(bytes, bytes + resource->size());
+			}
+		}
+		image_future result = newJob.result->get_future().share();
+		{
+			std::lock_guard<std::mutex> lock{ iMutex };
+			trim_cache();
+			iCache.emplace(key, cache_entry{ result, false, 0u, ++iUseCounter });
+			(aPrefetch ? iPrefetchJobs : iJobs).push_back(std::move(newJob));
+			start_workers();
+		}
+		iWork.notify_one();
+		return result;
+	}
+
+	void image_loader::start_workers()
+	{
+		if (!iWorkers.empty())
+			return;
+		auto const workerCount = std::max(1u, std::thread::hardware_concurrency() > 1u ? std::thread::hardware_concurrency() - 1u : 1u);
+		for (unsigned int i = 0; i < workerCount; ++i)
+			iWorkers.emplace_back([this]() { worker(); });
+	}
+
+	void image_loader::worker()
+	{
+		for (;;)
+		{
+			job next;
+			{
+				std::unique_lock<std::mutex> lock{ iMutex };
+				iWork.wait(lock, [this]() { return iStopping || !iJobs.empty() || !iPrefetchJobs.empty(); });
+				if (iStopping)
+					return;
+				auto& queue = !iJobs.empty() ? iJobs : iPrefetchJobs;
+				next = std::move(queue.front());
+				queue.pop_front();
+			}
+			image_pointer decoded;
+			try
+			{
+				decoded = decode(next);
+			}
+			catch (...)
+			{
+				next.result->set_exception(std::current_exception());
+			}
+			{
+				std::lock_guard<std::mutex> lock{ iMutex };
+				auto entry = iCache.find(next.key);
+				// failures aren't cached so the next request for the image tries again
+				if (entry != iCache.end() && (decoded == nullptr || decoded->error()))
+					iCache.erase(entry);
+				else if (entry != iCache.end())
+				{
+					entry->second.decoded = true;
+					entry->second.bytes = decoded->size();
+					iCacheSize += entry->second.bytes;
+				}
+			}
+			if (decoded != nullptr)
+				next.result->set_value(decoded);
+			wake_owner_thread();
+		}
+	}
+
+	image_loader::image_pointer image_loader::decode(const job& aJob)
+	{
+		auto const& targetSize = std::get<3>(aJob.key);
+		if (aJob.data.empty())
+			throw i_resource::not_available();
+		auto decoded = std::make_shared<image>(std::get<0>(aJob.key), &aJob.data[0], aJob.data.size(), std::get<1>(aJob.key), std::get<2>(aJob.key));
+		if (targetSize != size{} && decoded->extents() != size{})
+			decoded->resample(targetSize);
+		return decoded;
+	}
+
+	void image_loader::wake_owner_thread()
+	{
+		// completed decodes are collected by upload_textures; make sure an idle event loop notices them
+		try
+		{
+			app::instance().rendering_engine().wake();
+		}
+		catch (app::no_instance)
+		{
+		}
+	}
+
+	void image_loader::trim_cache()
+	{
+		while (iCacheSize > iCacheCapacity)
+		{
+			auto oldest = iCache.end();
+			for (auto i = iCache.begin(); i != iCache.end(); ++i)
+				if (i->second.decoded && (oldest == iCache.end() || i->second.lastUse < oldest->second.lastUse))
+					oldest = i;
+			if (oldest == iCache.end())
+				break;
+			iCacheSize -= oldest->second.bytes;
+			iCache.erase(oldest);
+		}
+	}
+}
@@ -0,0 +1,308 @@
+// frame_scheduler.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <algorithm>
+#include <neogfx/app/app.hpp>
+#include <neogfx/core/timer.hpp>
+#include <neogfx/gfx/image_loader.hpp>
+#include <neogfx/gui/widget/i_widget.hpp>
+#include "../../hid/native/i_native_surface.hpp"
+#include "opengl_renderer.hpp"
+#include "frame_scheduler.hpp"
+
+namespace neogfx
+{
+	namespace
+	{
+		void record_frame(frame_statistics& aStats, std::chrono::steady_clock::duration aFrameTime, bool aMissedDeadline)
+		{
+			auto const frameTime = std::chrono::duration_cast<std::chrono::microseconds>(aFrameTime);
+			++aStats.frames;
+			if (aMissedDeadline)
+				++aStats.missedDeadlines;
+			aStats.lastFrameTime = frameTime;
+			aStats.worstFrameTime = std::max(aStats.worstFrameTime, frameTime);
+			aStats.totalFrameTime += frameTime;
+		}
+	}
+
+	template <typename Visitor>
+	void frame_scheduler::for_each_renderable_surface(Visitor aVisitor) const
+	{
+		auto& surfaceManager = app::instance().surface_manager();
+		for (std::size_t s = 0; s < surfaceManager.surface_count(); ++s)
+		{
+			auto& surface = surfaceManager.surface(s);
+			if (surface.has_native_surface() && surface.surface_type() == surface_type::Window && surface.native_surface().can_render())
+				aVisitor(surface.native_surface());
+		}
+	}
+
+	frame_counter::frame_counter(uint32_t aDuration) :
+		iDuration{ std::chrono::milliseconds{ aDuration } }, iLastTick{ clock::now() }, iCounter{ 0u }, iStats{}
+	{
+	}
+
+	uint32_t frame_counter::counter() const
+	{
+		return iCounter;
+	}
+
+	const frame_statistics& frame_counter::stats() const
+	{
+		return iStats;
+	}
+
+	bool frame_counter::active() const
+	{
+		return !iWidgets.empty();
+	}
+
+	frame_counter::clock::time_point frame_counter::next_tick(clock::duration aRefreshInterval) const
+	{
+		return iLastTick + iDuration - aRefreshInterval / 2;
+	}
+
+	void frame_counter::add(i_widget& aWidget)
+	{
+		auto iterWidget = std::find(iWidgets.begin(), iWidgets.end(), &aWidget);
+		if (iterWidget == iWidgets.end())
+		{
+			if (iWidgets.empty())
+				iLastTick = clock::now();
+			iWidgets.push_back(&aWidget);
+		}
+	}
+
+	void frame_counter::remove(i_widget& aWidget)
+	{
+		auto iterWidget = std::find(iWidgets.begin(), iWidgets.end(), &aWidget);
+		if (iterWidget != iWidgets.end())
+			iWidgets.erase(iterWidget);
+	}
+
+	void frame_counter::tick(clock::time_point aNow, clock::duration aRefreshInterval)
+	{
+		if (!active() || aNow < next_tick(aRefreshInterval))
+			return;
+		// a tick more than a refresh late means an animation step was visibly dropped
+		record_frame(iStats, aNow - iLastTick, aNow - iLastTick > iDuration + aRefreshInterval);
+		iLastTick = aNow;
+		++iCounter;
+		for (auto w : iWidgets)
+			w->update();
+	}
+
+	const std::chrono::microseconds frame_scheduler::LatchMargin{ 1000 };
+
+	frame_scheduler::frame_scheduler(opengl_renderer& aRenderer) :
+		iRenderer{ aRenderer }, 
+		iRenderTimeEstimate{ clock::duration::zero() }, 
+		iStats{}
+	{
+	}
+
+	const boost::optional<std::chrono::milliseconds>& frame_scheduler::maximum_idle_wait() const
+	{
+		return iMaximumIdleWait;
+	}
+
+	void frame_scheduler::set_maximum_idle_wait(const boost::optional<std::chrono::milliseconds>& aWait)
+	{
+		iMaximumIdleWait = aWait;
+	}
+
+	bool frame_scheduler::idle() const
+	{
+		for (auto const& fc : iFrameCounters)
+			if (fc.second.active())
+				return false;
+		// decoded images waiting for their textures are uploaded by the next frame
+		if (image_loader::instance().textures_ready())
+			return false;
+		bool invalidated = false;
+		for_each_renderable_surface([&invalidated](i_native_surface& aSurface)
+		{
+			if (aSurface.has_invalidated_area())
+				invalidated = true;
+		});
+		return !invalidated;
+	}
+
+	bool frame_scheduler::frame_due() const
+	{
+		if (idle())
+			return false;
+		auto const now = clock::now();
+		auto const next = next_frame(now);
+		return next != boost::none && *next <= now;
+	}
+
+	boost::optional<frame_scheduler::clock::duration> frame_scheduler::time_until_next_frame() const
+	{
+		// with nothing to render and no timer pending the caller may block until woken by an event
+		auto const now = clock::now();
+		auto next = timer_service::instance().next_deadline();
+		if (!idle())
+		{
+			auto const frame = next_frame(now);
+			if (frame != boost::none && (next == boost::none || *frame < *next))
+				next = frame;
+		}
+		if (iMaximumIdleWait != boost::none && (next == boost::none || now + *iMaximumIdleWait < *next))
+			next = now + *iMaximumIdleWait;
+		if (next == boost::none)
+			return boost::none;
+		return std::max<clock::duration>(*next - now, clock::duration::zero());
+	}
+
+	void frame_scheduler::begin_frame()
+	{
+		iFrameStart = clock::now();
+		for_each_renderable_surface([this](i_native_surface& aSurface)
+		{
+			auto const d = iRenderer.display_index(aSurface);
+			display(d).target = next_vsync(d, iFrameStart);
+		});
+		auto const refreshInterval = display(primary_display()).refreshInterval;
+		for (auto& fc : iFrameCounters)
+			fc.second.tick(iFrameStart, refreshInterval);
+	}
+
+	void frame_scheduler::end_frame()
+	{
+		auto const now = clock::now();
+		auto const renderTime = now - iFrameStart;
+		iRenderTimeEstimate = iRenderTimeEstimate == clock::duration::zero() ? renderTime : (iRenderTimeEstimate * 7 + renderTime) / 8;
+		bool missedDeadline = false;
+		for (auto& dc : iDisplays)
+		{
+			auto& display = dc.second;
+			if (display.target == boost::none)
+				continue;
+			// presenting before the target (no blocking swap) or at it both hit the target refresh; anything
+			// later than half a refresh after it landed on a subsequent one
+			auto const target = *display.target;
+			if (now <= target + display.refreshInterval / 2)
+				display.lastVsync = target;
+			else
+			{
+				missedDeadline = true;
+				display.lastVsync = target + ((now - target + display.refreshInterval / 2) / display.refreshInterval) * display.refreshInterval;
+			}
+			display.target = boost::none;
+		}
+		record_frame(iStats, renderTime, missedDeadline);
+	}
+
+	void frame_scheduler::register_frame_counter(i_widget& aWidget, uint32_t aDuration)
+	{
+		auto iterFrameCounter = iFrameCounters.find(aDuration);
+		if (iterFrameCounter == iFrameCounters.end())
+			iterFrameCounter = iFrameCounters.emplace(aDuration, aDuration).first;
+		iterFrameCounter->second.add(aWidget);
+	}
+
+	void frame_scheduler::unregister_frame_counter(i_widget& aWidget, uint32_t aDuration)
+	{
+		auto iterFrameCounter = iFrameCounters.find(aDuration);
+		if (iterFrameCounter != iFrameCounters.end())
+			iterFrameCounter->second.remove(aWidget);
+	}
+
+	uint32_t frame_scheduler::frame_counter(uint32_t aDuration) const
+	{
+		auto iterFrameCounter = iFrameCounters.find(aDuration);
+		if (iterFrameCounter != iFrameCounters.end())
+			return iterFrameCounter->second.counter();
+		return 0;
+	}
+
+	const frame_statistics& frame_scheduler::frame_stats() const
+	{
+		return iStats;
+	}
+
+	const frame_statistics& frame_scheduler::frame_stats(uint32_t aDuration) const
+	{
+		auto iterFrameCounter = iFrameCounters.find(aDuration);
+		if (iterFrameCounter != iFrameCounters.end())
+			return iterFrameCounter->second.stats();
+		throw frame_counter_not_found();
+	}
+
+	boost::optional<frame_scheduler::clock::time_point> frame_scheduler::next_frame(clock::time_point aNow) const
+	{
+		boost::optional<clock::time_point> earliest;
+		for_each_renderable_surface([&](i_native_surface& aSurface)
+		{
+			if (!aSurface.has_invalidated_area())
+				return;
+			auto const d = iRenderer.display_index(aSurface);
+			auto const start = next_vsync(d, aNow) - latch_budget(d);
+			if (earliest == boost::none || start < *earliest)
+				earliest = start;
+		});
+		auto const primary = primary_display();
+		for (auto const& fc : iFrameCounters)
+		{
+			if (!fc.second.active())
+				continue;
+			auto const tick = fc.second.next_tick(display(primary).refreshInterval);
+			auto const start = next_vsync(primary, std::max(aNow, tick)) - latch_budget(primary);
+			if (earliest == boost::none || start < *earliest)
+				earliest = start;
+		}
+		return earliest;
+	}
+
+	frame_scheduler::clock::time_point frame_scheduler::next_vsync(display_index aDisplay, clock::time_point aNow) const
+	{
+		auto const& dc = display(aDisplay);
+		if (dc.lastVsync == boost::none)
+			return aNow; // no phase yet; the first frame establishes it
+		auto const periods = (aNow - *dc.lastVsync) / dc.refreshInterval + 1;
+		return *dc.lastVsync + periods * dc.refreshInterval;
+	}
+
+	frame_scheduler::clock::duration frame_scheduler::latch_budget(display_index aDisplay) const
+	{
+		return std::min<clock::duration>(iRenderTimeEstimate + LatchMargin, display(aDisplay).refreshInterval);
+	}
+
+	frame_scheduler::display_clock& frame_scheduler::display(display_index aDisplay) const
+	{
+		auto& dc = iDisplays[aDisplay];
+		// the refresh rate is re-read each time as the display mode can change under us
+		dc.refreshInterval = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>{ 1.0 / iRenderer.display_refresh_rate(aDisplay) });
+		return dc;
+	}
+
+	frame_scheduler::display_index frame_scheduler::primary_display() const
+	{
+		boost::optional<display_index> primary;
+		for_each_renderable_surface([&](i_native_surface& aSurface)
+		{
+			if (primary == boost::none)
+				primary = iRenderer.display_index(aSurface);
+		});
+		return primary != boost::none ? *primary : 0u;
+	}
+}
@@ -0,0 +1,112 @@
+// frame_scheduler.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <map>
+#include <vector>
+#include <chrono>
+#include <boost/optional.hpp>
+#include <neogfx/gfx/i_rendering_engine.hpp>
+
+namespace neogfx
+{
+	class i_widget;
+	class i_native_surface;
+	class opengl_renderer;
+
+	class frame_counter
+	{
+	public:
+		typedef std::chrono::steady_clock clock;
+	public:
+		frame_counter(uint32_t aDuration);
+	public:
+		uint32_t counter() const;
+		const frame_statistics& stats() const;
+		bool active() const;
+		clock::time_point next_tick(clock::duration aRefreshInterval) const;
+	public:
+		void add(i_widget& aWidget);
+		void remove(i_widget& aWidget);
+		void tick(clock::time_point aNow, clock::duration aRefreshInterval);
+	private:
+		clock::duration iDuration;
+		clock::time_point iLastTick;
+		uint32_t iCounter;
+		std::vector<i_widget*> iWidgets;
+		frame_statistics iStats;
+	};
+
+	// Decides when the renderer draws: frames are only produced while a surface is invalidated or a frame
+	// counter (animation) is active, and are started as late as the measured render time allows before the
+	// next refresh of the display(s) concerned so that input processed just beforehand makes the frame.
+	class frame_scheduler
+	{
+	public:
+		struct frame_counter_not_found : std::logic_error { frame_counter_not_found() : std::logic_error("neogfx::frame_scheduler::frame_counter_not_found") {} };
+	public:
+		typedef std::chrono::steady_clock clock;
+		typedef uint32_t display_index;
+	public:
+		static const std::chrono::microseconds LatchMargin;
+	private:
+		struct display_clock
+		{
+			clock::duration refreshInterval;
+			boost::optional<clock::time_point> lastVsync;
+			boost::optional<clock::time_point> target;
+		};
+		typedef std::map<display_index, display_clock> display_clocks;
+		typedef std::map<uint32_t, neogfx::frame_counter> frame_counters;
+	public:
+		frame_scheduler(opengl_renderer& aRenderer);
+	public:
+		const boost::optional<std::chrono::milliseconds>& maximum_idle_wait() const;
+		void set_maximum_idle_wait(const boost::optional<std::chrono::milliseconds>& aWait);
+		bool idle() const;
+		bool frame_due() const;
+		boost::optional<clock::duration> time_until_next_frame() const;
+		void begin_frame();
+		void end_frame();
+	public:
+		void register_frame_counter(i_widget& aWidget, uint32_t aDuration);
+		void unregister_frame_counter(i_widget& aWidget, uint32_t aDuration);
+		uint32_t frame_counter(uint32_t aDuration) const;
+		const frame_statistics& frame_stats() const;
+		const frame_statistics& frame_stats(uint32_t aDuration) const;
+	private:
+		boost::optional<clock::time_point> next_frame(clock::time_point aNow) const;
+		clock::time_point next_vsync(display_index aDisplay, clock::time_point aNow) const;
+		clock::duration latch_budget(display_index aDisplay) const;
+		display_clock& display(display_index aDisplay) const;
+		display_index primary_display() const;
+		template <typename Visitor>
+		void for_each_renderable_surface(Visitor aVisitor) const;
+	private:
+		opengl_renderer& iRenderer;
+		boost::optional<std::chrono::milliseconds> iMaximumIdleWait;
+		mutable display_clocks iDisplays;
+		frame_counters iFrameCounters;
+		clock::time_point iFrameStart;
+		clock::duration iRenderTimeEstimate;
+		frame_statistics iStats;
+	};
+}
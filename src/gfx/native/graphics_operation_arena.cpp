@@ -0,0 +1,93 @@
+// graphics_operation_arena.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include "graphics_operation_arena.hpp"
+
+namespace neogfx
+{
+	namespace graphics_operation
+	{
+		arena::arena(operation_arena_counters& aCounters) :
+			iCounters{ aCounters }, iPaths{ {}, 0 }, iMeshes{ {}, 0 }
+		{
+		}
+
+		path& arena::allocate(const path& aPath)
+		{
+			++iCounters.payloads;
+			if (iPaths.used == iPaths.slots.size())
+			{
+				++iCounters.growths;
+				iPaths.slots.push_back(aPath);
+				return iPaths.slots[iPaths.used++];
+			}
+			auto& slot = iPaths.slots[iPaths.used++];
+			if (!fits(slot, aPath))
+				++iCounters.growths;
+			slot = aPath;
+			return slot;
+		}
+
+		mesh& arena::allocate(const i_mesh& aMesh, const mat44& aTransformationMatrix)
+		{
+			++iCounters.payloads;
+			if (iMeshes.used == iMeshes.slots.size())
+			{
+				++iCounters.growths;
+				iMeshes.slots.emplace_back();
+				iMeshVertexCapacities.push_back(0);
+			}
+			auto& vertexCapacity = iMeshVertexCapacities[iMeshes.used];
+			auto& slot = iMeshes.slots[iMeshes.used++];
+			// mesh::transformed_vertices() reserves one transformed vertex per vertex and never shrinks
+			auto const vertexCount = aMesh.vertices() != nullptr ? aMesh.vertices()->size() : 0;
+			if (vertexCapacity < vertexCount)
+			{
+				++iCounters.growths;
+				vertexCapacity = vertexCount;
+			}
+			slot.set_vertices(aMesh.vertices());
+			slot.set_textures(aMesh.textures());
+			slot.set_faces(aMesh.faces());
+			slot.activate_faces(face_list{});
+			slot.set_transformation_matrix(aTransformationMatrix * aMesh.transformation_matrix());
+			return slot;
+		}
+
+		void arena::reset()
+		{
+			iPaths.used = 0;
+			iMeshes.used = 0;
+		}
+
+		bool arena::fits(const path& aSlot, const path& aPath)
+		{
+			// mirrors std::vector copy assignment: existing sub-paths are reused, new ones are constructed
+			auto const& slotPaths = aSlot.paths();
+			auto const& paths = aPath.paths();
+			if (slotPaths.capacity() < paths.size())
+				return false;
+			for (std::size_t i = 0; i < paths.size(); ++i)
+				if (i < slotPaths.size() ? slotPaths[i].capacity() < paths[i].size() : !paths[i].empty())
+					return false;
+			return true;
+		}
+	}
+}
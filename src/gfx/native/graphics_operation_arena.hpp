@@ -0,0 +1,59 @@
+// graphics_operation_arena.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <deque>
+#include <neogfx/core/path.hpp>
+#include <neogfx/game/mesh.hpp>
+#include <neogfx/gfx/i_rendering_engine.hpp>
+
+namespace neogfx
+{
+	namespace graphics_operation
+	{
+		// Storage for the heap owning payloads (paths and meshes) of queued operations. Slots are
+		// reused rather than freed when the queue is flushed so that a context rendering the same
+		// kind of frame again does not need to grow the arena.
+		class arena
+		{
+		private:
+			template <typename T>
+			struct pool
+			{
+				std::deque<T> slots; // deque: slot addresses are stable as the pool grows
+				std::size_t used;
+			};
+		public:
+			arena(operation_arena_counters& aCounters);
+		public:
+			path& allocate(const path& aPath);
+			mesh& allocate(const i_mesh& aMesh, const mat44& aTransformationMatrix);
+			void reset();
+		private:
+			static bool fits(const path& aSlot, const path& aPath);
+		private:
+			operation_arena_counters& iCounters;
+			pool<path> iPaths;
+			pool<mesh> iMeshes;
+			std::deque<std::size_t> iMeshVertexCapacities; // transformed vertex capacity each mesh slot has been sized for
+		};
+	}
+}
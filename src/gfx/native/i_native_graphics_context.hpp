@@ -40,7 +40,9 @@ namespace neogfx
 	public:
 		virtual i_rendering_engine& rendering_engine() = 0;
 		virtual const i_native_surface& surface() const = 0;
+		virtual graphics_operation::arena& operation_arena() = 0;
 		virtual void enqueue(const graphics_operation::operation& aOperation) = 0;
+		virtual uint64_t operation_count() const = 0;
 		virtual void flush() = 0;
 	public:
 		virtual const std::pair<vec2, vec2>& logical_coordinates() const = 0;
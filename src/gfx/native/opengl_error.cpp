@@ -20,6 +20,7 @@
 #include <neogfx/neogfx.hpp>
 #include <iostream>
 #include <neolib/string_utils.hpp>
+#include <neogfx/gfx/i_rendering_engine.hpp>
 #include "opengl_error.hpp"
 
 namespace
@@ -56,6 +57,8 @@ std::string glErrorString(GLenum aErrorCode)
 
 GLenum glCheckError(const char* file, unsigned int line)
 {
+	++neogfx::opengl_call_counters().errorChecks;
+
 	// Get the last error
 	GLenum errorCode = glGetError();
 
@@ -72,3 +75,40 @@ GLenum glCheckError(const char* file, unsigned int line)
 
 	return errorCode;
 }
+
+namespace
+{
+	neogfx::render_call_counters sCallCounters;
+	uint32_t sErrorCheckSampling;
+}
+
+void glCheckCall(const char* file, unsigned int line)
+{
+	auto const calls = ++sCallCounters.calls;
+#ifndef NEOGFX_GL_CHECK
+	if (sErrorCheckSampling != 0u && calls % sErrorCheckSampling == 0u)
+		glCheckError(file, line);
+#else
+	(void)calls;
+	(void)file;
+	(void)line;
+#endif
+}
+
+namespace neogfx
+{
+	render_call_counters& opengl_call_counters()
+	{
+		return sCallCounters;
+	}
+
+	uint32_t opengl_error_check_sampling()
+	{
+		return sErrorCheckSampling;
+	}
+
+	void set_opengl_error_check_sampling(uint32_t aInterval)
+	{
+		sErrorCheckSampling = aInterval;
+	}
+}
@@ -25,16 +25,33 @@
 
 std::string glErrorString(GLenum aErrorCode);
 GLenum glCheckError(const char* file, unsigned int line);
+void glCheckCall(const char* file, unsigned int line);
+
+// glGetError stalls threaded drivers so release builds only check every call if NEOGFX_GL_CHECK is defined;
+// otherwise calls are counted and checked at the configured sampling interval (and once per frame).
+#if defined(_DEBUG) && !defined(NEOGFX_GL_CHECK)
+#define NEOGFX_GL_CHECK
+#endif
 
 #ifdef glCheck
 #undef glCheck 
 #endif
-#define glCheck(x) x; glCheckError(__FILE__, __LINE__);
+#ifdef NEOGFX_GL_CHECK
+#define glCheck(x) x; glCheckCall(__FILE__, __LINE__); glCheckError(__FILE__, __LINE__);
+#else
+#define glCheck(x) x; glCheckCall(__FILE__, __LINE__);
+#endif
 
 namespace neogfx
 {
+	struct render_call_counters;
+
 	struct opengl_error : std::runtime_error
 	{
 		opengl_error(const std::string& aMessage) : std::runtime_error("neogfx::opengl_error: " + aMessage) {};
 	};
+
+	render_call_counters& opengl_call_counters();
+	uint32_t opengl_error_check_sampling();
+	void set_opengl_error_check_sampling(uint32_t aInterval);
 }
\ No newline at end of file
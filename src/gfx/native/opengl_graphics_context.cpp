@@ -225,7 +225,9 @@ namespace neogfx
 		iSmoothingMode(neogfx::smoothing_mode::None),
 		iSubpixelRendering(aRenderingEngine.is_subpixel_rendering_on()),
 		iClipCounter(0),
-		iLineStippleActive(false)
+		iLineStippleActive(false),
+		iOperationCount(0),
+		iArena(static_cast<opengl_renderer&>(iRenderingEngine).acquire_operation_arena())
 	{
 		iRenderingEngine.activate_context(iSurface);
 		iRenderingEngine.activate_shader_program(*this, iRenderingEngine.default_shader_program());
@@ -240,7 +242,9 @@ namespace neogfx
 		iSmoothingMode(neogfx::smoothing_mode::None),
 		iSubpixelRendering(aRenderingEngine.is_subpixel_rendering_on()),
 		iClipCounter(0),
-		iLineStippleActive(false)
+		iLineStippleActive(false),
+		iOperationCount(0),
+		iArena(static_cast<opengl_renderer&>(iRenderingEngine).acquire_operation_arena())
 	{
 		iRenderingEngine.activate_context(iSurface);
 		iRenderingEngine.activate_shader_program(*this, iRenderingEngine.default_shader_program());
@@ -255,7 +259,9 @@ namespace neogfx
 		iSmoothingMode(aOther.iSmoothingMode), 
 		iSubpixelRendering(aOther.iSubpixelRendering),
 		iClipCounter(0),
-		iLineStippleActive(false)
+		iLineStippleActive(false),
+		iOperationCount(0),
+		iArena(static_cast<opengl_renderer&>(iRenderingEngine).acquire_operation_arena())
 	{
 		iRenderingEngine.activate_context(iSurface);
 		iRenderingEngine.activate_shader_program(*this, iRenderingEngine.default_shader_program());
@@ -265,6 +271,7 @@ namespace neogfx
 	opengl_graphics_context::~opengl_graphics_context()
 	{
 		flush();
+		static_cast<opengl_renderer&>(iRenderingEngine).release_operation_arena(std::move(iArena));
 	}
 
 	i_rendering_engine& opengl_graphics_context::rendering_engine()
@@ -297,8 +304,14 @@ namespace neogfx
 		iLogicalCoordinates = aCoordinates;
 	}
 
+	graphics_operation::arena& opengl_graphics_context::operation_arena()
+	{
+		return *iArena;
+	}
+
 	void opengl_graphics_context::enqueue(const graphics_operation::operation& aOperation)
 	{
+		++iOperationCount;
 		if (iQueue.second.empty())
 			iQueue.second.push_back(0);
 		bool sameBatch = iQueue.first.empty() || graphics_operation::batchable(iQueue.first.back(), aOperation);
@@ -307,6 +320,11 @@ namespace neogfx
 		iQueue.first.push_back(aOperation);
 	}
 
+	uint64_t opengl_graphics_context::operation_count() const
+	{
+		return iOperationCount;
+	}
+
 	void opengl_graphics_context::flush()
 	{
 		if (iQueue.first.empty())
@@ -343,7 +361,7 @@ namespace neogfx
 				break;
 			case graphics_operation::operation_type::ClipToPath:
 				for (auto op = opBatch.first; op != opBatch.second; ++op)
-					clip_to(static_variant_cast<const graphics_operation::clip_to_path&>(*op).path, static_variant_cast<const graphics_operation::clip_to_path&>(*op).pathOutline);
+					clip_to(*static_variant_cast<const graphics_operation::clip_to_path&>(*op).path, static_variant_cast<const graphics_operation::clip_to_path&>(*op).pathOutline);
 				break;
 			case graphics_operation::operation_type::ResetClip:
 				for (auto op = opBatch.first; op != opBatch.second; ++op)
@@ -438,14 +456,14 @@ namespace neogfx
 				for (auto op = opBatch.first; op != opBatch.second; ++op)
 				{
 					const auto& args = static_cast<const graphics_operation::draw_path&>(*op);
-					draw_path(args.path, args.pen);
+					draw_path(*args.path, args.pen);
 				}
 				break;
 			case graphics_operation::operation_type::DrawShape:
 				for (auto op = opBatch.first; op != opBatch.second; ++op)
 				{
 					const auto& args = static_cast<const graphics_operation::draw_shape&>(*op);
-					draw_shape(args.mesh, args.pen);
+					draw_shape(*args.mesh, args.pen);
 				}
 				break;
 			case graphics_operation::operation_type::FillRect:
@@ -474,7 +492,7 @@ namespace neogfx
 				break;
 			case graphics_operation::operation_type::FillPath:
 				for (auto op = opBatch.first; op != opBatch.second; ++op)
-					fill_path(static_variant_cast<const graphics_operation::fill_path&>(*op).path, static_variant_cast<const graphics_operation::fill_path&>(*op).fill);
+					fill_path(*static_variant_cast<const graphics_operation::fill_path&>(*op).path, static_variant_cast<const graphics_operation::fill_path&>(*op).fill);
 				break;
 			case graphics_operation::operation_type::FillShape:
 				fill_shape(opBatch);
@@ -488,7 +506,7 @@ namespace neogfx
 					for (auto op = opBatch.first; op != opBatch.second; ++op)
 					{
 						const auto& args = static_variant_cast<const graphics_operation::draw_textures&>(*op);
-						draw_textures(args.mesh, args.colour, args.shaderEffect);
+						draw_textures(*args.mesh, args.colour, args.shaderEffect);
 					}
 				}
 				break;
@@ -496,13 +514,14 @@ namespace neogfx
 		}
 		iQueue.first.clear();
 		iQueue.second.clear();
+		iArena->reset();
 	}
 
 	void opengl_graphics_context::scissor_on(const rect& aRect)
 	{
 		if (iScissorRect == boost::none)
 		{
-			glCheck(glEnable(GL_SCISSOR_TEST));
+			state().enable(GL_SCISSOR_TEST);
 			iScissorRect = aRect;
 		}
 		iScissorRects.push_back(*iScissorRect);
@@ -516,7 +535,7 @@ namespace neogfx
 		iScissorRects.pop_back();
 		if (iScissorRects.empty())
 		{
-			glCheck(glDisable(GL_SCISSOR_TEST));
+			state().disable(GL_SCISSOR_TEST);
 			iScissorRect = boost::none;
 		}
 		else
@@ -531,14 +550,20 @@ namespace neogfx
 		return iScissorRect;
 	}
 
+	opengl_state& opengl_graphics_context::state() const
+	{
+		return opengl_state::current();
+	}
+
 	void opengl_graphics_context::apply_scissor()
 	{
 		auto sr = *scissor_rect();
-		GLint x = static_cast<GLint>(std::ceil(sr.x));
-		GLint y = static_cast<GLint>(std::ceil(rendering_area(false).cy - sr.cy - sr.y));
+		auto const target = iSurface.rendering_target_area();
+		GLint x = static_cast<GLint>(std::ceil(sr.x - target.x));
+		GLint y = static_cast<GLint>(std::ceil(target.bottom() - sr.cy - sr.y));
 		GLsizei cx = static_cast<GLsizei>(std::ceil(sr.cx));
 		GLsizei cy = static_cast<GLsizei>(std::ceil(sr.cy));
-		glCheck(glScissor(x, y, cx, cy));
+		state().scissor(x, y, cx, cy);
 	}
 
 	void opengl_graphics_context::clip_to(const rect& aRect)
@@ -546,22 +571,22 @@ namespace neogfx
 		if (iClipCounter++ == 0)
 		{
 			glCheck(glClear(GL_STENCIL_BUFFER_BIT));
-			glCheck(glEnable(GL_STENCIL_TEST));
+			state().enable(GL_STENCIL_TEST);
 		}
-		glCheck(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
-		glCheck(glDepthMask(GL_FALSE));
-		glCheck(glStencilOp(GL_REPLACE, GL_KEEP, GL_KEEP));  // draw 1s on test fail (always)
-		glCheck(glStencilMask(static_cast<GLuint>(-1)));
-		glCheck(glStencilFunc(GL_NEVER, 0, static_cast<GLuint>(-1)));
+		state().colour_mask(false, false, false, false);
+		state().depth_mask(false);
+		state().stencil_op(GL_REPLACE, GL_KEEP, GL_KEEP);  // draw 1s on test fail (always)
+		state().stencil_mask(static_cast<GLuint>(-1));
+		state().stencil_func(GL_NEVER, 0, static_cast<GLuint>(-1));
 		fill_rect(rendering_area(), colour::White);
-		glCheck(glStencilFunc(GL_NEVER, 1, static_cast<GLuint>(-1)));
+		state().stencil_func(GL_NEVER, 1, static_cast<GLuint>(-1));
 		fill_rect(aRect, colour::White);
-		glCheck(glStencilFunc(GL_NEVER, 1, static_cast<GLuint>(-1)));
-		glCheck(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
-		glCheck(glDepthMask(GL_TRUE));
-		glCheck(glStencilMask(0x00));
+		state().stencil_func(GL_NEVER, 1, static_cast<GLuint>(-1));
+		state().colour_mask(true, true, true, true);
+		state().depth_mask(true);
+		state().stencil_mask(0x00);
 		// draw only where stencil's value is 1
-		glCheck(glStencilFunc(GL_EQUAL, 1, static_cast<GLuint>(-1)));
+		state().stencil_func(GL_EQUAL, 1, static_cast<GLuint>(-1));
 	}
 
 	void opengl_graphics_context::clip_to(const path& aPath, dimension aPathOutline)
@@ -569,15 +594,15 @@ namespace neogfx
 		if (iClipCounter++ == 0)
 		{
 			glCheck(glClear(GL_STENCIL_BUFFER_BIT));
-			glCheck(glEnable(GL_STENCIL_TEST));
+			state().enable(GL_STENCIL_TEST);
 		}
-		glCheck(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
-		glCheck(glDepthMask(GL_FALSE));
-		glCheck(glStencilOp(GL_REPLACE, GL_KEEP, GL_KEEP));  // draw 1s on test fail (always)
-		glCheck(glStencilMask(static_cast<GLuint>(-1)));
-		glCheck(glStencilFunc(GL_NEVER, 0, static_cast<GLuint>(-1)));
+		state().colour_mask(false, false, false, false);
+		state().depth_mask(false);
+		state().stencil_op(GL_REPLACE, GL_KEEP, GL_KEEP);  // draw 1s on test fail (always)
+		state().stencil_mask(static_cast<GLuint>(-1));
+		state().stencil_func(GL_NEVER, 0, static_cast<GLuint>(-1));
 		fill_rect(rendering_area(), colour::White);
-		glCheck(glStencilFunc(GL_EQUAL, 1, static_cast<GLuint>(-1)));
+		state().stencil_func(GL_EQUAL, 1, static_cast<GLuint>(-1));
 		for (std::size_t i = 0; i < aPath.paths().size(); ++i)
 		{
 			if (aPath.paths()[i].size() > 2)
@@ -595,7 +620,7 @@ namespace neogfx
 		}
 		if (aPathOutline != 0)
 		{
-			glCheck(glStencilFunc(GL_NEVER, 0, static_cast<GLuint>(-1)));
+			state().stencil_func(GL_NEVER, 0, static_cast<GLuint>(-1));
 			path innerPath = aPath;
 			innerPath.deflate(aPathOutline);
 			for (std::size_t i = 0; i < innerPath.paths().size(); ++i)
@@ -614,18 +639,18 @@ namespace neogfx
 				}
 			}
 		}
-		glCheck(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
-		glCheck(glDepthMask(GL_TRUE));
-		glCheck(glStencilMask(0x00));
+		state().colour_mask(true, true, true, true);
+		state().depth_mask(true);
+		state().stencil_mask(0x00);
 		// draw only where stencil's value is 1
-		glCheck(glStencilFunc(GL_EQUAL, 1, static_cast<GLuint>(-1)));
+		state().stencil_func(GL_EQUAL, 1, static_cast<GLuint>(-1));
 	}
 
 	void opengl_graphics_context::reset_clip()
 	{
 		if (--iClipCounter == 0)
 		{
-			glCheck(glDisable(GL_STENCIL_TEST));
+			state().disable(GL_STENCIL_TEST);
 		}
 	}
 
@@ -639,13 +664,13 @@ namespace neogfx
 		iSmoothingMode = aSmoothingMode;
 		if (iSmoothingMode == neogfx::smoothing_mode::AntiAlias)
 		{
-			glCheck(glEnable(GL_LINE_SMOOTH));
-			glCheck(glEnable(GL_POLYGON_SMOOTH));
+			state().enable(GL_LINE_SMOOTH);
+			state().enable(GL_POLYGON_SMOOTH);
 		}
 		else
 		{
-			glCheck(glDisable(GL_LINE_SMOOTH));
-			glCheck(glDisable(GL_POLYGON_SMOOTH));
+			state().disable(GL_LINE_SMOOTH);
+			state().disable(GL_POLYGON_SMOOTH);
 		}
 	}
 
@@ -666,15 +691,15 @@ namespace neogfx
 	{
 		if (iLogicalOperationStack.empty() || iLogicalOperationStack.back() == logical_operation::None)
 		{
-			glCheck(glDisable(GL_COLOR_LOGIC_OP));
+			state().disable(GL_COLOR_LOGIC_OP);
 		}
 		else
 		{
-			glCheck(glEnable(GL_COLOR_LOGIC_OP));
+			state().enable(GL_COLOR_LOGIC_OP);
 			switch (iLogicalOperationStack.back())
 			{
 			case logical_operation::Xor:
-				glCheck(glLogicOp(GL_XOR));
+				state().logic_op(GL_XOR);
 				break;
 			}
 		}	
@@ -685,6 +710,8 @@ namespace neogfx
 		basic_rect<float> boundingBox{ aBoundingBox };
 		iShaderProgramStack.emplace_back(*this, iRenderingEngine, iRenderingEngine.gradient_shader_program());
 		iRenderingEngine.gradient_shader_program().set_uniform_variable("posViewportTop", static_cast<float>(logical_coordinates().first.y));
+		auto const target = iSurface.rendering_target_area();
+		iRenderingEngine.gradient_shader_program().set_uniform_variable("posTargetOrigin", static_cast<float>(target.x), static_cast<float>(iSurface.surface_size().cy - target.bottom()));
 		iRenderingEngine.gradient_shader_program().set_uniform_variable("posTopLeft", boundingBox.top_left().x, boundingBox.top_left().y);
 		iRenderingEngine.gradient_shader_program().set_uniform_variable("posBottomRight", boundingBox.bottom_right().x, boundingBox.bottom_right().y);
 		iRenderingEngine.gradient_shader_program().set_uniform_variable("nGradientDirection", static_cast<int>(aGradient.direction()));
@@ -709,37 +736,37 @@ namespace neogfx
 		auto filter = static_gaussian_filter<float, opengl_renderer::GRADIENT_FILTER_SIZE>(static_cast<float>(aGradient.smoothness() * 10.0));
 		// todo: remove the following cast when gradient textures abstracted in rendering engine base class interface
 		auto& gradientTextures = static_cast<opengl_renderer&>(iRenderingEngine).gradient_textures(); 
-		glCheck(glActiveTexture(GL_TEXTURE2));
-		glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, gradientTextures[0]));
+		state().active_texture(GL_TEXTURE2);
+		state().bind_texture(GL_TEXTURE_RECTANGLE, gradientTextures[0]);
 		glCheck(glTexSubImage2D(GL_TEXTURE_RECTANGLE, 0, 0, 0, iGradientStopPositions.size(), 1, GL_RED, GL_FLOAT, &iGradientStopPositions[0]));
-		glCheck(glActiveTexture(GL_TEXTURE3));
-		glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, gradientTextures[1]));
+		state().active_texture(GL_TEXTURE3);
+		state().bind_texture(GL_TEXTURE_RECTANGLE, gradientTextures[1]);
 		glCheck(glTexSubImage2D(GL_TEXTURE_RECTANGLE, 0, 0, 0, iGradientStopColours.size(), 1, GL_RGBA, GL_FLOAT, &iGradientStopColours[0]));
-		glCheck(glActiveTexture(GL_TEXTURE4));
-		glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, gradientTextures[2]));
+		state().active_texture(GL_TEXTURE4);
+		state().bind_texture(GL_TEXTURE_RECTANGLE, gradientTextures[2]);
 		glCheck(glTexSubImage2D(GL_TEXTURE_RECTANGLE, 0, 0, 0, opengl_renderer::GRADIENT_FILTER_SIZE, opengl_renderer::GRADIENT_FILTER_SIZE, GL_RED, GL_FLOAT, &filter[0][0]));
 		iRenderingEngine.gradient_shader_program().set_uniform_variable("texStopPositions", 2);
 		iRenderingEngine.gradient_shader_program().set_uniform_variable("texStopColours", 3);
 		iRenderingEngine.gradient_shader_program().set_uniform_variable("texFilter", 4);
-		glCheck(glActiveTexture(GL_TEXTURE1));
+		state().active_texture(GL_TEXTURE1);
 	}
 
 	void opengl_graphics_context::gradient_off()
 	{
 		iShaderProgramStack.pop_back();
-		glCheck(glDisable(GL_TEXTURE_RECTANGLE));
+		state().disable(GL_TEXTURE_RECTANGLE);
 	}
 
 	void opengl_graphics_context::line_stipple_on(uint32_t aFactor, uint16_t aPattern)
 	{
-		glCheck(glEnable(GL_LINE_STIPPLE));
+		state().enable(GL_LINE_STIPPLE);
 		glCheck(glLineStipple(static_cast<GLint>(aFactor), static_cast<GLushort>(aPattern)));
 		iLineStippleActive = true;
 	}
 
 	void opengl_graphics_context::line_stipple_off()
 	{
-		glCheck(glDisable(GL_LINE_STIPPLE));
+		state().disable(GL_LINE_STIPPLE);
 		iLineStippleActive = false;
 	}
 
@@ -799,13 +826,13 @@ namespace neogfx
 				static_cast<colour>(aPen.colour()).alpha()}} :
 			std::array<uint8_t, 4>{};
 
-		glCheck(glLineWidth(static_cast<GLfloat>(aPen.width())));
+		state().line_width(static_cast<GLfloat>(aPen.width()));
 		{
 			use_vertex_arrays vertexArrays{ *this, GL_LINES };
 			vertexArrays.push_back(opengl_standard_vertex_arrays::vertex{ xyz{aFrom.x + pixelAdjust, aFrom.y + pixelAdjust}, penColour });
 			vertexArrays.push_back(opengl_standard_vertex_arrays::vertex{ xyz{aTo.x + pixelAdjust, aTo.y + pixelAdjust}, penColour });
 		}
-		glCheck(glLineWidth(1.0f));
+		state().line_width(1.0f);
 
 		if (aPen.colour().is<gradient>())
 			gradient_off();
@@ -819,7 +846,7 @@ namespace neogfx
 			gradient_on(gradient, gradient.rect() != boost::none ? *gradient.rect() : aRect);
 		}
 
-		glCheck(glLineWidth(static_cast<GLfloat>(aPen.width())));
+		state().line_width(static_cast<GLfloat>(aPen.width()));
 		{
 			use_vertex_arrays vertexArrays{ *this, GL_LINES, 8 };
 			insert_back_rect_vertices(vertexArrays, aRect, pixel_adjust(aPen), rect_type::Outline);
@@ -832,7 +859,7 @@ namespace neogfx
 						static_cast<colour>(aPen.colour()).alpha()}} :
 					std::array <uint8_t, 4>{});
 		}
-		glCheck(glLineWidth(1.0f));
+		state().line_width(1.0f);
 
 		if (aPen.colour().is<gradient>())
 			gradient_off();
@@ -849,7 +876,7 @@ namespace neogfx
 		double pixelAdjust = pixel_adjust(aPen);
 		auto vertices = rounded_rect_vertices(aRect + point{ pixelAdjust, pixelAdjust }, aRadius, false);
 
-		glCheck(glLineWidth(static_cast<GLfloat>(aPen.width())));
+		state().line_width(static_cast<GLfloat>(aPen.width()));
 		{
 			use_vertex_arrays vertexArrays{ *this, GL_LINE_LOOP };
 			for (const auto& v : vertices)
@@ -861,7 +888,7 @@ namespace neogfx
 						static_cast<colour>(aPen.colour()).alpha()}} :
 					std::array <uint8_t, 4>{}});
 		}
-		glCheck(glLineWidth(1.0f));
+		state().line_width(1.0f);
 
 		if (aPen.colour().is<gradient>())
 			gradient_off();
@@ -877,7 +904,7 @@ namespace neogfx
 
 		auto vertices = circle_vertices(aCentre, aRadius, aStartAngle, false);
 
-		glCheck(glLineWidth(static_cast<GLfloat>(aPen.width())));
+		state().line_width(static_cast<GLfloat>(aPen.width()));
 		{
 			use_vertex_arrays vertexArrays{ *this, GL_LINE_LOOP, vertices.size() };
 			for (const auto& v : vertices)
@@ -889,7 +916,7 @@ namespace neogfx
 						static_cast<colour>(aPen.colour()).alpha()}} :
 					std::array <uint8_t, 4>{}});
 		}
-		glCheck(glLineWidth(1.0f));
+		state().line_width(1.0f);
 
 		if (aPen.colour().is<gradient>())
 			gradient_off();
@@ -905,7 +932,7 @@ namespace neogfx
 
 		auto vertices = line_loop_to_lines(arc_vertices(aCentre, aRadius, aStartAngle, aEndAngle, false));;
 
-		glCheck(glLineWidth(static_cast<GLfloat>(aPen.width())));
+		state().line_width(static_cast<GLfloat>(aPen.width()));
 		{
 			use_vertex_arrays vertexArrays{ *this, GL_LINES, vertices.size() };
 			for (const auto& v : vertices)
@@ -917,7 +944,7 @@ namespace neogfx
 								static_cast<colour>(aPen.colour()).alpha()}} :
 					std::array <uint8_t, 4>{} });
 		}
-		glCheck(glLineWidth(1.0f));
+		state().line_width(1.0f);
 
 		if (aPen.colour().is<gradient>())
 			gradient_off();
@@ -962,7 +989,7 @@ namespace neogfx
 
 	void opengl_graphics_context::draw_shape(const i_mesh& aMesh, const pen& aPen)
 	{
-		auto tvs = aMesh.transformed_vertices();
+		auto const& tvs = aMesh.transformed_vertices();
 
 		if (aPen.colour().is<gradient>())
 		{
@@ -1149,7 +1176,7 @@ namespace neogfx
 
 		if (firstOp.fill.is<gradient>())
 		{
-			auto tvs = firstOp.mesh.transformed_vertices();
+			auto const& tvs = firstOp.mesh->transformed_vertices();
 			vec3 min = tvs[0].coordinates.xyz;
 			vec3 max = min;
 			for (auto const& v : tvs)
@@ -1170,8 +1197,8 @@ namespace neogfx
 			for (auto op = aFillShapeOps.first; op != aFillShapeOps.second; ++op)
 			{
 				auto& drawOp = static_variant_cast<const graphics_operation::fill_shape&>(*op);
-				auto tvs = drawOp.mesh.transformed_vertices(); // todo: have vertex shader do this transformation
-				for (auto const& f : drawOp.mesh.faces())
+				auto const& tvs = drawOp.mesh->transformed_vertices(); // todo: have vertex shader do this transformation
+				for (auto const& f : drawOp.mesh->faces())
 				{
 					for (auto vi : f.vertices)
 					{
@@ -1300,16 +1327,16 @@ namespace neogfx
 		if (vertexArrays.empty())
 			return;
 
-		glCheck(glActiveTexture(GL_TEXTURE1));
-		glCheck(glEnable(GL_TEXTURE_2D));
-		glCheck(glGetIntegerv(GL_TEXTURE_BINDING_2D, &iPreviousTexture));
+		state().active_texture(GL_TEXTURE1);
+		state().enable(GL_TEXTURE_2D);
+		iPreviousTexture = state().bound_texture(GL_TEXTURE_2D);
 		glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
 		glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
 		if (firstOp.glyph.subpixel())
 		{
-			glCheck(glActiveTexture(GL_TEXTURE2));
-			glCheck(glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, reinterpret_cast<GLuint>(iSurface.rendering_target_texture_handle())));
-			glCheck(glActiveTexture(GL_TEXTURE1));
+			state().active_texture(GL_TEXTURE2);
+			state().bind_texture(GL_TEXTURE_2D_MULTISAMPLE, reinterpret_cast<GLuint>(iSurface.rendering_target_texture_handle()));
+			state().active_texture(GL_TEXTURE1);
 		}
 
 		if (firstOp.appearance.ink().is<gradient>())
@@ -1324,10 +1351,10 @@ namespace neogfx
 						vertexArrays[2].xyz[1]}});
 
 		const i_glyph_texture& firstGlyphTexture = firstOp.glyph.glyph_texture();
-		glCheck(glBindTexture(GL_TEXTURE_2D, reinterpret_cast<GLuint>(firstGlyphTexture.texture().native_texture()->handle())));
+		state().bind_texture(GL_TEXTURE_2D, reinterpret_cast<GLuint>(firstGlyphTexture.texture().native_texture()->handle()));
 
-		glCheck(glEnable(GL_BLEND));
-		glCheck(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+		state().enable(GL_BLEND);
+		state().blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 		disable_anti_alias daa(*this);
 
@@ -1342,6 +1369,8 @@ namespace neogfx
 			bool guiCoordinates = (logical_coordinates().first.y > logical_coordinates().second.y);
 			shader.set_uniform_variable("guiCoordinates", guiCoordinates);
 			shader.set_uniform_variable("outputExtents", static_cast<float>(iSurface.surface_size().cx), static_cast<float>(iSurface.surface_size().cy));
+			auto const target = iSurface.rendering_target_area();
+			shader.set_uniform_variable("outputOrigin", static_cast<float>(target.x), static_cast<float>(iSurface.surface_size().cy - target.bottom()));
 			
 			shader.set_uniform_variable("glyphTexture", 1);
 
@@ -1426,13 +1455,14 @@ namespace neogfx
 			}
 			else if (pass == 2)
 			{
-				shader.set_uniform_variable("effect", 0);
+				// subpixel glyphs blend with what is beneath them so on a transparent target fall back to their average coverage
+				shader.set_uniform_variable("effect", firstOp.glyph.subpixel() && !iSurface.rendering_target_opaque() ? 1 : 0);
 			}
 		}
 
 		vertexArrays.execute();
 
-		glCheck(glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(iPreviousTexture)));
+		state().bind_texture(GL_TEXTURE_2D, iPreviousTexture);
 
 		if (firstOp.appearance.ink().is<gradient>())
 			gradient_off();
@@ -1448,17 +1478,16 @@ namespace neogfx
 		if (aColour != boost::none)
 			colourizationColour = *aColour;
 
-		auto transformedVertices = aMesh.transformed_vertices(); // todo: have vertex shader do this transformation
+		auto const& transformedVertices = aMesh.transformed_vertices(); // todo: have vertex shader do this transformation
 
 		use_shader_program usp{ *this, iRenderingEngine, iRenderingEngine.texture_shader_program() };
 		iRenderingEngine.active_shader_program().set_uniform_variable("effect", static_cast<int>(aShaderEffect));
 
-		glCheck(glActiveTexture(GL_TEXTURE1));
-		glCheck(glEnable(GL_TEXTURE_2D));
-		glCheck(glEnable(GL_BLEND));
-		glCheck(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
-		GLint previousTexture;
-		glCheck(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
+		state().active_texture(GL_TEXTURE1);
+		state().enable(GL_TEXTURE_2D);
+		state().enable(GL_BLEND);
+		state().blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GLuint const previousTexture = state().bound_texture(GL_TEXTURE_2D);
 		glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
 
 		{
@@ -1476,7 +1505,7 @@ namespace neogfx
 					newTexture = true;
 					textureHandle = reinterpret_cast<GLuint>(texture.native_texture()->handle());
 					glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture.sampling() == texture_sampling::NormalMipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
-					glCheck(glBindTexture(GL_TEXTURE_2D, textureHandle));
+					state().bind_texture(GL_TEXTURE_2D, textureHandle);
 					if (first)
 						iRenderingEngine.active_shader_program().set_uniform_variable("tex", 1);
 				}
@@ -1514,7 +1543,41 @@ namespace neogfx
 			}
 		}
 
-		glCheck(glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previousTexture)));
+		state().bind_texture(GL_TEXTURE_2D, previousTexture);
+	}
+
+	void opengl_graphics_context::composite_layer(GLuint aTexture, const size& aTextureExtents, const rect& aLayerRect, const rect& aArea, bool aBlend)
+	{
+		use_shader_program usp{ *this, iRenderingEngine, iRenderingEngine.texture_shader_program() };
+		iRenderingEngine.active_shader_program().set_uniform_variable("effect", static_cast<int>(shader_effect::None));
+
+		state().active_texture(GL_TEXTURE1);
+		state().enable(GL_TEXTURE_2D);
+		bool const blend = state().is_enabled(GL_BLEND);
+		state().set_enabled(GL_BLEND, aBlend);
+		auto const blendFunc = state().blend_func();
+		// layer contents are premultiplied
+		state().blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		GLuint const previousTexture = state().bound_texture(GL_TEXTURE_2D);
+		state().bind_texture(GL_TEXTURE_2D, aTexture);
+		iRenderingEngine.active_shader_program().set_uniform_variable("tex", 1);
+
+		{
+			use_vertex_arrays vertexArrays{ *this, GL_TRIANGLES, with_textures, 6u };
+			auto newVertices = insert_back_rect_vertices(vertexArrays, aArea, 0.0, rect_type::FilledTriangles);
+			for (auto i = newVertices; i != vertexArrays.end(); ++i)
+			{
+				// the layer's rows run bottom up
+				i->rgba = vec4f{{ 1.0f, 1.0f, 1.0f, 1.0f }};
+				i->st = vec2f{{
+					static_cast<float>((i->xyz[0] - aLayerRect.left()) / aTextureExtents.cx),
+					static_cast<float>((aLayerRect.bottom() - i->xyz[1]) / aTextureExtents.cy) }};
+			}
+		}
+
+		state().bind_texture(GL_TEXTURE_2D, previousTexture);
+		state().blend_func(blendFunc.first, blendFunc.second);
+		state().set_enabled(GL_BLEND, blend);
 	}
 
 	xyz opengl_graphics_context::to_shader_vertex(const point& aPoint, coordinate aZ) const
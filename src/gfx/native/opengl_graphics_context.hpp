@@ -24,6 +24,7 @@
 #include "opengl_error.hpp"
 #include "i_native_graphics_context.hpp"
 #include "opengl_helpers.hpp"
+#include "graphics_operation_arena.hpp"
 
 namespace neogfx
 {
@@ -64,8 +65,12 @@ namespace neogfx
 		const i_native_surface& surface() const override;
 		virtual rect rendering_area(bool aConsiderScissor = true) const = 0;
 	public:
+		graphics_operation::arena& operation_arena() override;
 		void enqueue(const graphics_operation::operation& aOperation) override;
+		uint64_t operation_count() const override;
 		void flush() override;
+	public:
+		void composite_layer(GLuint aTexture, const size& aTextureExtents, const rect& aLayerRect, const rect& aArea, bool aBlend);
 	protected:
 		neogfx::logical_coordinate_system logical_coordinate_system() const;
 		void set_logical_coordinate_system(neogfx::logical_coordinate_system aSystem);
@@ -107,6 +112,7 @@ namespace neogfx
 		void draw_glyph(const graphics_operation::batch& aDrawGlyphOps);
 		void draw_textures(const i_mesh& aMesh, const optional_colour& aColour, shader_effect aShaderEffect);
 	private:
+		opengl_state& state() const;
 		void apply_scissor();
 		void apply_logical_operation();
 		void gradient_on(const gradient& aGradient, const rect& aBoundingBox);
@@ -125,12 +131,14 @@ namespace neogfx
 		uint32_t iClipCounter;
 		std::vector<rect> iScissorRects;
 		mutable optional_rect iScissorRect;
-		GLint iPreviousTexture;
+		GLuint iPreviousTexture;
 		bool iLineStippleActive;
 		std::vector<float> iGradientStopPositions;
 		std::vector<std::array<float, 4>> iGradientStopColours;
 		font iLastDrawGlyphFallbackFont;
 		boost::optional<uint8_t> iLastDrawGlyphFallbackFontIndex;
 		std::vector<vec2> iTempTextureCoords;
+		uint64_t iOperationCount;
+		std::unique_ptr<graphics_operation::arena> iArena;
 	};
 }
\ No newline at end of file
@@ -22,6 +22,7 @@
 #include <neogfx/neogfx.hpp>
 #include <neogfx/gfx/i_rendering_engine.hpp>
 #include "opengl.hpp"
+#include "opengl_state.hpp"
 #include "i_native_graphics_context.hpp"
 
 namespace neogfx
@@ -29,19 +30,20 @@ namespace neogfx
 	class opengl_vertex_array
 	{
 	public:
-		opengl_vertex_array()
+		opengl_vertex_array() :
+			iPreviousVertexArrayBindingHandle{ opengl_state::current().vertex_array() }
 		{
-			glCheck(glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &iPreviousVertexArrayBindingHandle));
 			glCheck(glGenVertexArrays(1, &iHandle));
-			glCheck(glBindVertexArray(iHandle));
+			opengl_state::current().bind_vertex_array(iHandle);
 		}
 		~opengl_vertex_array()
 		{
-			glCheck(glBindVertexArray(iPreviousVertexArrayBindingHandle));
+			opengl_state::current().bind_vertex_array(iPreviousVertexArrayBindingHandle);
 			glCheck(glDeleteVertexArrays(1, &iHandle));
+			opengl_state::current().vertex_array_deleted(iHandle);
 		}
 	private:
-		GLint iPreviousVertexArrayBindingHandle;
+		GLuint iPreviousVertexArrayBindingHandle;
 		GLuint iHandle;
 	};
 
@@ -52,17 +54,17 @@ namespace neogfx
 		typedef T value_type;
 	public:
 		opengl_buffer(std::size_t aSize) :
-			iSize{ aSize }, iMemory{ nullptr }
+			iSize{ aSize }, iPreviousBindingHandle{ opengl_state::current().bound_buffer(GL_ARRAY_BUFFER) }, iMemory{ nullptr }
 		{
-			glCheck(glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &iPreviousBindingHandle));
 			glCheck(glGenBuffers(1, &iHandle));
-			glCheck(glBindBuffer(GL_ARRAY_BUFFER, iHandle));
+			opengl_state::current().bind_buffer(GL_ARRAY_BUFFER, iHandle);
 			glCheck(glBufferStorage(GL_ARRAY_BUFFER, size() * sizeof(value_type), nullptr, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT));
 		}
 		~opengl_buffer()
 		{
-			glCheck(glBindBuffer(GL_ARRAY_BUFFER, iPreviousBindingHandle));
+			opengl_state::current().bind_buffer(GL_ARRAY_BUFFER, iPreviousBindingHandle);
 			glCheck(glDeleteBuffers(1, &iHandle));
+			opengl_state::current().buffer_deleted(iHandle);
 		}
 	public:
 		std::size_t size() const
@@ -99,7 +101,7 @@ namespace neogfx
 		}
 	private:
 		const std::size_t iSize;
-		GLint iPreviousBindingHandle;
+		GLuint iPreviousBindingHandle;
 		GLuint iHandle;
 		value_type* iMemory;
 	};
@@ -195,12 +197,11 @@ namespace neogfx
 		static constexpr std::size_t arity = sizeof(attribute_type) / sizeof(value_type);
 	public:
 		template <typename Buffer>
-		opengl_vertex_attrib_array(Buffer& aBuffer, bool aNormalized, std::size_t aStride, std::size_t aOffset, const i_rendering_engine::i_shader_program& aShaderProgram, const std::string& aVariableName)
+		opengl_vertex_attrib_array(Buffer& aBuffer, bool aNormalized, std::size_t aStride, std::size_t aOffset, const i_rendering_engine::i_shader_program& aShaderProgram, const std::string& aVariableName) :
+			iPreviousBindingHandle{ opengl_state::current().bound_buffer(GL_ARRAY_BUFFER) }
 		{
-			glCheck(glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &iPreviousBindingHandle));
-			glCheck(glBindBuffer(GL_ARRAY_BUFFER, aBuffer.handle()));
-			GLuint index;
-			glCheck(index = glGetAttribLocation(reinterpret_cast<GLuint>(aShaderProgram.handle()), aVariableName.c_str()));
+			opengl_state::current().bind_buffer(GL_ARRAY_BUFFER, aBuffer.handle());
+			GLint index = aShaderProgram.attribute_location(aVariableName);
 			if (index != -1)
 			{
 				glCheck(glVertexAttribPointer(
@@ -215,10 +216,10 @@ namespace neogfx
 		}
 		~opengl_vertex_attrib_array()
 		{
-			glCheck(glBindBuffer(GL_ARRAY_BUFFER, iPreviousBindingHandle));
+			opengl_state::current().bind_buffer(GL_ARRAY_BUFFER, iPreviousBindingHandle);
 		}
 	private:
-		GLint iPreviousBindingHandle;
+		GLuint iPreviousBindingHandle;
 	};
 
 	inline vec4f colour_to_vec4f(const std::array<uint8_t, 4>& aSource)
@@ -18,6 +18,7 @@
 */
 
 #include <neogfx/neogfx.hpp>
+#include <cstring>
 #include <boost/filesystem.hpp>
 
 #ifdef _WIN32
@@ -36,35 +37,6 @@
 
 namespace neogfx
 {
-	frame_counter::frame_counter(uint32_t aDuration) : iTimer{ app::instance(), [this](neolib::callback_timer& aTimer)
-		{
-			aTimer.again();
-			++iCounter;
-			for (auto w : iWidgets)
-				w->update();
-		}, aDuration }, iCounter{ 0 }
-	{
-	}
-
-	uint32_t frame_counter::counter() const
-	{
-		return iCounter;
-	}
-
-	void frame_counter::add(i_widget& aWidget)
-	{
-		auto iterWidget = std::find(iWidgets.begin(), iWidgets.end(), &aWidget);
-		if (iterWidget == iWidgets.end())
-			iWidgets.push_back(&aWidget);
-	}
-
-	void frame_counter::remove(i_widget& aWidget)
-	{
-		auto iterWidget = std::find(iWidgets.begin(), iWidgets.end(), &aWidget);
-		if (iterWidget != iWidgets.end())
-			iWidgets.erase(iterWidget);
-	}
-
 	opengl_renderer::shader_program::shader_program(GLuint aHandle, bool aHasProjectionMatrix) :
 		iHandle(aHandle), iHasProjectionMatrix(aHasProjectionMatrix)
 	{
@@ -110,92 +82,130 @@ namespace neogfx
 		return reinterpret_cast<void*>(v->second);
 	}
 
+	int32_t opengl_renderer::shader_program::attribute_location(const std::string& aVariableName) const
+	{
+		auto a = iAttributes.find(aVariableName);
+		if (a == iAttributes.end())
+		{
+			GLint location;
+			glCheck(location = glGetAttribLocation(iHandle, aVariableName.c_str()));
+			a = iAttributes.emplace(aVariableName, location).first;
+		}
+		return a->second;
+	}
+
 	void opengl_renderer::shader_program::set_uniform_variable(const std::string& aName, float aValue)
 	{
-		glUniform1f(uniform_location(aName), aValue);
-		GLenum errorCode = glGetError();
-		if (errorCode != GL_NO_ERROR)
-			throw shader_program_error(errorCode);
+		auto& u = find_uniform(aName);
+		if (update_shadow(u, &aValue, 1))
+		{
+			glUniform1f(u.location, aValue);
+			check_upload();
+		}
 	}
 
 	void opengl_renderer::shader_program::set_uniform_variable(const std::string& aName, double aValue)
 	{
-		glUniform1d(uniform_location(aName), aValue);
-		GLenum errorCode = glGetError();
-		if (errorCode != GL_NO_ERROR)
-			throw shader_program_error(errorCode);
+		auto& u = find_uniform(aName);
+		if (update_shadow(u, &aValue, 1))
+		{
+			glUniform1d(u.location, aValue);
+			check_upload();
+		}
 	}
 
 	void opengl_renderer::shader_program::set_uniform_variable(const std::string& aName, int aValue)
 	{
-		glUniform1i(uniform_location(aName), aValue);
-		GLenum errorCode = glGetError();
-		if (errorCode != GL_NO_ERROR)
-			throw shader_program_error(errorCode);
+		auto& u = find_uniform(aName);
+		if (update_shadow(u, &aValue, 1))
+		{
+			glUniform1i(u.location, aValue);
+			check_upload();
+		}
 	}
 
 	void opengl_renderer::shader_program::set_uniform_variable(const std::string& aName, double aValue1, double aValue2)
 	{
-		glUniform2d(uniform_location(aName), aValue1, aValue2);
-		GLenum errorCode = glGetError();
-		if (errorCode != GL_NO_ERROR)
-			throw shader_program_error(errorCode);
+		auto& u = find_uniform(aName);
+		const double values[] = { aValue1, aValue2 };
+		if (update_shadow(u, values, 2))
+		{
+			glUniform2d(u.location, aValue1, aValue2);
+			check_upload();
+		}
 	}
 
 	void opengl_renderer::shader_program::set_uniform_variable(const std::string& aName, float aValue1, float aValue2)
 	{
-		glUniform2f(uniform_location(aName), aValue1, aValue2);
-		GLenum errorCode = glGetError();
-		if (errorCode != GL_NO_ERROR)
-			throw shader_program_error(errorCode);
+		auto& u = find_uniform(aName);
+		const float values[] = { aValue1, aValue2 };
+		if (update_shadow(u, values, 2))
+		{
+			glUniform2f(u.location, aValue1, aValue2);
+			check_upload();
+		}
 	}
 
 	void opengl_renderer::shader_program::set_uniform_variable(const std::string& aName, const vec4f& aVector)
 	{
-		glUniform4f(uniform_location(aName), aVector[0], aVector[1], aVector[2], aVector[3]);
-		GLenum errorCode = glGetError();
-		if (errorCode != GL_NO_ERROR)
-			throw shader_program_error(errorCode);
+		auto& u = find_uniform(aName);
+		const float values[] = { aVector[0], aVector[1], aVector[2], aVector[3] };
+		if (update_shadow(u, values, 4))
+		{
+			glUniform4f(u.location, aVector[0], aVector[1], aVector[2], aVector[3]);
+			check_upload();
+		}
 	}
 
 	void opengl_renderer::shader_program::set_uniform_variable(const std::string& aName, const vec4& aVector)
 	{
-		glUniform4d(uniform_location(aName), aVector[0], aVector[1], aVector[2], aVector[3]);
-		GLenum errorCode = glGetError();
-		if (errorCode != GL_NO_ERROR)
-			throw shader_program_error(errorCode);
+		auto& u = find_uniform(aName);
+		const double values[] = { aVector[0], aVector[1], aVector[2], aVector[3] };
+		if (update_shadow(u, values, 4))
+		{
+			glUniform4d(u.location, aVector[0], aVector[1], aVector[2], aVector[3]);
+			check_upload();
+		}
 	}
 
 	void opengl_renderer::shader_program::set_uniform_array(const std::string& aName, uint32_t aSize, const float* aArray)
 	{
-		glUniform1fv(uniform_location(aName), aSize, aArray);
-		GLenum errorCode = glGetError();
-		if (errorCode != GL_NO_ERROR)
-			throw shader_program_error(errorCode);
+		auto& u = find_uniform(aName);
+		if (update_shadow(u, aArray, aSize))
+		{
+			glUniform1fv(u.location, aSize, aArray);
+			check_upload();
+		}
 	}
 
 	void opengl_renderer::shader_program::set_uniform_array(const std::string& aName, uint32_t aSize, const double* aArray)
 	{
-		glUniform1dv(uniform_location(aName), aSize, aArray);
-		GLenum errorCode = glGetError();
-		if (errorCode != GL_NO_ERROR)
-			throw shader_program_error(errorCode);
+		auto& u = find_uniform(aName);
+		if (update_shadow(u, aArray, aSize))
+		{
+			glUniform1dv(u.location, aSize, aArray);
+			check_upload();
+		}
 	}
 
 	void opengl_renderer::shader_program::set_uniform_matrix(const std::string& aName, const mat44::template rebind<float>::type& aMatrix)
 	{
-		glUniformMatrix4fv(uniform_location(aName), 1, false, aMatrix.data());
-		GLenum errorCode = glGetError();
-		if (errorCode != GL_NO_ERROR)
-			throw shader_program_error(errorCode);
+		auto& u = find_uniform(aName);
+		if (update_shadow(u, aMatrix.data(), 16))
+		{
+			glUniformMatrix4fv(u.location, 1, false, aMatrix.data());
+			check_upload();
+		}
 	}
 
 	void opengl_renderer::shader_program::set_uniform_matrix(const std::string& aName, const mat44::template rebind<double>::type& aMatrix)
 	{
-		glUniformMatrix4dv(uniform_location(aName), 1, false, aMatrix.data());
-		GLenum errorCode = glGetError();
-		if (errorCode != GL_NO_ERROR)
-			throw shader_program_error(errorCode);
+		auto& u = find_uniform(aName);
+		if (update_shadow(u, aMatrix.data(), 16))
+		{
+			glUniformMatrix4dv(u.location, 1, false, aMatrix.data());
+			check_upload();
+		}
 	}
 
 	GLuint opengl_renderer::shader_program::register_variable(const std::string& aVariableName)
@@ -205,25 +215,100 @@ namespace neogfx
 		return index;
 	}
 
+	void opengl_renderer::shader_program::cache_locations()
+	{
+		iUniforms.clear();
+		iAttributes.clear();
+		GLint count = 0;
+		GLint maxLength = 0;
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glCheck(glGetProgramiv(iHandle, GL_ACTIVE_UNIFORMS, &count));
+		glCheck(glGetProgramiv(iHandle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+		std::vector<GLchar> name(std::max<GLint>(maxLength, 1));
+		for (GLint i = 0; i < count; ++i)
+		{
+			glCheck(glGetActiveUniform(iHandle, static_cast<GLuint>(i), static_cast<GLsizei>(name.size()), &length, &size, &type, &name[0]));
+			std::string uniformName{ &name[0], static_cast<std::size_t>(length) };
+			GLint location;
+			glCheck(location = glGetUniformLocation(iHandle, uniformName.c_str()));
+			// arrays are reported as "name[0]" but are set by name
+			if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+				uniformName.erase(uniformName.size() - 3);
+			iUniforms[uniformName].location = location;
+		}
+		glCheck(glGetProgramiv(iHandle, GL_ACTIVE_ATTRIBUTES, &count));
+		glCheck(glGetProgramiv(iHandle, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength));
+		name.resize(std::max<GLint>(maxLength, 1));
+		for (GLint i = 0; i < count; ++i)
+		{
+			glCheck(glGetActiveAttrib(iHandle, static_cast<GLuint>(i), static_cast<GLsizei>(name.size()), &length, &size, &type, &name[0]));
+			std::string attributeName{ &name[0], static_cast<std::size_t>(length) };
+			GLint location;
+			glCheck(location = glGetAttribLocation(iHandle, attributeName.c_str()));
+			iAttributes[attributeName] = location;
+		}
+	}
+
 	bool opengl_renderer::shader_program::operator<(const shader_program& aRhs) const
 	{
 		return iHandle < aRhs.iHandle;
 	}
 
-	GLint opengl_renderer::shader_program::uniform_location(const std::string& aName)
+	opengl_renderer::shader_program::uniform& opengl_renderer::shader_program::find_uniform(const std::string& aName)
 	{
-		GLint var = glGetUniformLocation(iHandle, aName.c_str());
+		auto u = iUniforms.find(aName);
+		if (u == iUniforms.end())
+		{
+			// not active in the linked program (or not cached yet); remember the answer either way
+			GLint location;
+			glCheck(location = glGetUniformLocation(iHandle, aName.c_str()));
+			u = iUniforms.emplace(aName, uniform{ location }).first;
+		}
+		return u->second;
+	}
+
+	template <typename T>
+	bool opengl_renderer::shader_program::update_shadow(uniform& aUniform, const T* aData, std::size_t aCount)
+	{
+		if (aUniform.location == -1)
+			return false;
+		auto& counters = opengl_call_counters();
+		auto const bytes = reinterpret_cast<const uint8_t*>(aData);
+		auto const byteCount = sizeof(T) * aCount;
+		if (aUniform.shadow.size() == byteCount && std::memcmp(&aUniform.shadow[0], bytes, byteCount) == 0)
+		{
+			++counters.redundantUniformUploads;
+			return false;
+		}
+		aUniform.shadow.assign(bytes, bytes + byteCount);
+		++counters.uniformUploads;
+		++counters.calls;
+		return true;
+	}
+
+	void opengl_renderer::shader_program::check_upload() const
+	{
+#ifdef NEOGFX_GL_CHECK
+		++opengl_call_counters().errorChecks;
 		GLenum errorCode = glGetError();
 		if (errorCode != GL_NO_ERROR)
 			throw shader_program_error(errorCode);
-		return var;
+#endif
 	}
 
 	opengl_renderer::opengl_renderer(neogfx::renderer aRenderer) :
 		iRenderer{aRenderer},
 		iFontManager{*this},
 		iActiveProgram{iShaderPrograms.end()},
-		iSubpixelRendering{true}
+		iSubpixelRendering{true},
+		iFrameScheduler{*this},
+		iFrameCallCounters{},
+		iArenaCounters{},
+		iFrameArenaCounters{},
+		iRenderLayerBudget{DEFAULT_RENDER_LAYER_BUDGET},
+		iRenderLayerStats{}
 	{
 #ifdef _WIN32
 		SetProcessDpiAwareness(PROCESS_PER_MONITOR_DPI_AWARE);
@@ -237,6 +322,8 @@ namespace neogfx
 			glCheck(glDeleteTextures(1, &(*iGradientTextures)[0]));
 			glCheck(glDeleteTextures(1, &(*iGradientTextures)[1]));
 			glCheck(glDeleteTextures(1, &(*iGradientTextures)[2]));
+			for (auto texture : *iGradientTextures)
+				iState.texture_deleted(texture);
 		}
 	}
 
@@ -256,6 +343,8 @@ namespace neogfx
 		std::cout << "OpenGL renderer: " << reinterpret_cast<const char*>(glGetString(GL_RENDERER)) << std::endl;
 		std::cout << "OpenGL version: " << reinterpret_cast<const char*>(glGetString(GL_VERSION)) << std::endl;
 		std::cout << "OpenGL shading language version: " << reinterpret_cast<const char*>(glGetString(GL_SHADING_LANGUAGE_VERSION)) << std::endl;
+
+		iShaderProgramCache.emplace();
 			
 		iDefaultProgram = create_shader_program(
 			shaders
@@ -494,6 +583,7 @@ namespace neogfx
 							"uniform vec2 glyphOrigin;\n"
 							"uniform sampler2DMS outputTexture;\n"
 							"uniform vec2 outputExtents;\n"
+							"uniform vec2 outputOrigin;\n"
 							"uniform bool guiCoordinates;\n"
 							"uniform int effect;\n"
 							"uniform int effectWidth;\n"
@@ -527,7 +617,7 @@ namespace neogfx
 							"				discard;\n"
 							"			else\n"
 							"			{\n"
-							"				vec4 rgbDestination = texelFetch(outputTexture, dtpos, 0);\n"
+							"				vec4 rgbDestination = texelFetch(outputTexture, dtpos - ivec2(outputOrigin), 0);\n"
 							"				FragColor = vec4(Color.rgb * rgbAlpha.rgb * Color.a + rgbDestination.rgb * (vec3(1.0, 1.0, 1.0) - rgbAlpha.rgb * Color.a), 1.0);\n"
 							"			}\n"
 							"		}\n"
@@ -594,6 +684,7 @@ namespace neogfx
 							"uniform vec2 glyphOrigin;\n"
 							"uniform sampler2DMS outputTexture;\n"
 							"uniform vec2 outputExtents;\n"
+							"uniform vec2 outputOrigin;\n"
 							"uniform bool guiCoordinates;\n"
 							"uniform int effect;\n"
 							"uniform int effectWidth;\n"
@@ -627,7 +718,7 @@ namespace neogfx
 							"				discard;\n"
 							"			else\n"
 							"			{\n"
-							"				vec4 rgbDestination = texelFetch(outputTexture, dtpos, 0);\n"
+							"				vec4 rgbDestination = texelFetch(outputTexture, dtpos - ivec2(outputOrigin), 0);\n"
 							"				FragColor = vec4(Color.rgb * rgbAlpha.bgr * Color.a + rgbDestination.rgb * (vec3(1.0, 1.0, 1.0) - rgbAlpha.bgr * Color.a), 1.0);\n"
 							"			}\n"
 							"		}\n"
@@ -734,7 +825,7 @@ namespace neogfx
 				if (iActiveProgram != i)
 				{
 					iActiveProgram = i;
-					glCheck(glUseProgram(reinterpret_cast<GLuint>(iActiveProgram->handle())));
+					iState.use_program(reinterpret_cast<GLuint>(iActiveProgram->handle()));
 				}
 				if (iActiveProgram->has_projection_matrix())
 					iActiveProgram->set_projection_matrix(aGraphicsContext);
@@ -748,7 +839,7 @@ namespace neogfx
 		if (iActiveProgram == iShaderPrograms.end())
 			throw no_shader_program_active();
 		iActiveProgram = iShaderPrograms.end();
-		glCheck(glUseProgram(0));
+		iState.use_program(0);
 	}
 
 	const opengl_renderer::i_shader_program& opengl_renderer::active_shader_program() const
@@ -843,39 +934,86 @@ namespace neogfx
 	const std::array<GLuint, 3>& opengl_renderer::gradient_textures() const
 	{
 		// todo: use texture class
-		glCheck(glEnable(GL_TEXTURE_RECTANGLE));
+		iState.enable(GL_TEXTURE_RECTANGLE);
 		if (iGradientTextures == boost::none)
 		{
 			iGradientTextures.emplace(std::array<GLuint, 3>{});
 			glCheck(glGenTextures(1, &(*iGradientTextures)[0]));
 			glCheck(glGenTextures(1, &(*iGradientTextures)[1]));
 			glCheck(glGenTextures(1, &(*iGradientTextures)[2]));
-			GLint previousTexture;
-			glCheck(glGetIntegerv(GL_TEXTURE_BINDING_RECTANGLE, &previousTexture));
-			glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, (*iGradientTextures)[0]));
+			auto const previousTexture = iState.bound_texture(GL_TEXTURE_RECTANGLE);
+			iState.bind_texture(GL_TEXTURE_RECTANGLE, (*iGradientTextures)[0]);
 			glCheck(glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
 			glCheck(glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
 			static const std::array<float, gradient::MaxStops> sZeroStopPositions = {};
 			glCheck(glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_R32F, static_cast<GLsizei>(gradient::MaxStops), 1, 0, GL_RED, GL_FLOAT, &sZeroStopPositions[0]));
-			glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, (*iGradientTextures)[1]));
+			iState.bind_texture(GL_TEXTURE_RECTANGLE, (*iGradientTextures)[1]);
 			glCheck(glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
 			glCheck(glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
 			static const std::array<std::array<uint8_t, 4>, gradient::MaxStops> sZeroStopColours = {};
 			glCheck(glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_RGBA, static_cast<GLsizei>(gradient::MaxStops), 1, 0, GL_RGBA, GL_FLOAT, &sZeroStopColours[0]));
-			glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, (*iGradientTextures)[2]));
+			iState.bind_texture(GL_TEXTURE_RECTANGLE, (*iGradientTextures)[2]);
 			glCheck(glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
 			glCheck(glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
 			static const std::array<float, GRADIENT_FILTER_SIZE * GRADIENT_FILTER_SIZE> sFilter = {};
 			glCheck(glTexImage2D(GL_TEXTURE_RECTANGLE, 0, GL_R32F, GRADIENT_FILTER_SIZE, GRADIENT_FILTER_SIZE, 0, GL_RED, GL_FLOAT, &sFilter[0]));
-			glCheck(glBindTexture(GL_TEXTURE_RECTANGLE, previousTexture));
+			iState.bind_texture(GL_TEXTURE_RECTANGLE, previousTexture);
 		}
 		return *iGradientTextures;
 	}
 
+	opengl_state& opengl_renderer::state()
+	{
+		return iState;
+	}
+
+	bool opengl_renderer::render_frame()
+	{
+		// input has already been pumped by the caller so a frame started here latches the latest of it
+		if (!iFrameScheduler.frame_due())
+			return false;
+		auto const callsBefore = opengl_call_counters();
+		auto const arenaBefore = iArenaCounters;
+		iFrameScheduler.begin_frame();
+		render_now();
+		iFrameScheduler.end_frame();
+#ifndef NEOGFX_GL_CHECK
+		glCheckError(__FILE__, __LINE__); // release builds: once per frame rather than after every call
+#endif
+		auto const& callsAfter = opengl_call_counters();
+		iFrameCallCounters.calls = callsAfter.calls - callsBefore.calls;
+		iFrameCallCounters.errorChecks = callsAfter.errorChecks - callsBefore.errorChecks;
+		iFrameCallCounters.uniformUploads = callsAfter.uniformUploads - callsBefore.uniformUploads;
+		iFrameCallCounters.redundantUniformUploads = callsAfter.redundantUniformUploads - callsBefore.redundantUniformUploads;
+		iFrameCallCounters.stateChanges = callsAfter.stateChanges - callsBefore.stateChanges;
+		iFrameCallCounters.redundantStateChanges = callsAfter.redundantStateChanges - callsBefore.redundantStateChanges;
+		iFrameArenaCounters.payloads = iArenaCounters.payloads - arenaBefore.payloads;
+		iFrameArenaCounters.growths = iArenaCounters.growths - arenaBefore.growths;
+		return true;
+	}
+
+	void opengl_renderer::wait_for_frame()
+	{
+		auto const wait = iFrameScheduler.time_until_next_frame();
+		if (wait == boost::none)
+			wait_for_events(boost::none);
+		else if (*wait > frame_scheduler::clock::duration::zero())
+			wait_for_events(std::chrono::duration_cast<std::chrono::microseconds>(*wait));
+	}
+
+	const boost::optional<std::chrono::milliseconds>& opengl_renderer::maximum_idle_wait() const
+	{
+		return iFrameScheduler.maximum_idle_wait();
+	}
+
+	void opengl_renderer::set_maximum_idle_wait(const boost::optional<std::chrono::milliseconds>& aWait)
+	{
+		iFrameScheduler.set_maximum_idle_wait(aWait);
+	}
+
 	bool opengl_renderer::process_events()
 	{
 		bool didSome = false;
-		auto lastRenderTime = neolib::thread::program_elapsed_ms();
 		bool finished = false;
 		while (!finished)
 		{	
@@ -889,50 +1027,98 @@ namespace neogfx
 					finished = false;
 				}
 			}
-			if (neolib::thread::program_elapsed_ms() - lastRenderTime > 10)
-			{
-				lastRenderTime = neolib::thread::program_elapsed_ms();
-				render_now();
-			}
+			// keep frames coming during a long burst of events
+			render_frame();
 		}
 		return didSome;
 	}
 
 	void opengl_renderer::register_frame_counter(i_widget& aWidget, uint32_t aDuration)
 	{
-		auto iterFrameCounter = iFrameCounters.find(aDuration);
-		if (iterFrameCounter == iFrameCounters.end())
-			iterFrameCounter = iFrameCounters.emplace(aDuration, aDuration).first;
-		iterFrameCounter->second.add(aWidget);
+		iFrameScheduler.register_frame_counter(aWidget, aDuration);
 	}
 
 	void opengl_renderer::unregister_frame_counter(i_widget& aWidget, uint32_t aDuration)
 	{
-		auto iterFrameCounter = iFrameCounters.find(aDuration);
-		if (iterFrameCounter != iFrameCounters.end())
-			iterFrameCounter->second.remove(aWidget);
+		iFrameScheduler.unregister_frame_counter(aWidget, aDuration);
 	}
 
 	uint32_t opengl_renderer::frame_counter(uint32_t aDuration) const
 	{
-		auto iterFrameCounter = iFrameCounters.find(aDuration);
-		if (iterFrameCounter != iFrameCounters.end())
-			return iterFrameCounter->second.counter();
-		return 0;
+		return iFrameScheduler.frame_counter(aDuration);
+	}
+
+	const frame_statistics& opengl_renderer::frame_stats() const
+	{
+		return iFrameScheduler.frame_stats();
+	}
+
+	const frame_statistics& opengl_renderer::frame_stats(uint32_t aDuration) const
+	{
+		return iFrameScheduler.frame_stats(aDuration);
+	}
+
+	const render_call_counters& opengl_renderer::frame_call_counters() const
+	{
+		return iFrameCallCounters;
+	}
+
+	const operation_arena_counters& opengl_renderer::frame_arena_counters() const
+	{
+		return iFrameArenaCounters;
+	}
+
+	const shader_program_cache_statistics& opengl_renderer::shader_program_cache_stats() const
+	{
+		static const shader_program_cache_statistics sNoCache = {};
+		return iShaderProgramCache != boost::none ? iShaderProgramCache->stats() : sNoCache;
+	}
+
+	const render_layer_statistics& opengl_renderer::render_layer_stats() const
+	{
+		return iRenderLayerStats;
+	}
+
+	render_layer_statistics& opengl_renderer::render_layer_stats()
+	{
+		return iRenderLayerStats;
+	}
+
+	uint64_t opengl_renderer::render_layer_budget() const
+	{
+		return iRenderLayerBudget;
+	}
+
+	void opengl_renderer::set_render_layer_budget(uint64_t aBytes)
+	{
+		iRenderLayerBudget = aBytes;
+	}
+
+	std::unique_ptr<graphics_operation::arena> opengl_renderer::acquire_operation_arena()
+	{
+		if (iOperationArenas.empty())
+		{
+			++iArenaCounters.growths;
+			return std::make_unique<graphics_operation::arena>(iArenaCounters);
+		}
+		auto arena = std::move(iOperationArenas.back());
+		iOperationArenas.pop_back();
+		return arena;
+	}
+
+	void opengl_renderer::release_operation_arena(std::unique_ptr<graphics_operation::arena> aArena)
+	{
+		aArena->reset();
+		iOperationArenas.push_back(std::move(aArena));
 	}
 
 	opengl_renderer::shader_programs::iterator opengl_renderer::create_shader_program(const shaders& aShaders, const std::vector<std::string>& aVariables)
 	{
-		GLuint programHandle = glCheck(glCreateProgram());
-		if (0 == programHandle)
-			throw failed_to_create_shader_program("Failed to create shader program object");
+		shaders sources = aShaders;
 		bool hasProjectionMatrix = false;
-		for (auto& s : aShaders)
+		for (auto& s : sources)
 		{
-			GLuint shader = glCheck(glCreateShader(s.second));
-			if (0 == shader)
-				throw failed_to_create_shader_program("Failed to create shader object");
-			std::string source = s.first;
+			std::string& source = s.first;
 			if (source.find("uProjectionMatrix") != std::string::npos)
 				hasProjectionMatrix = true;
 			if (renderer() == neogfx::renderer::DirectX)
@@ -944,7 +1130,36 @@ namespace neogfx
 				else if ((v = source.find("#version 150")) != std::string::npos)
 					source.replace(v, VERSION_STRING_LENGTH, "#version 110");
 			}
-			const char* codeArray[] = { source.c_str() };
+		}
+		bool const useCache = iShaderProgramCache != boost::none && iShaderProgramCache->enabled();
+		shader_program_cache::key_type key;
+		if (useCache)
+		{
+			key = iShaderProgramCache->key(sources, aVariables);
+			GLuint programHandle = glCheck(glCreateProgram());
+			if (0 == programHandle)
+				throw failed_to_create_shader_program("Failed to create shader program object");
+			if (iShaderProgramCache->load(key, programHandle))
+			{
+				shader_program program(programHandle, hasProjectionMatrix);
+				for (auto& v : aVariables)
+					program.register_variable(v);
+				auto s = iShaderPrograms.insert(iShaderPrograms.end(), program);
+				s->cache_locations();
+				return s;
+			}
+			glCheck(glDeleteProgram(programHandle));
+		}
+		auto const compileStart = std::chrono::steady_clock::now();
+		GLuint programHandle = glCheck(glCreateProgram());
+		if (0 == programHandle)
+			throw failed_to_create_shader_program("Failed to create shader program object");
+		for (auto& s : sources)
+		{
+			GLuint shader = glCheck(glCreateShader(s.second));
+			if (0 == shader)
+				throw failed_to_create_shader_program("Failed to create shader object");
+			const char* codeArray[] = { s.first.c_str() };
 			glCheck(glShaderSource(shader, 1, codeArray, NULL));
 			glCheck(glCompileShader(shader));
 			GLint result;
@@ -964,11 +1179,18 @@ namespace neogfx
 		for (auto& v : aVariables)
 			glCheck(glBindAttribLocation(programHandle, program.register_variable(v), v.c_str()));
 		auto s = iShaderPrograms.insert(iShaderPrograms.end(), program);
+		if (useCache)
+			glCheck(glProgramParameteri(programHandle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
 		glCheck(glLinkProgram(programHandle));
 		GLint result;
 		glCheck(glGetProgramiv(programHandle, GL_LINK_STATUS, &result));
 		if (GL_FALSE == result)
 			throw failed_to_create_shader_program("Failed to link");
+		s->cache_locations();
+		if (iShaderProgramCache != boost::none)
+			iShaderProgramCache->compiled(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - compileStart));
+		if (useCache)
+			iShaderProgramCache->store(key, programHandle);
 		return s;
 	}
 }
\ No newline at end of file
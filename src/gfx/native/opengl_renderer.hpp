@@ -22,32 +22,22 @@
 #include <neogfx/neogfx.hpp>
 #include <set>
 #include <map>
+#include <unordered_map>
 #include "opengl.hpp"
 #include <neogfx/gfx/i_rendering_engine.hpp>
 #include <neogfx/gfx/text/font_manager.hpp>
 #include "opengl_texture_manager.hpp"
+#include "opengl_state.hpp"
 #include "opengl_helpers.hpp"
+#include "frame_scheduler.hpp"
+#include "shader_program_cache.hpp"
+#include "graphics_operation_arena.hpp"
 
 std::string glErrorString(GLenum aErrorCode);
 GLenum glCheckError(const char* file, unsigned int line);
 
 namespace neogfx
 {
-	class frame_counter
-	{
-	public:
-		frame_counter(uint32_t aDuration);
-	public:
-		uint32_t counter() const;
-	public:
-		void add(i_widget& aWidget);
-		void remove(i_widget& aWidget);
-	private:
-		neolib::callback_timer iTimer;
-		uint32_t iCounter;
-		std::vector<i_widget*> iWidgets;
-	};
-
 	class opengl_renderer : public i_rendering_engine
 	{
 	public:
@@ -64,6 +54,14 @@ namespace neogfx
 		{
 		public:
 			typedef std::map<std::string, GLuint> variable_map;
+		private:
+			struct uniform
+			{
+				GLint location;
+				std::vector<uint8_t> shadow; // last value uploaded
+			};
+			typedef std::unordered_map<std::string, uniform> uniform_map;
+			typedef std::unordered_map<std::string, GLint> attribute_map;
 		public:
 			shader_program(GLuint aHandle, bool aHasProjectionMatrix);
 		public:
@@ -71,6 +69,7 @@ namespace neogfx
 			bool has_projection_matrix() const override;
 			void set_projection_matrix(const i_native_graphics_context& aGraphicsContext) override;
 			void* variable(const std::string& aVariableName) const override;
+			int32_t attribute_location(const std::string& aVariableName) const override;
 			void set_uniform_variable(const std::string& aName, float aValue) override;
 			void set_uniform_variable(const std::string& aName, double aValue) override;
 			void set_uniform_variable(const std::string& aName, int aValue) override;
@@ -84,15 +83,21 @@ namespace neogfx
 			void set_uniform_matrix(const std::string& aName, const mat44::template rebind<double>::type& aMatrix) override;
 		public:
 			GLuint register_variable(const std::string& aVariableName);
+			void cache_locations();
 		public:
 			bool operator<(const shader_program& aRhs) const;
 		private:
-			GLint uniform_location(const std::string& aName);
+			uniform& find_uniform(const std::string& aName);
+			template <typename T>
+			bool update_shadow(uniform& aUniform, const T* aData, std::size_t aCount);
+			void check_upload() const;
 		private:
 			GLuint iHandle;
 			bool iHasProjectionMatrix;
 			std::pair<vec2, vec2> iLogicalCoordinates;
 			variable_map iVariables;
+			uniform_map iUniforms;
+			mutable attribute_map iAttributes;
 		};
 	private:
 		typedef std::vector<std::pair<std::string, GLenum>> shaders;
@@ -130,16 +135,41 @@ namespace neogfx
 		void subpixel_rendering_off() override;
 	public:
 		static const uint32_t GRADIENT_FILTER_SIZE = 15;
+		static const uint64_t DEFAULT_RENDER_LAYER_BUDGET = 64 * 1024 * 1024; // per window
 		const std::array<GLuint, 3>& gradient_textures() const; // todo: use texture class and add to base class interface
+	public:
+		opengl_state& state();
+	public:
+		bool render_frame() override;
+		void wait_for_frame() override;
+		const boost::optional<std::chrono::milliseconds>& maximum_idle_wait() const override;
+		void set_maximum_idle_wait(const boost::optional<std::chrono::milliseconds>& aWait) override;
 	public:
 		bool process_events() override;
 	public:
 		void register_frame_counter(i_widget& aWidget, uint32_t aDuration) override;
 		void unregister_frame_counter(i_widget& aWidget, uint32_t aDuration) override;
 		uint32_t frame_counter(uint32_t aDuration) const override;
+		const frame_statistics& frame_stats() const override;
+		const frame_statistics& frame_stats(uint32_t aDuration) const override;
+		const render_call_counters& frame_call_counters() const override;
+		const operation_arena_counters& frame_arena_counters() const override;
+		const shader_program_cache_statistics& shader_program_cache_stats() const override;
+		const render_layer_statistics& render_layer_stats() const override;
+		render_layer_statistics& render_layer_stats();
+		uint64_t render_layer_budget() const override;
+		void set_render_layer_budget(uint64_t aBytes) override;
+	public:
+		std::unique_ptr<graphics_operation::arena> acquire_operation_arena();
+		void release_operation_arena(std::unique_ptr<graphics_operation::arena> aArena);
+	public:
+		virtual uint32_t display_index(const i_native_surface& aSurface) const = 0;
+		virtual double display_refresh_rate(uint32_t aDisplayIndex) const = 0;
+		virtual void wait_for_events(const boost::optional<std::chrono::microseconds>& aTimeout) = 0;
 	private:
 		shader_programs::iterator create_shader_program(const shaders& aShaders, const std::vector<std::string>& aVariables);
 	private:
+		mutable opengl_state iState;
 		neogfx::renderer iRenderer;
 		opengl_texture_manager iTextureManager;
 		neogfx::font_manager iFontManager;
@@ -153,6 +183,13 @@ namespace neogfx
 		bool iSubpixelRendering;
 		mutable boost::optional<std::array<GLuint, 3>> iGradientTextures;
 		mutable boost::optional<opengl_standard_vertex_arrays> iVertexArrays;
-		std::map<uint32_t, neogfx::frame_counter> iFrameCounters;
+		neogfx::frame_scheduler iFrameScheduler;
+		render_call_counters iFrameCallCounters;
+		std::vector<std::unique_ptr<graphics_operation::arena>> iOperationArenas;
+		operation_arena_counters iArenaCounters;
+		operation_arena_counters iFrameArenaCounters;
+		boost::optional<shader_program_cache> iShaderProgramCache;
+		uint64_t iRenderLayerBudget;
+		render_layer_statistics iRenderLayerStats;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,526 @@
+// opengl_state.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <algorithm>
+#include <neogfx/gfx/i_rendering_engine.hpp>
+#include "opengl_state.hpp"
+
+namespace neogfx
+{
+	namespace
+	{
+		thread_local opengl_state* tCurrentState;
+
+		bool is_texture_capability(GLenum aCapability)
+		{
+			return aCapability == GL_TEXTURE_2D || aCapability == GL_TEXTURE_RECTANGLE;
+		}
+	}
+
+	opengl_state::opengl_state()
+	{
+		reset();
+	}
+
+	opengl_state::~opengl_state()
+	{
+		if (tCurrentState == this)
+			tCurrentState = nullptr;
+	}
+
+	bool opengl_state::has_current()
+	{
+		return tCurrentState != nullptr;
+	}
+
+	opengl_state& opengl_state::current()
+	{
+		if (tCurrentState == nullptr)
+			throw no_current_state();
+		return *tCurrentState;
+	}
+
+	void opengl_state::make_current()
+	{
+		tCurrentState = this;
+	}
+
+	void opengl_state::reset()
+	{
+		iCapabilities.clear();
+		iCapabilities.emplace_back(GL_DITHER, true);
+		iCapabilities.emplace_back(GL_MULTISAMPLE, true);
+		iBlendSourceFactor = GL_ONE;
+		iBlendDestinationFactor = GL_ZERO;
+		iAlphaBlendFactors = boost::none;
+		iLogicOp = GL_COPY;
+		iDepthFunc = GL_LESS;
+		iDepthMask = true;
+		iColourMask = { { true, true, true, true } };
+		iStencilOp = { { GL_KEEP, GL_KEEP, GL_KEEP } };
+		iStencilFunc = GL_ALWAYS;
+		iStencilReference = 0;
+		iStencilFuncMask = static_cast<GLuint>(-1);
+		iStencilMask = static_cast<GLuint>(-1);
+		iScissor = { { 0, 0, -1, -1 } }; // initial box is the window size which we don't know
+		iViewport = { { 0, 0, -1, -1 } };
+		iLineWidth = 1.0f;
+		iUnpackAlignment = 4;
+		iPackAlignment = 4;
+		iActiveTexture = GL_TEXTURE0;
+		for (auto& unit : iTextures)
+			unit.fill(0u);
+		iProgram = 0u;
+		iVertexArray = 0u;
+		iArrayBuffer = 0u;
+		iDrawFramebuffer = 0u;
+		iReadFramebuffer = 0u;
+		iRenderbuffer = 0u;
+	}
+
+	void opengl_state::enable(GLenum aCapability)
+	{
+		set_enabled(aCapability, true);
+	}
+
+	void opengl_state::disable(GLenum aCapability)
+	{
+		set_enabled(aCapability, false);
+	}
+
+	void opengl_state::set_enabled(GLenum aCapability, bool aEnabled)
+	{
+		auto const key = capability_key(aCapability);
+		auto existing = std::find_if(iCapabilities.begin(), iCapabilities.end(), [key](const capability_list::value_type& aEntry) { return aEntry.first == key; });
+		if (existing == iCapabilities.end())
+			existing = iCapabilities.emplace(iCapabilities.end(), key, false);
+		if (existing->second == aEnabled)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		existing->second = aEnabled;
+		++opengl_call_counters().stateChanges;
+		if (aEnabled)
+		{
+			glCheck(glEnable(aCapability));
+		}
+		else
+		{
+			glCheck(glDisable(aCapability));
+		}
+	}
+
+	bool opengl_state::is_enabled(GLenum aCapability) const
+	{
+		auto const key = capability_key(aCapability);
+		auto existing = std::find_if(iCapabilities.begin(), iCapabilities.end(), [key](const capability_list::value_type& aEntry) { return aEntry.first == key; });
+		return existing != iCapabilities.end() && existing->second;
+	}
+
+	opengl_state::blend_factors opengl_state::blend_func() const
+	{
+		return blend_factors{ iBlendSourceFactor, iBlendDestinationFactor };
+	}
+
+	void opengl_state::blend_func(GLenum aSourceFactor, GLenum aDestinationFactor)
+	{
+		if (iBlendSourceFactor == aSourceFactor && iBlendDestinationFactor == aDestinationFactor)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		iBlendSourceFactor = aSourceFactor;
+		iBlendDestinationFactor = aDestinationFactor;
+		++opengl_call_counters().stateChanges;
+		apply_blend_func();
+	}
+
+	const opengl_state::optional_blend_factors& opengl_state::alpha_blend_func() const
+	{
+		return iAlphaBlendFactors;
+	}
+
+	// while set the alpha channel is blended with these factors whatever blend_func is given; used when rendering
+	// into a transparent target so that it accumulates coverage
+	void opengl_state::alpha_blend_func(const optional_blend_factors& aFactors)
+	{
+		if (iAlphaBlendFactors == aFactors)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		iAlphaBlendFactors = aFactors;
+		++opengl_call_counters().stateChanges;
+		apply_blend_func();
+	}
+
+	void opengl_state::logic_op(GLenum aOpcode)
+	{
+		if (iLogicOp == aOpcode)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		iLogicOp = aOpcode;
+		++opengl_call_counters().stateChanges;
+		glCheck(glLogicOp(aOpcode));
+	}
+
+	void opengl_state::depth_func(GLenum aFunc)
+	{
+		if (iDepthFunc == aFunc)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		iDepthFunc = aFunc;
+		++opengl_call_counters().stateChanges;
+		glCheck(glDepthFunc(aFunc));
+	}
+
+	void opengl_state::depth_mask(bool aMask)
+	{
+		if (iDepthMask == aMask)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		iDepthMask = aMask;
+		++opengl_call_counters().stateChanges;
+		glCheck(glDepthMask(aMask ? GL_TRUE : GL_FALSE));
+	}
+
+	void opengl_state::colour_mask(bool aRed, bool aGreen, bool aBlue, bool aAlpha)
+	{
+		std::array<bool, 4> const mask = { { aRed, aGreen, aBlue, aAlpha } };
+		if (iColourMask == mask)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		iColourMask = mask;
+		++opengl_call_counters().stateChanges;
+		glCheck(glColorMask(aRed ? GL_TRUE : GL_FALSE, aGreen ? GL_TRUE : GL_FALSE, aBlue ? GL_TRUE : GL_FALSE, aAlpha ? GL_TRUE : GL_FALSE));
+	}
+
+	void opengl_state::stencil_op(GLenum aStencilFail, GLenum aDepthFail, GLenum aDepthPass)
+	{
+		std::array<GLenum, 3> const op = { { aStencilFail, aDepthFail, aDepthPass } };
+		if (iStencilOp == op)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		iStencilOp = op;
+		++opengl_call_counters().stateChanges;
+		glCheck(glStencilOp(aStencilFail, aDepthFail, aDepthPass));
+	}
+
+	void opengl_state::stencil_func(GLenum aFunc, GLint aReference, GLuint aMask)
+	{
+		if (iStencilFunc == aFunc && iStencilReference == aReference && iStencilFuncMask == aMask)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		iStencilFunc = aFunc;
+		iStencilReference = aReference;
+		iStencilFuncMask = aMask;
+		++opengl_call_counters().stateChanges;
+		glCheck(glStencilFunc(aFunc, aReference, aMask));
+	}
+
+	void opengl_state::stencil_mask(GLuint aMask)
+	{
+		if (iStencilMask == aMask)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		iStencilMask = aMask;
+		++opengl_call_counters().stateChanges;
+		glCheck(glStencilMask(aMask));
+	}
+
+	const std::array<GLint, 4>& opengl_state::scissor_box() const
+	{
+		return iScissor;
+	}
+
+	void opengl_state::scissor(GLint aX, GLint aY, GLsizei aWidth, GLsizei aHeight)
+	{
+		std::array<GLint, 4> const box = { { aX, aY, aWidth, aHeight } };
+		if (iScissor == box)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		iScissor = box;
+		++opengl_call_counters().stateChanges;
+		glCheck(glScissor(aX, aY, aWidth, aHeight));
+	}
+
+	void opengl_state::viewport(GLint aX, GLint aY, GLsizei aWidth, GLsizei aHeight)
+	{
+		std::array<GLint, 4> const box = { { aX, aY, aWidth, aHeight } };
+		if (iViewport == box)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		iViewport = box;
+		++opengl_call_counters().stateChanges;
+		glCheck(glViewport(aX, aY, aWidth, aHeight));
+	}
+
+	void opengl_state::line_width(GLfloat aWidth)
+	{
+		if (iLineWidth == aWidth)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		iLineWidth = aWidth;
+		++opengl_call_counters().stateChanges;
+		glCheck(glLineWidth(aWidth));
+	}
+
+	GLint opengl_state::pixel_store(GLenum aParameter) const
+	{
+		switch (aParameter)
+		{
+		case GL_UNPACK_ALIGNMENT:
+			return iUnpackAlignment;
+		case GL_PACK_ALIGNMENT:
+			return iPackAlignment;
+		default:
+			throw unsupported_target();
+		}
+	}
+
+	void opengl_state::pixel_store(GLenum aParameter, GLint aValue)
+	{
+		if (pixel_store(aParameter) == aValue)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		(aParameter == GL_UNPACK_ALIGNMENT ? iUnpackAlignment : iPackAlignment) = aValue;
+		++opengl_call_counters().stateChanges;
+		glCheck(glPixelStorei(aParameter, aValue));
+	}
+
+	GLenum opengl_state::active_texture() const
+	{
+		return iActiveTexture;
+	}
+
+	void opengl_state::active_texture(GLenum aUnit)
+	{
+		if (iActiveTexture == aUnit)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		if (aUnit - GL_TEXTURE0 >= MaxTextureUnits)
+			throw unsupported_target();
+		iActiveTexture = aUnit;
+		++opengl_call_counters().stateChanges;
+		glCheck(glActiveTexture(aUnit));
+	}
+
+	GLuint opengl_state::bound_texture(GLenum aTarget) const
+	{
+		return iTextures[iActiveTexture - GL_TEXTURE0][texture_target_index(aTarget)];
+	}
+
+	void opengl_state::bind_texture(GLenum aTarget, GLuint aTexture)
+	{
+		auto& binding = iTextures[iActiveTexture - GL_TEXTURE0][texture_target_index(aTarget)];
+		if (binding == aTexture)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		binding = aTexture;
+		++opengl_call_counters().stateChanges;
+		glCheck(glBindTexture(aTarget, aTexture));
+	}
+
+	GLuint opengl_state::program() const
+	{
+		return iProgram;
+	}
+
+	void opengl_state::use_program(GLuint aProgram)
+	{
+		if (iProgram == aProgram)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		iProgram = aProgram;
+		++opengl_call_counters().stateChanges;
+		glCheck(glUseProgram(aProgram));
+	}
+
+	GLuint opengl_state::vertex_array() const
+	{
+		return iVertexArray;
+	}
+
+	void opengl_state::bind_vertex_array(GLuint aVertexArray)
+	{
+		if (iVertexArray == aVertexArray)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		iVertexArray = aVertexArray;
+		++opengl_call_counters().stateChanges;
+		glCheck(glBindVertexArray(aVertexArray));
+	}
+
+	GLuint opengl_state::bound_buffer(GLenum aTarget) const
+	{
+		if (aTarget != GL_ARRAY_BUFFER) // other bindings are either vertex array state or unused
+			throw unsupported_target();
+		return iArrayBuffer;
+	}
+
+	void opengl_state::bind_buffer(GLenum aTarget, GLuint aBuffer)
+	{
+		if (aTarget != GL_ARRAY_BUFFER)
+			throw unsupported_target();
+		if (iArrayBuffer == aBuffer)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		iArrayBuffer = aBuffer;
+		++opengl_call_counters().stateChanges;
+		glCheck(glBindBuffer(aTarget, aBuffer));
+	}
+
+	GLuint opengl_state::bound_framebuffer(GLenum aTarget) const
+	{
+		return aTarget == GL_READ_FRAMEBUFFER ? iReadFramebuffer : iDrawFramebuffer;
+	}
+
+	void opengl_state::bind_framebuffer(GLenum aTarget, GLuint aFramebuffer)
+	{
+		bool const draw = (aTarget == GL_FRAMEBUFFER || aTarget == GL_DRAW_FRAMEBUFFER);
+		bool const read = (aTarget == GL_FRAMEBUFFER || aTarget == GL_READ_FRAMEBUFFER);
+		if ((!draw || iDrawFramebuffer == aFramebuffer) && (!read || iReadFramebuffer == aFramebuffer))
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		if (draw)
+			iDrawFramebuffer = aFramebuffer;
+		if (read)
+			iReadFramebuffer = aFramebuffer;
+		++opengl_call_counters().stateChanges;
+		glCheck(glBindFramebuffer(aTarget, aFramebuffer));
+	}
+
+	void opengl_state::bind_renderbuffer(GLuint aRenderbuffer)
+	{
+		if (iRenderbuffer == aRenderbuffer)
+		{
+			++opengl_call_counters().redundantStateChanges;
+			return;
+		}
+		iRenderbuffer = aRenderbuffer;
+		++opengl_call_counters().stateChanges;
+		glCheck(glBindRenderbuffer(GL_RENDERBUFFER, aRenderbuffer));
+	}
+
+	void opengl_state::texture_deleted(GLuint aTexture)
+	{
+		// deleting a bound texture reverts its bindings to zero
+		for (auto& unit : iTextures)
+			for (auto& binding : unit)
+				if (binding == aTexture)
+					binding = 0u;
+	}
+
+	void opengl_state::vertex_array_deleted(GLuint aVertexArray)
+	{
+		if (iVertexArray == aVertexArray)
+			iVertexArray = 0u;
+	}
+
+	void opengl_state::buffer_deleted(GLuint aBuffer)
+	{
+		if (iArrayBuffer == aBuffer)
+			iArrayBuffer = 0u;
+	}
+
+	void opengl_state::framebuffer_deleted(GLuint aFramebuffer)
+	{
+		if (iDrawFramebuffer == aFramebuffer)
+			iDrawFramebuffer = 0u;
+		if (iReadFramebuffer == aFramebuffer)
+			iReadFramebuffer = 0u;
+	}
+
+	void opengl_state::renderbuffer_deleted(GLuint aRenderbuffer)
+	{
+		if (iRenderbuffer == aRenderbuffer)
+			iRenderbuffer = 0u;
+	}
+
+	uint64_t opengl_state::capability_key(GLenum aCapability) const
+	{
+		// fixed function texture enables are per texture unit
+		if (is_texture_capability(aCapability))
+			return (static_cast<uint64_t>(iActiveTexture) << 32) | aCapability;
+		return aCapability;
+	}
+
+	std::size_t opengl_state::texture_target_index(GLenum aTarget)
+	{
+		switch (aTarget)
+		{
+		case GL_TEXTURE_2D:
+			return 0u;
+		case GL_TEXTURE_2D_MULTISAMPLE:
+			return 1u;
+		case GL_TEXTURE_RECTANGLE:
+			return 2u;
+		default:
+			throw unsupported_target();
+		}
+	}
+
+	void opengl_state::apply_blend_func()
+	{
+		if (iAlphaBlendFactors == boost::none)
+		{
+			glCheck(glBlendFunc(iBlendSourceFactor, iBlendDestinationFactor));
+		}
+		else
+		{
+			glCheck(glBlendFuncSeparate(iBlendSourceFactor, iBlendDestinationFactor, iAlphaBlendFactors->first, iAlphaBlendFactors->second));
+		}
+	}
+}
@@ -0,0 +1,128 @@
+// opengl_state.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <array>
+#include <vector>
+#include <boost/optional.hpp>
+#include "opengl.hpp"
+
+namespace neogfx
+{
+	// Shadow of the GL state of one context. All state changes go through here so that redundant
+	// changes are filtered and previous bindings can be restored without glGet* round trips; the
+	// shadow starts at the GL defaults so it must be reset whenever its context is (re)created.
+	class opengl_state
+	{
+	public:
+		struct no_current_state : std::logic_error { no_current_state() : std::logic_error("neogfx::opengl_state::no_current_state") {} };
+		struct unsupported_target : std::logic_error { unsupported_target() : std::logic_error("neogfx::opengl_state::unsupported_target") {} };
+	public:
+		static const std::size_t MaxTextureUnits = 16u;
+	public:
+		typedef std::pair<GLenum, GLenum> blend_factors;
+		typedef boost::optional<blend_factors> optional_blend_factors;
+	private:
+		typedef std::vector<std::pair<uint64_t, bool>> capability_list;
+		typedef std::array<GLuint, 3> texture_bindings;
+	public:
+		opengl_state();
+		~opengl_state();
+	public:
+		static bool has_current();
+		static opengl_state& current();
+		void make_current();
+		void reset();
+	public:
+		void enable(GLenum aCapability);
+		void disable(GLenum aCapability);
+		void set_enabled(GLenum aCapability, bool aEnabled);
+		bool is_enabled(GLenum aCapability) const;
+		blend_factors blend_func() const;
+		void blend_func(GLenum aSourceFactor, GLenum aDestinationFactor);
+		const optional_blend_factors& alpha_blend_func() const;
+		void alpha_blend_func(const optional_blend_factors& aFactors);
+		void logic_op(GLenum aOpcode);
+		void depth_func(GLenum aFunc);
+		void depth_mask(bool aMask);
+		void colour_mask(bool aRed, bool aGreen, bool aBlue, bool aAlpha);
+		void stencil_op(GLenum aStencilFail, GLenum aDepthFail, GLenum aDepthPass);
+		void stencil_func(GLenum aFunc, GLint aReference, GLuint aMask);
+		void stencil_mask(GLuint aMask);
+		const std::array<GLint, 4>& scissor_box() const;
+		void scissor(GLint aX, GLint aY, GLsizei aWidth, GLsizei aHeight);
+		void viewport(GLint aX, GLint aY, GLsizei aWidth, GLsizei aHeight);
+		void line_width(GLfloat aWidth);
+		GLint pixel_store(GLenum aParameter) const;
+		void pixel_store(GLenum aParameter, GLint aValue);
+	public:
+		GLenum active_texture() const;
+		void active_texture(GLenum aUnit);
+		GLuint bound_texture(GLenum aTarget) const;
+		void bind_texture(GLenum aTarget, GLuint aTexture);
+		GLuint program() const;
+		void use_program(GLuint aProgram);
+		GLuint vertex_array() const;
+		void bind_vertex_array(GLuint aVertexArray);
+		GLuint bound_buffer(GLenum aTarget) const;
+		void bind_buffer(GLenum aTarget, GLuint aBuffer);
+		GLuint bound_framebuffer(GLenum aTarget) const;
+		void bind_framebuffer(GLenum aTarget, GLuint aFramebuffer);
+		void bind_renderbuffer(GLuint aRenderbuffer);
+	public:
+		void texture_deleted(GLuint aTexture);
+		void vertex_array_deleted(GLuint aVertexArray);
+		void buffer_deleted(GLuint aBuffer);
+		void framebuffer_deleted(GLuint aFramebuffer);
+		void renderbuffer_deleted(GLuint aRenderbuffer);
+	private:
+		uint64_t capability_key(GLenum aCapability) const;
+		static std::size_t texture_target_index(GLenum aTarget);
+		void apply_blend_func();
+	private:
+		capability_list iCapabilities;
+		GLenum iBlendSourceFactor;
+		GLenum iBlendDestinationFactor;
+		optional_blend_factors iAlphaBlendFactors;
+		GLenum iLogicOp;
+		GLenum iDepthFunc;
+		bool iDepthMask;
+		std::array<bool, 4> iColourMask;
+		std::array<GLenum, 3> iStencilOp;
+		GLenum iStencilFunc;
+		GLint iStencilReference;
+		GLuint iStencilFuncMask;
+		GLuint iStencilMask;
+		std::array<GLint, 4> iScissor;
+		std::array<GLint, 4> iViewport;
+		GLfloat iLineWidth;
+		GLint iUnpackAlignment;
+		GLint iPackAlignment;
+		GLenum iActiveTexture;
+		std::array<texture_bindings, MaxTextureUnits> iTextures;
+		GLuint iProgram;
+		GLuint iVertexArray;
+		GLuint iArrayBuffer;
+		GLuint iDrawFramebuffer;
+		GLuint iReadFramebuffer;
+		GLuint iRenderbuffer;
+	};
+}
@@ -18,8 +18,11 @@
 */
 
 #include <neogfx/neogfx.hpp>
+#include <cstring>
 #include "opengl_error.hpp"
+#include "opengl_state.hpp"
 #include "opengl_texture.hpp"
+#include "../image_kernels.hpp"
 
 namespace neogfx
 {
@@ -31,12 +34,13 @@ namespace neogfx
 		iHandle{ 0 },
 		iUri{ "neogfx::opengl_texture::internal" }
 	{
-		GLint previousTexture;
+		auto& state = opengl_state::current();
+		GLenum const target = (iSampling == texture_sampling::Normal || iSampling == texture_sampling::NormalMipmap ? GL_TEXTURE_2D : GL_TEXTURE_2D_MULTISAMPLE);
+		GLuint const previousTexture = state.bound_texture(target);
 		try
 		{
-			glCheck(glGetIntegerv(iSampling == texture_sampling::Normal || iSampling == texture_sampling::NormalMipmap ? GL_TEXTURE_BINDING_2D : GL_TEXTURE_BINDING_2D_MULTISAMPLE, &previousTexture));
 			glCheck(glGenTextures(1, &iHandle));
-			glCheck(glBindTexture(iSampling == texture_sampling::Normal || iSampling == texture_sampling::NormalMipmap ? GL_TEXTURE_2D : GL_TEXTURE_2D_MULTISAMPLE, iHandle));
+			state.bind_texture(target, iHandle);
 			glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER));
 			glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER));
 			if (iSampling == texture_sampling::Normal)
@@ -83,11 +87,12 @@ namespace neogfx
 					glCheck(glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_RGBA8, static_cast<GLsizei>(iStorageSize.cx), static_cast<GLsizei>(iStorageSize.cy), true));
 				}
 			}
-			glCheck(glBindTexture(iSampling == texture_sampling::Normal || iSampling == texture_sampling::NormalMipmap ? GL_TEXTURE_2D : GL_TEXTURE_2D_MULTISAMPLE, static_cast<GLuint>(previousTexture)));
+			state.bind_texture(target, previousTexture);
 		}
 		catch (...)
 		{
 			glCheck(glDeleteTextures(1, &iHandle));
+			state.texture_deleted(iHandle);
 			throw;
 		}
 	}
@@ -100,12 +105,12 @@ namespace neogfx
 		iHandle{ 0 },
 		iUri{ aImage.uri() }
 	{
-		GLint previousTexture = 0;
+		auto& state = opengl_state::current();
+		GLuint const previousTexture = state.bound_texture(GL_TEXTURE_2D);
 		try
 		{
-			glCheck(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
 			glCheck(glGenTextures(1, &iHandle));
-			glCheck(glBindTexture(GL_TEXTURE_2D, iHandle));
+			state.bind_texture(GL_TEXTURE_2D, iHandle);
 			if (iSampling == texture_sampling::Normal)
 			{
 				glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
@@ -122,14 +127,23 @@ namespace neogfx
 				{
 					const uint8_t* imageData = static_cast<const uint8_t*>(aImage.data());
 					std::vector<uint8_t> data(iStorageSize.cx * 4 * iStorageSize.cy);
+					std::size_t const storageStride = static_cast<std::size_t>(iStorageSize.cx) * 4u;
+					std::size_t const imageStride = static_cast<std::size_t>(iSize.cx) * 4u;
 					for (std::size_t y = 1; y < 1 + iSize.cy; ++y)
-						for (std::size_t x = 1; x < 1 + iSize.cx; ++x)
-							for (std::size_t c = 0; c < 4; ++c)
-								data[y * iStorageSize.cx * 4 + x * 4 + c] = imageData[(y - 1) * iSize.cx * 4 + (x - 1) * 4 + c];
+						std::memcpy(&data[y * storageStride + 4u], imageData + (y - 1) * imageStride, imageStride);
 					glCheck(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, static_cast<GLsizei>(iStorageSize.cx), static_cast<GLsizei>(iStorageSize.cy), 0, GL_RGBA, GL_UNSIGNED_BYTE, &data[0]));
 					if (iSampling == texture_sampling::NormalMipmap)
 					{
-						glCheck(glGenerateMipmap(GL_TEXTURE_2D));
+						// generate the chain here rather than with glGenerateMipmap so that levels are alpha weighted
+						auto const levels = image_kernels::mipmap_chain(&data[0], static_cast<uint32_t>(iStorageSize.cx), static_cast<uint32_t>(iStorageSize.cy));
+						GLsizei levelWidth = static_cast<GLsizei>(iStorageSize.cx);
+						GLsizei levelHeight = static_cast<GLsizei>(iStorageSize.cy);
+						for (std::size_t level = 0; level < levels.size(); ++level)
+						{
+							levelWidth = std::max(1, levelWidth / 2);
+							levelHeight = std::max(1, levelHeight / 2);
+							glCheck(glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level + 1), GL_RGBA8, levelWidth, levelHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, &levels[level][0]));
+						}
 					}
 				}
 				break;
@@ -137,11 +151,12 @@ namespace neogfx
 				throw unsupported_colour_format();
 				break;
 			}
-			glCheck(glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previousTexture)));
+			state.bind_texture(GL_TEXTURE_2D, previousTexture);
 		}
 		catch (...)
 		{
 			glCheck(glDeleteTextures(1, &iHandle));
+			state.texture_deleted(iHandle);
 			throw;
 		}
 	}
@@ -149,6 +164,8 @@ namespace neogfx
 	opengl_texture::~opengl_texture()
 	{
 		glCheck(glDeleteTextures(1, &iHandle));
+		if (opengl_state::has_current())
+			opengl_state::current().texture_deleted(iHandle);
 	}
 
 	dimension opengl_texture::dpi_scale_factor() const
@@ -173,11 +190,11 @@ namespace neogfx
 
 	void opengl_texture::set_pixels(const rect& aRect, const void* aPixelData)
 	{
-		GLint previousTexture;
 		if (iSampling == texture_sampling::Normal || iSampling == texture_sampling::NormalMipmap)
 		{
-			glCheck(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
-			glCheck(glBindTexture(GL_TEXTURE_2D, iHandle));
+			auto& state = opengl_state::current();
+			GLuint const previousTexture = state.bound_texture(GL_TEXTURE_2D);
+			state.bind_texture(GL_TEXTURE_2D, iHandle);
 			glCheck(glTexSubImage2D(GL_TEXTURE_2D, 0,
 				static_cast<GLint>(aRect.x + 1.0), static_cast<GLint>(aRect.y + 1.0), static_cast<GLsizei>(aRect.cx), static_cast<GLsizei>(aRect.cy),
 				GL_RGBA, GL_UNSIGNED_BYTE, aPixelData));
@@ -185,7 +202,7 @@ namespace neogfx
 			{
 				glCheck(glGenerateMipmap(GL_TEXTURE_2D));
 			}
-			glCheck(glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previousTexture)));
+			state.bind_texture(GL_TEXTURE_2D, previousTexture);
 		}
 		else
 			throw multisample_texture_initialization_unsupported();
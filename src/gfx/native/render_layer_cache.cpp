@@ -0,0 +1,160 @@
+// render_layer_cache.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <algorithm>
+#include "opengl_error.hpp"
+#include "opengl_state.hpp"
+#include "render_layer_cache.hpp"
+
+namespace neogfx
+{
+	render_layer_cache::render_layer_cache(render_layer_statistics& aStats) :
+		iStats{ aStats },
+		iBytes{ 0 }
+	{
+	}
+
+	bool render_layer_cache::has_layer(const void* aOwner) const
+	{
+		return iIndex.find(aOwner) != iIndex.end();
+	}
+
+	render_layer_cache::layer* render_layer_cache::acquire(const void* aOwner, const size& aExtents, bool aOpaque, uint64_t aBudget)
+	{
+		auto existing = iIndex.find(aOwner);
+		if (existing != iIndex.end())
+		{
+			iLayers.splice(iLayers.begin(), iLayers, existing->second);
+			if (existing->second->second.extents == aExtents && existing->second->second.opaque == aOpaque)
+				return &existing->second->second;
+			if (existing->second->second.pinned != 0)
+				return nullptr;
+			erase(existing->second);
+		}
+		auto const required = bytes(aExtents);
+		if (required > aBudget)
+			return nullptr;
+		while (iBytes + required > aBudget)
+		{
+			// layers being rendered into can't be evicted
+			auto victim = std::find_if(iLayers.rbegin(), iLayers.rend(), [](const layer_list::value_type& aEntry) { return aEntry.second.pinned == 0; });
+			if (victim == iLayers.rend())
+				return nullptr;
+			erase(std::prev(victim.base()));
+			++iStats.evictions;
+		}
+		iLayers.emplace_front(aOwner, layer{});
+		iIndex[aOwner] = iLayers.begin();
+		create(iLayers.front().second, aExtents, aOpaque);
+		return &iLayers.front().second;
+	}
+
+	void render_layer_cache::release(const void* aOwner)
+	{
+		auto existing = iIndex.find(aOwner);
+		if (existing != iIndex.end() && existing->second->second.pinned == 0)
+			erase(existing->second);
+	}
+
+	void render_layer_cache::invalidate_all()
+	{
+		for (auto& entry : iLayers)
+			entry.second.validArea = rect{};
+	}
+
+	void render_layer_cache::clear()
+	{
+		while (!iLayers.empty())
+			erase(iLayers.begin());
+	}
+
+	void render_layer_cache::hit()
+	{
+		++iStats.hits;
+	}
+
+	void render_layer_cache::rerendered()
+	{
+		++iStats.rerenders;
+	}
+
+	uint64_t render_layer_cache::bytes(const size& aExtents)
+	{
+		// RGBA8 colour plus packed depth/stencil for every sample, and an RGBA8 resolve texture
+		auto const pixels = static_cast<uint64_t>(aExtents.cx) * static_cast<uint64_t>(aExtents.cy);
+		return pixels * SAMPLES * 8u + pixels * 4u;
+	}
+
+	void render_layer_cache::create(layer& aLayer, const size& aExtents, bool aOpaque)
+	{
+		auto& state = opengl_state::current();
+		aLayer.extents = aExtents;
+		aLayer.opaque = aOpaque;
+		aLayer.validArea = rect{};
+		aLayer.pinned = 0;
+		glCheck(glGenFramebuffers(1, &aLayer.frameBuffer));
+		state.bind_framebuffer(GL_FRAMEBUFFER, aLayer.frameBuffer);
+		glCheck(glGenTextures(1, &aLayer.texture));
+		state.bind_texture(GL_TEXTURE_2D_MULTISAMPLE, aLayer.texture);
+		glCheck(glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, SAMPLES, GL_RGBA8, static_cast<GLsizei>(aExtents.cx), static_cast<GLsizei>(aExtents.cy), true));
+		glCheck(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, aLayer.texture, 0));
+		glCheck(glGenRenderbuffers(1, &aLayer.depthStencilBuffer));
+		state.bind_renderbuffer(aLayer.depthStencilBuffer);
+		glCheck(glRenderbufferStorageMultisample(GL_RENDERBUFFER, SAMPLES, GL_DEPTH24_STENCIL8, static_cast<GLsizei>(aExtents.cx), static_cast<GLsizei>(aExtents.cy)));
+		glCheck(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, aLayer.depthStencilBuffer));
+		glCheck(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, aLayer.depthStencilBuffer));
+		glCheck(glGenFramebuffers(1, &aLayer.resolveFrameBuffer));
+		state.bind_framebuffer(GL_FRAMEBUFFER, aLayer.resolveFrameBuffer);
+		glCheck(glGenTextures(1, &aLayer.resolveTexture));
+		state.bind_texture(GL_TEXTURE_2D, aLayer.resolveTexture);
+		glCheck(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, static_cast<GLsizei>(aExtents.cx), static_cast<GLsizei>(aExtents.cy), 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
+		glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+		glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+		glCheck(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, aLayer.resolveTexture, 0));
+		iBytes += bytes(aExtents);
+		++iStats.layers;
+		iStats.bytes += bytes(aExtents);
+	}
+
+	void render_layer_cache::destroy(layer& aLayer)
+	{
+		auto& state = opengl_state::current();
+		glCheck(glDeleteTextures(1, &aLayer.resolveTexture));
+		glCheck(glDeleteFramebuffers(1, &aLayer.resolveFrameBuffer));
+		state.texture_deleted(aLayer.resolveTexture);
+		state.framebuffer_deleted(aLayer.resolveFrameBuffer);
+		glCheck(glDeleteRenderbuffers(1, &aLayer.depthStencilBuffer));
+		glCheck(glDeleteTextures(1, &aLayer.texture));
+		glCheck(glDeleteFramebuffers(1, &aLayer.frameBuffer));
+		state.renderbuffer_deleted(aLayer.depthStencilBuffer);
+		state.texture_deleted(aLayer.texture);
+		state.framebuffer_deleted(aLayer.frameBuffer);
+		iBytes -= bytes(aLayer.extents);
+		--iStats.layers;
+		iStats.bytes -= bytes(aLayer.extents);
+	}
+
+	void render_layer_cache::erase(layer_list::iterator aLayer)
+	{
+		destroy(aLayer->second);
+		iIndex.erase(aLayer->first);
+		iLayers.erase(aLayer);
+	}
+}
@@ -0,0 +1,77 @@
+// render_layer_cache.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <list>
+#include <unordered_map>
+#include <neogfx/core/geometry.hpp>
+#include <neogfx/gfx/i_rendering_engine.hpp>
+#include "opengl.hpp"
+
+namespace neogfx
+{
+	// Offscreen multisample render targets holding the last rendering of a widget subtree, keyed by
+	// owning widget (which releases its layer when destroyed) and evicted least recently used first
+	// when a window's budget is exceeded. Layers are resolved into a texture and composited as a quad;
+	// those of widgets without an opaque background hold premultiplied alpha and are blended.
+	class render_layer_cache
+	{
+	public:
+		static const uint32_t SAMPLES = 4;
+	public:
+		struct layer
+		{
+			GLuint frameBuffer;
+			GLuint texture;
+			GLuint depthStencilBuffer;
+			GLuint resolveFrameBuffer;
+			GLuint resolveTexture;
+			size extents;
+			bool opaque;
+			rect validArea;
+			uint32_t pinned;
+		};
+	private:
+		typedef std::list<std::pair<const void*, layer>> layer_list;
+		typedef std::unordered_map<const void*, layer_list::iterator> layer_index;
+	public:
+		render_layer_cache(render_layer_statistics& aStats);
+	public:
+		bool has_layer(const void* aOwner) const;
+		layer* acquire(const void* aOwner, const size& aExtents, bool aOpaque, uint64_t aBudget);
+		void release(const void* aOwner);
+		void invalidate_all();
+		void clear();
+		void hit();
+		void rerendered();
+	public:
+		static uint64_t bytes(const size& aExtents);
+	private:
+		void create(layer& aLayer, const size& aExtents, bool aOpaque);
+		void destroy(layer& aLayer);
+		void erase(layer_list::iterator aLayer);
+	private:
+		render_layer_statistics& iStats;
+		layer_list iLayers;
+		layer_index iIndex;
+		uint64_t iBytes;
+	};
+}
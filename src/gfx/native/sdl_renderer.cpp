@@ -22,6 +22,7 @@
 #include <neolib/raii.hpp>
 #include <neogfx/app/app.hpp>
 #include <neogfx/hid/surface_manager.hpp>
+#include <neogfx/gfx/image_loader.hpp>
 #include "../../gui/window/native/sdl_window.hpp"
 #include "sdl_renderer.hpp"
 
@@ -49,11 +50,12 @@ namespace neogfx
 		opengl_renderer(aRenderer),
 		iDoubleBuffering(aDoubleBufferedWindows),
 		iBasicServices(aBasicServices), iKeyboard(aKeyboard), iCreatingWindow(0), 
-		iContext(nullptr), iActiveContextSurface(nullptr)
+		iContext(nullptr), iActiveContextSurface(nullptr), iWakeEventType(0)
 	{
 		SDL_AddEventWatch(&filter_event, this);
 
 		sdl_instance::instantiate();
+		iWakeEventType = SDL_RegisterEvents(1);
 		SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, aDoubleBufferedWindows ? 1 : 0);
 		switch (aRenderer)
 		{
@@ -85,6 +87,7 @@ namespace neogfx
 			throw failed_to_create_system_cache_window(SDL_GetError());
 		iContext = create_context(iSystemCacheWindowHandle);
 		SDL_GL_MakeCurrent(static_cast<SDL_Window*>(iSystemCacheWindowHandle), iContext);
+		state().make_current();
 		glCheck(glewInit());
 	}
 
@@ -106,7 +109,10 @@ namespace neogfx
 	void sdl_renderer::activate_context(const i_native_surface& aSurface)
 	{
 		if (iContext == nullptr)
+		{
 			iContext = create_context(aSurface);
+			state().reset();
+		}
 		else
 		{
 			if (SDL_GL_MakeCurrent(static_cast<SDL_Window*>(aSurface.handle()), static_cast<SDL_GLContext>(iContext)) == -1)
@@ -195,6 +201,7 @@ namespace neogfx
 
 	void sdl_renderer::render_now()
 	{
+		image_loader::instance().upload_textures();
 		app::instance().surface_manager().render_surfaces();
 	}
 
@@ -215,6 +222,42 @@ namespace neogfx
 			return false;
 	}
 
+	void sdl_renderer::wake()
+	{
+		// SDL_PushEvent is thread safe; the event itself carries nothing, it only makes the event loop return.
+		if (iWakeEventType == static_cast<uint32_t>(-1))
+			return;
+		SDL_Event event = {};
+		event.type = iWakeEventType;
+		SDL_PushEvent(&event);
+	}
+
+	uint32_t sdl_renderer::display_index(const i_native_surface& aSurface) const
+	{
+		auto index = SDL_GetWindowDisplayIndex(static_cast<SDL_Window*>(aSurface.handle()));
+		return index >= 0 ? static_cast<uint32_t>(index) : 0u;
+	}
+
+	double sdl_renderer::display_refresh_rate(uint32_t aDisplayIndex) const
+	{
+		SDL_DisplayMode mode;
+		if (SDL_GetCurrentDisplayMode(static_cast<int>(aDisplayIndex), &mode) == 0 && mode.refresh_rate > 0)
+			return static_cast<double>(mode.refresh_rate);
+		return 60.0;
+	}
+
+	void sdl_renderer::wait_for_events(const boost::optional<std::chrono::microseconds>& aTimeout)
+	{
+		// returns early on any native event, including those pushed by wake()
+		if (aTimeout == boost::none)
+		{
+			SDL_WaitEvent(NULL);
+			return;
+		}
+		auto const ms = static_cast<int>((aTimeout->count() + 999) / 1000);
+		SDL_WaitEventTimeout(NULL, ms);
+	}
+
 	sdl_renderer::opengl_context sdl_renderer::create_context(void* aNativeSurfaceHandle)
 	{
 		return SDL_GL_CreateContext(static_cast<SDL_Window*>(aNativeSurfaceHandle));
@@ -318,6 +361,10 @@ namespace neogfx
 						static_cast<sdl_window&>(app::instance().surface_manager().attached_surface(window).native_surface()).process_event(event);
 				}
 				break;
+			case SDL_CLIPBOARDUPDATE:
+				// the system clipboard changed, possibly in another application
+				app::instance().clipboard().updated.trigger();
+				break;
 			default:
 				break;
 			}
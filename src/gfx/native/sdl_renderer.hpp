@@ -56,6 +56,11 @@ namespace neogfx
 		virtual void render_now();
 	public:
 		virtual bool process_events();
+		virtual void wake();
+	public:
+		virtual uint32_t display_index(const i_native_surface& aSurface) const;
+		virtual double display_refresh_rate(uint32_t aDisplayIndex) const;
+		virtual void wait_for_events(const boost::optional<std::chrono::microseconds>& aTimeout);
 	private:
 		opengl_context create_context(void* aNativeSurfaceHandle);
 		static int filter_event(void* aSelf, SDL_Event* aEvent);
@@ -68,5 +73,6 @@ namespace neogfx
 		opengl_context iContext;
 		uint32_t iCreatingWindow;
 		const i_native_surface* iActiveContextSurface;
+		uint32_t iWakeEventType;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,209 @@
+// shader_program_cache.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <boost/filesystem.hpp>
+#include <openssl/sha.h>
+#include "shader_program_cache.hpp"
+
+namespace neogfx
+{
+	namespace
+	{
+		const uint32_t sCacheMagic = 0x4353474Eu; // "NGSC"
+		const uint32_t sCacheVersion = 1u;
+
+		std::string get_shader_cache_directory()
+		{
+#ifdef WIN32
+			const char* localAppData = std::getenv("LOCALAPPDATA");
+			if (localAppData == nullptr)
+				return std::string{};
+			return std::string{ localAppData } + "\\neogfx\\shader_cache";
+#elif defined(__linux__)
+			if (std::getenv("XDG_CACHE_HOME") != nullptr && *std::getenv("XDG_CACHE_HOME") != '\0')
+				return std::string{ std::getenv("XDG_CACHE_HOME") } + "/neogfx/shader_cache";
+			if (std::getenv("HOME") != nullptr)
+				return std::string{ std::getenv("HOME") } + "/.cache/neogfx/shader_cache";
+			return std::string{};
+#else
+			return std::string{};
+#endif
+		}
+
+		std::string gl_string(GLenum aName)
+		{
+			auto s = glGetString(aName);
+			return s != nullptr ? std::string{ reinterpret_cast<const char*>(s) } : std::string{};
+		}
+
+		template <typename T>
+		void write_value(std::ostream& aStream, const T& aValue)
+		{
+			aStream.write(reinterpret_cast<const char*>(&aValue), sizeof(T));
+		}
+
+		template <typename T>
+		bool read_value(std::istream& aStream, T& aValue)
+		{
+			aStream.read(reinterpret_cast<char*>(&aValue), sizeof(T));
+			return !!aStream;
+		}
+	}
+
+	shader_program_cache::shader_program_cache() :
+		iDirectory{ get_shader_cache_directory() }, iEnabled{ false }, iStats{}
+	{
+		iDriver = gl_string(GL_VENDOR) + '\n' + gl_string(GL_RENDERER) + '\n' + gl_string(GL_VERSION) + '\n' + gl_string(GL_SHADING_LANGUAGE_VERSION);
+		if (!iDirectory.empty() && (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary))
+		{
+			GLint formats = 0;
+			glCheck(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+			iEnabled = (formats > 0);
+		}
+	}
+
+	bool shader_program_cache::enabled() const
+	{
+		return iEnabled;
+	}
+
+	const std::string& shader_program_cache::directory() const
+	{
+		return iDirectory;
+	}
+
+	shader_program_cache::key_type shader_program_cache::key(const shaders& aShaders, const std::vector<std::string>& aVariables) const
+	{
+		std::ostringstream input;
+		input << iDriver << '\0';
+		for (auto const& s : aShaders)
+			input << s.second << '\0' << s.first << '\0';
+		for (auto const& v : aVariables)
+			input << v << '\0';
+		auto const data = input.str();
+		unsigned char digest[SHA256_DIGEST_LENGTH];
+		SHA256(reinterpret_cast<const unsigned char*>(data.data()), data.size(), digest);
+		std::ostringstream result;
+		result << std::hex << std::setfill('0');
+		for (auto b : digest)
+			result << std::setw(2) << static_cast<uint32_t>(b);
+		return result.str();
+	}
+
+	bool shader_program_cache::load(const key_type& aKey, GLuint aProgram)
+	{
+		if (!iEnabled)
+			return false;
+		auto const start = std::chrono::steady_clock::now();
+		std::ifstream input{ path(aKey), std::ios::in | std::ios::binary };
+		uint32_t magic = 0u;
+		uint32_t version = 0u;
+		GLenum format = 0;
+		uint32_t length = 0u;
+		if (!input || !read_value(input, magic) || magic != sCacheMagic || !read_value(input, version) || version != sCacheVersion ||
+			!read_value(input, format) || !read_value(input, length) || length == 0u)
+		{
+			++iStats.misses;
+			return false;
+		}
+		std::vector<char> binary(length);
+		if (!input.read(&binary[0], length))
+		{
+			++iStats.misses;
+			return false;
+		}
+		// a binary from another driver version is an expected failure (GL_INVALID_ENUM for a format no longer
+		// supported) so it is not checked; any error it raised is cleared before falling back to compiling
+		glProgramBinary(aProgram, format, &binary[0], static_cast<GLsizei>(length));
+		bool rejected = false;
+		while (glGetError() != GL_NO_ERROR)
+			rejected = true;
+		GLint result = GL_FALSE;
+		if (!rejected)
+		{
+			glCheck(glGetProgramiv(aProgram, GL_LINK_STATUS, &result));
+		}
+		if (GL_FALSE == result)
+		{
+			++iStats.misses;
+			++iStats.rejected;
+			boost::system::error_code ec;
+			boost::filesystem::remove(path(aKey), ec);
+			return false;
+		}
+		++iStats.hits;
+		iStats.loadTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+		return true;
+	}
+
+	void shader_program_cache::store(const key_type& aKey, GLuint aProgram)
+	{
+		if (!iEnabled)
+			return;
+		GLint length = 0;
+		glCheck(glGetProgramiv(aProgram, GL_PROGRAM_BINARY_LENGTH, &length));
+		if (length <= 0)
+			return;
+		std::vector<char> binary(static_cast<std::size_t>(length));
+		GLenum format = 0;
+		GLsizei written = 0;
+		glCheck(glGetProgramBinary(aProgram, length, &written, &format, &binary[0]));
+		if (written <= 0)
+			return;
+		boost::system::error_code ec;
+		boost::filesystem::create_directories(iDirectory, ec);
+		std::string const finalPath = path(aKey);
+		std::string const tempPath = finalPath + ".tmp";
+		{
+			std::ofstream output{ tempPath, std::ios::out | std::ios::binary | std::ios::trunc };
+			if (!output)
+				return;
+			write_value(output, sCacheMagic);
+			write_value(output, sCacheVersion);
+			write_value(output, format);
+			write_value(output, static_cast<uint32_t>(written));
+			output.write(&binary[0], written);
+			if (!output)
+				return;
+		}
+		boost::filesystem::rename(tempPath, finalPath, ec);
+		if (ec)
+			boost::filesystem::remove(tempPath, ec);
+	}
+
+	void shader_program_cache::compiled(std::chrono::microseconds aCompileTime)
+	{
+		iStats.compileTime += aCompileTime;
+	}
+
+	const shader_program_cache_statistics& shader_program_cache::stats() const
+	{
+		return iStats;
+	}
+
+	std::string shader_program_cache::path(const key_type& aKey) const
+	{
+		return (boost::filesystem::path{ iDirectory } / (aKey + ".bin")).string();
+	}
+}
@@ -0,0 +1,57 @@
+// shader_program_cache.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "opengl.hpp"
+#include <neogfx/gfx/i_rendering_engine.hpp>
+
+namespace neogfx
+{
+	// Linked program binaries keyed by final shader source and driver identity; a binary the driver
+	// rejects (e.g. after a driver update) is treated as a miss and the program is compiled as normal.
+	class shader_program_cache
+	{
+	public:
+		typedef std::vector<std::pair<std::string, GLenum>> shaders;
+		typedef std::string key_type;
+	public:
+		shader_program_cache();
+	public:
+		bool enabled() const;
+		const std::string& directory() const;
+		key_type key(const shaders& aShaders, const std::vector<std::string>& aVariables) const;
+		bool load(const key_type& aKey, GLuint aProgram);
+		void store(const key_type& aKey, GLuint aProgram);
+		void compiled(std::chrono::microseconds aCompileTime);
+	public:
+		const shader_program_cache_statistics& stats() const;
+	private:
+		std::string path(const key_type& aKey) const;
+	private:
+		std::string iDirectory;
+		std::string iDriver;
+		bool iEnabled;
+		shader_program_cache_statistics iStats;
+	};
+}
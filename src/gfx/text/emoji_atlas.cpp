@@ -19,73 +19,93 @@
 
 #include <neogfx/neogfx.hpp>
 #include <sstream>
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
-#include <boost/filesystem.hpp>
-#include <neolib/string_utils.hpp>
+#include <fstream>
+#include <algorithm>
 #include <neolib/file.hpp>
-#include <neolib/zip.hpp>
 #include <neogfx/gfx/image.hpp>
+#include <neogfx/app/resource.hpp>
+#include <neogfx/app/resource_manager.hpp>
 #include <neogfx/gfx/text/emoji_atlas.hpp>
+#include "../../app/mapped_zip_archive.hpp"
+#include "emoji_index.hpp"
 
 namespace neogfx
 {
-	emoji_atlas::emoji_atlas(i_texture_manager& aTextureManager) : 
-		kFilePath{ neolib::program_directory() + "/emoji.zip" },
-		iTextureAtlas{ aTextureManager.create_texture_atlas(size{ 1024.0, 1024.0}) }
+	namespace
 	{
-		try
+		const char32_t ZERO_WIDTH_JOINER = 0x200D;
+		const char32_t EMOJI_PRESENTATION_SELECTOR = 0xFE0F;
+
+		inline bool is_joiner(char32_t aCodePoint)
 		{
-			neolib::zip zipFile(kFilePath);
-			std::istringstream metaDataFile{ zipFile.extract_to_string(zipFile.index_of("meta.json")) };
-			boost::property_tree::ptree metaData;
-			boost::property_tree::read_json(metaDataFile, metaData);
-			for (auto const& set : metaData.get_child("sets"))
-			{
-				dimension size = set.second.get<dimension>("size");
-				std::string location = set.second.get<std::string>("location");
-				for (std::size_t i = 0; i < zipFile.file_count(); ++i)
-				{
-					auto const& filePath = zipFile.file_path(i);
-					if (filePath.find(location) == 0)
-					{
-						std::u32string codePoints;
-						std::vector<std::string> hexCodePoints;
-						neolib::tokens(boost::filesystem::path(filePath).stem().string(), std::string("-"), hexCodePoints);
-						for (auto const& hexCodePoint : hexCodePoints)
-						{
-							std::stringstream ss;
-							ss << std::hex << hexCodePoint;
-							uint32_t x;
-							ss >> x;
-							if (x < 256)
-								break;
-							codePoints.push_back(x);
-						}
-						if (!codePoints.empty())
-						{
-							iEmojis[codePoints][size] = filePath;
-							iEmojiMap[codePoints] = boost::optional<emoji_id>{};
-						}
-					}
-				}
-			}
+			return aCodePoint == ZERO_WIDTH_JOINER || aCodePoint == EMOJI_PRESENTATION_SELECTOR;
 		}
-		catch (...)
+
+		// emoji file names (and so our keys) omit the joiners and selectors that appear in text
+		std::u32string strip_joiners(const std::u32string& aCodePoints)
 		{
+			std::u32string result;
+			result.reserve(aCodePoints.size());
+			for (auto codePoint : aCodePoints)
+				if (!is_joiner(codePoint))
+					result += codePoint;
+			return result;
 		}
 	}
 
+	emoji_atlas::emoji_atlas(i_texture_manager& aTextureManager) : 
+		kFilePath{ neolib::program_directory() + "/emoji.zip" },
+		iTextureManager{ aTextureManager },
+		iLoaded{ false }
+	{
+	}
+
+	emoji_atlas::~emoji_atlas()
+	{
+	}
+
 	bool emoji_atlas::is_emoji(char32_t aCodePoint) const
 	{
-		std::u32string str;
-		str += aCodePoint;
-		return is_emoji(str);
+		if (!iLoaded)
+			load();
+		auto page = static_cast<uint32_t>(aCodePoint) >> 8u;
+		if (page >= iSingleEmojiPages.size())
+			return false;
+		auto const& block = iSingleEmojiBlocks[iSingleEmojiPages[page]];
+		return ((block[(aCodePoint & 0xFFu) >> 6u] >> (aCodePoint & 0x3Fu)) & 1u) != 0u;
 	}
 
 	bool emoji_atlas::is_emoji(const std::u32string& aCodePoints) const
 	{
-		return iEmojiMap.find(aCodePoints) != iEmojiMap.end();
+		if (aCodePoints.size() == 1)
+			return is_emoji(aCodePoints[0]);
+		return !aCodePoints.empty() && match_emoji_sequence(aCodePoints.data(), aCodePoints.data() + aCodePoints.size()) == aCodePoints.size();
+	}
+
+	std::size_t emoji_atlas::match_emoji_sequence(const char32_t* aCodePoints, const char32_t* aCodePointsEnd) const
+	{
+		if (!iLoaded)
+			load();
+		if (iSequences.empty())
+			return 0u;
+		std::size_t longestMatch = 0u;
+		uint32_t node = 0u;
+		for (auto next = aCodePoints; next != aCodePointsEnd; ++next)
+		{
+			if (next != aCodePoints && is_joiner(*next))
+			{
+				// step over the joiner but count it as consumed if it directly follows a match
+				if (iSequences[node].terminal && longestMatch == static_cast<std::size_t>(next - aCodePoints))
+					longestMatch = static_cast<std::size_t>(next - aCodePoints) + 1u;
+				continue;
+			}
+			node = find_child(node, *next);
+			if (node == 0u)
+				break;
+			if (iSequences[node].terminal)
+				longestMatch = static_cast<std::size_t>(next - aCodePoints) + 1u;
+		}
+		return longestMatch;
 	}
 
 	emoji_atlas::emoji_id emoji_atlas::emoji(char32_t aCodePoint, dimension aDesiredSize) const
@@ -97,22 +117,119 @@ namespace neogfx
 
 	emoji_atlas::emoji_id emoji_atlas::emoji(const std::u32string& aCodePoints, dimension aDesiredSize) const
 	{
-		auto iterEmoji = iEmojiMap.find(aCodePoints);
-		if (iterEmoji == iEmojiMap.end())
+		if (!iLoaded)
+			load();
+		auto emojiFiles = iEmojis.find(strip_joiners(aCodePoints));
+		if (emojiFiles == iEmojis.end())
 			throw emoji_not_found();
-		if (!iterEmoji->second.is_initialized())
+		auto emojiFile = emojiFiles->second.lower_bound(aDesiredSize);
+		if (emojiFile == emojiFiles->second.end())
+			--emojiFile;
+		if (emojiFile->second.id == boost::none)
 		{
-			auto emojiFiles = iEmojis.find(aCodePoints);
-			auto emojiFile = emojiFiles->second.lower_bound(aDesiredSize);
-			if (emojiFile == emojiFiles->second.end())
-				--emojiFile;
-			iterEmoji->second = iTextureAtlas->create_sub_texture(neogfx::image("file:///" + kFilePath + "#" + emojiFile->second)).atlas_id();
+			auto const& file = iIndex->entries[emojiFile->second.entry].file;
+			std::ostringstream uri;
+			uri << "file:///" << kFilePath << "#" << std::hex << file.localHeaderOffset;
+			i_resource::pointer imageData;
+			if (iArchive->stored(file))
+			{
+				auto const storedData = iArchive->stored_data(file);
+				imageData = std::make_shared<resource>(resource_manager::instance(), uri.str(), storedData.first, storedData.second);
+			}
+			else
+			{
+				mapped_zip_archive::buffer_type buffer;
+				iArchive->extract(file, buffer);
+				imageData = std::make_shared<resource>(resource_manager::instance(), uri.str(), buffer.data(), buffer.size());
+			}
+			if (iTextureAtlas == nullptr)
+				iTextureAtlas = iTextureManager.create_texture_atlas(size{ 1024.0, 1024.0 });
+			emojiFile->second.id = iTextureAtlas->create_sub_texture(neogfx::image{ imageData }).atlas_id();
 		}
-		return *iterEmoji->second;
+		return *emojiFile->second.id;
 	}
 
 	const i_texture& emoji_atlas::emoji_texture(emoji_id aId) const
 	{
 		return iTextureAtlas->sub_texture(aId);
 	}
+
+	void emoji_atlas::load() const
+	{
+		iLoaded = true;
+		try
+		{
+			iArchive = std::make_unique<mapped_zip_archive>(kFilePath);
+			iIndex = std::make_unique<emoji_index::contents>();
+			std::ifstream indexFile{ emoji_index::index_path(kFilePath), std::ios::in | std::ios::binary };
+			if (!indexFile || !emoji_index::read(indexFile, iArchive->size(), iArchive->end_record(), *iIndex))
+			{
+				// no (valid) precomputed index so build one from the archive directory
+				auto metaData = iArchive->index_of("meta.json");
+				if (metaData == boost::none)
+					throw emoji_not_found();
+				*iIndex = emoji_index::build(iArchive->size(), iArchive->end_record(), iArchive->entries(), iArchive->extract_to_string(iArchive->entries()[*metaData]));
+			}
+			for (uint32_t i = 0; i < iIndex->entries.size(); ++i)
+			{
+				auto const& e = iIndex->entries[i];
+				iEmojis[strip_joiners(e.sequence)][iIndex->sets[e.set]] = emoji_file{ i };
+			}
+		}
+		catch (...)
+		{
+			iEmojis.clear();
+			iIndex.reset();
+			iArchive.reset();
+		}
+		index_emojis();
+	}
+
+	void emoji_atlas::index_emojis() const
+	{
+		iSingleEmojiPages.assign(0x110000u >> 8u, 0u);
+		iSingleEmojiBlocks.assign(1u, code_point_block{});
+		iSequences.assign(1u, sequence_node{ false });
+		for (auto const& e : iEmojis)
+		{
+			auto const& codePoints = e.first;
+			if (codePoints.size() == 1 && codePoints[0] < 0x110000u)
+			{
+				auto page = static_cast<uint32_t>(codePoints[0]) >> 8u;
+				if (iSingleEmojiPages[page] == 0u)
+				{
+					iSingleEmojiPages[page] = static_cast<uint16_t>(iSingleEmojiBlocks.size());
+					iSingleEmojiBlocks.push_back(code_point_block{});
+				}
+				iSingleEmojiBlocks[iSingleEmojiPages[page]][(codePoints[0] & 0xFFu) >> 6u] |= (1ull << (codePoints[0] & 0x3Fu));
+			}
+			uint32_t node = 0u;
+			for (auto codePoint : codePoints)
+			{
+				auto& children = iSequences[node].children;
+				auto child = std::lower_bound(children.begin(), children.end(), codePoint,
+					[](const std::pair<char32_t, uint32_t>& aChild, char32_t aCodePoint) { return aChild.first < aCodePoint; });
+				if (child != children.end() && child->first == codePoint)
+					node = child->second;
+				else
+				{
+					auto newNode = static_cast<uint32_t>(iSequences.size());
+					children.insert(child, std::make_pair(codePoint, newNode));
+					iSequences.push_back(sequence_node{ false });
+					node = newNode;
+				}
+			}
+			iSequences[node].terminal = true;
+		}
+	}
+
+	uint32_t emoji_atlas::find_child(uint32_t aNode, char32_t aCodePoint) const
+	{
+		auto const& children = iSequences[aNode].children;
+		auto child = std::lower_bound(children.begin(), children.end(), aCodePoint,
+			[](const std::pair<char32_t, uint32_t>& aChild, char32_t aCodePoint) { return aChild.first < aCodePoint; });
+		if (child != children.end() && child->first == aCodePoint)
+			return child->second;
+		return 0u;
+	}
 }
\ No newline at end of file
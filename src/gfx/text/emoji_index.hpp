@@ -0,0 +1,187 @@
+// emoji_index.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <istream>
+#include <ostream>
+#include <algorithm>
+#include <boost/filesystem/path.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include "../../app/zip_directory.hpp"
+
+namespace neogfx
+{
+	// Binary index of an emoji archive (emoji.zip): code point sequence to set (size bucket) and
+	// archive entry. Written next to the archive by the resource compiler (nrc -emoji) so that the
+	// archive's directory and meta.json need not be parsed at run time.
+	namespace emoji_index
+	{
+		const uint32_t Magic = 0x49454E47u; // "NGEI"
+		const uint32_t Version = 1u;
+
+		struct entry
+		{
+			std::u32string sequence;
+			uint32_t set;
+			zip_entry file;
+		};
+
+		struct contents
+		{
+			uint64_t archiveSize;
+			uint32_t directoryOffset;
+			std::vector<double> sets;
+			std::vector<entry> entries;
+		};
+
+		inline std::string index_path(const std::string& aArchivePath)
+		{
+			return boost::filesystem::path(aArchivePath).replace_extension(".idx").string();
+		}
+
+		inline bool parse_sequence(const std::string& aFilePath, std::u32string& aSequence)
+		{
+			aSequence.clear();
+			std::istringstream stem{ boost::filesystem::path(aFilePath).stem().string() };
+			std::string hexCodePoint;
+			while (std::getline(stem, hexCodePoint, '-'))
+			{
+				uint32_t x = 0u;
+				std::istringstream{ hexCodePoint } >> std::hex >> x;
+				if (x < 256)
+					break;
+				aSequence.push_back(static_cast<char32_t>(x));
+			}
+			return !aSequence.empty();
+		}
+
+		inline contents build(uint64_t aArchiveSize, const zip_end_record& aEndRecord, const zip_entry_list& aEntries, const std::string& aMetaData)
+		{
+			contents result{ aArchiveSize, aEndRecord.directoryOffset };
+			std::istringstream metaDataFile{ aMetaData };
+			boost::property_tree::ptree metaData;
+			boost::property_tree::read_json(metaDataFile, metaData);
+			for (auto const& set : metaData.get_child("sets"))
+			{
+				auto const setIndex = static_cast<uint32_t>(result.sets.size());
+				result.sets.push_back(set.second.get<double>("size"));
+				std::string location = set.second.get<std::string>("location");
+				for (auto const& file : aEntries)
+				{
+					entry e{ std::u32string{}, setIndex, file };
+					if (file.path.find(location) == 0 && parse_sequence(file.path, e.sequence))
+					{
+						e.file.path.clear();
+						result.entries.push_back(std::move(e));
+					}
+				}
+			}
+			std::sort(result.entries.begin(), result.entries.end(), [](const entry& aLhs, const entry& aRhs)
+			{
+				return aLhs.sequence < aRhs.sequence || (aLhs.sequence == aRhs.sequence && aLhs.set < aRhs.set);
+			});
+			return result;
+		}
+
+		template <typename T>
+		inline void write_value(std::ostream& aStream, T aValue)
+		{
+			aStream.write(reinterpret_cast<const char*>(&aValue), sizeof(T));
+		}
+
+		template <typename T>
+		inline bool read_value(std::istream& aStream, T& aValue)
+		{
+			return !!aStream.read(reinterpret_cast<char*>(&aValue), sizeof(T));
+		}
+
+		inline void write(std::ostream& aStream, const contents& aContents)
+		{
+			write_value(aStream, Magic);
+			write_value(aStream, Version);
+			write_value(aStream, aContents.archiveSize);
+			write_value(aStream, aContents.directoryOffset);
+			write_value(aStream, static_cast<uint32_t>(aContents.sets.size()));
+			for (auto size : aContents.sets)
+				write_value(aStream, size);
+			write_value(aStream, static_cast<uint32_t>(aContents.entries.size()));
+			for (auto const& e : aContents.entries)
+			{
+				write_value(aStream, static_cast<uint8_t>(e.sequence.size()));
+				for (auto codePoint : e.sequence)
+					write_value(aStream, static_cast<uint32_t>(codePoint));
+				write_value(aStream, static_cast<uint8_t>(e.set));
+				write_value(aStream, e.file.method);
+				write_value(aStream, e.file.crc);
+				write_value(aStream, e.file.compressedSize);
+				write_value(aStream, e.file.uncompressedSize);
+				write_value(aStream, e.file.localHeaderOffset);
+			}
+		}
+
+		// Returns false if the stream is not a valid index for an archive with the given stamp.
+		inline bool read(std::istream& aStream, uint64_t aArchiveSize, const zip_end_record& aEndRecord, contents& aContents)
+		{
+			uint32_t magic, version, setCount, entryCount;
+			if (!read_value(aStream, magic) || magic != Magic || !read_value(aStream, version) || version != Version)
+				return false;
+			if (!read_value(aStream, aContents.archiveSize) || aContents.archiveSize != aArchiveSize ||
+				!read_value(aStream, aContents.directoryOffset) || aContents.directoryOffset != aEndRecord.directoryOffset)
+				return false;
+			if (!read_value(aStream, setCount) || setCount > 0xFFu)
+				return false;
+			aContents.sets.resize(setCount);
+			for (auto& size : aContents.sets)
+				if (!read_value(aStream, size))
+					return false;
+			if (!read_value(aStream, entryCount))
+				return false;
+			aContents.entries.clear();
+			aContents.entries.reserve(entryCount);
+			for (uint32_t i = 0; i < entryCount; ++i)
+			{
+				entry e{};
+				uint8_t length, set;
+				if (!read_value(aStream, length))
+					return false;
+				for (uint8_t j = 0; j < length; ++j)
+				{
+					uint32_t codePoint;
+					if (!read_value(aStream, codePoint))
+						return false;
+					e.sequence.push_back(static_cast<char32_t>(codePoint));
+				}
+				if (!read_value(aStream, set) || set >= setCount)
+					return false;
+				e.set = set;
+				if (!read_value(aStream, e.file.method) || !read_value(aStream, e.file.crc) || !read_value(aStream, e.file.compressedSize) ||
+					!read_value(aStream, e.file.uncompressedSize) || !read_value(aStream, e.file.localHeaderOffset))
+					return false;
+				aContents.entries.push_back(std::move(e));
+			}
+			return true;
+		}
+	}
+}
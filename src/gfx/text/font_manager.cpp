@@ -18,6 +18,7 @@
 */
 
 #include <neogfx/neogfx.hpp>
+#include <cstdlib>
 #include <neolib/string_utils.hpp>
 #include <boost/filesystem.hpp>
 #include <ft2build.h>
@@ -27,6 +28,7 @@
 #include <neogfx/gfx/text/font_manager.hpp>
 #include "../../gfx/text/native/native_font_face.hpp"
 #include "../../gfx/text/native/native_font.hpp"
+#include "../../gfx/text/native/font_catalog.hpp"
 
 namespace neogfx
 {
@@ -61,6 +63,8 @@ namespace neogfx
 			void update_handle(void* aHandle) override { iFontFace.update_handle(aHandle); }
 			void* aux_handle() const override { return iFontFace.aux_handle(); }
 			uint32_t glyph_index(char32_t aCodePoint) const override { return iFontFace.glyph_index(aCodePoint); }
+			bool has_glyph(char32_t aCodePoint) const override { return iFontFace.has_glyph(aCodePoint); }
+			uint32_t fallback_level(char32_t aCodePoint) const override { return iFontFace.fallback_level(aCodePoint); }
 			i_glyph_texture& glyph_texture(const glyph& aGlyph) const override { return iFontFace.glyph_texture(aGlyph); }
 		public:
 			void add_ref() override { iFontFace.add_ref(); }
@@ -95,21 +99,68 @@ namespace neogfx
 					::RegCloseKey(hkeyDefaultFont);
 				}
 				return font_info(neolib::utf16_to_utf8(reinterpret_cast<const char16_t*>(defaultFontFaceName.c_str())), font::Normal, 8);
+#elif defined(__linux__)
+				return font_info("DejaVu Sans", font::Normal, 8);
 #else
 				throw std::logic_error("neogfx::detail::platform_specific::default_system_font_info: Unknown system");
 #endif
 			}
 
-			std::string get_system_font_directory()
+			std::vector<std::string> get_system_font_directories()
 			{
 #ifdef WIN32
 				std::string windowsDirectory;
 				windowsDirectory.resize(MAX_PATH);
 				GetWindowsDirectoryA(&windowsDirectory[0], windowsDirectory.size());
 				windowsDirectory.resize(std::strlen(windowsDirectory.c_str()));
-				return windowsDirectory + "\\fonts";
+				return std::vector<std::string>{ windowsDirectory + "\\fonts" };
+#elif defined(__linux__)
+				std::vector<std::string> result;
+				std::string home = std::getenv("HOME") != nullptr ? std::getenv("HOME") : "";
+				std::string dataHome = std::getenv("XDG_DATA_HOME") != nullptr && *std::getenv("XDG_DATA_HOME") != '\0' ? 
+					std::getenv("XDG_DATA_HOME") : home.empty() ? "" : home + "/.local/share";
+				if (!dataHome.empty())
+					result.push_back(dataHome + "/fonts");
+				if (!home.empty())
+					result.push_back(home + "/.fonts");
+				std::string dataDirs = std::getenv("XDG_DATA_DIRS") != nullptr && *std::getenv("XDG_DATA_DIRS") != '\0' ?
+					std::getenv("XDG_DATA_DIRS") : "/usr/local/share:/usr/share";
+				std::vector<std::string> dataDirList;
+				neolib::tokens(dataDirs, std::string(":"), dataDirList);
+				for (const auto& dataDir : dataDirList)
+					result.push_back(dataDir + "/fonts");
+				if (std::find(result.begin(), result.end(), "/usr/share/fonts") == result.end())
+					result.push_back("/usr/share/fonts");
+				return result;
 #else
-				throw std::logic_error("neogfx::detail::platform_specific::get_system_font_directory: Unknown system");
+				throw std::logic_error("neogfx::detail::platform_specific::get_system_font_directories: Unknown system");
+#endif
+			}
+
+			bool system_font_directories_recursive()
+			{
+#ifdef WIN32
+				return false;
+#else
+				return true;
+#endif
+			}
+
+			std::string get_font_catalog_path()
+			{
+#ifdef WIN32
+				const char* localAppData = std::getenv("LOCALAPPDATA");
+				if (localAppData == nullptr)
+					return std::string{};
+				return std::string{ localAppData } + "\\neogfx\\font_catalog.bin";
+#elif defined(__linux__)
+				if (std::getenv("XDG_CACHE_HOME") != nullptr && *std::getenv("XDG_CACHE_HOME") != '\0')
+					return std::string{ std::getenv("XDG_CACHE_HOME") } + "/neogfx/font_catalog.bin";
+				if (std::getenv("HOME") != nullptr)
+					return std::string{ std::getenv("HOME") } + "/.cache/neogfx/font_catalog.bin";
+				return std::string{};
+#else
+				return std::string{};
 #endif
 			}
 
@@ -117,6 +168,8 @@ namespace neogfx
 			{
 #ifdef WIN32
 				return fallback_font_info{ {"Segoe UI Symbol", "Arial Unicode MS" } };
+#elif defined(__linux__)
+				return fallback_font_info{ {"DejaVu Sans", "Noto Sans Symbols", "Noto Sans Symbols2" } };
 #else
 				throw std::logic_error("neogfx::detail::platform_specific::default_fallback_font_info: Unknown system");
 #endif
@@ -153,27 +206,17 @@ namespace neogfx
 		{
 			throw error_initializing_font_library();
 		}
-		std::string fontsDirectory = detail::platform_specific::get_system_font_directory();
-		for (boost::filesystem::directory_iterator file(fontsDirectory); file != boost::filesystem::directory_iterator(); ++file)
+		font_catalog catalog{ iFontLib, detail::platform_specific::get_font_catalog_path() };
+		catalog.scan(detail::platform_specific::get_system_font_directories(), detail::platform_specific::system_font_directories_recursive());
+		for (const auto& file : catalog.files())
 		{
-			if (!boost::filesystem::is_regular_file(file->status())) 
+			if (file.faces.empty())
 				continue;
-			try
-			{
-				if (is_font_file(file->path().string()))
-				{
-					auto font = iNativeFonts.emplace(iNativeFonts.end(), iRenderingEngine, iFontLib, file->path().string());
-					iFontFamilies[neolib::make_ci_string(font->family_name())].push_back(font);
-				}
-			}
-			catch (native_font::failed_to_load_font&)
-			{
-			}
-			catch (...)
-			{
-				throw;
-			}
+			auto font = iNativeFonts.emplace(iNativeFonts.end(), iRenderingEngine, iFontLib, file);
+			iFontFamilies[neolib::make_ci_string(font->family_name())].push_back(font);
 		}
+		if (catalog.dirty() && !detail::platform_specific::get_font_catalog_path().empty())
+			catalog.save();
 	}
 
 	font_manager::~font_manager()
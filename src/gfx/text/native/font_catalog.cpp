@@ -0,0 +1,265 @@
+// font_catalog.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <fstream>
+#include <algorithm>
+#include <cctype>
+#include <boost/filesystem.hpp>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_TRUETYPE_TABLES_H
+#include "font_catalog.hpp"
+
+namespace neogfx
+{
+	namespace
+	{
+		const uint32_t sCatalogMagic = 0x4346474E; // "NGFC"
+		const uint32_t sCatalogVersion = 2u;
+
+		template <typename T>
+		void write_value(std::ostream& aStream, const T& aValue)
+		{
+			aStream.write(reinterpret_cast<const char*>(&aValue), sizeof(T));
+		}
+
+		void write_string(std::ostream& aStream, const std::string& aValue)
+		{
+			write_value(aStream, static_cast<uint32_t>(aValue.size()));
+			aStream.write(aValue.data(), aValue.size());
+		}
+
+		template <typename T>
+		T read_value(std::istream& aStream)
+		{
+			T value;
+			if (!aStream.read(reinterpret_cast<char*>(&value), sizeof(T)))
+				throw font_catalog::bad_catalog_file();
+			return value;
+		}
+
+		std::string read_string(std::istream& aStream)
+		{
+			auto length = read_value<uint32_t>(aStream);
+			if (length > 0x10000u)
+				throw font_catalog::bad_catalog_file();
+			std::string value(length, '\0');
+			if (length != 0 && !aStream.read(&value[0], length))
+				throw font_catalog::bad_catalog_file();
+			return value;
+		}
+	}
+
+	font_catalog::font_catalog(FT_Library aFontLib, const std::string& aCatalogPath) :
+		iFontLib{ aFontLib }, iCatalogPath{ aCatalogPath }, iDirty{ false }, iFilesScanned{ 0u }, iFilesReused{ 0u }
+	{
+		try
+		{
+			load();
+		}
+		catch (...)
+		{
+			iFiles.clear();
+			iIndex.clear();
+			iDirty = true;
+		}
+	}
+
+	const font_catalog::file_list& font_catalog::files() const
+	{
+		return iFiles;
+	}
+
+	void font_catalog::scan(const std::vector<std::string>& aDirectories, bool aRecursive)
+	{
+		file_list previousFiles;
+		previousFiles.swap(iFiles);
+		file_index previousIndex;
+		previousIndex.swap(iIndex);
+		auto consider = [&](const boost::filesystem::path& aPath)
+		{
+			boost::system::error_code ec;
+			if (!is_font_file_name(aPath.string()) || !boost::filesystem::is_regular_file(aPath, ec))
+				return;
+			auto path = aPath.string();
+			if (iIndex.find(path) != iIndex.end())
+				return;
+			int64_t modified = static_cast<int64_t>(boost::filesystem::last_write_time(aPath, ec));
+			if (ec)
+				return;
+			uint64_t size = static_cast<uint64_t>(boost::filesystem::file_size(aPath, ec));
+			if (ec)
+				return;
+			auto existing = previousIndex.find(path);
+			if (existing != previousIndex.end() && previousFiles[existing->second].modified == modified && previousFiles[existing->second].size == size)
+			{
+				iIndex[path] = iFiles.size();
+				iFiles.push_back(std::move(previousFiles[existing->second]));
+				++iFilesReused;
+			}
+			else
+				scan_file(path, modified, size);
+		};
+		for (const auto& directory : aDirectories)
+		{
+			boost::system::error_code ec;
+			if (!boost::filesystem::is_directory(directory, ec))
+				continue;
+			if (aRecursive)
+			{
+				for (boost::filesystem::recursive_directory_iterator file(directory, boost::filesystem::symlink_option::follow_directory_symlink, ec), end; !ec && file != end; file.increment(ec))
+					consider(file->path());
+			}
+			else
+			{
+				for (boost::filesystem::directory_iterator file(directory, ec), end; !ec && file != end; file.increment(ec))
+					consider(file->path());
+			}
+		}
+		if (iFiles.size() != previousFiles.size() || iFilesScanned != 0u)
+			iDirty = true;
+	}
+
+	bool font_catalog::dirty() const
+	{
+		return iDirty;
+	}
+
+	void font_catalog::save() const
+	{
+		boost::system::error_code ec;
+		boost::filesystem::create_directories(boost::filesystem::path(iCatalogPath).parent_path(), ec);
+		std::string tempPath = iCatalogPath + ".tmp";
+		{
+			std::ofstream output{ tempPath, std::ios::out | std::ios::binary | std::ios::trunc };
+			if (!output)
+				return;
+			write_value(output, sCatalogMagic);
+			write_value(output, sCatalogVersion);
+			write_value(output, static_cast<uint32_t>(iFiles.size()));
+			for (const auto& file : iFiles)
+			{
+				write_string(output, file.path);
+				write_value(output, file.modified);
+				write_value(output, file.size);
+				write_value(output, static_cast<uint32_t>(file.faces.size()));
+				for (const auto& face : file.faces)
+				{
+					write_value(output, static_cast<int32_t>(face.faceIndex));
+					write_string(output, face.familyName);
+					write_string(output, face.styleName);
+					write_value(output, static_cast<uint32_t>(face.style));
+					write_value(output, face.weight);
+				}
+			}
+			if (!output)
+				return;
+		}
+		boost::filesystem::rename(tempPath, iCatalogPath, ec);
+		if (ec)
+			boost::filesystem::remove(tempPath, ec);
+	}
+
+	uint32_t font_catalog::files_scanned() const
+	{
+		return iFilesScanned;
+	}
+
+	uint32_t font_catalog::files_reused() const
+	{
+		return iFilesReused;
+	}
+
+	bool font_catalog::is_font_file_name(const std::string& aPath)
+	{
+		auto extension = boost::filesystem::path(aPath).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char aChar) { return static_cast<char>(std::tolower(static_cast<unsigned char>(aChar))); });
+		return extension == ".ttf" || extension == ".otf" || extension == ".ttc" || extension == ".pfb";
+	}
+
+	uint16_t font_catalog::face_weight(FT_Face aFace)
+	{
+		auto os2 = static_cast<const TT_OS2*>(FT_Get_Sfnt_Table(aFace, FT_SFNT_OS2));
+		if (os2 != nullptr && os2->version != 0xFFFFu && os2->usWeightClass != 0u)
+			return os2->usWeightClass;
+		return (aFace->style_flags & FT_STYLE_FLAG_BOLD) ? 700u : 400u;
+	}
+
+	void font_catalog::load()
+	{
+		std::ifstream input{ iCatalogPath, std::ios::in | std::ios::binary };
+		if (!input)
+		{
+			iDirty = true;
+			return;
+		}
+		if (read_value<uint32_t>(input) != sCatalogMagic || read_value<uint32_t>(input) != sCatalogVersion)
+			throw bad_catalog_file();
+		auto fileCount = read_value<uint32_t>(input);
+		iFiles.reserve(fileCount);
+		for (uint32_t i = 0; i < fileCount; ++i)
+		{
+			file_record file;
+			file.path = read_string(input);
+			file.modified = read_value<int64_t>(input);
+			file.size = read_value<uint64_t>(input);
+			auto faceCount = read_value<uint32_t>(input);
+			file.faces.reserve(faceCount);
+			for (uint32_t j = 0; j < faceCount; ++j)
+			{
+				face_record face;
+				face.faceIndex = static_cast<FT_Long>(read_value<int32_t>(input));
+				face.familyName = read_string(input);
+				face.styleName = read_string(input);
+				face.style = static_cast<font::style_e>(read_value<uint32_t>(input));
+				face.weight = read_value<uint16_t>(input);
+				file.faces.push_back(std::move(face));
+			}
+			iIndex[file.path] = iFiles.size();
+			iFiles.push_back(std::move(file));
+		}
+	}
+
+	void font_catalog::scan_file(const std::string& aPath, int64_t aModified, uint64_t aSize)
+	{
+		++iFilesScanned;
+		file_record file{ aPath, aModified, aSize, face_list{} };
+		FT_Long faceCount = 1;
+		for (FT_Long faceIndex = 0; faceIndex < faceCount; ++faceIndex)
+		{
+			FT_Face face;
+			if (FT_New_Face(iFontLib, aPath.c_str(), faceIndex, &face) != 0)
+				break;
+			if (faceIndex == 0)
+				faceCount = face->num_faces;
+			face_record record{ faceIndex, face->family_name != nullptr ? face->family_name : "", face->style_name != nullptr ? face->style_name : "", font::Invalid, face_weight(face) };
+			if (face->style_flags & FT_STYLE_FLAG_ITALIC)
+				record.style = static_cast<font::style_e>(record.style | font::Italic);
+			if (face->style_flags & FT_STYLE_FLAG_BOLD)
+				record.style = static_cast<font::style_e>(record.style | font::Bold);
+			if (record.style == font::Invalid)
+				record.style = font::Normal;
+			FT_Done_Face(face);
+			file.faces.push_back(std::move(record));
+		}
+		iIndex[aPath] = iFiles.size();
+		iFiles.push_back(std::move(file));
+	}
+}
@@ -0,0 +1,81 @@
+// font_catalog.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <vector>
+#include <unordered_map>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <neogfx/gfx/text/font.hpp>
+
+namespace neogfx
+{
+	// Persistent index of the font files found in the system font directories; a file is only
+	// opened (with FreeType) if its stamp (modification time and size) differs from the cached one.
+	class font_catalog
+	{
+	public:
+		struct face_record
+		{
+			FT_Long faceIndex;
+			std::string familyName;
+			std::string styleName;
+			font::style_e style;
+			uint16_t weight;
+		};
+		typedef std::vector<face_record> face_list;
+		struct file_record
+		{
+			std::string path;
+			int64_t modified;
+			uint64_t size;
+			face_list faces; // empty if not a font file
+		};
+		typedef std::vector<file_record> file_list;
+	private:
+		typedef std::unordered_map<std::string, std::size_t> file_index;
+	public:
+		struct bad_catalog_file : std::runtime_error { bad_catalog_file() : std::runtime_error("neogfx::font_catalog::bad_catalog_file") {} };
+	public:
+		font_catalog(FT_Library aFontLib, const std::string& aCatalogPath);
+	public:
+		const file_list& files() const;
+		void scan(const std::vector<std::string>& aDirectories, bool aRecursive);
+		bool dirty() const;
+		void save() const;
+		uint32_t files_scanned() const;
+		uint32_t files_reused() const;
+	public:
+		static bool is_font_file_name(const std::string& aPath);
+		static uint16_t face_weight(FT_Face aFace);
+	private:
+		void load();
+		void scan_file(const std::string& aPath, int64_t aModified, uint64_t aSize);
+	private:
+		FT_Library iFontLib;
+		std::string iCatalogPath;
+		file_list iFiles;
+		file_index iIndex;
+		bool iDirty;
+		uint32_t iFilesScanned;
+		uint32_t iFilesReused;
+	};
+}
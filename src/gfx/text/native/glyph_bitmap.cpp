@@ -0,0 +1,178 @@
+// glyph_bitmap.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <cstring>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NEOGFX_GLYPH_BITMAP_AVX2
+#define NEOGFX_GLYPH_BITMAP_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NEOGFX_GLYPH_BITMAP_SSE2
+#endif
+#include "glyph_bitmap.hpp"
+
+namespace neogfx
+{
+	namespace glyph_bitmap
+	{
+		namespace
+		{
+			// The filter coefficients are exact binary fractions so the original floating point
+			// filter (each tap truncated to an integer) reduces to these shifts.
+			inline uint8_t lcd_tap(uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t e)
+			{
+				return static_cast<uint8_t>(((a * 3u) >> 5u) + ((b * 3u) >> 4u) + ((c * 7u) >> 4u) + ((d * 3u) >> 4u) + ((e * 3u) >> 5u));
+			}
+
+			thread_local std::vector<uint8_t> tPaddedRow;
+			thread_local std::vector<uint8_t> tFilteredRow;
+			thread_local std::vector<uint8_t> tAlphaScratch;
+			thread_local std::vector<subpixel> tSubpixelScratch;
+
+#ifdef NEOGFX_GLYPH_BITMAP_SSE2
+			inline __m128i lcd_taps_sse2(const uint8_t* p)
+			{
+				const __m128i zero = _mm_setzero_si128();
+				__m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), zero);
+				__m128i b = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + 1)), zero);
+				__m128i c = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + 2)), zero);
+				__m128i d = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + 3)), zero);
+				__m128i e = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + 4)), zero);
+				const __m128i three = _mm_set1_epi16(3);
+				const __m128i seven = _mm_set1_epi16(7);
+				__m128i sum = _mm_srli_epi16(_mm_mullo_epi16(a, three), 5);
+				sum = _mm_add_epi16(sum, _mm_srli_epi16(_mm_mullo_epi16(b, three), 4));
+				sum = _mm_add_epi16(sum, _mm_srli_epi16(_mm_mullo_epi16(c, seven), 4));
+				sum = _mm_add_epi16(sum, _mm_srli_epi16(_mm_mullo_epi16(d, three), 4));
+				sum = _mm_add_epi16(sum, _mm_srli_epi16(_mm_mullo_epi16(e, three), 5));
+				return sum;
+			}
+#endif
+
+#ifdef NEOGFX_GLYPH_BITMAP_AVX2
+			inline __m256i lcd_taps_avx2(const uint8_t* p)
+			{
+				__m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+				__m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1)));
+				__m256i c = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 2)));
+				__m256i d = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 3)));
+				__m256i e = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 4)));
+				const __m256i three = _mm256_set1_epi16(3);
+				const __m256i seven = _mm256_set1_epi16(7);
+				__m256i sum = _mm256_srli_epi16(_mm256_mullo_epi16(a, three), 5);
+				sum = _mm256_add_epi16(sum, _mm256_srli_epi16(_mm256_mullo_epi16(b, three), 4));
+				sum = _mm256_add_epi16(sum, _mm256_srli_epi16(_mm256_mullo_epi16(c, seven), 4));
+				sum = _mm256_add_epi16(sum, _mm256_srli_epi16(_mm256_mullo_epi16(d, three), 4));
+				sum = _mm256_add_epi16(sum, _mm256_srli_epi16(_mm256_mullo_epi16(e, three), 5));
+				return sum;
+			}
+#endif
+		}
+
+		std::vector<uint8_t>& alpha_scratch(std::size_t aSize)
+		{
+			tAlphaScratch.assign(aSize, 0u);
+			return tAlphaScratch;
+		}
+
+		std::vector<subpixel>& subpixel_scratch(std::size_t aSize)
+		{
+			tSubpixelScratch.assign(aSize, subpixel{});
+			return tSubpixelScratch;
+		}
+
+		void lcd_filter_row(const uint8_t* aSource, uint8_t* aDestination, uint32_t aWidth)
+		{
+			if (aWidth == 0u)
+				return;
+			// pad both ends with the edge value (clamping) plus slack so vector loads stay in bounds
+			tPaddedRow.resize(aWidth + 4u + 16u);
+			uint8_t* padded = &tPaddedRow[0];
+			padded[0] = padded[1] = aSource[0];
+			std::memcpy(padded + 2u, aSource, aWidth);
+			std::memset(padded + 2u + aWidth, aSource[aWidth - 1u], 2u + 16u);
+			uint32_t x = 0u;
+#ifdef NEOGFX_GLYPH_BITMAP_AVX2
+			for (; x + 16u <= aWidth; x += 16u)
+			{
+				__m256i sum = lcd_taps_avx2(padded + x);
+				__m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(aDestination + x), packed);
+			}
+#endif
+#ifdef NEOGFX_GLYPH_BITMAP_SSE2
+			for (; x + 8u <= aWidth; x += 8u)
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(aDestination + x), _mm_packus_epi16(lcd_taps_sse2(padded + x), _mm_setzero_si128()));
+#endif
+			for (; x < aWidth; ++x)
+				aDestination[x] = lcd_tap(padded[x], padded[x + 1u], padded[x + 2u], padded[x + 3u], padded[x + 4u]);
+		}
+
+		void lcd_filter_row_reference(const uint8_t* aSource, uint8_t* aDestination, uint32_t aWidth)
+		{
+			static const double coefficients[] = { 1.5 / 16.0, 3.0 / 16.0, 7.0 / 16.0, 3.0 / 16.0, 1.5 / 16.0 };
+			for (uint32_t x = 0; x < aWidth; x++)
+			{
+				uint8_t alpha = 0;
+				for (int32_t z = -2; z <= 2; ++z)
+					alpha += static_cast<uint8_t>(aSource[std::max<int32_t>(0, std::min<int32_t>(aWidth - 1, x + z))] * coefficients[z + 2]);
+				aDestination[x] = alpha;
+			}
+		}
+
+		void lcd_to_subpixels(const uint8_t* aSource, int32_t aPitch, uint32_t aWidth, uint32_t aRows, subpixel* aDestination, std::size_t aDestinationStride)
+		{
+			tFilteredRow.resize(aWidth);
+			for (uint32_t y = 0; y < aRows; ++y)
+			{
+				lcd_filter_row(aSource + aPitch * static_cast<int32_t>(y), tFilteredRow.data(), aWidth);
+				const uint8_t* filtered = tFilteredRow.data();
+				subpixel* row = aDestination + y * aDestinationStride;
+				uint32_t const texels = aWidth / 3u;
+				for (uint32_t x = 0; x < texels; ++x, filtered += 3)
+				{
+					row[x][0] = filtered[0];
+					row[x][1] = filtered[1];
+					row[x][2] = filtered[2];
+				}
+				for (uint32_t x = texels * 3u; x < aWidth; ++x)
+					row[x / 3u][x % 3u] = tFilteredRow[x];
+			}
+		}
+
+		void grey_to_alpha(const uint8_t* aSource, int32_t aPitch, uint32_t aWidth, uint32_t aRows, uint8_t* aDestination, std::size_t aDestinationStride)
+		{
+			for (uint32_t y = 0; y < aRows; ++y)
+				std::memcpy(aDestination + y * aDestinationStride, aSource + aPitch * static_cast<int32_t>(y), aWidth);
+		}
+
+		void mono_to_alpha(const uint8_t* aSource, int32_t aPitch, uint32_t aWidth, uint32_t aRows, uint8_t* aDestination, std::size_t aDestinationStride)
+		{
+			for (uint32_t y = 0; y < aRows; ++y)
+			{
+				const uint8_t* source = aSource + aPitch * static_cast<int32_t>(y);
+				uint8_t* destination = aDestination + y * aDestinationStride;
+				for (uint32_t x = 0; x < aWidth; ++x)
+					destination[x] = (source[x >> 3u] & (0x80u >> (x & 7u))) != 0 ? 0xFF : 0x00;
+			}
+		}
+	}
+}
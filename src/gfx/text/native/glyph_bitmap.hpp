@@ -0,0 +1,48 @@
+// glyph_bitmap.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <neogfx/neogfx.hpp>
+#include <array>
+#include <vector>
+
+namespace neogfx
+{
+	// Conversion of FreeType glyph bitmaps into padded atlas texture data. The filter kernels use
+	// SSE2/AVX2 where the compiler targets them and a plain loop otherwise; all paths produce the
+	// same output as the scalar reference.
+	namespace glyph_bitmap
+	{
+		typedef std::array<uint8_t, 4> subpixel;
+
+		// Per-thread scratch buffers reused across glyphs.
+		std::vector<uint8_t>& alpha_scratch(std::size_t aSize);
+		std::vector<subpixel>& subpixel_scratch(std::size_t aSize);
+
+		// 5-tap (1.5, 3, 7, 3, 1.5)/16 FIR filter over one row of LCD subpixels, edges clamped.
+		void lcd_filter_row(const uint8_t* aSource, uint8_t* aDestination, uint32_t aWidth);
+		void lcd_filter_row_reference(const uint8_t* aSource, uint8_t* aDestination, uint32_t aWidth);
+		// Filtered LCD bitmap (width in subpixels) to RGBA texels, one texel per three subpixels.
+		void lcd_to_subpixels(const uint8_t* aSource, int32_t aPitch, uint32_t aWidth, uint32_t aRows, subpixel* aDestination, std::size_t aDestinationStride);
+		// 8-bit grey and 1-bit mono bitmaps to 8-bit alpha.
+		void grey_to_alpha(const uint8_t* aSource, int32_t aPitch, uint32_t aWidth, uint32_t aRows, uint8_t* aDestination, std::size_t aDestinationStride);
+		void mono_to_alpha(const uint8_t* aSource, int32_t aPitch, uint32_t aWidth, uint32_t aRows, uint8_t* aDestination, std::size_t aDestinationStride);
+	}
+}
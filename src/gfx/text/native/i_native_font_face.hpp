@@ -61,6 +61,8 @@ namespace neogfx
 		virtual void update_handle(void* aHandle) = 0;
 		virtual void* aux_handle() const = 0;
 		virtual uint32_t glyph_index(char32_t aCodePoint) const = 0;
+		virtual bool has_glyph(char32_t aCodePoint) const = 0;
+		virtual uint32_t fallback_level(char32_t aCodePoint) const = 0;
 		virtual i_glyph_texture& glyph_texture(const glyph& aGlyph) const = 0;
 	public:
 		virtual void add_ref() = 0;
@@ -18,30 +18,40 @@
 */
 
 #include <neogfx/neogfx.hpp>
-#include <boost/filesystem.hpp>
+#include <cstdlib>
 #include "native_font.hpp"
 #include "native_font_face.hpp"
 
 namespace neogfx
 {
 	native_font::native_font(i_rendering_engine& aRenderingEngine, FT_Library aFontLib, const std::string aFileName) :
-		iRenderingEngine(aRenderingEngine), iFontLib(aFontLib), iSource(filename_type(aFileName)), iCache{}, iFaceCount(0)
+		iRenderingEngine(aRenderingEngine), iFontLib(aFontLib), iSource(filename_type(aFileName)), iFaceCount(0)
 	{
 		register_face(0);
 		for (FT_Long f = 1; f < iFaceCount; ++f)
 			register_face(f);
-		iCache.clear();
-		iCache.shrink_to_fit();
+		unmap();
+	}
+
+	native_font::native_font(i_rendering_engine& aRenderingEngine, FT_Library aFontLib, const font_catalog::file_record& aCatalogEntry) :
+		iRenderingEngine(aRenderingEngine), iFontLib(aFontLib), iSource(filename_type(aCatalogEntry.path)), iFaceCount(static_cast<FT_Long>(aCatalogEntry.faces.size()))
+	{
+		if (aCatalogEntry.faces.empty())
+			throw failed_to_load_font();
+		iFamilyName = aCatalogEntry.faces[0].familyName;
+		for (const auto& face : aCatalogEntry.faces)
+		{
+			iStyleMap.emplace(face.style, std::make_pair(face.styleName, face.faceIndex));
+			iWeights[face.faceIndex] = face.weight;
+		}
 	}
 
 	native_font::native_font(i_rendering_engine& aRenderingEngine, FT_Library aFontLib, const void* aData, std::size_t aSizeInBytes) :
-		iRenderingEngine(aRenderingEngine), iFontLib(aFontLib), iSource(memory_block_type(aData, aSizeInBytes)), iCache{}, iFaceCount(0)
+		iRenderingEngine(aRenderingEngine), iFontLib(aFontLib), iSource(memory_block_type(aData, aSizeInBytes)), iFaceCount(0)
 	{
 		register_face(0);
 		for (FT_Long f = 1; f < iFaceCount; ++f)
 			register_face(f);
-		iCache.clear();
-		iCache.shrink_to_fit();
 	}
 
 	native_font::~native_font()
@@ -98,8 +108,15 @@ namespace neogfx
 			matches.insert(std::make_pair(matching_bits(s.first, aStyle), &s));
 		if (matches.empty())
 			throw no_matching_style_found();
-		FT_Long faceIndex = matches.rbegin()->second->second.second;
-		font::style_e faceStyle = matches.rbegin()->second->first;
+		// of the equally good style matches prefer the face whose weight is nearest the regular or bold weight
+		auto const targetWeight = (aStyle & font::Bold) ? 700 : 400;
+		auto best = matches.rbegin();
+		for (auto m = matches.rbegin(); m != matches.rend() && m->first == matches.rbegin()->first; ++m)
+			if (std::abs(weight(m->second->second.second, m->second->first) - targetWeight) < 
+				std::abs(weight(best->second->second.second, best->second->first) - targetWeight))
+				best = m;
+		FT_Long faceIndex = best->second->second.second;
+		font::style_e faceStyle = best->second->first;
 		return create_face(faceIndex, faceStyle, aSize, aDevice);
 	}
 
@@ -145,10 +162,7 @@ namespace neogfx
 			aFace.update_handle(nullptr);
 		}
 		if (iFaceUsage.empty())
-		{
-			iCache.clear();
-			iCache.shrink_to_fit();
-		}
+			unmap();
 	}
 
 	void native_font::register_face(FT_Long aFaceIndex)
@@ -169,6 +183,7 @@ namespace neogfx
 			if (style == font::Invalid)
 				style = font::Normal;
 			iStyleMap.emplace(style, std::make_pair(face->style_name, aFaceIndex));
+			iWeights[aFaceIndex] = font_catalog::face_weight(face);
 		}
 		catch (...)
 		{
@@ -183,17 +198,21 @@ namespace neogfx
 		FT_Face face;
 		if (iSource.is<filename_type>())
 		{
-			if (iCache.empty())
+			if (!iFileData.is_open())
 			{
-				std::size_t fileSize = static_cast<std::size_t>(boost::filesystem::file_size(static_variant_cast<const filename_type&>(iSource)));
-				iCache.resize(fileSize);
-				std::ifstream file{ static_variant_cast<const filename_type&>(iSource).c_str(), std::ios::in | std::ios::binary };
-				file.read(reinterpret_cast<char*>(&iCache[0]), fileSize);
+				try
+				{
+					iFileData.open(static_variant_cast<const filename_type&>(iSource));
+				}
+				catch (...)
+				{
+					throw failed_to_load_font();
+				}
 			}
 			FT_Error error = FT_New_Memory_Face(
 				iFontLib,
-				static_cast<const FT_Byte*>(&iCache[0]),
-				iCache.size(),
+				reinterpret_cast<const FT_Byte*>(iFileData.data()),
+				static_cast<FT_Long>(iFileData.size()),
 				aFaceIndex,
 				&face);
 			if (error)
@@ -218,6 +237,20 @@ namespace neogfx
 		FT_Done_Face(aFace);
 	}
 
+	uint16_t native_font::weight(FT_Long aFaceIndex, font::style_e aStyle) const
+	{
+		auto w = iWeights.find(aFaceIndex);
+		if (w != iWeights.end())
+			return w->second;
+		return (aStyle & font::Bold) ? 700u : 400u;
+	}
+
+	void native_font::unmap()
+	{
+		if (iFileData.is_open())
+			iFileData.close();
+	}
+
 	i_native_font_face& native_font::create_face(FT_Long aFaceIndex, font::style_e aStyle, font::point_size aSize, const i_device_resolution& aDevice)
 	{
 		auto existingFace = iFaces.find(std::make_tuple(aFaceIndex, aSize, size(aDevice.horizontal_dpi(), aDevice.vertical_dpi())));
@@ -23,10 +23,12 @@
 #include <unordered_map>
 #include <tuple>
 #include <neolib/variant.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include "i_native_font.hpp"
 #include "i_native_font_face.hpp"
+#include "font_catalog.hpp"
 
 namespace neogfx
 {
@@ -40,6 +42,7 @@ namespace neogfx
 	private:
 		typedef neolib::variant<filename_type, memory_block_type> source_type;
 		typedef std::multimap<font::style_e, std::pair<std::string, FT_Long>> style_map;
+		typedef std::map<FT_Long, uint16_t> weight_map;
 		typedef std::map<std::tuple<FT_Long, font::point_size, size>, std::unique_ptr<i_native_font_face>> face_map;
 		typedef std::unordered_map<i_native_font_face*, uint32_t> usage_map;
 	public:
@@ -47,6 +50,7 @@ namespace neogfx
 		struct no_matching_style_found : std::runtime_error { no_matching_style_found() : std::runtime_error("neogfx::native_font::no_matching_style_found") {} };
 	public:
 		native_font(i_rendering_engine& aRenderingEngine, FT_Library aFontLib, const std::string aFileName);
+		native_font(i_rendering_engine& aRenderingEngine, FT_Library aFontLib, const font_catalog::file_record& aCatalogEntry);
 		native_font(i_rendering_engine& aRenderingEngine, FT_Library aFontLib, const void* aData, std::size_t aSizeInBytes);
 		~native_font();
 	public:
@@ -62,17 +66,20 @@ namespace neogfx
 		virtual void release(i_native_font_face& aFace);
 	private:
 		void register_face(FT_Long aFaceIndex);
+		void unmap();
 		FT_Face open_face(FT_Long aFaceIndex);
 		void close_face(FT_Face aFace);
+		uint16_t weight(FT_Long aFaceIndex, font::style_e aStyle) const;
 		i_native_font_face& create_face(FT_Long aFaceIndex, font::style_e aStyle, font::point_size aSize, const i_device_resolution& aDevice);
 	private:
 		i_rendering_engine& iRenderingEngine;
 		FT_Library iFontLib;
 		source_type iSource;
-		std::vector<unsigned char> iCache;
+		boost::iostreams::mapped_file_source iFileData;
 		std::string iFamilyName;
 		FT_Long iFaceCount;
 		style_map iStyleMap;
+		weight_map iWeights;
 		face_map iFaces;
 		usage_map iFaceUsage;
 	};
@@ -27,8 +27,10 @@
 #include FT_BITMAP_H
 #include FT_LCD_FILTER_H
 #include "../../native/opengl.hpp"
+#include "../../native/opengl_state.hpp"
 #include "../../native/i_native_texture.hpp"
 #include "native_font_face.hpp"
+#include "glyph_bitmap.hpp"
 #include <neogfx/gfx/text/glyph.hpp>
 #include <neogfx/gfx/i_rendering_engine.hpp>
 
@@ -76,7 +78,7 @@ namespace neogfx
 	}
 
 	native_font_face::native_font_face(i_rendering_engine& aRenderingEngine, i_native_font& aFont, font::style_e aStyle, font::point_size aSize, neogfx::size aDpiResolution, FT_Face aHandle) :
-		iRenderingEngine(aRenderingEngine), iFont(aFont), iStyle(aStyle), iStyleName(aHandle->style_name), iSize(aSize), iPixelDensityDpi(aDpiResolution), iHandle(aHandle), iHasKerning(!!FT_HAS_KERNING(iHandle))
+		iRenderingEngine(aRenderingEngine), iFont(aFont), iStyle(aStyle), iStyleName(aHandle->style_name), iSize(aSize), iPixelDensityDpi(aDpiResolution), iHandle(aHandle), iHasKerning(!!FT_HAS_KERNING(iHandle)), iCoverageBuilt(false)
 	{
 		set_metrics();
 		sGetAdvanceCache[iHandle] = get_advance_cache_face{};
@@ -241,6 +243,47 @@ namespace neogfx
 		return FT_Get_Char_Index(iHandle, aCodePoint);
 	}
 
+	bool native_font_face::has_glyph(char32_t aCodePoint) const
+	{
+		if (!iCoverageBuilt)
+			build_coverage();
+		auto page = static_cast<uint32_t>(aCodePoint) >> 8u;
+		if (page >= iCoverage.size() || iCoverage[page] == nullptr)
+			return false;
+		return (((*iCoverage[page])[(aCodePoint & 0xFFu) >> 6u] >> (aCodePoint & 0x3Fu)) & 1u) != 0u;
+	}
+
+	uint32_t native_font_face::fallback_level(char32_t aCodePoint) const
+	{
+		if (has_glyph(aCodePoint))
+			return 0u;
+		auto block = iFallbackLevels.find(static_cast<uint32_t>(aCodePoint) >> FallbackBlockBits);
+		if (block == iFallbackLevels.end())
+		{
+			fallback_block levels;
+			char32_t const blockStart = aCodePoint & ~((1u << FallbackBlockBits) - 1u);
+			for (uint32_t i = 0u; i < levels.size(); ++i)
+			{
+				levels[i] = 0u;
+				char32_t codePoint = blockStart + i;
+				if (has_glyph(codePoint))
+					continue;
+				const i_native_font_face* face = this;
+				for (uint32_t level = 1u; level <= MaxFallbackLevel && face->has_fallback(); ++level)
+				{
+					face = &face->fallback();
+					if (face->has_glyph(codePoint))
+					{
+						levels[i] = static_cast<uint8_t>(level);
+						break;
+					}
+				}
+			}
+			block = iFallbackLevels.emplace(static_cast<uint32_t>(aCodePoint) >> FallbackBlockBits, levels).first;
+		}
+		return block->second[aCodePoint & ((1u << FallbackBlockBits) - 1u)];
+	}
+
 	i_glyph_texture& native_font_face::glyph_texture(const glyph& aGlyph) const
 	{
 		auto existingGlyph = iGlyphs.find(std::make_pair(aGlyph.value(), aGlyph.subpixel()));
@@ -278,63 +321,38 @@ namespace neogfx
 					iHandle->glyph->metrics.horiBearingX / 64.0,
 					(iHandle->glyph->metrics.horiBearingY - iHandle->glyph->metrics.height) / 64.0 } })).first->second;
 
-		iGlyphTextureData.clear();
-		iGlyphTextureData.resize(static_cast<std::size_t>(glyphRect.cx * glyphRect.cy));
-		iSubpixelGlyphTextureData.clear();
-		iSubpixelGlyphTextureData.resize(static_cast<std::size_t>(glyphRect.cx * glyphRect.cy));
-
+		std::size_t const textureStride = static_cast<std::size_t>(glyphRect.cx);
+		std::size_t const textureSize = static_cast<std::size_t>(glyphRect.cx * glyphRect.cy);
 		const GLubyte* textureData = 0;
 		
 		if (aGlyph.subpixel())
 		{
-			// sub-pixel FIR filter.
-			static double coefficients[] = { 1.5/16.0, 3.0/16.0, 7.0/16.0, 3.0/16.0, 1.5/16.0 };
-			for (uint32_t y = 0; y < bitmap.rows; y++)
-			{
-				for (uint32_t x = 0; x < bitmap.width; x++)
-				{
-					uint8_t alpha = 0;
-					for (int32_t z = -2; z <= 2; ++z)
-						alpha += static_cast<uint8_t>(bitmap.buffer[std::max(0, std::min<int32_t>(bitmap.width - 1, x + z)) + bitmap.pitch * y] * coefficients[z + 2]);
-					iSubpixelGlyphTextureData[(x / 3 + 1) + (y + 1) * static_cast<std::size_t>(glyphRect.cx)][x % 3] = alpha;
-				}
-			}
-			textureData = &iSubpixelGlyphTextureData[0][0];
+			auto& subpixelData = glyph_bitmap::subpixel_scratch(textureSize);
+			glyph_bitmap::lcd_to_subpixels(bitmap.buffer, bitmap.pitch, bitmap.width, bitmap.rows, &subpixelData[textureStride + 1], textureStride);
+			textureData = &subpixelData[0][0];
 		}
 		else
 		{
-			for (uint32_t y = 0; y < bitmap.rows; y++)
-				switch (bitmap.pixel_mode)
-				{
-				case FT_PIXEL_MODE_MONO: // 1 bit per pixel monochrome
-					for (uint32_t x = 0; x < bitmap.width; x += 8)
-						for (uint32_t b = 0; b < 8; ++b)
-							iGlyphTextureData[(x + b + 1) + (y + 1) * static_cast<std::size_t>(glyphRect.cx)] =
-							(x >= bitmap.width || y >= bitmap.rows) ? 0x00 : ((bitmap.buffer[x / 8 + bitmap.pitch * y] & (1 << (7 - b))) != 0 ? 0xFF : 0x00);
-					break;
-				case FT_PIXEL_MODE_GRAY:
-				default:
-					for (uint32_t x = 0; x < bitmap.width; x++)
-						iGlyphTextureData[(x + 1) + (y + 1) * static_cast<std::size_t>(glyphRect.cx)] =
-						(x >= bitmap.width || y >= bitmap.rows) ? 0x00 : bitmap.buffer[x + bitmap.pitch * y];
-					break;
-				}
-			textureData = &iGlyphTextureData[0];
+			auto& alphaData = glyph_bitmap::alpha_scratch(textureSize);
+			if (bitmap.pixel_mode == FT_PIXEL_MODE_MONO) // 1 bit per pixel monochrome
+				glyph_bitmap::mono_to_alpha(bitmap.buffer, bitmap.pitch, bitmap.width, bitmap.rows, &alphaData[textureStride + 1], textureStride);
+			else
+				glyph_bitmap::grey_to_alpha(bitmap.buffer, bitmap.pitch, bitmap.width, bitmap.rows, &alphaData[textureStride + 1], textureStride);
+			textureData = &alphaData[0];
 		}
 
-		GLint previousTexture;
-		glCheck(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
-		glCheck(glBindTexture(GL_TEXTURE_2D, reinterpret_cast<GLuint>(glyphTexture.texture().native_texture()->handle())));
+		auto& state = opengl_state::current();
+		GLuint const previousTexture = state.bound_texture(GL_TEXTURE_2D);
+		state.bind_texture(GL_TEXTURE_2D, reinterpret_cast<GLuint>(glyphTexture.texture().native_texture()->handle()));
 
-		GLint previousPackAlignment;
-		glCheck(glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousPackAlignment))
-		glCheck(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+		GLint const previousPackAlignment = state.pixel_store(GL_UNPACK_ALIGNMENT);
+		state.pixel_store(GL_UNPACK_ALIGNMENT, 1);
 		glCheck(glTexSubImage2D(GL_TEXTURE_2D, 0,
 			static_cast<GLint>(glyphRect.x), static_cast<GLint>(glyphRect.y), static_cast<GLsizei>(glyphRect.cx), static_cast<GLsizei>(glyphRect.cy), 
 			aGlyph.subpixel() ? GL_RGBA : GL_ALPHA, GL_UNSIGNED_BYTE, &textureData[0]));
-		glCheck(glPixelStorei(GL_UNPACK_ALIGNMENT, previousPackAlignment));
+		state.pixel_store(GL_UNPACK_ALIGNMENT, previousPackAlignment);
 
-		glCheck(glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previousTexture)));
+		state.bind_texture(GL_TEXTURE_2D, previousTexture);
 
 		return glyphTexture;
 	}
@@ -349,6 +367,23 @@ namespace neogfx
 		native_font().release(*this);
 	}
 
+	void native_font_face::build_coverage() const
+	{
+		iCoverageBuilt = true;
+		if (iHandle == nullptr)
+			return;
+		FT_UInt glyphIndex;
+		for (FT_ULong codePoint = FT_Get_First_Char(iHandle, &glyphIndex); glyphIndex != 0; codePoint = FT_Get_Next_Char(iHandle, codePoint, &glyphIndex))
+		{
+			auto page = static_cast<uint32_t>(codePoint >> 8u);
+			if (page >= iCoverage.size())
+				iCoverage.resize(page + 1u);
+			if (iCoverage[page] == nullptr)
+				iCoverage[page] = std::make_unique<coverage_page>(coverage_page{});
+			(*iCoverage[page])[(codePoint & 0xFFu) >> 6u] |= (1ull << (codePoint & 0x3Fu));
+		}
+	}
+
 	void native_font_face::set_metrics()
 	{
 		if (!is_bitmap_font())
@@ -75,6 +75,12 @@ namespace neogfx
 		typedef std::unordered_map<std::pair<uint32_t, bool>, neogfx::glyph_texture, boost::hash<std::pair<uint32_t, bool>>> glyph_map;
 		typedef std::unordered_map<std::pair<uint32_t, uint32_t>, dimension, boost::hash<std::pair<uint32_t, uint32_t>>, std::equal_to<std::pair<uint32_t, uint32_t>>, 
 			boost::fast_pool_allocator<std::pair<const std::pair<uint32_t, uint32_t>, dimension>>> kerning_table;
+		typedef std::array<uint64_t, 4> coverage_page;
+		typedef std::vector<std::unique_ptr<coverage_page>> coverage_map;
+		static const uint32_t FallbackBlockBits = 7u;
+		typedef std::array<uint8_t, 1u << FallbackBlockBits> fallback_block;
+		typedef std::unordered_map<uint32_t, fallback_block> fallback_map;
+		static const uint32_t MaxFallbackLevel = 8u;
 	public:
 		struct hb_handle
 		{
@@ -123,12 +129,15 @@ namespace neogfx
 		void update_handle(void* aHandle) override;
 		void* aux_handle() const override;
 		uint32_t glyph_index(char32_t aCodePoint) const override;
+		bool has_glyph(char32_t aCodePoint) const override;
+		uint32_t fallback_level(char32_t aCodePoint) const override;
 		i_glyph_texture& glyph_texture(const glyph& aGlyph) const override;
 	public:
 		void add_ref() override;
 		void release() override;
 	private:
 		void set_metrics();
+		void build_coverage() const;
 	private:
 		i_rendering_engine& iRenderingEngine;
 		i_native_font& iFont;
@@ -140,10 +149,11 @@ namespace neogfx
 		mutable std::unique_ptr<hb_handle> iAuxHandle;
 		mutable std::unique_ptr<i_native_font_face> iFallbackFont;
 		mutable glyph_map iGlyphs;
-		mutable std::vector<GLubyte> iGlyphTextureData;
-		mutable std::vector<std::array<GLubyte, 4>> iSubpixelGlyphTextureData;
 		bool iHasKerning;
 		mutable kerning_table iKerningTable;
 		mutable boost::optional<bool> iHasFallback;
+		mutable coverage_map iCoverage;
+		mutable bool iCoverageBuilt;
+		mutable fallback_map iFallbackLevels;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,54 @@
+// text_category_map.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2015-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <neogfx/gfx/text/text_category_map.hpp>
+#include "text_category_table.hpp"
+
+namespace neogfx
+{
+	namespace detail
+	{
+		namespace
+		{
+			constexpr uint32_t TEXT_CATEGORY_BLOCK_SIZE = 1u << TEXT_CATEGORY_BLOCK_BITS;
+
+			static_assert(sizeof(TEXT_CATEGORY_BLOCK_INDEX) / sizeof(TEXT_CATEGORY_BLOCK_INDEX[0]) == TEXT_CATEGORY_CODE_POINT_LIMIT >> TEXT_CATEGORY_BLOCK_BITS, "Bad generated text category table");
+
+			inline uint16_t text_category_entry(char32_t aCodePoint)
+			{
+				return TEXT_CATEGORY_BLOCKS[(static_cast<uint32_t>(TEXT_CATEGORY_BLOCK_INDEX[aCodePoint >> TEXT_CATEGORY_BLOCK_BITS]) << TEXT_CATEGORY_BLOCK_BITS) | (aCodePoint & (TEXT_CATEGORY_BLOCK_SIZE - 1u))];
+			}
+		}
+
+		text_category text_category_table::category(char32_t aCodePoint)
+		{
+			if (aCodePoint >= TEXT_CATEGORY_CODE_POINT_LIMIT)
+				return text_category::Unknown;
+			return static_cast<text_category>(text_category_entry(aCodePoint) & 0xFFu);
+		}
+
+		text_script text_category_table::script(char32_t aCodePoint)
+		{
+			if (aCodePoint >= TEXT_CATEGORY_CODE_POINT_LIMIT)
+				return text_script::Unknown;
+			return static_cast<text_script>(text_category_entry(aCodePoint) >> 8u);
+		}
+	}
+}
@@ -18,6 +18,7 @@
 */
 
 #include <neogfx/neogfx.hpp>
+#include <sstream>
 #include <neogfx/gfx/texture_manager.hpp>
 #include <neogfx/gfx/texture_atlas.hpp>
 #include "native/i_native_texture.hpp"
@@ -27,12 +28,15 @@ namespace neogfx
 	class texture_wrapper : public i_native_texture
 	{
 	public:
-		texture_wrapper(texture_manager::texture_list::iterator aTexture) :
-			iTexture(aTexture->lock())
+		texture_wrapper(texture_manager& aManager, std::shared_ptr<i_native_texture> aTexture) :
+			iManager(aManager), iTexture(aTexture)
 		{
 		}
 		~texture_wrapper()
 		{
+			auto const handle = iTexture->handle();
+			iTexture.reset();
+			iManager.release_texture(handle);
 		}
 	public:
 		dimension dpi_scale_factor() const override
@@ -69,18 +73,18 @@ namespace neogfx
 			return iTexture->uri();
 		}
 	private:
+		texture_manager& iManager;
 		std::shared_ptr<i_native_texture> iTexture;
 	};
 
 	std::unique_ptr<i_native_texture> texture_manager::join_texture(const i_native_texture& aTexture)
 	{
-		for (auto i = iTextures.begin(); i != iTextures.end(); ++i)
+		auto existing = iTextures.find(aTexture.handle());
+		if (existing != iTextures.end())
 		{
-			if (i->expired())
-				continue;
-			auto p = i->lock();
-			if (aTexture.handle() == p->handle())
-				return std::make_unique<texture_wrapper>(i);
+			auto p = existing->second.texture.lock();
+			if (p != nullptr)
+				return std::make_unique<texture_wrapper>(*this, p);
 		}
 		throw texture_not_found();
 	}
@@ -93,6 +97,7 @@ namespace neogfx
 	void texture_manager::clear_textures()
 	{
 		iTextures.clear();
+		iIndex.clear();
 	}
 
 	std::unique_ptr<i_texture_atlas> texture_manager::create_texture_atlas(const size& aSize)
@@ -100,6 +105,21 @@ namespace neogfx
 		return std::make_unique<texture_atlas>(*this, aSize);
 	}
 
+	texture_memory_usage texture_manager::memory_usage() const
+	{
+		texture_memory_usage result{};
+		for (auto const& t : iTextures)
+		{
+			auto p = t.second.texture.lock();
+			if (p == nullptr)
+				continue;
+			++result.textureCount;
+			result.bytes += t.second.bytes;
+			result.pages.push_back(texture_page_usage{ t.first, p->uri(), p->storage_extents(), p->sampling(), t.second.bytes, p.use_count() - 1 });
+		}
+		return result;
+	}
+
 	const texture_manager::texture_list& texture_manager::textures() const
 	{
 		return iTextures;
@@ -110,41 +130,71 @@ namespace neogfx
 		return iTextures;
 	}
 
-	texture_manager::texture_list::const_iterator texture_manager::find_texture(const i_image& aImage) const
+	std::shared_ptr<i_native_texture> texture_manager::find_texture(const i_image& aImage) const
 	{
-		for (auto i = iTextures.begin(); i != iTextures.end(); ++i)
-		{
-			auto p = i->lock();
-			if (!aImage.uri().empty() && aImage.uri() == p->uri())
-				return i;
-		}
-		return iTextures.end();
+		if (aImage.uri().empty())
+			return nullptr;
+		auto existing = iIndex.find(image_key(aImage));
+		if (existing == iIndex.end())
+			return nullptr;
+		auto texture = iTextures.find(existing->second);
+		if (texture == iTextures.end())
+			return nullptr;
+		return texture->second.texture.lock();
 	}
 
-	texture_manager::texture_list::iterator texture_manager::find_texture(const i_image& aImage)
+	std::unique_ptr<i_native_texture> texture_manager::add_texture(std::shared_ptr<i_native_texture> aTexture)
 	{
-		for (auto i = iTextures.begin(); i != iTextures.end(); ++i)
+		iTextures[aTexture->handle()] = texture_record{ aTexture, std::string{}, texture_bytes(*aTexture) };
+		return std::make_unique<texture_wrapper>(*this, aTexture);
+	}
+
+	std::unique_ptr<i_native_texture> texture_manager::add_texture(std::shared_ptr<i_native_texture> aTexture, const i_image& aImage)
+	{
+		if (aImage.uri().empty())
+			return add_texture(aTexture);
+		auto key = image_key(aImage);
+		iIndex[key] = aTexture->handle();
+		iTextures[aTexture->handle()] = texture_record{ aTexture, std::move(key), texture_bytes(*aTexture) };
+		return std::make_unique<texture_wrapper>(*this, aTexture);
+	}
+
+	std::string texture_manager::image_key(const i_image& aImage)
+	{
+		// only images loaded from a URI are shared; a URI-less image is typically generated and may be
+		// mutated through its texture (set_pixels) so it always gets a texture of its own
+		std::ostringstream key;
+		key << "uri:" << aImage.uri();
+		key << '|' << aImage.extents().cx << 'x' << aImage.extents().cy << '|' << aImage.dpi_scale_factor() << '|' << static_cast<int>(aImage.sampling());
+		return key.str();
+	}
+
+	std::size_t texture_manager::texture_bytes(const i_native_texture& aTexture)
+	{
+		auto const storage = aTexture.storage_extents();
+		auto bytes = static_cast<std::size_t>(storage.cx * storage.cy * 4.0);
+		switch (aTexture.sampling())
 		{
-			if (i->expired())
-				continue;
-			auto p = i->lock();
-			if (!aImage.uri().empty() && aImage.uri() == p->uri())
-				return i;
+		case texture_sampling::NormalMipmap:
+			return bytes + bytes / 3u;
+		case texture_sampling::Multisample:
+			return bytes * 4u;
+		default:
+			return bytes;
 		}
-		return iTextures.end();
 	}
 
-	std::unique_ptr<i_native_texture> texture_manager::add_texture(std::shared_ptr<i_native_texture> aTexture)
+	void texture_manager::release_texture(const void* aHandle)
 	{
-		// cleanup opportunity
-		for (auto i = iTextures.begin(); i != iTextures.end();)
+		auto existing = iTextures.find(aHandle);
+		if (existing == iTextures.end() || !existing->second.texture.expired())
+			return;
+		if (!existing->second.key.empty())
 		{
-			if (i->expired())
-				i = iTextures.erase(i);
-			else
-				++i;
+			auto indexed = iIndex.find(existing->second.key);
+			if (indexed != iIndex.end() && indexed->second == aHandle)
+				iIndex.erase(indexed);
 		}
-		auto newTexture = iTextures.insert(iTextures.end(), aTexture);
-		return std::make_unique<texture_wrapper>(newTexture);
+		iTextures.erase(existing);
 	}
 }
\ No newline at end of file
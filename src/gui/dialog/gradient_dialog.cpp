@@ -30,7 +30,7 @@ namespace neogfx
 		preview_box(gradient_dialog& aOwner) :
 			framed_widget(aOwner.iPreviewGroupBox.item_layout()),
 			iOwner(aOwner),
-			iAnimationTimer{ app::instance(), [this](neolib::callback_timer& aTimer)
+			iAnimationTimer{ [this](callback_timer& aTimer)
 			{
 				aTimer.again();
 				animate();
@@ -95,7 +95,7 @@ namespace neogfx
 		}
 	private:
 		gradient_dialog& iOwner;
-		neolib::callback_timer iAnimationTimer;
+		callback_timer iAnimationTimer;
 		bool iTracking;
 	};
 
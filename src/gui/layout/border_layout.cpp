@@ -171,6 +171,9 @@ namespace neogfx
 
 	void border_layout::layout_items(const point& aPosition, const size& aSize)
 	{
+		validate();
+		set_position(aPosition);
+		set_extents(aSize);
 		iRows.layout_items(aPosition, aSize);
 	}
 
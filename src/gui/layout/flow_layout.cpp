@@ -93,7 +93,6 @@ namespace neogfx
 		if (debug == this)
 			std::cerr << "flow_layout::layout_items(" << aPosition << ", " << aSize << ")" << std::endl;
 		layout_owner().layout_items_started();
-		next_layout_id();
 		validate();
 		if (iFlowDirection == FlowDirectionHorizontal)
 			do_layout_items<layout::column_major<flow_layout>>(aPosition, aSize);
@@ -18,11 +18,11 @@
 */
 
 #include <neogfx/neogfx.hpp>
-#include <map>
-#include <neolib/bresenham_counter.hpp>
+#include <algorithm>
 #include <neogfx/gui/widget/i_widget.hpp>
 #include <neogfx/gui/layout/grid_layout.hpp>
 #include <neogfx/gui/layout/spacer.hpp>
+#include "layout.inl"
 
 namespace neogfx
 {
@@ -91,6 +91,7 @@ namespace neogfx
 	void grid_layout::set_dimensions(cell_coordinate aRows, cell_coordinate aColumns)
 	{
 		iDimensions = cell_dimensions{aColumns, aRows};
+		iOccupancyValid = false;
 	}
 
 	bool grid_layout::is_item_at_position(cell_coordinate aRow, cell_coordinate aColumn) const
@@ -135,6 +136,7 @@ namespace neogfx
 		iCells[cell_coordinates{ aColumn, aRow }] = items().insert(items().end(), item{ *this, aItem });
 		iDimensions.cy = std::max(iDimensions.cy, aRow + 1);
 		iDimensions.cx = std::max(iDimensions.cx, aColumn + 1);
+		iOccupancyValid = false;
 		row_layout(aRow).replace_item_at(aColumn, aItem);
 		return *aItem;
 	}
@@ -210,9 +212,10 @@ namespace neogfx
 		iDimensions = cell_dimensions{};
 		for (const auto& cell : iCells)
 		{
-			iDimensions.cy = std::max(iDimensions.cy, cell.first.y);
-			iDimensions.cx = std::max(iDimensions.cx, cell.first.x);
+			iDimensions.cy = std::max(iDimensions.cy, cell.first.y + 1);
+			iDimensions.cx = std::max(iDimensions.cx, cell.first.x + 1);
 		}
+		iOccupancyValid = false;
 		iCursor = cell_coordinates{};
 		layout::remove(iterExistingItem);
 	}
@@ -224,6 +227,7 @@ namespace neogfx
 		iRows.clear();
 		iCells.clear();
 		iDimensions = cell_dimensions{};
+		iOccupancyValid = false;
 		iCursor = cell_coordinates{};
 	}
 
@@ -268,27 +272,26 @@ namespace neogfx
 		auto availableSpaceForChildren = aAvailableSpace;
 		if (availableSpaceForChildren != boost::none)
 			*availableSpaceForChildren -= margins().size();
-		size result;
-		uint32_t visibleColumns = visible_columns();
-		uint32_t visibleRows = visible_rows();
-		for (cell_coordinate row = 0; row < rows(); ++row)
+		size_tracks<layout::column_major<grid_layout>>(iColumnTracks, availableSpaceForChildren);
+		size_tracks<layout::row_major<grid_layout>>(iRowTracks, availableSpaceForChildren);
+		auto total = [](const track_list& aTracks, size::dimension_type aSpacing)
 		{
-			if (!is_row_visible(row))
-				continue;
-			result.cy += row_minimum_size(row, availableSpaceForChildren);
-		}
-		for (cell_coordinate column = 0; column < columns(); ++column)
-		{
-			if (!is_column_visible(column))
-				continue;
-			result.cx += column_minimum_size(column, availableSpaceForChildren);
-		}
+			size::dimension_type result = 0.0;
+			uint32_t visibleTracks = 0;
+			for (const auto& t : aTracks)
+			{
+				if (t.minimum == 0.0)
+					continue;
+				result += t.minimum;
+				++visibleTracks;
+			}
+			if (visibleTracks > 1)
+				result += (aSpacing * (visibleTracks - 1));
+			return result;
+		};
+		size result{ total(iColumnTracks, spacing().cx), total(iRowTracks, spacing().cy) };
 		result.cx += (margins().left + margins().right);
 		result.cy += (margins().top + margins().bottom);
-		if (result.cx != size::max_dimension() && visibleColumns> 0)
-			result.cx += (spacing().cx * (visibleColumns - 1));
-		if (result.cy != size::max_dimension() && visibleRows > 0)
-			result.cy += (spacing().cy * (visibleRows - 1));
 		result.cx = std::max(result.cx, layout::minimum_size(aAvailableSpace).cx);
 		result.cy = std::max(result.cy, layout::minimum_size(aAvailableSpace).cy);
 		return result;
@@ -301,35 +304,30 @@ namespace neogfx
 		auto availableSpaceForChildren = aAvailableSpace;
 		if (availableSpaceForChildren != boost::none)
 			*availableSpaceForChildren -= margins().size();
-		size result;
-		for (cell_coordinate row = 0; row < visible_rows(); ++row)
+		size_tracks<layout::column_major<grid_layout>>(iColumnTracks, availableSpaceForChildren);
+		size_tracks<layout::row_major<grid_layout>>(iRowTracks, availableSpaceForChildren);
+		auto total = [](const track_list& aTracks, size::dimension_type aSpacing)
 		{
-			size::dimension_type rowMaxSize = row_maximum_size(row, availableSpaceForChildren);
-			if (rowMaxSize == size::max_dimension())
-				result.cy = rowMaxSize;
-			else if (result.cy != size::max_dimension())
-				result.cy += rowMaxSize;
-		}
-		for (cell_coordinate column = 0; column < visible_columns(); ++column)
-		{
-			size::dimension_type columnMaxSize = column_maximum_size(column, availableSpaceForChildren);
-			if (columnMaxSize == size::max_dimension())
-				result.cx = columnMaxSize;
-			else if (result.cx != size::max_dimension())
-				result.cx += columnMaxSize;
-		}
-		if (result.cx != size::max_dimension())
-			result.cx += (margins().left + margins().right);
-		if (result.cy != size::max_dimension())
-			result.cy += (margins().top + margins().bottom);
-		if (result.cx != size::max_dimension() && visible_columns() > 0)
-			result.cx += (spacing().cx * (visible_columns() - 1));
-		if (result.cy != size::max_dimension() && visible_rows() > 0)
-			result.cy += (spacing().cy * (visible_rows() - 1));
+			size::dimension_type result = 0.0;
+			uint32_t visibleTracks = 0;
+			for (const auto& t : aTracks)
+			{
+				if (t.maximum == size::max_dimension())
+					return size::max_dimension();
+				if (t.maximum == 0.0)
+					continue;
+				result += t.maximum;
+				++visibleTracks;
+			}
+			if (visibleTracks > 1)
+				result += (aSpacing * (visibleTracks - 1));
+			return result;
+		};
+		size result{ total(iColumnTracks, spacing().cx), total(iRowTracks, spacing().cy) };
 		if (result.cx != size::max_dimension())
-			result.cx = std::min(result.cx, layout::maximum_size(aAvailableSpace).cx);
+			result.cx = std::min(result.cx + margins().left + margins().right, layout::maximum_size(aAvailableSpace).cx);
 		if (result.cy != size::max_dimension())
-			result.cy = std::min(result.cy, layout::maximum_size(aAvailableSpace).cy);
+			result.cy = std::min(result.cy + margins().top + margins().bottom, layout::maximum_size(aAvailableSpace).cy);
 		return result;
 	}
 
@@ -339,8 +337,8 @@ namespace neogfx
 		iRowLayout.set_spacing(aSpacing, false);
 		for (auto& r : iRows)
 			r->set_spacing(aSpacing, false);
-		if (has_layout_owner() && aUpdateLayout)
-			layout_owner().ultimate_ancestor().layout_items(true);
+		if (aUpdateLayout)
+			invalidate();
 	}
 
 	void grid_layout::add_span(cell_coordinate aRowFrom, cell_coordinate aColumnFrom, uint32_t aRows, uint32_t aColumns)
@@ -351,8 +349,8 @@ namespace neogfx
 	void grid_layout::add_span(const cell_coordinates& aFrom, const cell_coordinates& aTo)
 	{
 		iSpans.push_back(std::make_pair(aFrom, aTo));
-		if (has_layout_owner())
-			layout_owner().ultimate_ancestor().layout_items(true);
+		iOccupancyValid = false;
+		invalidate();
 	}
 
 	void grid_layout::set_alignment(neogfx::alignment aAlignment, bool aUpdateLayout)
@@ -370,198 +368,259 @@ namespace neogfx
 		if (debug == this)
 			std::cerr << "grid_layout::layout_items(" << aPosition << ", " << aSize << ")" << std::endl;
 		layout_owner().layout_items_started();
-		next_layout_id();
 		validate();
 		set_position(aPosition);
 		set_extents(aSize);
-		for (auto& r : iRows)
-			while (r->count() < iDimensions.cx)
-				r->add_spacer();
 		point availablePos = aPosition + point{ margins().left, margins().top };
 		size availableSize = aSize;
 		availableSize.cx -= (margins().left + margins().right);
 		availableSize.cy -= (margins().top + margins().bottom);
-		iRowLayout.layout_items(availablePos, availableSize);
-		std::vector<dimension> maxRowHeight(iDimensions.cy);
-		std::vector<dimension> maxColWidth(iDimensions.cx);
-		for (cell_coordinate row = 0; row < iDimensions.cy; ++row)
+		size_tracks<layout::column_major<grid_layout>>(iColumnTracks, availableSize);
+		size_tracks<layout::row_major<grid_layout>>(iRowTracks, availableSize);
+		distribute_tracks<layout::column_major<grid_layout>>(iColumnTracks, availableSize.cx);
+		distribute_tracks<layout::row_major<grid_layout>>(iRowTracks, availableSize.cy);
+		// The row layouts only provide structure (item ownership and invalidation); their geometry 
+		// mirrors the row tracks and the items themselves are arranged directly from the tracks below.
+		iRowLayout.set_position(availablePos);
+		iRowLayout.set_extents(availableSize);
+		iRowLayout.validate();
+		for (cell_coordinate row = 0; row < iRows.size() && row < iRowTracks.size(); ++row)
 		{
-			for (cell_coordinate col = 0; col < iDimensions.cx; ++col)
-			{
-				auto i = iCells.find(cell_coordinates{ col, row });
-				if (i != iCells.end())
-				{
-					auto s = find_span(cell_coordinates{ col, row });
-					if (s == iSpans.end())
-					{
-						maxRowHeight[row] = std::max(maxRowHeight[row], i->second->extents().cy);
-						maxColWidth[col] = std::max(maxColWidth[col], i->second->extents().cx);
-					}
-					else
-					{
-						maxRowHeight[row] = std::max(maxRowHeight[row], 
-							(i->second->extents().cy - spacing().cy * (s->second.y - s->first.y)) / (s->second.y - s->first.y + 1));
-						maxColWidth[col] = std::max(maxColWidth[col],
-							(i->second->extents().cx - spacing().cx * (s->second.x - s->first.x)) / (s->second.x - s->first.x + 1));
-					}
-				}
-			}
+			iRows[row]->set_position(availablePos + point{ 0.0, iRowTracks[row].position });
+			iRows[row]->set_extents(size{ availableSize.cx, iRowTracks[row].extent });
+			iRows[row]->validate();
 		}
-		point rowPos = availablePos;
+		const auto& cells = occupancy();
 		for (cell_coordinate row = 0; row < iDimensions.cy; ++row)
 		{
-			if (maxRowHeight[row] == 0.0)
-				continue;
-			point colPos = rowPos;
 			for (cell_coordinate col = 0; col < iDimensions.cx; ++col)
 			{
-				if (maxColWidth[col] == 0.0)
+				const auto& c = cells[row * iDimensions.cx + col];
+				if (c.occupant == nullptr || !c.occupant->visible())
 					continue;
-				auto i = iCells.find(cell_coordinates{ col, row });
-				if (i != iCells.end())
+				cell_coordinates from{ col, row };
+				cell_coordinates to{ col, row };
+				if (c.span != NoSpan)
 				{
-					bool foundSpan = false;
-					for (auto& s : iSpans)
-					{
-						if (col >= s.first.x && col <= s.second.x &&
-							row >= s.first.y && row <= s.second.y)
-						{
-							point fromPos;
-							point toPos;
-							point rowPos2 = availablePos;
-							for (cell_coordinate row2 = 0; !foundSpan && row2 <= s.second.y; ++row2)
-							{
-								point colPos2 = rowPos2;
-								for (cell_coordinate col2 = 0; !foundSpan && col2 <= s.second.x; ++col2)
-								{
-									if (row2 == s.first.y && col2 == s.first.x)
-										fromPos = colPos2;
-									if (row2 == s.second.y && col2 == s.second.x)
-									{
-										toPos = colPos2 + size{ maxColWidth[col2], maxRowHeight[row2] };
-										i->second->layout_as(fromPos, toPos - fromPos);
-										foundSpan = true;
-									}
-									colPos2.x += maxColWidth[col2];
-									colPos2.x += spacing().cx;
-								}
-								rowPos2.y += maxRowHeight[row2];
-								rowPos2.y += spacing().cy;
-							}
-						}
-					}
-					if (!foundSpan)
-						i->second->layout_as(colPos, size{maxColWidth[col], maxRowHeight[row]});
+					from = iSpans[c.span].first;
+					to.x = std::min(iSpans[c.span].second.x, iDimensions.cx - 1);
+					to.y = std::min(iSpans[c.span].second.y, iDimensions.cy - 1);
 				}
-				colPos.x += maxColWidth[col];
-				colPos.x += spacing().cx;
+				const auto& fromColumn = iColumnTracks[from.x];
+				const auto& toColumn = iColumnTracks[to.x];
+				const auto& fromRow = iRowTracks[from.y];
+				const auto& toRow = iRowTracks[to.y];
+				c.occupant->layout_as(
+					availablePos + point{ fromColumn.position, fromRow.position },
+					size{ toColumn.position + toColumn.extent - fromColumn.position, toRow.position + toRow.extent - fromRow.position });
 			}
-			rowPos.y += maxRowHeight[row];
-			rowPos.y += spacing().cy;
 		}
 		layout_owner().layout_items_completed();
 	}
 
-	uint32_t grid_layout::visible_rows() const
+	const grid_layout::occupancy_map& grid_layout::occupancy() const
 	{
-		uint32_t result = 0;
-		for (cell_coordinate row = 0; row < iDimensions.cy; ++row)
-			for (cell_coordinate col = 0; col < iDimensions.cx; ++col)
-			{
-				auto i = iCells.find(cell_coordinates{col, row});
-				if (i != iCells.end() && i->second->visible() && i->second->minimum_size().cy != 0.0)
+		if (iOccupancyValid)
+			return iOccupancy;
+		iOccupancy.assign(static_cast<std::size_t>(iDimensions.cx) * iDimensions.cy, cell{ nullptr, NoSpan });
+		for (const auto& c : iCells)
+			if (c.first.x < iDimensions.cx && c.first.y < iDimensions.cy)
+				iOccupancy[c.first.y * iDimensions.cx + c.first.x].occupant = &*c.second;
+		// where spans overlap the first span added wins
+		for (uint32_t s = 0; s < iSpans.size(); ++s)
+			for (cell_coordinate row = iSpans[s].first.y; row <= iSpans[s].second.y && row < iDimensions.cy; ++row)
+				for (cell_coordinate col = iSpans[s].first.x; col <= iSpans[s].second.x && col < iDimensions.cx; ++col)
 				{
-					++result;
-					break;
+					auto& c = iOccupancy[row * iDimensions.cx + col];
+					if (c.span == NoSpan)
+						c.span = s;
 				}
-			}
-		return result;
+		iOccupancyValid = true;
+		return iOccupancy;
 	}
 
-	bool grid_layout::is_row_visible(uint32_t aRow) const
+	template <typename AxisPolicy>
+	void grid_layout::size_tracks(track_list& aTracks, const optional_size& aAvailableSpace) const
 	{
-		for (cell_coordinate col = 0; col < iDimensions.cx; ++col)
+		auto track_index = [](cell_coordinate aRow, cell_coordinate aColumn)
 		{
-			auto i = iCells.find(cell_coordinates{col, aRow});
-			if (i != iCells.end() && i->second->visible() && i->second->minimum_size().cy != 0.0)
-				return true;
-		}
-		return false;
-	}
-
-	uint32_t grid_layout::visible_columns() const
-	{
-		uint32_t result = 0;
-		for (cell_coordinate col = 0; col < iDimensions.cx; ++col)
-			for (cell_coordinate row = 0; row < iDimensions.cy; ++row)
+			return static_cast<uint32_t>(AxisPolicy::x(point{ static_cast<coordinate>(aColumn), static_cast<coordinate>(aRow) }));
+		};
+		const auto& cells = occupancy();
+		aTracks.assign(track_index(iDimensions.cy, iDimensions.cx), track{});
+		if (aTracks.empty())
+			return;
+		auto item_extents = [&aAvailableSpace](const item& aItem)
+		{
+			auto const minimumSize = AxisPolicy::cx(aItem.minimum_size(aAvailableSpace));
+			auto const sizePolicy = AxisPolicy::size_policy_x(aItem.size_policy());
+			if (sizePolicy == neogfx::size_policy::Fixed || sizePolicy == neogfx::size_policy::Minimum)
+				return std::make_pair(minimumSize, minimumSize);
+			return std::make_pair(minimumSize, std::max(minimumSize, AxisPolicy::cx(aItem.maximum_size(aAvailableSpace))));
+		};
+		// Pass 1: intrinsic sizes of items confined to a single track; items spanning several tracks are deferred.
+		std::vector<std::pair<uint32_t, const cell*>> spanningItems;
+		for (cell_coordinate row = 0; row < iDimensions.cy; ++row)
+		{
+			for (cell_coordinate col = 0; col < iDimensions.cx; ++col)
 			{
-				auto i = iCells.find(cell_coordinates{col, row});
-				if (i != iCells.end() && i->second->visible() && i->second->minimum_size().cx != 0.0)
+				const auto& c = cells[row * iDimensions.cx + col];
+				if (c.occupant == nullptr || !c.occupant->visible())
+					continue;
+				if (c.span != NoSpan)
 				{
-					++result;
-					break;
+					const auto& s = iSpans[c.span];
+					auto const spanTracks = std::min(track_index(s.second.y, s.second.x), static_cast<uint32_t>(aTracks.size() - 1)) - track_index(s.first.y, s.first.x) + 1;
+					if (spanTracks > 1)
+					{
+						spanningItems.emplace_back(spanTracks, &c);
+						continue;
+					}
 				}
+				auto& t = aTracks[track_index(row, col)];
+				auto const extents = item_extents(*c.occupant);
+				t.minimum = std::max(t.minimum, extents.first);
+				t.maximum = std::max(t.maximum, extents.second);
+				if (extents.second > extents.first)
+					t.weight = std::max(t.weight, AxisPolicy::cx(c.occupant->weight()));
 			}
-		return result;
-	}
-
-	bool grid_layout::is_column_visible(uint32_t aColumn) const
-	{
-		for (cell_coordinate row = 0; row < iDimensions.cy; ++row)
+		}
+		// Pass 2: distribute the requirements of spanning items over the tracks they span, narrowest spans 
+		// first so that wider spans see the contributions of the narrower ones.
+		std::stable_sort(spanningItems.begin(), spanningItems.end(), 
+			[](const std::pair<uint32_t, const cell*>& aLeft, const std::pair<uint32_t, const cell*>& aRight) { return aLeft.first < aRight.first; });
+		auto const spacing = AxisPolicy::cx(this->spacing());
+		for (const auto& spanningItem : spanningItems)
 		{
-			auto i = iCells.find(cell_coordinates{aColumn, row});
-			if (i != iCells.end() && i->second->visible() && i->second->minimum_size().cx != 0.0)
-				return true;
+			const auto& s = iSpans[spanningItem.second->span];
+			auto const first = track_index(s.first.y, s.first.x);
+			auto const last = first + spanningItem.first - 1;
+			auto const extents = item_extents(*spanningItem.second->occupant);
+			auto const spannedSpacing = spacing * (spanningItem.first - 1);
+			size::dimension_type existing = 0.0;
+			uint32_t growable = 0;
+			for (auto i = first; i <= last; ++i)
+			{
+				existing += aTracks[i].minimum;
+				if (aTracks[i].maximum > aTracks[i].minimum)
+					++growable;
+			}
+			auto const deficit = extents.first - spannedSpacing - existing;
+			if (deficit > 0.0)
+			{
+				auto const share = std::ceil(deficit / (growable != 0 ? growable : spanningItem.first));
+				for (auto i = first; i <= last; ++i)
+					if (growable == 0 || aTracks[i].maximum > aTracks[i].minimum)
+						aTracks[i].minimum += share;
+			}
+			auto const maximumShare = (extents.second == size::max_dimension() ? 
+				size::max_dimension() : (extents.second - spannedSpacing) / spanningItem.first);
+			for (auto i = first; i <= last; ++i)
+			{
+				aTracks[i].maximum = std::max(aTracks[i].maximum, maximumShare);
+				if (extents.second > extents.first)
+					aTracks[i].weight = std::max(aTracks[i].weight, AxisPolicy::cx(spanningItem.second->occupant->weight()));
+			}
+		}
+		for (auto& t : aTracks)
+		{
+			t.maximum = std::max(t.maximum, t.minimum);
+			t.extent = t.minimum;
+			t.position = 0.0;
 		}
-		return false;
 	}
 
-	size::dimension_type grid_layout::row_minimum_size(cell_coordinate aRow, const optional_size& aAvailableSpace) const
+	template <typename AxisPolicy>
+	void grid_layout::distribute_tracks(track_list& aTracks, size::dimension_type aAvailableExtent) const
 	{
-		size::dimension_type result {};
-		for (const auto& item : iCells)
-			if (item.first.y == aRow)
+		auto const spacing = AxisPolicy::cx(this->spacing());
+		auto spacing_for = [spacing](uint32_t aVisibleTracks) { return aVisibleTracks > 1 ? spacing * (aVisibleTracks - 1) : 0.0; };
+		size::dimension_type totalMinimum = 0.0;
+		uint32_t visibleTracks = 0;
+		uint32_t growableEmptyTracks = 0;
+		for (const auto& t : aTracks)
+		{
+			totalMinimum += t.minimum;
+			if (t.minimum != 0.0)
+				++visibleTracks;
+			else if (t.maximum != 0.0)
+				++growableEmptyTracks;
+		}
+		// Pass 3: share out any leftover space between the tracks that can grow, in proportion to their 
+		// weight; tracks that reach their maximum are frozen and the remainder shared out again. Empty 
+		// tracks only grow if there is room for the extra spacing they then require.
+		auto leftover = aAvailableExtent - totalMinimum - spacing_for(visibleTracks);
+		bool growEmptyTracks = false;
+		if (growableEmptyTracks != 0 && leftover - spacing_for(visibleTracks + growableEmptyTracks) + spacing_for(visibleTracks) > 0.0)
+		{
+			growEmptyTracks = true;
+			leftover -= (spacing_for(visibleTracks + growableEmptyTracks) - spacing_for(visibleTracks));
+		}
+		std::vector<track*> growing;
+		for (auto& t : aTracks)
+			if (t.maximum > t.minimum && (t.minimum != 0.0 || growEmptyTracks))
+				growing.push_back(&t);
+		bool frozen = true;
+		while (leftover > 0.0 && !growing.empty() && frozen)
+		{
+			frozen = false;
+			size::dimension_type totalWeight = 0.0;
+			for (auto t : growing)
+				totalWeight += (t->weight > 0.0 ? t->weight : 1.0);
+			for (auto t = growing.begin(); t != growing.end();)
 			{
-				auto s = find_span(item.first);
-				if (s == iSpans.end())
-					result = std::max(result, item.second->minimum_size(aAvailableSpace).cy);
+				auto const share = leftover * ((*t)->weight > 0.0 ? (*t)->weight : 1.0) / totalWeight;
+				if ((*t)->minimum + share >= (*t)->maximum)
+				{
+					(*t)->extent = (*t)->maximum;
+					leftover -= ((*t)->maximum - (*t)->minimum);
+					t = growing.erase(t);
+					frozen = true;
+				}
 				else
-					result = std::max(result, (item.second->minimum_size(aAvailableSpace).cy - spacing().cy * (s->second.y - s->first.y)) / (s->second.y - s->first.y + 1));
+					++t;
 			}
-		return result;
-	}
-
-	size::dimension_type grid_layout::column_minimum_size(cell_coordinate aColumn, const optional_size& aAvailableSpace) const
-	{
-		size::dimension_type result {};
-		for (const auto& item : iCells)
-			if (item.first.x == aColumn)
+		}
+		if (leftover > 0.0 && !growing.empty())
+		{
+			size::dimension_type totalWeight = 0.0;
+			for (auto t : growing)
+				totalWeight += (t->weight > 0.0 ? t->weight : 1.0);
+			// accumulate before rounding so that the leftover pixels are spread out rather than lost
+			size::dimension_type accumulated = 0.0;
+			for (auto t : growing)
 			{
-				auto s = find_span(item.first);
-				if (s == iSpans.end())
-					result = std::max(result, item.second->minimum_size(aAvailableSpace).cx);
-				else
-					result = std::max(result, (item.second->minimum_size(aAvailableSpace).cx - spacing().cx * (s->second.x - s->first.x)) / (s->second.x - s->first.x + 1));
+				auto const previous = std::floor(accumulated);
+				accumulated += leftover * (t->weight > 0.0 ? t->weight : 1.0) / totalWeight;
+				t->extent = t->minimum + std::floor(accumulated) - previous;
 			}
-		return result;
-	}
-
-	size::dimension_type grid_layout::row_maximum_size(cell_coordinate aRow, const optional_size& aAvailableSpace) const
-	{
-		size::dimension_type result {};
-		for (const auto& item : iCells)
-			if (item.first.y == aRow)
-				result = std::max(result, item.second->maximum_size(aAvailableSpace).cy);
-		return result;
-	}
-
-	size::dimension_type grid_layout::column_maximum_size(cell_coordinate aColumn, const optional_size& aAvailableSpace) const
-	{
-		size::dimension_type result {};
-		for (const auto& item : iCells)
-			if (item.first.x == aColumn)
-				result = std::max(result, item.second->maximum_size(aAvailableSpace).cx);
-		return result;
+			leftover = 0.0;
+		}
+		size::dimension_type nextPosition = 0.0;
+		if (leftover > 0.0)
+		{
+			switch (alignment() & AxisPolicy::InlineAlignmentMask)
+			{
+			case alignment::Left:
+			case alignment::Top:
+			default:
+				break;
+			case alignment::Right:
+			case alignment::Bottom:
+				nextPosition = leftover;
+				break;
+			case alignment::Centre:
+			case alignment::VCentre:
+				nextPosition = std::floor(leftover / 2.0);
+				break;
+			}
+		}
+		for (auto& t : aTracks)
+		{
+			t.position = nextPosition;
+			if (t.extent != 0.0)
+				nextPosition += (t.extent + spacing);
+		}
 	}
 
 	void grid_layout::increment_cursor()
@@ -587,20 +646,15 @@ namespace neogfx
 		return *iRows[aRow];
 	}
 
-	grid_layout::span_list::const_iterator grid_layout::find_span(const cell_coordinates& aCell) const
-	{
-		for (auto s = iSpans.begin(); s != iSpans.end(); ++s)
-			if (aCell.x >= s->first.x && aCell.x <= s->second.x && aCell.y >= s->first.y && aCell.y <= s->second.y)
-				return s;
-		return iSpans.end();
-	}
-
 	void grid_layout::init()
 	{
+		iRowLayout.set_parent_layout(this);
 		iRowLayout.set_margins(neogfx::margins{});
 		iRowLayout.set_spacing(spacing());
 		iRowLayout.set_always_use_spacing(true);
 
+		iOccupancyValid = false;
+
 		set_alive();
 		invalidate();
 	}
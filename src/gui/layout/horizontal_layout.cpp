@@ -79,7 +79,6 @@ namespace neogfx
 		if (debug == this)
 			std::cerr << "horizontal_layout::layout_items(" << aPosition << ", " << aSize << ")" << std::endl;
 		layout_owner().layout_items_started();
-		next_layout_id();
 		validate();
 		layout::do_layout_items<layout::column_major<horizontal_layout>>(aPosition, aSize);
 		layout_owner().layout_items_completed();
@@ -22,6 +22,7 @@
 #include <neogfx/gui/layout/layout.hpp>
 #include <neogfx/gui/layout/layout_item.hpp>
 #include <neogfx/gui/layout/i_spacer.hpp>
+#include <neogfx/gui/layout/layout_statistics.hpp>
 #include <neogfx/app/app.hpp>
 #include "layout.inl"
 
@@ -48,7 +49,9 @@ namespace neogfx
 		iMaximumSize{},
 		iLayoutStarted{ false },
 		iLayoutId{ 0 },
-		iInvalidated{ false }
+		iArrangedGeneration{ static_cast<uint32_t>(-1) },
+		iInvalidated{ false },
+		iItemArrangementInvalidated{ false }
 	{
 		enable();
 	}
@@ -64,7 +67,9 @@ namespace neogfx
 		iMaximumSize{},
 		iLayoutStarted{ false },
 		iLayoutId{ 0 },
-		iInvalidated{ false }
+		iArrangedGeneration{ static_cast<uint32_t>(-1) },
+		iInvalidated{ false },
+		iItemArrangementInvalidated{ false }
 	{
 		aOwner.set_layout(*this);
 		enable();
@@ -82,7 +87,9 @@ namespace neogfx
 		iMaximumSize{},
 		iLayoutStarted{ false },
 		iLayoutId{ 0 },
-		iInvalidated{ false }
+		iArrangedGeneration{ static_cast<uint32_t>(-1) },
+		iInvalidated{ false },
+		iItemArrangementInvalidated{ false }
 	{
 		aParent.add(*this);
 		enable();
@@ -428,7 +435,15 @@ namespace neogfx
 
 	void layout::layout_as(const point& aPosition, const size& aSize)
 	{
+		if (!invalidated() && iArrangedGeneration == layout_item::generation() && position() == aPosition && extents() == aSize)
+		{
+			if (item_arrangement_invalidated())
+				arrange_invalidated_items();
+			return;
+		}
+		layout_statistics::instance().item_arranged();
 		layout_items(aPosition, aSize);
+		iArrangedGeneration = layout_item::generation();
 	}
 
 	uint32_t layout::layout_id() const
@@ -440,8 +455,15 @@ namespace neogfx
 	{
 		if (++iLayoutId == static_cast<uint32_t>(-1))
 			iLayoutId = 0;
-		for (auto& item : items())
-			item.next_layout_id();
+		if (has_parent_layout())
+		{
+			if (parent_layout().item_measurement_changed(*this))
+				parent_layout().next_layout_id();
+		}
+		else if (has_layout_owner() && layout_owner().has_layout() && &layout_owner().layout() == this &&
+			!(layout_owner().has_minimum_size() && layout_owner().has_maximum_size())) // owner's measurement is fixed so stop here
+			layout_owner().next_layout_id();
+		invalidate_arrangement();
 	}
 
 	bool layout::visible() const
@@ -457,33 +479,68 @@ namespace neogfx
 	}
 
 	void layout::invalidate()
+	{
+		if (!enabled())
+			return;
+		next_layout_id();
+		invalidate_arrangement();
+	}
+
+	void layout::invalidate_arrangement()
 	{
 		if (!enabled())
 			return;
 		if (invalidated())
 			return;
 		iInvalidated = true;
-		if (has_parent_layout())
-			parent_layout().invalidate();
-		if (has_layout_owner())
+		propagate_arrangement_invalidation();
+	}
+
+	bool layout::item_arrangement_invalidated() const
+	{
+		return iItemArrangementInvalidated;
+	}
+
+	void layout::invalidate_item_arrangement()
+	{
+		if (!enabled())
+			return;
+		if (invalidated() || item_arrangement_invalidated())
+			return;
+		iItemArrangementInvalidated = true;
+		propagate_arrangement_invalidation();
+	}
+
+	void layout::invalidate_measurements()
+	{
+		for (auto& item : items())
 		{
-			if (layout_owner().is_managing_layout())
-				layout_owner().layout_items(true);
-			i_widget* w = iOwner;
-			while (w != nullptr && w->has_parent())
+			item.invalidate_measurement();
+			i_layout* itemLayout = nullptr;
+			if (item.is_layout())
+				itemLayout = &item.as_layout();
+			else if (item.is_widget() && item.as_widget().has_layout())
+				itemLayout = &item.as_widget().layout();
+			if (itemLayout != nullptr)
 			{
-				w = &w->parent();
-				if (w->has_layout())
-					break;
+				itemLayout->invalidate_measurements();
+				itemLayout->invalidate_arrangement();
 			}
-			if (w != nullptr && w != iOwner && w->has_layout())
-				w->layout().invalidate();
 		}
 	}
 
+	bool layout::item_measurement_changed(const i_layout_item& aItem) const
+	{
+		for (const auto& item : items())
+			if (&item.subject() == &aItem)
+				return item.measurement_changed();
+		return true;
+	}
+
 	void layout::validate()
 	{
 		iInvalidated = false;
+		iItemArrangementInvalidated = false;
 	}
 
 	point layout::position() const
@@ -676,4 +733,37 @@ namespace neogfx
 			}
 		return count;
 	}
-}
\ No newline at end of file
+
+	void layout::propagate_arrangement_invalidation()
+	{
+		if (has_parent_layout())
+			parent_layout().invalidate_item_arrangement();
+		else if (has_layout_owner())
+		{
+			if (layout_owner().is_managing_layout())
+				layout_owner().layout_items(true); // the managing widget arranges everything below it so stop here
+			else if (layout_owner().has_parent_layout())
+				layout_owner().parent_layout().invalidate_item_arrangement();
+			else
+			{
+				i_widget* w = iOwner;
+				while (w != nullptr && w->has_parent())
+				{
+					w = &w->parent();
+					if (w->has_layout())
+						break;
+				}
+				if (w != nullptr && w != iOwner && w->has_layout())
+					w->layout().invalidate_item_arrangement();
+			}
+		}
+	}
+
+	void layout::arrange_invalidated_items()
+	{
+		iItemArrangementInvalidated = false;
+		for (auto& item : items())
+			if (item.visible() && !item.is_spacer())
+				item.subject().layout_as(item.subject().position(), item.subject().extents());
+	}
+}
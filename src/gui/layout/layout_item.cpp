@@ -21,16 +21,24 @@
 #include <neogfx/gui/layout/layout_item.hpp>
 #include <neogfx/gui/layout/i_layout.hpp>
 #include <neogfx/gui/layout/i_spacer.hpp>
+#include <neogfx/gui/layout/layout_statistics.hpp>
 
 namespace neogfx
 {
+	namespace
+	{
+		uint32_t sGeneration;
+	}
+
 	layout_item::layout_item(i_layout& aParentLayout, i_layout_item& aItem) :
 		layout_item{ aParentLayout, std::shared_ptr<i_layout_item>{ std::shared_ptr<i_layout_item>{}, &aItem } } 
 	{
 	}
 
 	layout_item::layout_item(i_layout& aParentLayout, std::shared_ptr<i_layout_item> aItem) :
-		iSubject{ aItem }, iLayoutId{ -1, -1 }
+		iSubject{ aItem }, 
+		iMinimumSize{ static_cast<uint32_t>(-1), 0u, optional_size{}, size{} }, 
+		iMaximumSize{ static_cast<uint32_t>(-1), 0u, optional_size{}, size{} }
 	{
 		subject().set_parent_layout(&aParentLayout);
 		if (aParentLayout.has_layout_owner())
@@ -38,7 +46,9 @@ namespace neogfx
 	}
 
 	layout_item::layout_item(const layout_item& aOther) :
-		iSubject{ aOther.iSubject }, iLayoutId{ -1, -1 }
+		iSubject{ aOther.iSubject }, 
+		iMinimumSize{ static_cast<uint32_t>(-1), 0u, optional_size{}, size{} }, 
+		iMaximumSize{ static_cast<uint32_t>(-1), 0u, optional_size{}, size{} }
 	{
 	}
 
@@ -252,39 +262,18 @@ namespace neogfx
 	{
 		if (!visible())
 			return size{};
-		if (iLayoutId.first == parent_layout().layout_id() && iLayoutId.first != -1)
-			return iMinimumSize;
-		else
-		{
-			iMinimumSize = subject().minimum_size(aAvailableSpace);
-			if (size_policy().maintain_aspect_ratio())
-			{
-				const auto& aspectRatio = size_policy().aspect_ratio();
-				if (aspectRatio.cx < aspectRatio.cy)
-				{
-					if (iMinimumSize.cx < iMinimumSize.cy)
-						iMinimumSize = size{ iMinimumSize.cx, iMinimumSize.cx * (aspectRatio.cy / aspectRatio.cx) };
-					else
-						iMinimumSize = size{ iMinimumSize.cy * (aspectRatio.cx / aspectRatio.cy), iMinimumSize.cy };
-				}
-				else
-				{
-					if (iMinimumSize.cx < iMinimumSize.cy)
-						iMinimumSize = size{ iMinimumSize.cy * (aspectRatio.cx / aspectRatio.cy), iMinimumSize.cy };
-					else
-						iMinimumSize = size{ iMinimumSize.cx, iMinimumSize.cx * (aspectRatio.cy / aspectRatio.cx) };
-				}
-			}
-			iLayoutId.first = parent_layout().layout_id();
-			return iMinimumSize;
-		}
+		if (iMinimumSize.layoutId == subject().layout_id() && iMinimumSize.layoutId != static_cast<uint32_t>(-1) && 
+			iMinimumSize.generation == generation() && iMinimumSize.availableSpace == aAvailableSpace)
+			return iMinimumSize.value;
+		auto const result = measure_minimum_size(aAvailableSpace);
+		iMinimumSize = cached_size{ subject().layout_id(), generation(), aAvailableSpace, result };
+		return result;
 	}
 
 	void layout_item::set_minimum_size(const optional_size& aMinimumSize, bool aUpdateLayout)
 	{
 		subject().set_minimum_size(aMinimumSize, aUpdateLayout);
-		if (aMinimumSize != boost::none)
-			iMinimumSize = *aMinimumSize;
+		iMinimumSize.layoutId = static_cast<uint32_t>(-1);
 	}
 
 	bool layout_item::has_maximum_size() const
@@ -296,21 +285,18 @@ namespace neogfx
 	{
 		if (!visible())
 			return size::max_size();
-		if (iLayoutId.second == parent_layout().layout_id() && iLayoutId.second != -1)
-			return iMaximumSize;
-		else
-		{
-			iMaximumSize = subject().maximum_size(aAvailableSpace);
-			iLayoutId.second = parent_layout().layout_id();
-			return iMaximumSize;
-		}
+		if (iMaximumSize.layoutId == subject().layout_id() && iMaximumSize.layoutId != static_cast<uint32_t>(-1) &&
+			iMaximumSize.generation == generation() && iMaximumSize.availableSpace == aAvailableSpace)
+			return iMaximumSize.value;
+		layout_statistics::instance().item_measured();
+		iMaximumSize = cached_size{ subject().layout_id(), generation(), aAvailableSpace, subject().maximum_size(aAvailableSpace) };
+		return iMaximumSize.value;
 	}
 
 	void layout_item::set_maximum_size(const optional_size& aMaximumSize, bool aUpdateLayout)
 	{
 		subject().set_maximum_size(aMaximumSize, aUpdateLayout);
-		if (aMaximumSize != boost::none)
-			iMaximumSize = *aMaximumSize;
+		iMaximumSize.layoutId = static_cast<uint32_t>(-1);
 	}
 
 	bool layout_item::has_margins() const
@@ -333,8 +319,67 @@ namespace neogfx
 		return subject().visible();
 	}
 
+	bool layout_item::measurement_changed() const
+	{
+		if (!visible())
+			return false;
+		if (iMinimumSize.layoutId == static_cast<uint32_t>(-1) || iMinimumSize.generation != generation() ||
+			iMaximumSize.layoutId == static_cast<uint32_t>(-1) || iMaximumSize.generation != generation())
+			return true;
+		auto const minimumSize = measure_minimum_size(iMinimumSize.availableSpace);
+		layout_statistics::instance().item_measured();
+		auto const maximumSize = subject().maximum_size(iMaximumSize.availableSpace);
+		bool const changed = (minimumSize != iMinimumSize.value || maximumSize != iMaximumSize.value);
+		iMinimumSize.layoutId = subject().layout_id();
+		iMinimumSize.value = minimumSize;
+		iMaximumSize.layoutId = subject().layout_id();
+		iMaximumSize.value = maximumSize;
+		return changed;
+	}
+
+	void layout_item::invalidate_measurement()
+	{
+		iMinimumSize.layoutId = static_cast<uint32_t>(-1);
+		iMaximumSize.layoutId = static_cast<uint32_t>(-1);
+	}
+
 	bool layout_item::operator==(const layout_item& aOther) const
 	{
 		return iSubject == aOther.iSubject;
 	}
+
+	uint32_t layout_item::generation()
+	{
+		return sGeneration;
+	}
+
+	void layout_item::next_generation()
+	{
+		++sGeneration;
+	}
+
+	size layout_item::measure_minimum_size(const optional_size& aAvailableSpace) const
+	{
+		layout_statistics::instance().item_measured();
+		auto result = subject().minimum_size(aAvailableSpace);
+		if (size_policy().maintain_aspect_ratio())
+		{
+			const auto& aspectRatio = size_policy().aspect_ratio();
+			if (aspectRatio.cx < aspectRatio.cy)
+			{
+				if (result.cx < result.cy)
+					result = size{ result.cx, result.cx * (aspectRatio.cy / aspectRatio.cx) };
+				else
+					result = size{ result.cy * (aspectRatio.cx / aspectRatio.cy), result.cy };
+			}
+			else
+			{
+				if (result.cx < result.cy)
+					result = size{ result.cy * (aspectRatio.cx / aspectRatio.cy), result.cy };
+				else
+					result = size{ result.cx, result.cx * (aspectRatio.cy / aspectRatio.cx) };
+			}
+		}
+		return result;
+	}
 }
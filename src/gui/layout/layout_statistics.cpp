@@ -0,0 +1,87 @@
+// layout_statistics.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <neogfx/gui/layout/layout_statistics.hpp>
+
+namespace neogfx
+{
+	layout_statistics::layout_statistics() :
+		iPasses{ 0u }, iPassDepth{ 0u }, iCurrentPass{}, iLastPass{}
+	{
+	}
+
+	layout_statistics& layout_statistics::instance()
+	{
+		static layout_statistics sInstance;
+		return sInstance;
+	}
+
+	uint32_t layout_statistics::passes() const
+	{
+		return iPasses;
+	}
+
+	const layout_statistics::pass& layout_statistics::current_pass() const
+	{
+		return iCurrentPass;
+	}
+
+	const layout_statistics::pass& layout_statistics::last_pass() const
+	{
+		return iLastPass;
+	}
+
+	bool layout_statistics::pass_in_progress() const
+	{
+		return iPassDepth != 0u;
+	}
+
+	void layout_statistics::reset()
+	{
+		iPasses = 0u;
+		iCurrentPass = pass{};
+		iLastPass = pass{};
+	}
+
+	void layout_statistics::pass_started()
+	{
+		++iPassDepth;
+	}
+
+	void layout_statistics::pass_completed()
+	{
+		if (--iPassDepth == 0u)
+		{
+			++iPasses;
+			iLastPass = iCurrentPass;
+			iCurrentPass = pass{};
+		}
+	}
+
+	void layout_statistics::item_measured()
+	{
+		++iCurrentPass.itemsMeasured;
+	}
+
+	void layout_statistics::item_arranged()
+	{
+		++iCurrentPass.itemsArranged;
+	}
+}
@@ -133,8 +133,7 @@ namespace neogfx
 		if (iExpansionPolicy != aExpansionPolicy)
 		{
 			iExpansionPolicy = aExpansionPolicy;
-			if (has_layout_owner())
-				layout_owner().ultimate_ancestor().layout_items(true);
+			update_layout();
 		}
 	}
 
@@ -195,8 +194,8 @@ namespace neogfx
 		if (iSizePolicy != aSizePolicy)
 		{
 			iSizePolicy = aSizePolicy;
-			if (has_layout_owner() && aUpdateLayout)
-				layout_owner().ultimate_ancestor().layout_items(true);
+			if (aUpdateLayout)
+				update_layout();
 		}
 	}
 
@@ -218,8 +217,8 @@ namespace neogfx
 		if (iWeight != aWeight)
 		{
 			iWeight = aWeight;
-			if (has_layout_owner() && aUpdateLayout)
-				layout_owner().ultimate_ancestor().layout_items(true);
+			if (aUpdateLayout)
+				update_layout();
 		}
 	}
 
@@ -241,8 +240,8 @@ namespace neogfx
 		if (iMinimumSize != newMinimumSize)
 		{
 			iMinimumSize = newMinimumSize;
-			if (has_layout_owner() && aUpdateLayout)
-				layout_owner().ultimate_ancestor().layout_items(true);
+			if (aUpdateLayout)
+				update_layout();
 		}
 	}
 
@@ -264,8 +263,8 @@ namespace neogfx
 		if (iMaximumSize != newMaximumSize)
 		{
 			iMaximumSize = newMaximumSize;
-			if (has_layout_owner() && aUpdateLayout)
-				layout_owner().ultimate_ancestor().layout_items(true);
+			if (aUpdateLayout)
+				update_layout();
 		}
 	}
 
@@ -320,6 +319,8 @@ namespace neogfx
 	{
 		if (++iLayoutId == static_cast<uint32_t>(-1))
 			iLayoutId = 0;
+		if (has_parent_layout())
+			parent_layout().next_layout_id();
 	}
 
 	bool spacer::visible() const
@@ -329,6 +330,13 @@ namespace neogfx
 		return false;
 	}
 
+	void spacer::update_layout()
+	{
+		next_layout_id();
+		if (has_parent_layout())
+			parent_layout().invalidate_arrangement();
+	}
+
 	horizontal_spacer::horizontal_spacer() :
 		spacer(ExpandHorizontally)
 	{
@@ -100,8 +100,9 @@ namespace neogfx
 		if (debug == this)
 			std::cerr << "stack_layout::layout_items(" << aPosition << ", " << aSize << ")" << std::endl;
 		layout_owner().layout_items_started();
-		next_layout_id();
 		validate();
+		set_position(aPosition);
+		set_extents(aSize);
 		for (auto& item : items())
 		{
 			if (!item.visible())
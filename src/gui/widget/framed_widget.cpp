@@ -126,8 +126,7 @@ namespace neogfx
 		if (iStyle != aStyle)
 		{
 			iStyle = aStyle;
-			if (has_managing_layout())
-				managing_layout().layout_items(true);
+			update_layout();
 		}
 	}
 
@@ -18,7 +18,7 @@
 */
 
 #include <neogfx/neogfx.hpp>
-#include <neolib/timer.hpp>
+#include <neogfx/core/timer.hpp>
 #include <neolib/lifetime.hpp>
 #include <neogfx/app/app.hpp>
 #include <neogfx/gui/layout/i_layout.hpp>
@@ -28,11 +28,11 @@
 
 namespace neogfx
 {
-	class header_view::updater : private neolib::callback_timer
+	class header_view::updater : private callback_timer
 	{
 	public:
 		updater(header_view& aParent) :
-			neolib::callback_timer{ app::instance(), [this, &aParent](neolib::callback_timer&)
+			callback_timer{ [this, &aParent](callback_timer&)
 			{
 				neolib::destroyed_flag destroyed{ *this };
 				neolib::destroyed_flag surfaceDestroyed{ aParent.surface().as_lifetime() };
@@ -213,8 +213,8 @@ namespace neogfx
 		size oldSize = minimum_size();
 		iTexture = aTexture;
 		image_changed.trigger();
-		if (oldSize != minimum_size() && has_managing_layout())
-			managing_layout().layout_items(true);
+		if (oldSize != minimum_size())
+			update_layout();
 		update();
 	}
 
@@ -223,8 +223,8 @@ namespace neogfx
 		size oldSize = minimum_size();
 		iTexture = aImage;
 		image_changed.trigger();
-		if (oldSize != minimum_size() && has_managing_layout())
-			managing_layout().layout_items(true);
+		if (oldSize != minimum_size())
+			update_layout();
 		update();
 	}
 
@@ -305,7 +305,7 @@ namespace neogfx
 			}			
 			if (capturing())
 			{
-				iMouseTracker.emplace(app::instance(), [this](neolib::callback_timer& aTimer)
+				iMouseTracker.emplace([this](callback_timer& aTimer)
 				{
 					aTimer.again();
 					auto item = item_at(root().mouse_position() - origin());
@@ -376,7 +376,7 @@ namespace neogfx
 			{
 				if (!iSubMenuOpener)
 				{
-					iSubMenuOpener = std::make_unique<neolib::callback_timer>(app::instance(), [this](neolib::callback_timer&)
+					iSubMenuOpener = std::make_unique<callback_timer>([this](callback_timer&)
 					{
 						destroyed_flag destroyed{ *this };
 						if (!menu_item().sub_menu().is_open())
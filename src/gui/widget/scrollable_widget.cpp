@@ -349,6 +349,18 @@ namespace neogfx
 		return neogfx::scrolling_disposition::ScrollChildWidgetVertically | neogfx::scrolling_disposition::ScrollChildWidgetHorizontally;
 	}
 
+	point scrollable_widget::child_offset(const i_widget& aChild) const
+	{
+		if (iScrollPosition == point{})
+			return point{};
+		point result = -iScrollPosition;
+		if ((scrolling_disposition(aChild) & neogfx::scrolling_disposition::ScrollChildWidgetHorizontally) == neogfx::scrolling_disposition::DontScrollChildWidget)
+			result.x = 0.0;
+		if ((scrolling_disposition(aChild) & neogfx::scrolling_disposition::ScrollChildWidgetVertically) == neogfx::scrolling_disposition::DontScrollChildWidget)
+			result.y = 0.0;
+		return result;
+	}
+
 	rect scrollable_widget::scrollbar_geometry(const i_units_context& aContext, const i_scrollbar& aScrollbar) const
 	{
 		switch (aScrollbar.type())
@@ -372,35 +384,98 @@ namespace neogfx
 		}
 	}
 
-	void scrollable_widget::scrollbar_updated(const i_scrollbar& aScrollbar, i_scrollbar::update_reason_e)
+	void scrollable_widget::scrollbar_updated(const i_scrollbar& aScrollbar, i_scrollbar::update_reason_e aReason)
 	{
 		if (!iIgnoreScrollbarUpdates)
 		{
 			point scrollPosition = units_converter(*this).from_device_units(point(static_cast<coordinate>(horizontal_scrollbar().position()), static_cast<coordinate>(vertical_scrollbar().position())));
-			if (iOldScrollPosition != scrollPosition)
+			if (aScrollbar.type() == scrollbar_type::Vertical)
+				scrollPosition.x = iScrollPosition.x;
+			else
+				scrollPosition.y = iScrollPosition.y;
+			if (iScrollPosition != scrollPosition)
 			{
+				point const delta = iScrollPosition - scrollPosition;
+				iScrollPosition = scrollPosition;
+				invalidate_hit_test_index();
+				// children are repositioned by child_offset(); only those that are or were in view need to know
+				auto const cr = client_rect();
 				for (auto& c : children())
 				{
-					point delta = -(scrollPosition - iOldScrollPosition);
-					if (aScrollbar.type() == scrollbar_type::Horizontal || (scrolling_disposition(*c) & neogfx::scrolling_disposition::ScrollChildWidgetVertically) == neogfx::scrolling_disposition::DontScrollChildWidget)
-						delta.y = 0.0;
-					if (aScrollbar.type() == scrollbar_type::Vertical || (scrolling_disposition(*c) & neogfx::scrolling_disposition::ScrollChildWidgetHorizontally) == neogfx::scrolling_disposition::DontScrollChildWidget)
-						delta.x = 0.0;
-					c->move(c->position() + delta);
-				}
-				if (aScrollbar.type() == scrollbar_type::Vertical)
-				{
-					iOldScrollPosition.y = scrollPosition.y;
+					point childDelta = delta;
+					if ((scrolling_disposition(*c) & neogfx::scrolling_disposition::ScrollChildWidgetHorizontally) == neogfx::scrolling_disposition::DontScrollChildWidget)
+						childDelta.x = 0.0;
+					if ((scrolling_disposition(*c) & neogfx::scrolling_disposition::ScrollChildWidgetVertically) == neogfx::scrolling_disposition::DontScrollChildWidget)
+						childDelta.y = 0.0;
+					if (childDelta == point{})
+						continue;
+					rect const childRect{ c->position(), c->extents() };
+					if (!childRect.intersection(cr).empty() || !rect{ childRect.position() - childDelta, childRect.extents() }.intersection(cr).empty())
+						c->moved();
 				}
-				else if (aScrollbar.type() == scrollbar_type::Horizontal)
+				rect scrollArea;
+				if ((aReason == i_scrollbar::ScrolledUp || aReason == i_scrollbar::ScrolledDown) && can_scroll_surface(aScrollbar, scrollArea))
 				{
-					iOldScrollPosition.x = scrollPosition.x;
+					surface().scroll_surface(to_window_coordinates(scrollArea), delta);
+					update(to_client_coordinates(scrollbar_geometry(*this, aScrollbar)));
+					return;
 				}
 			}
+			else if (aReason == i_scrollbar::Updated)
+			{
+				update(to_client_coordinates(scrollbar_geometry(*this, aScrollbar)));
+				return;
+			}
 		}
 		update(true);
 	}
 
+	bool scrollable_widget::can_scroll_surface(const i_scrollbar& aScrollbar, rect& aArea) const
+	{
+		if ((!is_root() && !has_parent()) || !has_root() || !root().has_native_surface() || effectively_hidden() || layout_items_in_progress())
+			return false;
+		if (aScrollbar.style() != scrollbar_style::Normal || opacity() != 1.0 || (transparent_background() && !has_background_colour()))
+			return false;
+		auto const axis = (aScrollbar.type() == scrollbar_type::Vertical ? neogfx::scrolling_disposition::ScrollChildWidgetVertically : neogfx::scrolling_disposition::ScrollChildWidgetHorizontally);
+		aArea = to_window_coordinates(client_rect());
+		for (const i_widget* w = this; !w->is_root() && w->has_parent(); w = &w->parent())
+			aArea = aArea.intersection(w->parent().to_window_coordinates(w->parent().client_rect()));
+		// siblings painted after us (or after any ancestor) are on top so the surface can't be copied from under them;
+		// children are painted last to first
+		for (const i_widget* w = this; !w->is_root() && w->has_parent(); w = &w->parent())
+		{
+			auto const& siblings = w->parent().children();
+			for (auto s = siblings.begin(); s != siblings.end() && &**s != w; ++s)
+				if (!(*s)->is_root() && !(*s)->hidden() && !(*s)->window_rect().intersection(aArea).empty())
+					return false;
+		}
+		aArea = to_client_coordinates(aArea);
+		// children that stay put must sit along an edge of the scrolled area so that they can be excluded from it
+		for (auto& c : children())
+		{
+			if (c->hidden() || (scrolling_disposition(*c) & axis) == axis)
+				continue;
+			rect const childRect{ c->position(), c->extents() };
+			if (childRect.intersection(aArea).empty())
+				continue;
+			bool const spansWidth = childRect.left() <= aArea.left() && childRect.right() >= aArea.right();
+			bool const spansHeight = childRect.top() <= aArea.top() && childRect.bottom() >= aArea.bottom();
+			if (spansWidth && childRect.top() <= aArea.top())
+				aArea = rect{ point{ aArea.left(), childRect.bottom() }, aArea.bottom_right() };
+			else if (spansWidth && childRect.bottom() >= aArea.bottom())
+				aArea = rect{ aArea.top_left(), point{ aArea.right(), childRect.top() } };
+			else if (spansHeight && childRect.left() <= aArea.left())
+				aArea = rect{ point{ childRect.right(), aArea.top() }, aArea.bottom_right() };
+			else if (spansHeight && childRect.right() >= aArea.right())
+				aArea = rect{ aArea.top_left(), point{ childRect.left(), aArea.bottom() } };
+			else
+				return false;
+			if (aArea.cx <= 0.0 || aArea.cy <= 0.0)
+				return false;
+		}
+		return aArea.cx > 0.0 && aArea.cy > 0.0;
+	}
+
 	colour scrollable_widget::scrollbar_colour(const i_scrollbar&) const
 	{
 		return background_colour();
@@ -35,7 +35,7 @@ namespace neogfx
 		};
 	public:
 		close_button(i_tab& aParent) :
-			push_button{ aParent.as_widget().layout() }, iParent{ aParent }, iTextureState{ Unknown }, iUpdater{ app::instance(), [this](neolib::callback_timer& aTimer) { aTimer.again(); update_appearance(); }, 20 }
+			push_button{ aParent.as_widget().layout() }, iParent{ aParent }, iTextureState{ Unknown }, iUpdater{ [this](callback_timer& aTimer) { if (hovered()) aTimer.again(); update_appearance(); }, 20, false }
 		{
 			set_margins(neogfx::margins{ 2.0 });
 			iSink += app::instance().current_style_changed([this](style_aspect aAspect) { if ((aAspect & style_aspect::Colour) == style_aspect::Colour) update_textures(); });
@@ -48,6 +48,8 @@ namespace neogfx
 		void update_state()
 		{
 			update_appearance();
+			if (hovered())
+				iUpdater.again_if();
 		}
 	protected:
 		void paint(graphics_context& aGraphicsContext) const
@@ -150,12 +152,16 @@ namespace neogfx
 			iTextureState = Unknown;
 			update_appearance();
 		}
+		bool hovered() const
+		{
+			return entered() || iParent.as_widget().entered() || (has_root() && root().has_entered_widget() && root().entered_widget().is_descendent_of(iParent.as_widget()));
+		}
 		void update_appearance()
 		{
 			auto oldState = iTextureState;
 			if (entered())
 				iTextureState = TextureOnOver;
-			else if (iParent.is_selected() || iParent.as_widget().entered() || (has_root() && root().has_entered_widget() && root().entered_widget().is_descendent_of(iParent.as_widget())))
+			else if (iParent.is_selected() || hovered())
 				iTextureState = TextureOn;
 			else
 				iTextureState = TextureOff;
@@ -178,7 +184,7 @@ namespace neogfx
 		sink iSink;
 		mutable boost::optional<std::pair<colour, texture>> iTextures[3];
 		texture_index_e iTextureState;
-		neolib::callback_timer iUpdater;
+		callback_timer iUpdater;
 	};
 
 	tab_button::tab_button(i_tab_container& aContainer, const std::string& aText, bool aClosable, bool aStandardImageSize) :
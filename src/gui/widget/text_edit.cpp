@@ -169,11 +169,13 @@ namespace neogfx
 		iGlyphColumns{ 1 },
 		iCursorAnimationStartTime{ app::instance().program_elapsed_ms() },
 		iTabStopHint{ "0000" },
-		iAnimator{ app::instance(), [this](neolib::callback_timer&)
+		iAnimator{ [this](callback_timer&)
 		{
+			if (!has_focus())
+				return;
 			iAnimator.again();
 			animate();
-		}, 40 },
+		}, 40, false },
 		iSuppressTextChangedNotification{ 0u },
 		iWantedToNotfiyTextChanged{ 0u },
 		iOutOfMemory{ false }
@@ -192,11 +194,13 @@ namespace neogfx
 		iGlyphColumns{ 1 },
 		iCursorAnimationStartTime{ app::instance().program_elapsed_ms() },
 		iTabStopHint{ "0000" },
-		iAnimator{ app::instance(), [this](neolib::callback_timer&)
+		iAnimator{ [this](callback_timer&)
 		{
+			if (!has_focus())
+				return;
 			iAnimator.again();
 			animate();
-		}, 40 },
+		}, 40, false },
 		iSuppressTextChangedNotification{ 0u },
 		iWantedToNotfiyTextChanged{ 0u },
 		iOutOfMemory{ false }
@@ -215,11 +219,13 @@ namespace neogfx
 		iGlyphColumns{ 1 },
 		iCursorAnimationStartTime{ app::instance().program_elapsed_ms() },
 		iTabStopHint{ "0000" },
-		iAnimator{ app::instance(), [this](neolib::callback_timer&)
+		iAnimator{ [this](callback_timer&)
 		{
+			if (!has_focus())
+				return;
 			iAnimator.again();
 			animate();
-		}, 40 },
+		}, 40, false },
 		iSuppressTextChangedNotification{ 0u },
 		iWantedToNotfiyTextChanged{ 0u },
 		iOutOfMemory{ false }
@@ -333,6 +339,7 @@ namespace neogfx
 		scrollable_widget::focus_gained(aFocusReason);
 		app::instance().clipboard().activate(*this);
 		iCursorAnimationStartTime = app::instance().program_elapsed_ms();
+		iAnimator.again_if();
 		if (iType == SingleLine && aFocusReason == focus_reason::Tab)
 		{
 			cursor().set_anchor(0);
@@ -853,8 +860,12 @@ namespace neogfx
 
 	void text_edit::set_read_only(bool aReadOnly)
 	{
-		iReadOnly = aReadOnly;
-		update();
+		if (iReadOnly != aReadOnly)
+		{
+			iReadOnly = aReadOnly;
+			update();
+			sink_state_changed.trigger();
+		}
 	}
 
 	bool text_edit::word_wrap() const
@@ -960,7 +971,7 @@ namespace neogfx
 		{
 			if (!capturing())
 				set_capture();
-			iDragger.emplace(app::instance(), [this](neolib::callback_timer& aTimer)
+			iDragger.emplace([this](callback_timer& aTimer)
 			{
 				aTimer.again();
 				set_cursor_position(root().mouse_position() - origin(), false);
@@ -1284,8 +1295,7 @@ namespace neogfx
 		{
 			iHint = aHint;
 			iHintedSize = boost::none;
-			if (has_managing_layout())
-				managing_layout().layout_items(true);
+			update_layout();
 			update();
 		}
 	}
@@ -1344,10 +1354,16 @@ namespace neogfx
 			iCursorAnimationStartTime = app::instance().program_elapsed_ms();
 			make_cursor_visible();
 			update();
+			sink_state_changed.trigger();
 		});
 		iSink += cursor().anchor_changed([this]()
 		{
 			update();
+			sink_state_changed.trigger();
+		});
+		iSink += text_changed([this]()
+		{
+			sink_state_changed.trigger();
 		});
 		iSink += cursor().appearance_changed([this]()
 		{
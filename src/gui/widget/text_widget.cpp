@@ -147,10 +147,7 @@ namespace neogfx
 			iTextExtent = boost::none;
 			iGlyphTextCache = glyph_text{};
 			text_changed.trigger();
-			if (has_parent_layout())
-				parent_layout().invalidate();
-			if (oldSize != minimum_size() && has_managing_layout())
-				managing_layout().layout_items();
+			update_layout(oldSize == minimum_size());
 			update();
 		}
 	}
@@ -162,10 +159,7 @@ namespace neogfx
 			size oldSize = minimum_size();
 			iSizeHint = aSizeHint;
 			iSizeHintExtent = boost::none;
-			if (has_parent_layout())
-				parent_layout().invalidate();
-			if (oldSize != minimum_size() && has_managing_layout())
-				managing_layout().layout_items();
+			update_layout(oldSize == minimum_size());
 		}
 	}
 
@@ -195,7 +189,7 @@ namespace neogfx
 		{
 			iAlignment = aAlignment;
 			if (aUpdateLayout)
-				ultimate_ancestor().layout_items(true);
+				update_layout();
 		}
 	}
 
@@ -318,8 +312,7 @@ namespace neogfx
 				iTextExtent = boost::none;
 				iSizeHintExtent = boost::none;
 				iGlyphTextCache = glyph_text{};
-				if (has_parent_layout())
-					parent_layout().invalidate();
+				update_layout();
 				update();
 			}
 		});
@@ -328,8 +321,7 @@ namespace neogfx
 			iTextExtent = boost::none;
 			iSizeHintExtent = boost::none;
 			iGlyphTextCache = glyph_text{};
-			if (has_parent_layout())
-				parent_layout().invalidate();
+			update_layout();
 			update();
 		});
 	}
@@ -22,15 +22,17 @@
 #include <neogfx/app/app.hpp>
 #include <neogfx/gui/widget/widget.hpp>
 #include <neogfx/gui/layout/i_layout.hpp>
+#include <neogfx/gui/layout/layout_item.hpp>
+#include <neogfx/gui/layout/layout_statistics.hpp>
 #include <neogfx/hid/i_surface_window.hpp>
 
 namespace neogfx
 {
-	class widget::layout_timer : public pause_rendering, neolib::callback_timer
+	class widget::layout_timer : public pause_rendering, callback_timer
 	{
 	public:
-		layout_timer(i_window& aWindow, neolib::async_task& aIoTask, std::function<void(callback_timer&)> aCallback) :
-			pause_rendering{ aWindow }, neolib::callback_timer{ aIoTask, aCallback, 0 }
+		layout_timer(i_window& aWindow, std::function<void(callback_timer&)> aCallback) :
+			pause_rendering{ aWindow }, callback_timer{ aCallback, 0 }
 		{
 		}
 		~layout_timer()
@@ -38,6 +40,129 @@ namespace neogfx
 		}
 	};
 
+	namespace
+	{
+		// subtrees that are cheaper than this to draw are not worth a layer
+		const uint64_t RENDER_LAYER_OPERATION_THRESHOLD = 256u;
+		const uint32_t RENDER_LAYER_STABLE_RENDERS = 2u;
+		// containers with fewer children than this are scanned rather than bucketed
+		const std::size_t HIT_TEST_GRID_THRESHOLD = 32u;
+	}
+
+	class widget::hit_test_index
+	{
+	private:
+		struct entry
+		{
+			const i_widget* child;
+			rect bounds;
+			bool occluded;
+		};
+		typedef std::vector<uint32_t> cell;
+	public:
+		hit_test_index() :
+			iDirty{ true }, iColumns{ 0u }, iRows{ 0u }
+		{
+		}
+	public:
+		void invalidate()
+		{
+			iDirty = true;
+		}
+		const i_widget* child_at(const i_widget& aOwner, const point& aPosition)
+		{
+			if (iDirty)
+				build(aOwner);
+			if (iLastHit != boost::none)
+			{
+				auto const& lastHit = iEntries[*iLastHit];
+				if (!lastHit.occluded && lastHit.bounds.contains(aPosition))
+					return lastHit.child;
+			}
+			if (iColumns == 0u)
+			{
+				for (uint32_t i = 0u; i < iEntries.size(); ++i)
+					if (iEntries[i].bounds.contains(aPosition))
+						return hit(i);
+			}
+			else if (iBounds.contains(aPosition))
+			{
+				for (auto i : iCells[column(aPosition.x) + row(aPosition.y) * iColumns])
+					if (iEntries[i].bounds.contains(aPosition))
+						return hit(i);
+			}
+			return nullptr;
+		}
+	private:
+		const i_widget* hit(uint32_t aEntry)
+		{
+			iLastHit = aEntry;
+			return iEntries[aEntry].child;
+		}
+		void build(const i_widget& aOwner)
+		{
+			iDirty = false;
+			iLastHit = boost::none;
+			iEntries.clear();
+			iCells.clear();
+			iColumns = iRows = 0u;
+			for (const auto& c : aOwner.children())
+				if (c->visible())
+					iEntries.push_back(entry{ &*c, aOwner.to_client_coordinates(c->window_rect()), false });
+			if (iEntries.size() >= HIT_TEST_GRID_THRESHOLD)
+			{
+				iBounds = iEntries[0].bounds;
+				for (const auto& e : iEntries)
+					iBounds = iBounds.combine(e.bounds);
+				if (!iBounds.empty())
+				{
+					iColumns = iRows = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(iEntries.size()))));
+					iCells.resize(iColumns * iRows);
+					for (uint32_t i = 0u; i < iEntries.size(); ++i)
+						for_each_cell(iEntries[i].bounds, [&](cell& aCell) { aCell.push_back(i); });
+				}
+			}
+			// a child that no earlier (topmost) sibling overlaps can answer repeat hits on its own
+			for (uint32_t i = 0u; i < iEntries.size(); ++i)
+			{
+				auto& e = iEntries[i];
+				auto overlaps = [&](uint32_t aOther) { return aOther < i && !e.bounds.intersection(iEntries[aOther].bounds).empty(); };
+				if (iColumns == 0u)
+				{
+					for (uint32_t j = 0u; j < i && !e.occluded; ++j)
+						e.occluded = overlaps(j);
+				}
+				else
+					for_each_cell(e.bounds, [&](cell& aCell) { e.occluded = e.occluded || std::any_of(aCell.begin(), aCell.end(), overlaps); });
+			}
+		}
+		uint32_t column(coordinate aX) const
+		{
+			return std::min(iColumns - 1u, static_cast<uint32_t>(std::max(0.0, (aX - iBounds.x) * iColumns / iBounds.cx)));
+		}
+		uint32_t row(coordinate aY) const
+		{
+			return std::min(iRows - 1u, static_cast<uint32_t>(std::max(0.0, (aY - iBounds.y) * iRows / iBounds.cy)));
+		}
+		template <typename Visitor>
+		void for_each_cell(const rect& aBounds, Visitor aVisitor)
+		{
+			if (aBounds.empty())
+				return;
+			for (uint32_t y = row(aBounds.top()); y <= row(aBounds.bottom()); ++y)
+				for (uint32_t x = column(aBounds.left()); x <= column(aBounds.right()); ++x)
+					aVisitor(iCells[x + y * iColumns]);
+		}
+	private:
+		bool iDirty;
+		std::vector<entry> iEntries;
+		rect iBounds;
+		uint32_t iColumns;
+		uint32_t iRows;
+		std::vector<cell> iCells;
+		boost::optional<uint32_t> iLastHit;
+	};
+
 	i_widget* widget::debug;
 
 	widget::widget() :
@@ -61,7 +186,12 @@ namespace neogfx
 		iForegroundColour{},
 		iBackgroundColour{},
 		iIgnoreMouseEvents{ false },
-		iIgnoreNonClientMouseEvents{ true }
+		iIgnoreNonClientMouseEvents{ true },
+		iRenderLayerPolicy{ neogfx::render_layer_policy::Automatic },
+		iRenderLayerDirty{ true },
+		iRenderLayerAcquired{ false },
+		iRenderLayerStableRenders{ 0u },
+		iRenderLayerOperations{ 0u }
 	{
 	}
 	
@@ -86,7 +216,12 @@ namespace neogfx
 		iForegroundColour{},
 		iBackgroundColour{},
 		iIgnoreMouseEvents{ false },
-		iIgnoreNonClientMouseEvents{ true }
+		iIgnoreNonClientMouseEvents{ true },
+		iRenderLayerPolicy{ neogfx::render_layer_policy::Automatic },
+		iRenderLayerDirty{ true },
+		iRenderLayerAcquired{ false },
+		iRenderLayerStableRenders{ 0u },
+		iRenderLayerOperations{ 0u }
 	{
 		aParent.add(*this);
 	}
@@ -112,13 +247,21 @@ namespace neogfx
 		iForegroundColour{},
 		iBackgroundColour{},
 		iIgnoreMouseEvents{ false },
-		iIgnoreNonClientMouseEvents{ true }
+		iIgnoreNonClientMouseEvents{ true },
+		iRenderLayerPolicy{ neogfx::render_layer_policy::Automatic },
+		iRenderLayerDirty{ true },
+		iRenderLayerAcquired{ false },
+		iRenderLayerStableRenders{ 0u },
+		iRenderLayerOperations{ 0u }
 	{
 		aLayout.add(*this);
 	}
 
 	widget::~widget()
 	{
+		// layers are keyed by address so ours must go before another widget can take it
+		if (iRenderLayerAcquired && has_root() && root().has_native_surface())
+			surface().release_render_layer(*this);
 		unlink();
 		if (app::instance().keyboard().is_keyboard_grabbed_by(*this))
 			app::instance().keyboard().ungrab_keyboard(*this);
@@ -232,6 +375,7 @@ namespace neogfx
 
 	void widget::parent_changed()
 	{
+		app::instance().invalidate_mnemonics();
 		if (!is_root() && has_managing_layout())
 			managing_layout().layout_items(true);
 	}
@@ -293,6 +437,7 @@ namespace neogfx
 		if (oldParent != nullptr)
 			aChild = oldParent->remove(*aChild, true);
 		iChildren.push_back(aChild);
+		invalidate_hit_test_index();
 		aChild->set_parent(*this);
 		aChild->set_singular(false);
 		if (has_root())
@@ -309,6 +454,7 @@ namespace neogfx
 		if (aSingular)
 			keep->set_singular(true);
 		iChildren.erase(existing);
+		invalidate_hit_test_index();
 		if (has_layout())
 			layout().remove(aChild);
 		if (has_root())
@@ -682,7 +828,7 @@ namespace neogfx
 		{
 			if (!iLayoutTimer)
 			{
-				iLayoutTimer = std::make_unique<layout_timer>(root(), app::instance(), [this](neolib::callback_timer&)
+				iLayoutTimer = std::make_unique<layout_timer>(root(), [this](callback_timer&)
 				{
 					if (root().has_native_window())
 					{
@@ -701,7 +847,8 @@ namespace neogfx
 
 	void widget::layout_items_started()
 	{
-		++iLayoutInProgress;
+		if (iLayoutInProgress++ == 0)
+			layout_statistics::instance().pass_started();
 	}
 
 	bool widget::layout_items_in_progress() const
@@ -713,6 +860,7 @@ namespace neogfx
 	{
 		if (--iLayoutInProgress == 0)
 		{
+			layout_statistics::instance().pass_completed();
 			layout_completed.trigger();
 			update();
 		}
@@ -751,7 +899,10 @@ namespace neogfx
 
 	point widget::position() const
 	{
-		return units_converter(*this).from_device_units(iPosition);
+		if (!is_root() && has_parent())
+			return units_converter(*this).from_device_units(iPosition) + parent().child_offset(*this);
+		else
+			return units_converter(*this).from_device_units(iPosition);
 	}
 
 	void widget::set_position(const point& aPosition)
@@ -769,10 +920,13 @@ namespace neogfx
 
 	void widget::move(const point& aPosition)
 	{
-		if (iPosition != units_converter(*this).to_device_units(aPosition))
+		point const newPosition = units_converter(*this).to_device_units(!is_root() && has_parent() ? aPosition - parent().child_offset(*this) : aPosition);
+		if (iPosition != newPosition)
 		{
 			update(true);
-			iPosition = units_converter(*this).to_device_units(aPosition);
+			iPosition = newPosition;
+			if (has_parent())
+				parent().invalidate_hit_test_index();
 			update(true);
 			moved();
 		}
@@ -782,6 +936,11 @@ namespace neogfx
 	{
 		position_changed.trigger();
 	}
+
+	point widget::child_offset(const i_widget&) const
+	{
+		return point{};
+	}
 	
 	size widget::extents() const
 	{
@@ -799,6 +958,8 @@ namespace neogfx
 		{
 			update();
 			iSize = units_converter(*this).to_device_units(aSize);
+			if (has_parent())
+				parent().invalidate_hit_test_index();
 			update();
 			resized();
 		}
@@ -825,11 +986,21 @@ namespace neogfx
 
 	const i_widget& widget::widget_at(const point& aPosition) const
 	{
-		if (client_rect().contains(aPosition))
+		if (client_rect().contains(aPosition) && has_children())
 		{
-			for (const auto& c : children())
-				if (c->visible() && to_client_coordinates(c->window_rect()).contains(aPosition))
-					return c->widget_at(aPosition - c->position());
+			if (children().size() < HIT_TEST_GRID_THRESHOLD)
+			{
+				iHitTestIndex.reset();
+				for (const auto& c : children())
+					if (c->visible() && to_client_coordinates(c->window_rect()).contains(aPosition))
+						return c->widget_at(aPosition - c->position());
+				return *this;
+			}
+			if (iHitTestIndex == nullptr)
+				iHitTestIndex = std::make_unique<hit_test_index>();
+			auto c = iHitTestIndex->child_at(*this, aPosition);
+			if (c != nullptr)
+				return c->widget_at(aPosition - c->position());
 		}
 		return *this;
 	}
@@ -867,8 +1038,8 @@ namespace neogfx
 		if (iSizePolicy != aSizePolicy)
 		{
 			iSizePolicy = aSizePolicy;
-			if (aUpdateLayout && has_managing_layout())
-				managing_layout().layout_items(true);
+			if (aUpdateLayout)
+				update_layout();
 		}
 	}
 
@@ -889,8 +1060,8 @@ namespace neogfx
 		if (iWeight != aWeight)
 		{
 			iWeight = aWeight;
-			if (aUpdateLayout && has_managing_layout())
-				managing_layout().layout_items(true);
+			if (aUpdateLayout)
+				update_layout();
 		}
 	}
 
@@ -922,8 +1093,8 @@ namespace neogfx
 		if (iMinimumSize != newMinimumSize)
 		{
 			iMinimumSize = newMinimumSize;
-			if (aUpdateLayout && has_managing_layout())
-				managing_layout().layout_items(true);
+			if (aUpdateLayout)
+				update_layout();
 		}
 	}
 
@@ -957,8 +1128,8 @@ namespace neogfx
 		if (iMaximumSize != newMaximumSize)
 		{
 			iMaximumSize = newMaximumSize;
-			if (aUpdateLayout && has_managing_layout())
-				managing_layout().layout_items(true);
+			if (aUpdateLayout)
+				update_layout();
 		}
 	}
 
@@ -982,18 +1153,27 @@ namespace neogfx
 		if (iMargins != newMargins)
 		{
 			iMargins = newMargins;
-			if (aUpdateLayout && has_managing_layout())
-				managing_layout().layout_items(true);
+			if (aUpdateLayout)
+				update_layout();
 		}
 	}
 
 	void widget::layout_as(const point& aPosition, const size& aSize)
 	{
-		move(aPosition);
-		if (extents() != aSize)
+		bool const resizing = (extents() != aSize);
+		bool const relayout = !resizing && has_layout() && layout().invalidated();
+		bool const rearrangeItems = !resizing && !relayout && has_layout() && layout().item_arrangement_invalidated();
+		if (position() != aPosition || resizing || relayout)
+		{
+			layout_statistics::instance().item_arranged();
+			move(aPosition);
+		}
+		if (resizing)
 			resize(aSize);
-		else if (has_layout() && layout().invalidated())
+		else if (relayout)
 			layout_items();
+		else if (rearrangeItems)
+			layout().layout_as(client_rect(false).top_left(), client_rect(false).extents());
 	}
 
 	uint32_t widget::layout_id() const
@@ -1005,12 +1185,13 @@ namespace neogfx
 	{
 		if (++iLayoutId == static_cast<uint32_t>(-1))
 			iLayoutId = 0;
-		if (has_layout())
-			layout().next_layout_id();
+		if (has_parent_layout() && parent_layout().item_measurement_changed(*this))
+			parent_layout().next_layout_id();
 	}
 
 	void widget::update(bool aIncludeNonClient)
 	{
+		invalidate_render_layer();
 		if ((!is_root() && !has_parent()) || !has_root() || !root().has_native_surface() || effectively_hidden() || layout_items_in_progress())
 			return;
 		update(aIncludeNonClient ? to_client_coordinates(window_rect()) : client_rect());
@@ -1018,6 +1199,7 @@ namespace neogfx
 
 	void widget::update(const rect& aUpdateRect)
 	{
+		invalidate_render_layer();
 		if ((!is_root() && !has_parent()) || !has_root() || !root().has_native_surface() || effectively_hidden() || layout_items_in_progress())
 			return;
 		if (aUpdateRect.empty())
@@ -1062,6 +1244,54 @@ namespace neogfx
 		if (!requires_update())
 			return;
 
+		bool const layerable = !is_root() && opacity() == 1.0;
+		if (layerable && (iRenderLayerPolicy == neogfx::render_layer_policy::Always ||
+			(iRenderLayerPolicy == neogfx::render_layer_policy::Automatic &&
+				iRenderLayerOperations >= RENDER_LAYER_OPERATION_THRESHOLD && iRenderLayerStableRenders >= RENDER_LAYER_STABLE_RENDERS)))
+		{
+			aGraphicsContext.flush();
+			iDefaultClipRect = std::make_pair(boost::none, boost::none);
+			bool const opaque = !transparent_background() || (has_background_colour() && background_colour().alpha() == 0xFF);
+			iRenderLayerAcquired = true;
+			if (surface().render_layer(*this, window_rect(), to_window_coordinates(default_clip_rect(true)), opaque, iRenderLayerDirty,
+				[this, &aGraphicsContext]() { render_subtree(aGraphicsContext); aGraphicsContext.flush(); }))
+			{
+				iRenderLayerDirty = false;
+				return;
+			}
+		}
+
+		auto const operations = aGraphicsContext.operation_count();
+		render_subtree(aGraphicsContext);
+		iRenderLayerOperations = aGraphicsContext.operation_count() - operations;
+		if (iRenderLayerStableRenders < RENDER_LAYER_STABLE_RENDERS)
+			++iRenderLayerStableRenders;
+	}
+
+	neogfx::render_layer_policy widget::render_layer_policy() const
+	{
+		return iRenderLayerPolicy;
+	}
+
+	void widget::set_render_layer_policy(neogfx::render_layer_policy aPolicy)
+	{
+		if (iRenderLayerPolicy != aPolicy)
+		{
+			iRenderLayerPolicy = aPolicy;
+			invalidate_render_layer();
+		}
+	}
+
+	void widget::invalidate_render_layer()
+	{
+		iRenderLayerDirty = true;
+		iRenderLayerStableRenders = 0u;
+		if (!is_root() && has_parent())
+			parent().invalidate_render_layer();
+	}
+
+	void widget::render_subtree(graphics_context& aGraphicsContext) const
+	{
 		iDefaultClipRect = std::make_pair(boost::none, boost::none);
 
 		const rect updateRect = update_rect();
@@ -1222,8 +1452,9 @@ namespace neogfx
 		if (iFont != aFont)
 		{
 			iFont = aFont;
-			if (has_managing_layout())
-				managing_layout().layout_items(true);
+			if (has_layout())
+				layout().invalidate_measurements(); // compound widgets derive child metrics from our font
+			update_layout();
 			update();
 		}
 	}
@@ -1254,6 +1485,9 @@ namespace neogfx
 		{
 			bool isEntered = entered();
 			iVisible = aVisible;
+			invalidate_render_layer();
+			if (has_parent())
+				parent().invalidate_hit_test_index();
 			if (!visible() && isEntered)
 			{
 				if (!is_root())
@@ -1262,6 +1496,7 @@ namespace neogfx
 					mouse_left();
 			}
 			visibility_changed.trigger();
+			app::instance().invalidate_mnemonics();
 			if (has_parent_layout())
 				parent_layout().invalidate();
 			if (effectively_hidden())
@@ -1574,6 +1809,12 @@ namespace neogfx
 		return graphics_context{ *this };
 	}
 
+	void widget::invalidate_hit_test_index()
+	{
+		if (iHitTestIndex != nullptr)
+			iHitTestIndex->invalidate();
+	}
+
 	const i_surface* widget::find_surface() const
 	{
 		if (iSurface != nullptr)
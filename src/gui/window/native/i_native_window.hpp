@@ -33,6 +33,16 @@ namespace neogfx
 	{
 	public:
 		typedef neolib::variant<window_event, mouse_event, non_client_mouse_event, keyboard_event> native_event;
+		typedef std::vector<native_event> native_event_list;
+		struct input_statistics
+		{
+			uint64_t eventsReceived;
+			uint64_t eventsCoalesced;
+			uint64_t inputFramesPainted; // frames painted with at least one input event handled since the previous frame
+			std::chrono::microseconds lastInputToPaint; // from oldest input event handled to the frame being displayed
+			std::chrono::microseconds maximumInputToPaint;
+			std::chrono::microseconds totalInputToPaint;
+		};
 	public:
 		event<native_event&> filter_event;
 	public:
@@ -50,6 +60,10 @@ namespace neogfx
 		virtual void handle_event(const native_event& aNativeEvent) = 0;
 		virtual bool has_current_event() const = 0;
 		virtual const native_event& current_event() const = 0;
+		// the raw events (oldest first) that were coalesced into the current event; empty if it was not coalesced
+		virtual const native_event_list& coalesced_events() const = 0;
+		virtual const input_statistics& input_counters() const = 0;
+		virtual void reset_input_counters() = 0;
 		virtual void handle_event() = 0;
 		virtual bool processing_event() const = 0;
 		virtual i_surface_window& surface_window() const = 0;
@@ -32,15 +32,32 @@
 
 namespace neogfx
 {
+	namespace
+	{
+		boost::optional<event_timestamp> input_timestamp(const i_native_window::native_event& aEvent)
+		{
+			if (aEvent.is<mouse_event>())
+				return static_variant_cast<const mouse_event&>(aEvent).timestamp();
+			else if (aEvent.is<non_client_mouse_event>())
+				return static_variant_cast<const non_client_mouse_event&>(aEvent).timestamp();
+			else if (aEvent.is<keyboard_event>())
+				return static_variant_cast<const keyboard_event&>(aEvent).timestamp();
+			return boost::none;
+		}
+	}
+
 	native_window::native_window(i_rendering_engine& aRenderingEngine, i_surface_manager& aSurfaceManager) :
 		iRenderingEngine{ aRenderingEngine },
 		iSurfaceManager{ aSurfaceManager },
+		iInputCounters{},
 		iProcessingEvent{ 0u },
 		iNonClientEntered{ false },
-		iUpdater{ app::instance(), [this](neolib::callback_timer& aTimer)
+		iUpdater{ [this](callback_timer& aTimer)
 		{
+			if (!non_client_entered())
+				return;
 			aTimer.again();
-			if (non_client_entered() && 
+			if (
 				surface_window().native_window_hit_test(surface_window().as_window().window_manager().mouse_position(surface_window().as_window())) == widget_part::Nowhere)
 			{
 				auto e1 = find_event<window_event>(window_event_type::NonClientLeave);
@@ -49,7 +66,7 @@ namespace neogfx
 					std::distance(iEventQueue.cbegin(), e1) < std::distance(iEventQueue.cbegin(), e2)))
 					push_event(window_event{ window_event_type::NonClientLeave });
 			}
-		}, 10 }
+		}, 10, false }
 	{
 	}
 
@@ -89,6 +106,9 @@ namespace neogfx
 
 	void native_window::push_event(const native_event& aEvent)
 	{
+		++iInputCounters.eventsReceived;
+		if (coalesce(aEvent))
+			return;
 		if (aEvent.is<window_event>())
 		{
 			const auto& windowEvent = static_variant_cast<const window_event&>(aEvent);
@@ -98,7 +118,7 @@ namespace neogfx
 			case window_event_type::SizeChanged:
 				for (auto e = iEventQueue.begin(); e != iEventQueue.end();)
 				{
-					if (e->is<window_event>() && static_variant_cast<const window_event&>(*e).type() == windowEvent.type())
+					if (e->event.is<window_event>() && static_variant_cast<const window_event&>(e->event).type() == windowEvent.type())
 						e = iEventQueue.erase(e);
 					else
 						++e;
@@ -108,7 +128,7 @@ namespace neogfx
 				break;
 			}
 		}
-		iEventQueue.push_back(aEvent);
+		iEventQueue.push_back(queued_event{ aEvent });
 	}
 
 	bool native_window::pump_event()
@@ -116,9 +136,22 @@ namespace neogfx
 		neolib::scoped_counter sc{ iProcessingEvent };
 		if (iEventQueue.empty())
 			return false;
-		auto e = iEventQueue.front();
+		auto e = std::move(iEventQueue.front());
 		iEventQueue.pop_front();
-		handle_event(e);
+		if (!e.coalesced.empty())
+		{
+			// latency is measured from the oldest of the raw events
+			auto oldest = input_timestamp(e.coalesced.front());
+			if (oldest != boost::none)
+				input_handled(*oldest);
+		}
+		neolib::destroyed_flag destroyed{ *this };
+		iCurrentCoalescedEvents.swap(e.coalesced);
+		handle_event(e.event);
+		if (!destroyed)
+			iCurrentCoalescedEvents.clear();
+		else
+			sc.ignore();
 		return true;
 	}
 
@@ -126,6 +159,9 @@ namespace neogfx
 	{
 		neolib::destroyed_flag destroyed{ *this };
 		neolib::scoped_counter sc{ iProcessingEvent };
+		auto timestamp = input_timestamp(aEvent);
+		if (timestamp != boost::none)
+			input_handled(*timestamp);
 		iCurrentEvent = aEvent;
 		handle_event();
 		if (!destroyed)
@@ -146,6 +182,21 @@ namespace neogfx
 		throw no_current_event();
 	}
 
+	const native_window::native_event_list& native_window::coalesced_events() const
+	{
+		return iCurrentCoalescedEvents;
+	}
+
+	const native_window::input_statistics& native_window::input_counters() const
+	{
+		return iInputCounters;
+	}
+
+	void native_window::reset_input_counters()
+	{
+		iInputCounters = input_statistics{};
+	}
+
 	void native_window::handle_event()
 	{
 		neolib::destroyed_flag destroyed{ *this };
@@ -174,9 +225,9 @@ namespace neogfx
 				surface_window().native_window_resized();
 				for (auto e = iEventQueue.begin(); e != iEventQueue.end();)
 				{
-					if (e->is<window_event>())
+					if (e->event.is<window_event>())
 					{
-						switch (static_variant_cast<const window_event&>(*e).type())
+						switch (static_variant_cast<const window_event&>(e->event).type())
 						{
 						case window_event_type::Resized:
 						case window_event_type::SizeChanged:
@@ -204,6 +255,7 @@ namespace neogfx
 				break;
 			case window_event_type::NonClientEnter:
 				iNonClientEntered = true;
+				iUpdater.again_if();
 				surface_window().native_window_mouse_entered(windowEvent.position());
 				break;
 			case window_event_type::NonClientLeave:
@@ -374,4 +426,55 @@ namespace neogfx
 		iPixelDensityDpi = boost::none;
 		surface_window().handle_dpi_changed();
 	}
+
+	void native_window::input_painted()
+	{
+		if (iOldestUnpaintedInput == boost::none)
+			return;
+		auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - *iOldestUnpaintedInput);
+		iOldestUnpaintedInput = boost::none;
+		++iInputCounters.inputFramesPainted;
+		iInputCounters.lastInputToPaint = latency;
+		iInputCounters.maximumInputToPaint = std::max(iInputCounters.maximumInputToPaint, latency);
+		iInputCounters.totalInputToPaint += latency;
+	}
+
+	bool native_window::coalesce(const native_event& aEvent)
+	{
+		// Consecutive mouse moves (with the same buttons held) and wheel scrolls (with the same modifiers) 
+		// are merged so that a high rate mouse costs one hit test and dispatch per pump rather than per 
+		// sample; the raw events are kept for coalesced_events().
+		if (!aEvent.is<mouse_event>() || iEventQueue.empty() || !iEventQueue.back().event.is<mouse_event>())
+			return false;
+		const auto& later = static_variant_cast<const mouse_event&>(aEvent);
+		auto& earlier = static_variant_cast<mouse_event&>(iEventQueue.back().event);
+		if (earlier.type() != later.type())
+			return false;
+		switch (later.type())
+		{
+		case mouse_event_type::Moved:
+			if (earlier.mouse_button() != later.mouse_button())
+				return false;
+			break;
+		case mouse_event_type::WheelScrolled:
+			if (earlier.key_modifiers() != later.key_modifiers())
+				return false;
+			break;
+		default:
+			return false;
+		}
+		auto& entry = iEventQueue.back();
+		if (entry.coalesced.empty())
+			entry.coalesced.push_back(entry.event);
+		entry.coalesced.push_back(aEvent);
+		earlier.coalesce(later);
+		++iInputCounters.eventsCoalesced;
+		return true;
+	}
+
+	void native_window::input_handled(event_timestamp aTimestamp)
+	{
+		if (iOldestUnpaintedInput == boost::none || aTimestamp < *iOldestUnpaintedInput)
+			iOldestUnpaintedInput = aTimestamp;
+	}
 }
\ No newline at end of file
@@ -31,7 +31,12 @@ namespace neogfx
 
 	class native_window : public i_native_window, protected neolib::lifetime
 	{
-		typedef std::deque<native_event> event_queue;
+		struct queued_event
+		{
+			native_event event;
+			native_event_list coalesced;
+		};
+		typedef std::deque<queued_event> event_queue;
 	public:
 		native_window(i_rendering_engine& aRenderingEngine, i_surface_manager& aSurfaceManager);
 		virtual ~native_window();
@@ -48,6 +53,9 @@ namespace neogfx
 		void handle_event(const native_event& aEvent) override;
 		bool has_current_event() const override;
 		const native_event& current_event() const override;
+		const native_event_list& coalesced_events() const override;
+		const input_statistics& input_counters() const override;
+		void reset_input_counters() override;
 		void handle_event() override;
 		bool processing_event() const override;
 		bool has_rendering_priority() const override;
@@ -61,6 +69,10 @@ namespace neogfx
 	protected:
 		size& pixel_density() const;
 		void handle_dpi_changed() override;
+		void input_painted();
+	private:
+		bool coalesce(const native_event& aEvent);
+		void input_handled(event_timestamp aTimestamp);
 	private:
 		template <typename EventCategory, typename EventType>
 		event_queue::const_iterator find_event(EventType aEventType) const
@@ -68,7 +80,7 @@ namespace neogfx
 			for (auto e = iEventQueue.end(); e != iEventQueue.begin();)
 			{
 				--e;
-				if (e->is<EventCategory>() && static_variant_cast<const EventCategory&>(*e).type() == aEventType)
+				if (e->event.is<EventCategory>() && static_variant_cast<const EventCategory&>(e->event).type() == aEventType)
 					return e;
 			}
 			return iEventQueue.end();
@@ -79,9 +91,12 @@ namespace neogfx
 		mutable optional_size iPixelDensityDpi;
 		event_queue iEventQueue;
 		native_event iCurrentEvent;
+		native_event_list iCurrentCoalescedEvents;
+		input_statistics iInputCounters;
+		boost::optional<event_timestamp> iOldestUnpaintedInput;
 		uint32_t iProcessingEvent;
 		std::string iTitleText;
 		bool iNonClientEntered;
-		neolib::callback_timer iUpdater;
+		callback_timer iUpdater;
 	};
 }
\ No newline at end of file
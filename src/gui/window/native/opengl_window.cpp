@@ -23,6 +23,8 @@
 #include <neogfx/hid/i_surface_window.hpp>
 #include "opengl_window.hpp"
 #include "..\..\..\gfx\native\opengl_helpers.hpp"
+#include "..\..\..\gfx\native\opengl_renderer.hpp"
+#include "..\..\..\gfx\native\opengl_graphics_context.hpp"
 #ifdef _WIN32
 #include <D2d1.h>
 #endif
@@ -37,7 +39,8 @@ namespace neogfx
 		iFrameCounter{ 0 },
 		iLastFrameTime{ 0 },
 		iRendering{ false },
-		iPaused{ 0 }
+		iPaused{ 0 },
+		iRenderLayers{ static_cast<opengl_renderer&>(aRenderingEngine).render_layer_stats() }
 	{
 	}
 
@@ -105,6 +108,9 @@ namespace neogfx
 				iInvalidatedArea = aInvalidatedRect.ceil();
 			else
 				iInvalidatedArea = invalidated_area().combine(aInvalidatedRect).ceil();
+			// whilst rendering the invalidated area is the rect currently being rendered
+			if (!iRendering)
+				add_invalidated_rect(aInvalidatedRect.ceil());
 		}
 	}
 
@@ -126,11 +132,48 @@ namespace neogfx
 		{
 			rect validatedArea = invalidated_area();
 			iInvalidatedArea = boost::none;
+			iInvalidatedRects.clear();
 			return validatedArea;
 		}
 		throw no_invalidated_area();
 	}
 
+	bool opengl_window::scroll(const rect& aArea, const point& aDelta)
+	{
+		if (iRendering || iFrameBufferSize == size{})
+			return false;
+		auto integral = [](coordinate aValue) { return std::floor(aValue) == aValue; };
+		rect const area = aArea.intersection(rect{ point{}, extents() });
+		if (!integral(area.x) || !integral(area.y) || !integral(area.cx) || !integral(area.cy) || !integral(aDelta.x) || !integral(aDelta.y))
+			return false;
+		if (std::abs(aDelta.x) >= area.cx || std::abs(aDelta.y) >= area.cy)
+			return false;
+		// anything already invalidated within the area has to move with it
+		for (auto const& r : iInvalidatedRects)
+			if (!r.intersection(area).empty() && !area.contains(r))
+				return false;
+		for (auto r = iInvalidatedRects.begin(); r != iInvalidatedRects.end();)
+		{
+			if (!r->intersection(area).empty())
+				*r = rect{ r->top_left() + aDelta, r->extents() }.intersection(area);
+			if (r->empty())
+				r = iInvalidatedRects.erase(r);
+			else
+				++r;
+		}
+		update_invalidated_area();
+		iPendingScrolls.push_back(pending_scroll{ area, aDelta });
+		if (aDelta.y > 0.0)
+			invalidate(rect{ area.top_left(), size{ area.cx, aDelta.y } });
+		else if (aDelta.y < 0.0)
+			invalidate(rect{ point{ area.x, area.bottom() + aDelta.y }, size{ area.cx, -aDelta.y } });
+		if (aDelta.x > 0.0)
+			invalidate(rect{ area.top_left(), size{ aDelta.x, area.cy } });
+		else if (aDelta.x < 0.0)
+			invalidate(rect{ point{ area.right() + aDelta.x, area.y }, size{ -aDelta.x, area.cy } });
+		return true;
+	}
+
 	bool opengl_window::can_render() const
 	{
 		return !iPaused;
@@ -148,7 +191,9 @@ namespace neogfx
 			if (processing_event())
 				return;
 
-			if (iFrameRate != boost::none && now - iLastFrameTime < 1000 / (has_rendering_priority() ? *iFrameRate : *iFrameRate / 10.0))
+			// frames are paced by the renderer's frame scheduler; allow a millisecond of jitter so a limit equal
+			// to the display refresh rate doesn't drop every other refresh
+			if (iFrameRate != boost::none && now - iLastFrameTime + 1 < 1000 / (has_rendering_priority() ? *iFrameRate : *iFrameRate / 10.0))
 				return;
 
 			if (!surface_window().native_window_ready_to_render())
@@ -175,58 +220,78 @@ namespace neogfx
 
 		rendering_engine().activate_context(*this);
 
-		glCheck(glViewport(0, 0, static_cast<GLsizei>(extents().cx), static_cast<GLsizei>(extents().cy)));
-		glCheck(glEnable(GL_TEXTURE_2D));
-		glCheck(glEnable(GL_MULTISAMPLE));
-		glCheck(glEnable(GL_BLEND));
-		glCheck(glEnable(GL_DEPTH_TEST));
-		glCheck(glDepthFunc(GL_LEQUAL));
+		auto& state = opengl_state::current();
+		state.viewport(0, 0, static_cast<GLsizei>(extents().cx), static_cast<GLsizei>(extents().cy));
+		state.enable(GL_TEXTURE_2D);
+		state.enable(GL_MULTISAMPLE);
+		state.enable(GL_BLEND);
+		state.enable(GL_DEPTH_TEST);
+		state.depth_func(GL_LEQUAL);
 		if (iFrameBufferSize.cx < static_cast<double>(extents().cx) || iFrameBufferSize.cy < static_cast<double>(extents().cy))
 		{
+			// scrolled contents didn't survive so everything needs repainting
+			if (!iPendingScrolls.empty())
+			{
+				iPendingScrolls.clear();
+				iInvalidatedArea = rect{ point{}, extents() };
+				iInvalidatedRects.assign(1, *iInvalidatedArea);
+			}
 			if (iFrameBufferSize != size{})
 			{
 				glCheck(glDeleteRenderbuffers(1, &iDepthStencilBuffer));
 				glCheck(glDeleteTextures(1, &iFrameBufferTexture));
 				glCheck(glDeleteFramebuffers(1, &iFrameBuffer));
+				state.renderbuffer_deleted(iDepthStencilBuffer);
+				state.texture_deleted(iFrameBufferTexture);
+				state.framebuffer_deleted(iFrameBuffer);
 			}
 			iFrameBufferSize = size(
 				iFrameBufferSize.cx < extents().cx ? extents().cx * 1.5f : iFrameBufferSize.cx,
 				iFrameBufferSize.cy < extents().cy ? extents().cy * 1.5f : iFrameBufferSize.cy);
 			glCheck(glGenFramebuffers(1, &iFrameBuffer));
-			glCheck(glBindFramebuffer(GL_FRAMEBUFFER, iFrameBuffer));
+			state.bind_framebuffer(GL_FRAMEBUFFER, iFrameBuffer);
 			glCheck(glGenTextures(1, &iFrameBufferTexture));
-			glCheck(glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, iFrameBufferTexture));
+			state.bind_texture(GL_TEXTURE_2D_MULTISAMPLE, iFrameBufferTexture);
 			glCheck(glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_RGBA8, static_cast<GLsizei>(iFrameBufferSize.cx), static_cast<GLsizei>(iFrameBufferSize.cy), true));
 			glCheck(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, iFrameBufferTexture, 0));
 			glCheck(glGenRenderbuffers(1, &iDepthStencilBuffer));
-			glCheck(glBindRenderbuffer(GL_RENDERBUFFER, iDepthStencilBuffer));
+			state.bind_renderbuffer(iDepthStencilBuffer);
 			glCheck(glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_DEPTH24_STENCIL8, static_cast<GLsizei>(iFrameBufferSize.cx), static_cast<GLsizei>(iFrameBufferSize.cy)));
 			glCheck(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, iDepthStencilBuffer));
 			glCheck(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, iDepthStencilBuffer));
 		}
 		else
 		{
-			glCheck(glBindFramebuffer(GL_FRAMEBUFFER, iFrameBuffer));
-			glCheck(glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, iFrameBufferTexture));
-			glCheck(glBindRenderbuffer(GL_RENDERBUFFER, iDepthStencilBuffer));
+			state.bind_framebuffer(GL_FRAMEBUFFER, iFrameBuffer);
+			state.bind_texture(GL_TEXTURE_2D_MULTISAMPLE, iFrameBufferTexture);
+			state.bind_renderbuffer(iDepthStencilBuffer);
 		}
 		glCheck(glClear(GL_DEPTH_BUFFER_BIT));
 		GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
 		if (status != GL_NO_ERROR && status != GL_FRAMEBUFFER_COMPLETE)
 			throw failed_to_create_framebuffer(status);
-		glCheck(glBindFramebuffer(GL_FRAMEBUFFER, iFrameBuffer));
+		state.bind_framebuffer(GL_FRAMEBUFFER, iFrameBuffer);
 		GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0 };
 		glCheck(glDrawBuffers(sizeof(drawBuffers) / sizeof(drawBuffers[0]), drawBuffers));
 
-		glCheck(surface_window().native_window_render(invalidated_area()));
+		if (!iPendingScrolls.empty())
+			apply_pending_scrolls();
+
+		auto const invalidatedRects = iInvalidatedRects;
+		for (auto const& r : invalidatedRects)
+		{
+			iInvalidatedArea = r;
+			glCheck(surface_window().native_window_render(r));
+		}
 
 		rendering_engine().vertex_arrays().execute();
 
-		glCheck(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0));
-		glCheck(glBindFramebuffer(GL_READ_FRAMEBUFFER, iFrameBuffer));
+		state.bind_framebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		state.bind_framebuffer(GL_READ_FRAMEBUFFER, iFrameBuffer);
 		glCheck(glBlitFramebuffer(0, 0, static_cast<GLint>(extents().cx), static_cast<GLint>(extents().cy), 0, 0, static_cast<GLint>(extents().cx), static_cast<GLint>(extents().cy), GL_COLOR_BUFFER_BIT, GL_NEAREST));
 
 		display();
+		input_painted();
 
 		iRendering = false;
 		validate();
@@ -257,14 +322,124 @@ namespace neogfx
 
 	void* opengl_window::rendering_target_texture_handle() const
 	{
+		if (!iRenderTargets.empty())
+			return reinterpret_cast<void*>(iRenderTargets.back().first->texture);
 		return reinterpret_cast<void*>(iFrameBufferTexture);
 	}
 
 	size opengl_window::rendering_target_texture_extents() const
 	{
+		if (!iRenderTargets.empty())
+			return iRenderTargets.back().first->extents;
 		return iFrameBufferSize;
 	}
 
+	rect opengl_window::rendering_target_area() const
+	{
+		if (!iRenderTargets.empty())
+			return iRenderTargets.back().second;
+		return rect{ point{}, extents() };
+	}
+
+	bool opengl_window::rendering_target_opaque() const
+	{
+		return iRenderTargets.empty() || iRenderTargets.back().first->opaque;
+	}
+
+	bool opengl_window::render_layer(const void* aOwner, const rect& aLayerRect, const rect& aVisibleRect, bool aOpaque, bool aContentsChanged, const std::function<void()>& aPainter)
+	{
+		if (!iRendering || !has_invalidated_area())
+			return false;
+		auto snap = [](const rect& aRect) { return rect{ point{ std::floor(aRect.left()), std::floor(aRect.top()) }, point{ std::ceil(aRect.right()), std::ceil(aRect.bottom()) } }; };
+		rect const layerRect = snap(aLayerRect);
+		rect const visibleRect = snap(aVisibleRect.intersection(rect{ point{}, extents() })).intersection(layerRect);
+		if (visibleRect.empty())
+			return false;
+		// anything already batched belongs to the current target
+		rendering_engine().vertex_arrays().execute();
+		auto layer = iRenderLayers.acquire(aOwner, layerRect.extents(), aOpaque, rendering_engine().render_layer_budget());
+		if (layer == nullptr)
+			return false;
+		auto& state = opengl_state::current();
+		rect const localVisibleRect{ visibleRect.top_left() - layerRect.top_left(), visibleRect.extents() };
+		if (aContentsChanged || !layer->validArea.contains(localVisibleRect))
+		{
+			bool const scissor = state.is_enabled(GL_SCISSOR_TEST);
+			auto const scissorBox = state.scissor_box();
+			bool const stencil = state.is_enabled(GL_STENCIL_TEST);
+			auto const alphaBlendFunc = state.alpha_blend_func();
+			auto const invalidatedArea = iInvalidatedArea;
+			iInvalidatedArea = visibleRect;
+			++layer->pinned;
+			iRenderTargets.emplace_back(layer, layerRect);
+			activate_rendering_target();
+			state.disable(GL_SCISSOR_TEST);
+			state.disable(GL_STENCIL_TEST);
+			state.depth_mask(true);
+			state.stencil_mask(static_cast<GLuint>(-1));
+			if (layer->opaque)
+			{
+				glCheck(glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT));
+			}
+			else
+			{
+				// nothing is painted beneath the subtree so it starts transparent and accumulates premultiplied colour
+				state.colour_mask(true, true, true, true);
+				glCheck(glClearColor(0.0f, 0.0f, 0.0f, 0.0f));
+				glCheck(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT));
+				state.alpha_blend_func(opengl_state::blend_factors{ GL_ONE, GL_ONE_MINUS_SRC_ALPHA });
+			}
+			aPainter();
+			rendering_engine().vertex_arrays().execute();
+			state.alpha_blend_func(alphaBlendFunc);
+			iRenderTargets.pop_back();
+			--layer->pinned;
+			activate_rendering_target();
+			iInvalidatedArea = invalidatedArea;
+			state.set_enabled(GL_STENCIL_TEST, stencil);
+			state.scissor(scissorBox[0], scissorBox[1], scissorBox[2], scissorBox[3]);
+			state.set_enabled(GL_SCISSOR_TEST, scissor);
+			layer->validArea = localVisibleRect;
+			iRenderLayers.rerendered();
+		}
+		else
+			iRenderLayers.hit();
+		rect const compositeRect = snap(visibleRect.intersection(invalidated_area()));
+		if (!compositeRect.empty())
+		{
+			// a multisample blit can't change position so resolve in place and draw the result as a quad
+			auto const sourceX = static_cast<GLint>(compositeRect.left() - layerRect.left());
+			auto const sourceY = static_cast<GLint>(layerRect.bottom() - compositeRect.bottom());
+			auto const cx = static_cast<GLint>(compositeRect.cx);
+			auto const cy = static_cast<GLint>(compositeRect.cy);
+			bool const scissor = state.is_enabled(GL_SCISSOR_TEST);
+			state.disable(GL_SCISSOR_TEST);
+			state.bind_framebuffer(GL_READ_FRAMEBUFFER, layer->frameBuffer);
+			state.bind_framebuffer(GL_DRAW_FRAMEBUFFER, layer->resolveFrameBuffer);
+			glCheck(glBlitFramebuffer(sourceX, sourceY, sourceX + cx, sourceY + cy, sourceX, sourceY, sourceX + cx, sourceY + cy, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+			activate_rendering_target();
+			auto gc = create_graphics_context();
+			static_cast<opengl_graphics_context&>(*gc).composite_layer(layer->resolveTexture, layer->extents, layerRect, compositeRect, !layer->opaque);
+			gc.reset();
+			state.set_enabled(GL_SCISSOR_TEST, scissor);
+		}
+		return true;
+	}
+
+	void opengl_window::release_render_layer(const void* aOwner)
+	{
+		if (!iRenderLayers.has_layer(aOwner))
+			return;
+		if (rendering_engine().active_context_surface() == nullptr)
+			rendering_engine().activate_context(*this);
+		iRenderLayers.release(aOwner);
+	}
+
+	void opengl_window::invalidate_render_layers()
+	{
+		iRenderLayers.invalidate_all();
+	}
+
 	bool opengl_window::metrics_available() const
 	{
 		return true;
@@ -289,6 +464,18 @@ namespace neogfx
 			glCheck(glDeleteRenderbuffers(1, &iDepthStencilBuffer));
 			glCheck(glDeleteTextures(1, &iFrameBufferTexture));
 			glCheck(glDeleteFramebuffers(1, &iFrameBuffer));
+			auto& state = opengl_state::current();
+			state.renderbuffer_deleted(iDepthStencilBuffer);
+			state.texture_deleted(iFrameBufferTexture);
+			state.framebuffer_deleted(iFrameBuffer);
+			if (iScrollFrameBufferSize != size{})
+			{
+				glCheck(glDeleteTextures(1, &iScrollFrameBufferTexture));
+				glCheck(glDeleteFramebuffers(1, &iScrollFrameBuffer));
+				state.texture_deleted(iScrollFrameBufferTexture);
+				state.framebuffer_deleted(iScrollFrameBuffer);
+			}
+			iRenderLayers.clear();
 		}
 	}
 
@@ -301,4 +488,88 @@ namespace neogfx
 	{
 		return *this;
 	}
+
+	void opengl_window::add_invalidated_rect(const rect& aInvalidatedRect)
+	{
+		rect merged = aInvalidatedRect;
+		for (auto r = iInvalidatedRects.begin(); r != iInvalidatedRects.end();)
+		{
+			if (!r->intersection(merged).empty())
+			{
+				merged = merged.combine(*r);
+				iInvalidatedRects.erase(r);
+				r = iInvalidatedRects.begin();
+			}
+			else
+				++r;
+		}
+		iInvalidatedRects.push_back(merged);
+		if (iInvalidatedRects.size() > MaxInvalidatedRects)
+			iInvalidatedRects.assign(1, *iInvalidatedArea);
+	}
+
+	void opengl_window::update_invalidated_area()
+	{
+		iInvalidatedArea = boost::none;
+		for (auto const& r : iInvalidatedRects)
+			iInvalidatedArea = (iInvalidatedArea == boost::none ? r : iInvalidatedArea->combine(r));
+	}
+
+	void opengl_window::apply_pending_scrolls()
+	{
+		auto& state = opengl_state::current();
+		if (iScrollFrameBufferSize != iFrameBufferSize)
+		{
+			if (iScrollFrameBufferSize != size{})
+			{
+				glCheck(glDeleteTextures(1, &iScrollFrameBufferTexture));
+				glCheck(glDeleteFramebuffers(1, &iScrollFrameBuffer));
+				state.texture_deleted(iScrollFrameBufferTexture);
+				state.framebuffer_deleted(iScrollFrameBuffer);
+			}
+			iScrollFrameBufferSize = iFrameBufferSize;
+			glCheck(glGenFramebuffers(1, &iScrollFrameBuffer));
+			state.bind_framebuffer(GL_FRAMEBUFFER, iScrollFrameBuffer);
+			glCheck(glGenTextures(1, &iScrollFrameBufferTexture));
+			auto const previousTexture = state.bound_texture(GL_TEXTURE_2D);
+			state.bind_texture(GL_TEXTURE_2D, iScrollFrameBufferTexture);
+			glCheck(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, static_cast<GLsizei>(iScrollFrameBufferSize.cx), static_cast<GLsizei>(iScrollFrameBufferSize.cy), 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
+			glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+			glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+			glCheck(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, iScrollFrameBufferTexture, 0));
+			state.bind_texture(GL_TEXTURE_2D, previousTexture);
+		}
+		bool const scissor = state.is_enabled(GL_SCISSOR_TEST);
+		state.disable(GL_SCISSOR_TEST);
+		// a multisample blit can't change position so resolve the source in place and draw it back offset
+		auto const height = static_cast<GLint>(extents().cy);
+		for (auto const& s : iPendingScrolls)
+		{
+			rect const source = s.area.intersection(rect{ s.area.top_left() - s.delta, s.area.extents() });
+			if (source.empty())
+				continue;
+			auto const x0 = static_cast<GLint>(source.left());
+			auto const y0 = height - static_cast<GLint>(source.bottom());
+			auto const x1 = static_cast<GLint>(source.right());
+			auto const y1 = height - static_cast<GLint>(source.top());
+			state.bind_framebuffer(GL_READ_FRAMEBUFFER, iFrameBuffer);
+			state.bind_framebuffer(GL_DRAW_FRAMEBUFFER, iScrollFrameBuffer);
+			glCheck(glBlitFramebuffer(x0, y0, x1, y1, x0, y0, x1, y1, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+			state.bind_framebuffer(GL_FRAMEBUFFER, iFrameBuffer);
+			auto gc = create_graphics_context();
+			static_cast<opengl_graphics_context&>(*gc).composite_layer(iScrollFrameBufferTexture, iScrollFrameBufferSize, rect{ s.delta, extents() }, rect{ source.top_left() + s.delta, source.extents() }, false);
+		}
+		iPendingScrolls.clear();
+		state.bind_framebuffer(GL_FRAMEBUFFER, iFrameBuffer);
+		state.set_enabled(GL_SCISSOR_TEST, scissor);
+	}
+
+	void opengl_window::activate_rendering_target()
+	{
+		auto& state = opengl_state::current();
+		auto const target = rendering_target_area();
+		state.bind_framebuffer(GL_FRAMEBUFFER, iRenderTargets.empty() ? iFrameBuffer : iRenderTargets.back().first->frameBuffer);
+		// the viewport keeps covering the whole window so that window coordinates map onto the target
+		state.viewport(-static_cast<GLint>(target.x), -static_cast<GLint>(extents().cy - target.bottom()), static_cast<GLsizei>(extents().cx), static_cast<GLsizei>(extents().cy));
+	}
 }
\ No newline at end of file
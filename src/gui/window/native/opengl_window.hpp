@@ -23,12 +23,12 @@
 #include <unordered_set>
 #include <boost/lexical_cast.hpp>
 #include <neolib/string_utils.hpp>
-#include <neolib/timer.hpp>
 #include <neogfx/neogfx.hpp>
 #include "../../../gfx/native/opengl.hpp"
 #include "../../../gfx/native/opengl.hpp"
 #include "../../../gfx/native/i_native_graphics_context.hpp"
 #include "../../../gfx/native/opengl_texture.hpp"
+#include "../../../gfx/native/render_layer_cache.hpp"
 #include "native_window.hpp"
 
 namespace neogfx
@@ -37,6 +37,13 @@ namespace neogfx
 
 	class opengl_window : public native_window
 	{
+	private:
+		struct pending_scroll
+		{
+			rect area;
+			point delta;
+		};
+		static const std::size_t MaxInvalidatedRects = 4;
 	public:
 		struct failed_to_create_framebuffer : std::runtime_error { 
 			failed_to_create_framebuffer(GLenum aErrorCode) : 
@@ -60,6 +67,7 @@ namespace neogfx
 		bool has_invalidated_area() const override;
 		const rect& invalidated_area() const override;
 		rect validate() override;
+		bool scroll(const rect& aArea, const point& aDelta) override;
 		bool can_render() const override;
 		void render(bool aOOBRequest = false) override;
 		void pause() override;
@@ -67,6 +75,11 @@ namespace neogfx
 		bool is_rendering() const override;
 		void* rendering_target_texture_handle() const override;
 		size rendering_target_texture_extents() const override;
+		rect rendering_target_area() const override;
+		bool rendering_target_opaque() const override;
+		bool render_layer(const void* aOwner, const rect& aLayerRect, const rect& aVisibleRect, bool aOpaque, bool aContentsChanged, const std::function<void()>& aPainter) override;
+		void release_render_layer(const void* aOwner) override;
+		void invalidate_render_layers() override;
 	public:
 		bool metrics_available() const override;
 		size extents() const override;
@@ -78,6 +91,10 @@ namespace neogfx
 		neolib::i_lifetime& as_lifetime() override;
 	private:
 		virtual void display() = 0;
+		void add_invalidated_rect(const rect& aInvalidatedRect);
+		void update_invalidated_area();
+		void apply_pending_scrolls();
+		void activate_rendering_target();
 	private:
 		i_surface_window& iSurfaceWindow;
 		neogfx::logical_coordinate_system iLogicalCoordinateSystem;
@@ -86,7 +103,14 @@ namespace neogfx
 		GLuint iFrameBufferTexture;
 		GLuint iDepthStencilBuffer;
 		size iFrameBufferSize;
+		GLuint iScrollFrameBuffer;
+		GLuint iScrollFrameBufferTexture;
+		size iScrollFrameBufferSize;
 		boost::optional<rect> iInvalidatedArea;
+		std::vector<rect> iInvalidatedRects;
+		std::vector<pending_scroll> iPendingScrolls;
+		render_layer_cache iRenderLayers;
+		std::vector<std::pair<render_layer_cache::layer*, rect>> iRenderTargets;
 		uint64_t iFrameCounter;
 		boost::optional<uint32_t> iFrameRate;
 		uint64_t iLastFrameTime;
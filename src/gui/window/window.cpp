@@ -294,6 +294,8 @@ namespace neogfx
 
 	window::~window()
 	{
+		// children release their render layers through our surface so must go while we are still a window
+		remove_all();
 		update_modality(true);
 		window_manager().remove_window(*this);
 		lifetime::set_destroyed();
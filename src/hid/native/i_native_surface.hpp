@@ -69,6 +69,7 @@ namespace neogfx
 		virtual bool has_invalidated_area() const = 0;
 		virtual const rect& invalidated_area() const = 0;
 		virtual rect validate() = 0;
+		virtual bool scroll(const rect& aArea, const point& aDelta) = 0;
 		virtual bool can_render() const = 0;
 		virtual void render(bool aOOBRequest = false) = 0;
 		virtual void pause() = 0;
@@ -76,6 +77,11 @@ namespace neogfx
 		virtual bool is_rendering() const = 0;
 		virtual void* rendering_target_texture_handle() const = 0;
 		virtual size rendering_target_texture_extents() const = 0;
+		virtual rect rendering_target_area() const = 0;
+		virtual bool rendering_target_opaque() const = 0;
+		virtual bool render_layer(const void* aOwner, const rect& aLayerRect, const rect& aVisibleRect, bool aOpaque, bool aContentsChanged, const std::function<void()>& aPainter) = 0;
+		virtual void release_render_layer(const void* aOwner) = 0;
+		virtual void invalidate_render_layers() = 0;
 		virtual std::unique_ptr<i_native_graphics_context> create_graphics_context() const = 0;
 		virtual std::unique_ptr<i_native_graphics_context> create_graphics_context(const i_widget& aWidget) const = 0;
 	public:
@@ -21,6 +21,7 @@
 #include <neolib/raii.hpp>
 #include <neogfx/app/app.hpp>
 #include <neogfx/hid/surface_window_proxy.hpp>
+#include <neogfx/gui/layout/layout_item.hpp>
 #include "../gui/window/native/i_native_window.hpp"
 #include "native/i_native_surface.hpp"
 
@@ -205,7 +206,11 @@ namespace neogfx
 	{
 		native_surface().invalidate(aInvalidatedRect);
 		if (!aInternal)
+		{
+			// external invalidation (e.g. a style change) can alter any widget's appearance
+			native_surface().invalidate_render_layers();
 			as_widget().update(aInvalidatedRect);
+		}
 	}
 
 	bool surface_window_proxy::has_invalidated_area() const
@@ -223,6 +228,31 @@ namespace neogfx
 		return native_surface().validate();
 	}
 
+	void surface_window_proxy::scroll_surface(const rect& aArea, const point& aDelta)
+	{
+		if (!native_surface().scroll(aArea, aDelta))
+			native_surface().invalidate(aArea);
+	}
+
+	bool surface_window_proxy::render_layer(const i_widget& aOwner, const rect& aLayerRect, const rect& aVisibleRect, bool aOpaque, bool aContentsChanged, const std::function<void()>& aPainter) const
+	{
+		if (!has_native_surface())
+			return false;
+		return iNativeWindow->render_layer(&aOwner, aLayerRect, aVisibleRect, aOpaque, aContentsChanged, aPainter);
+	}
+
+	void surface_window_proxy::release_render_layer(const i_widget& aOwner) const
+	{
+		if (has_native_surface())
+			iNativeWindow->release_render_layer(&aOwner);
+	}
+
+	void surface_window_proxy::invalidate_render_layers()
+	{
+		if (has_native_surface())
+			native_surface().invalidate_render_layers();
+	}
+
 	bool surface_window_proxy::has_rendering_priority() const
 	{
 		return as_window().has_rendering_priority();
@@ -282,6 +312,7 @@ namespace neogfx
 
 	void surface_window_proxy::handle_dpi_changed()
 	{
+		layout_item::next_generation();
 		as_window().surface().dpi_changed.trigger();
 	}
 
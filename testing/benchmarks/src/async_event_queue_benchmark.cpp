@@ -0,0 +1,165 @@
+// async_event_queue_benchmark.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <neogfx/core/event.hpp>
+#include "benchmarks.hpp"
+
+namespace neogfx
+{
+	namespace benchmarks
+	{
+		namespace
+		{
+			struct i_value
+			{
+				virtual ~i_value() {}
+				virtual int value() const = 0;
+			};
+
+			struct seven : i_value
+			{
+				int value() const override { return 7; }
+			};
+
+			bool check(bool aPassed, const std::string& aWhat)
+			{
+				if (!aPassed)
+					std::cout << "async_event_queue: " << aWhat << " check failed" << std::endl;
+				return aPassed;
+			}
+
+			bool delivery(async_event_queue& aQueue)
+			{
+				bool passed = true;
+				{
+					// arguments are captured by value: the temporaries are gone before the queue runs
+					event<int, const std::string&> e;
+					std::vector<std::string> received;
+					sink s = e([&](int aNumber, const std::string& aText) { received.push_back(std::to_string(aNumber) + aText); });
+					e.set_trigger_type(event_trigger_type::Asynchronous);
+					{
+						std::string text = "abc";
+						e.trigger(1, text);
+						e.trigger(2, std::string{ "de" });
+					}
+					aQueue.exec();
+					passed = check(received == std::vector<std::string>{ "1abc", "2de" }, "by value") && passed;
+				}
+				{
+					// a move-only argument is moved into the queued item
+					event<const std::unique_ptr<int>&> e;
+					int received = 0;
+					sink s = e([&](const std::unique_ptr<int>& aValue) { received = *aValue; });
+					e.async_trigger(std::make_unique<int>(42));
+					aQueue.exec();
+					passed = check(received == 42, "move-only argument") && passed;
+				}
+				{
+					// abstract arguments can only be held by reference
+					event<const i_value&> e;
+					int received = 0;
+					sink s = e([&](const i_value& aValue) { received = aValue.value(); });
+					seven v;
+					e.async_trigger(v);
+					aQueue.exec();
+					passed = check(received == 7, "reference argument") && passed;
+				}
+				{
+					// nothing is delivered for an event destroyed while its trigger is queued
+					auto e = std::make_unique<event<int>>();
+					uint32_t calls = 0u;
+					sink s = (*e)([&](int) { ++calls; });
+					e->async_trigger(1);
+					e.reset();
+					aQueue.exec();
+					passed = check(calls == 0u, "destroyed event") && passed;
+				}
+				return passed;
+			}
+
+			bool coalescing(async_event_queue& aQueue)
+			{
+				bool passed = true;
+				{
+					event<int> e;
+					std::vector<int> received;
+					sink s = e([&](int aValue) { received.push_back(aValue); });
+					e.set_coalescing(event_coalescing::LatestWins);
+					std::thread producer{ [&]() { for (int i = 0; i < 100000; ++i) e.async_trigger(i); } };
+					producer.join();
+					aQueue.exec();
+					passed = check(received.size() == 1u && received.back() == 99999, "latest wins") && passed;
+				}
+				{
+					event<int> e;
+					int64_t total = 0;
+					sink s = e([&](int aValue) { total += aValue; });
+					e.set_coalescing(event_coalescing::Accumulate, [](std::tuple<int>& aPending, std::tuple<int>&& aNext) { std::get<0>(aPending) += std::get<0>(aNext); });
+					std::vector<std::thread> producers;
+					for (int p = 0; p < 4; ++p)
+						producers.emplace_back([&]() { for (int i = 0; i < 100000; ++i) e.async_trigger(1); });
+					for (auto& producer : producers)
+						producer.join();
+					while (aQueue.exec());
+					passed = check(total == 400000, "accumulate") && passed;
+				}
+				return passed;
+			}
+
+			void throughput(async_event_queue& aQueue)
+			{
+				event<int> e;
+				int64_t total = 0;
+				sink s = e([&](int aValue) { total += aValue; });
+				aQueue.reset_stats();
+				int64_t const events = 1000000;
+				auto const start = std::chrono::steady_clock::now();
+				std::thread producer{ [&]() { for (int64_t i = 0; i < events; ++i) e.async_trigger(1); } };
+				while (total < events)
+					aQueue.exec();
+				producer.join();
+				auto const end = std::chrono::steady_clock::now();
+				auto const stats = aQueue.stats();
+				std::cout << "async_event_queue: " << events / std::chrono::duration<double>(end - start).count() / 1.0e6 << " M cross-thread events/s, mean latency " << 
+					stats.totalLatency.count() / 1.0e3 / std::max<uint64_t>(stats.dispatched, 1u) << " us, max latency " << stats.maxLatency.count() / 1.0e3 << " us" << std::endl;
+			}
+		}
+
+		bool async_events()
+		{
+			async_event_queue queue;
+			bool passed = delivery(queue);
+			passed = coalescing(queue) && passed;
+			auto const stats = queue.stats();
+			passed = check(stats.posted == stats.dispatched + stats.discarded && stats.discarded == 1u && stats.coalesced > 0u, "counter") && passed;
+			std::cout << "async_event_queue: posted " << stats.posted << ", coalesced " << stats.coalesced << ", dispatched " << stats.dispatched << 
+				", discarded " << stats.discarded << ", wakeups " << stats.wakeups << std::endl;
+			throughput(queue);
+			return passed;
+		}
+	}
+}
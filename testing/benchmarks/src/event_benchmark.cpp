@@ -0,0 +1,160 @@
+// event_benchmark.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <neogfx/core/event.hpp>
+#include "benchmarks.hpp"
+
+namespace neogfx
+{
+	namespace benchmarks
+	{
+		namespace
+		{
+			double nanoseconds_per_trigger(uint32_t aSubscribers)
+			{
+				event<int> e;
+				uint64_t sum = 0u;
+				std::vector<sink> sinks;
+				for (uint32_t i = 0u; i < aSubscribers; ++i)
+					sinks.push_back(e([&sum](int aValue) { sum += aValue; }));
+				uint32_t const repetitions = 10000000u / std::max(aSubscribers, 1u);
+				auto const start = std::chrono::steady_clock::now();
+				for (uint32_t i = 0u; i < repetitions; ++i)
+					e.trigger(static_cast<int>(i));
+				auto const end = std::chrono::steady_clock::now();
+				if (sum != static_cast<uint64_t>(repetitions) * (repetitions - 1u) / 2u * aSubscribers)
+					return -1.0;
+				return std::chrono::duration<double, std::nano>(end - start).count() / repetitions;
+			}
+
+			bool reentrancy()
+			{
+				bool passed = true;
+				{
+					// a handler that unsubscribes itself is called once; one subscribed during a trigger is not called by it
+					event<> e;
+					uint32_t first = 0u;
+					uint32_t second = 0u;
+					uint32_t late = 0u;
+					sink s1;
+					sink s2;
+					sink s3;
+					s1 = e([&]() { ++first; s1 = sink{}; });
+					s2 = e([&]() { ++second; if (second == 1u) s3 = e([&]() { ++late; }); });
+					e.trigger();
+					e.trigger();
+					passed = first == 1u && second == 2u && late == 1u && passed;
+				}
+				{
+					// destroying the event from one of its handlers stops the trigger
+					auto e = new event<>;
+					uint32_t after = 0u;
+					sink s1 = (*e)([&]() { delete e; });
+					sink s2 = (*e)([&]() { ++after; });
+					passed = !e->trigger() && after == 0u && passed;
+				}
+				{
+					// resubscribing with a unique id replaces the handler; the subscription lasts while either sink does
+					event<> e;
+					int id;
+					uint32_t first = 0u;
+					uint32_t second = 0u;
+					{
+						sink s1 = e([&]() { ++first; }, id);
+						{
+							sink s2 = e([&]() { ++second; }, id);
+							e.trigger();
+						}
+						e.trigger();
+					}
+					e.trigger();
+					passed = first == 0u && second == 2u && passed;
+				}
+				return passed;
+			}
+
+			bool concurrent_subscribers()
+			{
+				// handlers subscribed on the writer thread are queued to it by our triggers and run by its exec()
+				async_event_queue queue;
+				event<int> e;
+				std::atomic<uint32_t> permanentCalls{ 0u };
+				std::atomic<uint32_t> queuedCalls{ 0u };
+				std::atomic<bool> wrongThread{ false };
+				sink permanent = e([&](int) { ++permanentCalls; });
+				std::atomic<bool> ready{ false };
+				std::atomic<bool> stop{ false };
+				std::thread writer{ [&]()
+				{
+					auto const self = std::this_thread::get_id();
+					sink queued = e([&, self](int) { if (std::this_thread::get_id() == self) ++queuedCalls; else wrongThread = true; });
+					ready = true;
+					while (!stop)
+					{
+						sink transient = e([](int) {});
+						queue.exec();
+					}
+					while (queue.exec());
+				} };
+				while (!ready)
+					std::this_thread::yield();
+				uint32_t const triggers = 1000000u;
+				for (uint32_t i = 0u; i < triggers; ++i)
+					e.trigger(static_cast<int>(i));
+				stop = true;
+				writer.join();
+				return permanentCalls == triggers && queuedCalls == triggers && !wrongThread;
+			}
+		}
+
+		bool event_dispatch()
+		{
+			bool passed = true;
+			for (uint32_t subscribers : { 0u, 1u, 4u, 64u })
+			{
+				auto const cost = nanoseconds_per_trigger(subscribers);
+				if (cost < 0.0)
+				{
+					std::cout << "event: wrong handler calls with " << subscribers << " subscribers" << std::endl;
+					passed = false;
+				}
+				else
+					std::cout << "event: trigger with " << subscribers << " subscribers " << cost << " ns" << std::endl;
+			}
+			if (!reentrancy())
+			{
+				std::cout << "event: re-entrant subscribe/unsubscribe/destroy check failed" << std::endl;
+				passed = false;
+			}
+			if (!concurrent_subscribers())
+			{
+				std::cout << "event: handler calls lost or misdelivered while another thread subscribed and unsubscribed" << std::endl;
+				passed = false;
+			}
+			return passed;
+		}
+	}
+}
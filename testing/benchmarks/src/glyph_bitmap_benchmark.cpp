@@ -0,0 +1,86 @@
+// glyph_bitmap_benchmark.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../../../src/gfx/text/native/glyph_bitmap.hpp"
+#include "benchmarks.hpp"
+
+namespace neogfx
+{
+	namespace benchmarks
+	{
+		namespace
+		{
+			typedef void (*filter_function)(const uint8_t*, uint8_t*, uint32_t);
+
+			double nanoseconds_per_row(filter_function aFilter, const std::vector<uint8_t>& aSource, std::vector<uint8_t>& aDestination, uint32_t aRepetitions)
+			{
+				auto const start = std::chrono::steady_clock::now();
+				for (uint32_t i = 0; i < aRepetitions; ++i)
+					aFilter(aSource.data(), aDestination.data(), static_cast<uint32_t>(aSource.size()));
+				auto const end = std::chrono::steady_clock::now();
+				return std::chrono::duration<double, std::nano>(end - start).count() / aRepetitions;
+			}
+		}
+
+		bool glyph_bitmap()
+		{
+			std::mt19937 random{ 42u };
+			std::uniform_int_distribution<int> byte{ 0, 255 };
+			std::vector<uint8_t> source;
+			std::vector<uint8_t> result;
+			std::vector<uint8_t> reference;
+			bool exact = true;
+			// every width up to a few vector lengths so that the AVX2, SSE2 and scalar tails are all exercised
+			for (uint32_t width = 1u; width <= 256u && exact; ++width)
+			{
+				for (uint32_t pass = 0u; pass < 18u && exact; ++pass)
+				{
+					source.resize(width);
+					for (auto& value : source)
+						value = pass == 0u ? 0xFFu : pass == 1u ? 0x00u : static_cast<uint8_t>(byte(random));
+					result.assign(width, 0u);
+					reference.assign(width, 0u);
+					glyph_bitmap::lcd_filter_row(source.data(), result.data(), width);
+					glyph_bitmap::lcd_filter_row_reference(source.data(), reference.data(), width);
+					if (result != reference)
+					{
+						std::cout << "glyph_bitmap: lcd_filter_row differs from the reference at width " << width << std::endl;
+						exact = false;
+					}
+				}
+			}
+			// a typical LCD glyph row: 64 texels of 3 subpixels
+			source.resize(192u);
+			for (auto& value : source)
+				value = static_cast<uint8_t>(byte(random));
+			result.assign(source.size(), 0u);
+			uint32_t const repetitions = 200000u;
+			auto const filter = nanoseconds_per_row(&glyph_bitmap::lcd_filter_row, source, result, repetitions);
+			auto const referenceFilter = nanoseconds_per_row(&glyph_bitmap::lcd_filter_row_reference, source, result, repetitions);
+			std::cout << "glyph_bitmap: lcd_filter_row " << filter << " ns/row, reference " << referenceFilter << " ns/row (" <<
+				referenceFilter / filter << "x)" << std::endl;
+			return exact;
+		}
+	}
+}
@@ -0,0 +1,33 @@
+// main.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright (c) 2018-present, Leigh Johnston.  All Rights Reserved.
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <neogfx/neogfx.hpp>
+#include <cstdlib>
+#include <iostream>
+#include "benchmarks.hpp"
+
+int main()
+{
+	bool passed = true;
+	passed = neogfx::benchmarks::glyph_bitmap() && passed;
+	passed = neogfx::benchmarks::event_dispatch() && passed;
+	passed = neogfx::benchmarks::async_events() && passed;
+	std::cout << (passed ? "all checks passed" : "CHECKS FAILED") << std::endl;
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
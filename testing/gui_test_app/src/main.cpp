@@ -223,7 +223,7 @@ int main(int argc, char* argv[])
 
 		auto& pasteAndGoAction = app.add_action("Paste and Go", ":/closed/resources/caw_toolbar.naa#paste_and_go.png").set_shortcut("Ctrl+Shift+V");
 
-		neolib::callback_timer ct{ app, [&app, &pasteAndGoAction](neolib::callback_timer& aTimer)
+		ng::callback_timer ct{ [&app, &pasteAndGoAction](ng::callback_timer& aTimer)
 		{
 			aTimer.again();
 			if (app.clipboard().sink_active())
@@ -740,7 +740,7 @@ int main(int argc, char* argv[])
 		keypad.add_item_at_position(3, 1, std::make_shared<keypad_button>(textEdit, 0));
 		keypad.add_span(3, 1, 1, 2);
 
-		neolib::callback_timer animation(app, [&](neolib::callback_timer& aTimer)
+		ng::callback_timer animation([&](ng::callback_timer& aTimer)
 		{
 			if (button6.is_singular())
 				return;
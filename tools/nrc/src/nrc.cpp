@@ -19,8 +19,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <fstream>
 #include <iostream>
+#include <cctype>
 #include <boost/filesystem.hpp>
 #include <neolib/xml.hpp>
+#include <neolib/zip.hpp>
+#include "../../../src/gfx/text/emoji_index.hpp"
+#include "../../../src/app/resource_archive.hpp"
 
 struct invalid_file : std::runtime_error 
 { 
@@ -33,6 +37,100 @@ struct failed_to_read_resource_file : std::runtime_error
 };
 struct bad_usage : std::runtime_error { bad_usage() : std::runtime_error("Bad usage") {} };
 
+struct resource_file
+{
+	std::string resourcePath;
+	std::string filePath;
+	neogfx::resource_archive::codec codec;
+};
+
+neogfx::resource_archive::codec parse_codec(const std::string& aCodec)
+{
+	if (aCodec == "store")
+		return neogfx::resource_archive::codec::Store;
+	else if (aCodec == "deflate")
+		return neogfx::resource_archive::codec::Deflate;
+	else if (aCodec == "auto")
+		return neogfx::resource_archive::codec::Auto;
+	throw invalid_file("unknown codec '" + aCodec + "'");
+}
+
+std::vector<resource_file> read_resources(const std::string& aInputFileName, const neolib::xml& aInput)
+{
+	std::vector<resource_file> result;
+	for (const auto& resource : aInput.root())
+	{
+		if (resource.name() == "resource")
+		{
+			auto const resourceCodec = resource.has_attribute("codec") ? parse_codec(std::string(resource.attribute_value("codec"))) : neogfx::resource_archive::codec::Auto;
+			for (const auto& file : resource)
+			{
+				if (file.name() == "file")
+				{
+					std::string resourcePath = boost::filesystem::path(aInputFileName).parent_path().string();
+					if (!resourcePath.empty())
+						resourcePath += "/";
+					resourcePath += std::string(file.text());
+					result.push_back(resource_file{
+						(resource.has_attribute("prefix") ? std::string(resource.attribute_value("prefix")) + "/" : "") + std::string(file.text()),
+						resourcePath,
+						file.has_attribute("codec") ? parse_codec(std::string(file.attribute_value("codec"))) : resourceCodec });
+				}
+			}
+		}
+	}
+	return result;
+}
+
+std::string identifier(const std::string& aName)
+{
+	std::string result;
+	for (auto ch : aName)
+		result += std::isalnum(static_cast<unsigned char>(ch)) ? ch : '_';
+	return result;
+}
+
+void write_archive(const std::vector<resource_file>& aResources, const std::string& aOutputPath)
+{
+	std::vector<neogfx::resource_archive::source> sources;
+	for (auto const& resource : aResources)
+	{
+		std::cout << "Processing " << resource.filePath << "..." << std::endl;
+		std::ifstream resourceFile(resource.filePath, std::ios_base::in | std::ios_base::binary);
+		if (!resourceFile)
+			throw failed_to_read_resource_file(resource.filePath);
+		sources.push_back(neogfx::resource_archive::source{ resource.resourcePath, resource.codec,
+			std::vector<uint8_t>{ std::istreambuf_iterator<char>{ resourceFile }, std::istreambuf_iterator<char>{} } });
+		if (resourceFile.bad())
+			throw failed_to_read_resource_file(resource.filePath);
+	}
+	std::ofstream output(aOutputPath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+	neogfx::resource_archive::write(output, sources);
+	if (!output)
+		throw std::runtime_error("Failed to write resource archive '" + aOutputPath + "'!");
+	std::cout << "Resource archive: " << aOutputPath << " (" << sources.size() << " entries)" << std::endl;
+}
+
+void write_emoji_index(const std::string& aArchivePath, std::string aOutputPath)
+{
+	std::cout << "Emoji archive: " << aArchivePath << std::endl;
+	if (aOutputPath.empty())
+		aOutputPath = neogfx::emoji_index::index_path(aArchivePath);
+	std::ifstream archiveFile(aArchivePath, std::ios_base::in | std::ios_base::binary);
+	std::vector<uint8_t> archive{ std::istreambuf_iterator<char>{ archiveFile }, std::istreambuf_iterator<char>{} };
+	if (archive.empty())
+		throw failed_to_read_resource_file(aArchivePath);
+	auto const endRecord = neogfx::zip_directory::end_record(&archive[0], archive.size());
+	auto const entries = neogfx::zip_directory::entries(&archive[0], archive.size());
+	neolib::zip zipFile(aArchivePath);
+	auto const index = neogfx::emoji_index::build(archive.size(), endRecord, entries, zipFile.extract_to_string(zipFile.index_of("meta.json")));
+	std::ofstream output(aOutputPath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+	neogfx::emoji_index::write(output, index);
+	if (!output)
+		throw std::runtime_error("Failed to write emoji index '" + aOutputPath + "'!");
+	std::cout << "Emoji index: " << aOutputPath << " (" << index.entries.size() << " entries)" << std::endl;
+}
+
 int main(int argc, char* argv[])
 {
 	std::cout << "nrc neogfx resource compiler" << std::endl;
@@ -50,105 +148,76 @@ int main(int argc, char* argv[])
 		{
 			throw bad_usage();
 		}
+		if (!options.empty() && options[0] == "-emoji")
+		{
+			write_emoji_index(files[0], files.size() > 1 ? files[1] : std::string{});
+			return 0;
+		}
 		std::string inputFileName(files[0]);
 		std::cout << "Resource meta file: " << inputFileName << std::endl;
 		neolib::xml input(inputFileName);
 		if (!input.got_root() || input.root().name() != "nrc")
 			throw invalid_file("bad root node");
+		std::string const mode = options.empty() ? std::string{ "-embed" } : options[0];
+		if (mode != "-embed" && mode != "-archive" && mode != "-incbin")
+			throw bad_usage();
 		std::string outputFileName;
 		if (files.size() > 1)
 			outputFileName = files[1];
 		if (outputFileName.empty())
-		{
-			outputFileName = inputFileName;
-			std::string::size_type dot = outputFileName.rfind('.');
-			if (options.empty() || options[0] == "-embed")
-			{
-				if (dot == std::string::npos)
-					outputFileName += ".cpp";
-				else
-					outputFileName = outputFileName.substr(0, dot) + ".cpp";
-			}
-			else if (options[0] == "-archive")
-			{
-				if (dot == std::string::npos)
-					outputFileName += ".na";
-				else
-					outputFileName = outputFileName.substr(0, dot) + ".na";
-			}
-			else
-			{
-				throw bad_usage();
-			}
-		}
-		if (options.empty() || options[0] == "-embed")
+			outputFileName = boost::filesystem::path(inputFileName).replace_extension(mode == "-archive" ? ".na" : ".cpp").string();
+		auto const resources = read_resources(inputFileName, input);
+		if (mode == "-embed")
 		{
 			std::ofstream output(outputFileName);
 			output << "// This is a automatically generated file, do not edit!" << std::endl;
 			output << "#include <neogfx/app/resource_manager.hpp>" << std::endl << std::endl;
 			output << "namespace nrc" << std::endl << "{" << std::endl;
 			output << "namespace" << std::endl << "{" << std::endl;
-			std::vector<std::string> resourcePaths;
-			uint32_t resourceIndex = 0;
-			for (const auto& resource : input.root())
+			for (std::size_t resourceIndex = 0; resourceIndex < resources.size(); ++resourceIndex)
 			{
-				if (resource.name() == "resource")
+				std::cout << "Processing " << resources[resourceIndex].filePath << "..." << std::endl;
+				std::ifstream resourceFile(resources[resourceIndex].filePath, std::ios_base::in | std::ios_base::binary);
+				output << "\tconst unsigned char resource_" << resourceIndex << "_data[] =" << std::endl << "\t{" << std::endl;
+				const std::size_t kBufferSize = 32;
+				bool doneSome = false;
+				unsigned char buffer[kBufferSize];
+				while (resourceFile)
 				{
-					for (const auto& file : resource)
+					resourceFile.read(reinterpret_cast<char*>(buffer), kBufferSize);
+					std::streamsize amount = resourceFile.gcount();
+					if (amount != 0)
 					{
-						if (file.name() == "file")
+						if (doneSome)
+							output << ", " << std::endl;
+						output << "\t\t";
+						for (std::size_t j = 0; j != amount;)
 						{
-							std::cout << "Processing " << std::string(file.text()) << "..." << std::endl;
-							resourcePaths.push_back((resource.has_attribute("prefix") ? std::string(resource.attribute_value("prefix")) + "/" : "") + std::string(file.text()));
-							std::string resourcePath = boost::filesystem::path(inputFileName).parent_path().string();
-							if (!resourcePath.empty())
-								resourcePath += "/";
-							resourcePath += std::string(file.text());
-							std::ifstream resourceFile(resourcePath, std::ios_base::in | std::ios_base::binary);
-							output << "\tconst unsigned char resource_" << resourceIndex << "_data[] =" << std::endl << "\t{" << std::endl;
-							const std::size_t kBufferSize = 32;
-							bool doneSome = false;
-							unsigned char buffer[kBufferSize];
-							while (resourceFile)
-							{
-								resourceFile.read(reinterpret_cast<char*>(buffer), kBufferSize);
-								std::streamsize amount = resourceFile.gcount();
-								if (amount != 0)
-								{
-									if (doneSome)
-										output << ", " << std::endl;
-									output << "\t\t";
-									for (std::size_t j = 0; j != amount;)
-									{
-										output << "0x";
-										output.width(2);
-										output.fill('0');
-										output << std::hex << std::uppercase << static_cast<unsigned int>(buffer[j]);
-										if (++j != amount)
-											output << ", ";
-									}
-									doneSome = true;
-								}
-								else
-								{
-									output << std::endl;
-									break;
-								}
-							}
-							if (resourceFile.fail() && !resourceFile.eof())
-								throw failed_to_read_resource_file(resourcePath);
-							output << "\t};" << std::endl;
-							++resourceIndex;
+							output << "0x";
+							output.width(2);
+							output.fill('0');
+							output << std::hex << std::uppercase << static_cast<unsigned int>(buffer[j]);
+							if (++j != amount)
+								output << ", ";
 						}
+						doneSome = true;
+					}
+					else
+					{
+						output << std::endl;
+						break;
 					}
 				}
+				if (resourceFile.fail() && !resourceFile.eof())
+					throw failed_to_read_resource_file(resources[resourceIndex].filePath);
+				output << std::dec << "\t};" << std::endl;
 			}
 			output << "\tstruct register_data" << std::endl << "\t{" << std::endl;
 			output << "\t\tregister_data()" << std::endl << "\t\t{" << std::endl;
-			for (std::size_t i = 0; i < resourcePaths.size(); ++i)
+			for (std::size_t i = 0; i < resources.size(); ++i)
 			{
 				output << "\t\t\tneogfx::resource_manager::instance().add_module_resource("
-					<< "\":/" << resourcePaths[i] << "\", " << "resource_" << i << "_data, " << "sizeof(resource_" << i << "_data)"
+					<< "\":/" << resources[i].resourcePath << "\", " << "resource_" << i << "_data, " << "sizeof(resource_" << i << "_data)"
 					<< ");" << std::endl;
 			}
 			output << "\t\t}" << std::endl;
@@ -158,10 +227,56 @@ int main(int argc, char* argv[])
 				output << "void* " << input.root().attribute_value("ref") << " = &sData;" << std::endl;
 			output << "}" << std::endl;
 		}
+		else if (mode == "-archive")
+			write_archive(resources, outputFileName);
+		else
+		{
+			std::string const archiveFileName = boost::filesystem::path(outputFileName).replace_extension(".na").string();
+			write_archive(resources, archiveFileName);
+			std::string const symbol = "nrc_" + identifier(boost::filesystem::path(inputFileName).stem().string()) + "_archive";
+			std::ofstream output(outputFileName);
+			output << "// This is a automatically generated file, do not edit!" << std::endl;
+			output << "#include <neogfx/app/resource_manager.hpp>" << std::endl << std::endl;
+			output << "#if !defined(__GNUC__)" << std::endl;
+			output << "#error nrc -incbin output requires an assembler with .incbin (GCC or Clang); use nrc -embed with this compiler" << std::endl;
+			output << "#endif" << std::endl << std::endl;
+			output << "#if defined(__APPLE__)" << std::endl;
+			output << "#define NRC_SECTION_BEGIN \".const_data\\n\"" << std::endl;
+			output << "#define NRC_SECTION_END \".text\\n\"" << std::endl;
+			output << "#define NRC_SYMBOL(name) \"_\" #name" << std::endl;
+			output << "#else" << std::endl;
+			output << "#define NRC_SECTION_BEGIN \".pushsection .rodata\\n\"" << std::endl;
+			output << "#define NRC_SECTION_END \".popsection\\n\"" << std::endl;
+			output << "#define NRC_SYMBOL(name) #name" << std::endl;
+			output << "#endif" << std::endl << std::endl;
+			output << "extern \"C\" const unsigned char " << symbol << "[];" << std::endl;
+			output << "extern \"C\" const unsigned char " << symbol << "_end[];" << std::endl << std::endl;
+			output << "__asm__(" << std::endl;
+			output << "\tNRC_SECTION_BEGIN" << std::endl;
+			output << "\t\".balign " << neogfx::resource_archive::DataAlignment << "\\n\"" << std::endl;
+			output << "\t\".global \" NRC_SYMBOL(" << symbol << ") \"\\n\"" << std::endl;
+			output << "\tNRC_SYMBOL(" << symbol << ") \":\\n\"" << std::endl;
+			output << "\t\".incbin \\\"" << boost::filesystem::absolute(archiveFileName).generic_string() << "\\\"\\n\"" << std::endl;
+			output << "\t\".global \" NRC_SYMBOL(" << symbol << "_end) \"\\n\"" << std::endl;
+			output << "\tNRC_SYMBOL(" << symbol << "_end) \":\\n\"" << std::endl;
+			output << "\tNRC_SECTION_END);" << std::endl << std::endl;
+			output << "namespace nrc" << std::endl << "{" << std::endl;
+			output << "namespace" << std::endl << "{" << std::endl;
+			output << "\tstruct register_data" << std::endl << "\t{" << std::endl;
+			output << "\t\tregister_data()" << std::endl << "\t\t{" << std::endl;
+			output << "\t\t\tneogfx::resource_manager::instance().add_module_archive(" << symbol << ", " << symbol << "_end - " << symbol << ");" << std::endl;
+			output << "\t\t}" << std::endl;
+			output << "\t} sData;" << std::endl;
+			output << "}" << std::endl;
+			if (input.root().has_attribute("ref"))
+				output << "void* " << input.root().attribute_value("ref") << " = &sData;" << std::endl;
+			output << "}" << std::endl;
+		}
 	}
 	catch (const bad_usage&)
 	{
-		std::cerr << "Usage: " << argv[0] << " [-embed|-archive] <input path> [<output path>]" << std::endl;
+		std::cerr << "Usage: " << argv[0] << " [-embed|-archive|-incbin] <input path> [<output path>]" << std::endl;
+		std::cerr << "       " << argv[0] << " -emoji <emoji.zip path> [<index output path>]" << std::endl;
 		return EXIT_FAILURE;
 	}
 	catch (const std::exception& e)
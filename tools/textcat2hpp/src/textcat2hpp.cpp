@@ -0,0 +1,78 @@
+// textcat2hpp.cpp : Generates the two-stage text category/script lookup tables as constexpr data.
+//
+
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <neogfx/gfx/text/text_category_map.hpp>
+
+using namespace neogfx;
+using namespace neogfx::detail;
+
+namespace
+{
+	const uint32_t BlockBits = 7u;
+	const uint32_t BlockSize = 1u << BlockBits;
+	const uint32_t CodePointLimit = 0x110000u;
+
+	void write_array(std::ofstream& aOutput, const char* aName, const std::vector<uint16_t>& aValues)
+	{
+		aOutput << "\t\tconstexpr uint16_t " << aName << "[" << std::dec << aValues.size() << "] =\n\t\t{";
+		for (std::size_t i = 0; i < aValues.size(); ++i)
+		{
+			if (i != 0)
+				aOutput << ",";
+			aOutput << (i % 16 == 0 ? "\n\t\t\t" : " ");
+			aOutput << "0x" << std::hex << std::setw(4) << std::setfill('0') << aValues[i];
+		}
+		aOutput << "\n\t\t};\n";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	auto const categoryEnd = &TEXT_CATEGORY_MAP[0] + sizeof(TEXT_CATEGORY_MAP) / sizeof(TEXT_CATEGORY_MAP[0]);
+	auto const scriptEnd = &TEXT_SCRIPT_MAP[0] + sizeof(TEXT_SCRIPT_MAP) / sizeof(TEXT_SCRIPT_MAP[0]);
+	auto nextCategory = &TEXT_CATEGORY_MAP[0];
+	auto nextScript = &TEXT_SCRIPT_MAP[0];
+	text_category currentCategory = text_category::Unknown;
+	text_script currentScript = text_script::Unknown;
+	std::map<std::vector<uint16_t>, uint16_t> uniqueBlocks;
+	std::vector<uint16_t> blockIndex(CodePointLimit >> BlockBits);
+	std::vector<uint16_t> blocks;
+	std::vector<uint16_t> block(BlockSize);
+	for (uint32_t blockStart = 0u; blockStart < CodePointLimit; blockStart += BlockSize)
+	{
+		for (uint32_t i = 0u; i < BlockSize; ++i)
+		{
+			uint32_t codePoint = blockStart + i;
+			while (nextCategory != categoryEnd && nextCategory->first <= codePoint)
+				currentCategory = (nextCategory++)->second;
+			while (nextScript != scriptEnd && nextScript->first <= codePoint)
+				currentScript = (nextScript++)->second;
+			text_script script = currentScript;
+			if (currentCategory == text_category::Unknown)
+				script = text_script::Unknown;
+			else if (currentCategory == text_category::Mark && script == text_script::Common)
+				script = text_script::Inherited;
+			block[i] = static_cast<uint16_t>((static_cast<uint16_t>(script) << 8u) | static_cast<uint16_t>(currentCategory));
+		}
+		auto existing = uniqueBlocks.find(block);
+		if (existing == uniqueBlocks.end())
+		{
+			existing = uniqueBlocks.emplace(block, static_cast<uint16_t>(blocks.size() / BlockSize)).first;
+			blocks.insert(blocks.end(), block.begin(), block.end());
+		}
+		blockIndex[blockStart >> BlockBits] = existing->second;
+	}
+	std::ofstream output(argv[1]);
+	output << "// Generated by textcat2hpp from text_category_map.hpp; do not edit.\n\n";
+	output << "namespace neogfx\n{\n\tnamespace detail\n\t{\n";
+	output << "\t\tconstexpr uint32_t TEXT_CATEGORY_BLOCK_BITS = " << std::dec << BlockBits << "u;\n";
+	output << "\t\tconstexpr uint32_t TEXT_CATEGORY_CODE_POINT_LIMIT = 0x" << std::hex << CodePointLimit << "u;\n";
+	write_array(output, "TEXT_CATEGORY_BLOCK_INDEX", blockIndex);
+	write_array(output, "TEXT_CATEGORY_BLOCKS", blocks);
+	output << "\t}\n}\n";
+	return 0;
+}